@@ -0,0 +1,140 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "core/cdrom_async_reader.h"
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <gtest/gtest.h>
+#include <random>
+#include <thread>
+
+namespace {
+
+static constexpr u32 NUM_SECTORS = 20000;
+static constexpr u32 NUM_ITERATIONS = 20000;
+static constexpr auto HANG_TIMEOUT = std::chrono::seconds(60);
+
+// Sectors are generated from their LBA, so reads can be checked without any backing file. Every sector gets its own
+// index, which makes seeks scan the whole index list, and widens the window the read thread spends seeking unlocked.
+class TestImage final : public CDImage
+{
+public:
+  TestImage()
+  {
+    m_filename = "test.bin";
+    m_lba_count = NUM_SECTORS;
+
+    SubChannelQ::Control control = {};
+    control.data = true;
+
+    Index pregap_index = {};
+    pregap_index.file_sector_size = RAW_SECTOR_SIZE;
+    pregap_index.start_lba_in_track = static_cast<LBA>(-static_cast<s32>(2 * FRAMES_PER_SECOND));
+    pregap_index.length = 2 * FRAMES_PER_SECOND;
+    pregap_index.track_number = 1;
+    pregap_index.mode = TrackMode::Mode2Raw;
+    pregap_index.control.bits = control.bits;
+    pregap_index.is_pregap = true;
+    m_indices.push_back(pregap_index);
+
+    for (u32 i = 0; i < NUM_SECTORS; i++)
+    {
+      Index data_index = {};
+      data_index.file_offset = static_cast<u64>(i) * RAW_SECTOR_SIZE;
+      data_index.file_sector_size = RAW_SECTOR_SIZE;
+      data_index.start_lba_on_disc = pregap_index.length + i;
+      data_index.track_number = 1;
+      data_index.index_number = 1 + (i % 98);
+      data_index.start_lba_in_track = i;
+      data_index.length = 1;
+      data_index.mode = TrackMode::Mode2Raw;
+      data_index.control.bits = control.bits;
+      m_indices.push_back(data_index);
+    }
+
+    m_tracks.push_back(Track{1, pregap_index.length, 1, m_lba_count, TrackMode::Mode2Raw, control});
+    AddLeadOutIndex();
+    Seek(1, Position{0, 0, 0});
+  }
+
+  static void FillSector(u8* buffer, LBA lba)
+  {
+    for (u32 i = 0; i < RAW_SECTOR_SIZE; i += sizeof(lba))
+      std::memcpy(&buffer[i], &lba, sizeof(lba));
+  }
+
+  static bool CheckSector(const u8* buffer, LBA lba)
+  {
+    std::array<u8, RAW_SECTOR_SIZE> expected;
+    FillSector(expected.data(), lba);
+    return (std::memcmp(buffer, expected.data(), RAW_SECTOR_SIZE) == 0);
+  }
+
+protected:
+  bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override
+  {
+    FillSector(static_cast<u8*>(buffer), index.start_lba_on_disc + lba_in_index);
+    return true;
+  }
+};
+
+static CDImage::LBA RandomLBA(std::mt19937& rng)
+{
+  return 2 * CDImage::FRAMES_PER_SECOND + (rng() % NUM_SECTORS);
+}
+
+} // namespace
+
+TEST(CDROMAsyncReader, UncachedReadsDuringSeeks)
+{
+  CDROMAsyncReader reader;
+  reader.StartThread();
+  reader.SetMedia(std::make_unique<TestImage>());
+
+  // A deadlock would hang the test forever, so run it on another thread and give up if it doesn't finish.
+  std::promise<u32> done;
+  std::future<u32> done_future = done.get_future();
+  std::thread([&reader, &done]() {
+    std::mt19937 rng(0x1234567u);
+    CDROMAsyncReader::SectorBuffer buffer;
+    CDImage::SubChannelQ subq;
+    u32 failures = 0;
+    for (u32 i = 0; i < NUM_ITERATIONS; i++)
+    {
+      // Give the read thread a varying head start, so the uncached read lands at different points of the seek.
+      const CDImage::LBA queued_lba = RandomLBA(rng);
+      reader.QueueReadSector(queued_lba);
+      for (u32 spin = rng() % 2048; spin > 0; spin--)
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+
+      const CDImage::LBA uncached_lba = RandomLBA(rng);
+      if (!reader.ReadSectorUncached(uncached_lba, &subq, &buffer) ||
+          !TestImage::CheckSector(buffer.data(), uncached_lba))
+      {
+        failures++;
+      }
+
+      // The queued sector should be unaffected by the uncached read.
+      if (!reader.WaitForReadToComplete() || reader.GetLastReadSector() != queued_lba ||
+          !TestImage::CheckSector(reader.GetSectorBuffer(), queued_lba))
+      {
+        failures++;
+      }
+    }
+
+    reader.WaitForIdle();
+    done.set_value(failures);
+  }).detach();
+
+  // Can't clean up after a hang, the reader's threads are stuck.
+  if (done_future.wait_for(HANG_TIMEOUT) != std::future_status::ready)
+  {
+    ADD_FAILURE() << "Reader hung during uncached reads";
+    std::fflush(stdout);
+    std::_Exit(1);
+  }
+
+  EXPECT_EQ(done_future.get(), 0u);
+  reader.StopThread();
+}
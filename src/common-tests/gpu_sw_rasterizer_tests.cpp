@@ -0,0 +1,97 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "core/gpu_sw_rasterizer.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+namespace {
+
+static constexpr u32 NUM_SPANS_PER_VARIANT = 500;
+static constexpr u32 MAX_SPAN_WIDTH = 64;
+
+template<bool shading_enable, bool texture_enable, bool raw_texture_enable, bool transparency_enable,
+         bool dithering_enable>
+static void TestSpanVariant(std::mt19937& rng, const std::vector<u16>& initial_vram)
+{
+  std::vector<u16> scalar_vram(initial_vram);
+  std::vector<u16> vector_vram(initial_vram);
+
+  for (u32 i = 0; i < NUM_SPANS_PER_VARIANT; i++)
+  {
+    GPUBackendDrawCommand cmd = {};
+    cmd.params.bits = static_cast<u8>(rng() & 0x0Cu); // mask bits only
+    cmd.draw_mode.bits = static_cast<u16>(rng() & GPUDrawModeReg::MASK);
+    cmd.palette.bits = static_cast<u16>(rng() & GPUTexturePaletteReg::MASK);
+    cmd.window.and_x = static_cast<u8>(rng());
+    cmd.window.and_y = static_cast<u8>(rng());
+    cmd.window.or_x = static_cast<u8>(rng() & ~cmd.window.and_x);
+    cmd.window.or_y = static_cast<u8>(rng() & ~cmd.window.and_y);
+
+    const u32 x = rng() % VRAM_WIDTH;
+    const u32 y = rng() % VRAM_HEIGHT;
+    const u32 width = 1 + (rng() % std::min<u32>(MAX_SPAN_WIDTH, VRAM_WIDTH - x));
+
+    // Keep the steps small sometimes, so we get runs of identical texels/colours as well as noise.
+    const u32 step_shift = rng() % 16;
+    GPU_SW_Rasterizer::SpanInterpolants start, step;
+    for (u32* value : {&start.u, &start.v, &start.r, &start.g, &start.b})
+      *value = static_cast<u32>(rng());
+    for (u32* value : {&step.u, &step.v, &step.r, &step.g, &step.b})
+      *value = static_cast<u32>(rng()) >> step_shift;
+
+    GPU_SW_Rasterizer::DrawSpanScalar<shading_enable, texture_enable, raw_texture_enable, transparency_enable,
+                                      dithering_enable>(scalar_vram.data(), &cmd, x, y, width, start, step);
+    GPU_SW_Rasterizer::DrawSpan<shading_enable, texture_enable, raw_texture_enable, transparency_enable,
+                                dithering_enable>(vector_vram.data(), &cmd, x, y, width, start, step);
+
+    const u16* scalar_row = &scalar_vram[VRAM_WIDTH * y];
+    const u16* vector_row = &vector_vram[VRAM_WIDTH * y];
+    for (u32 col = 0; col < VRAM_WIDTH; col++)
+    {
+      ASSERT_EQ(scalar_row[col], vector_row[col])
+        << "shading=" << shading_enable << " texture=" << texture_enable << " raw=" << raw_texture_enable
+        << " transparency=" << transparency_enable << " dithering=" << dithering_enable << " x=" << x << " y=" << y
+        << " width=" << width << " col=" << col;
+    }
+  }
+}
+
+template<u32 variant>
+static void TestAllSpanVariants(std::mt19937& rng, const std::vector<u16>& initial_vram)
+{
+  TestSpanVariant<(variant & 1u) != 0, (variant & 2u) != 0, (variant & 4u) != 0, (variant & 8u) != 0,
+                  (variant & 16u) != 0>(rng, initial_vram);
+
+  if constexpr (variant < 31)
+    TestAllSpanVariants<variant + 1>(rng, initial_vram);
+}
+
+} // namespace
+
+TEST(GPU_SW_Rasterizer, DitherLUTMatchesMatrix)
+{
+  for (u32 i = 0; i < DITHER_MATRIX_SIZE; i++)
+  {
+    for (u32 j = 0; j < DITHER_MATRIX_SIZE; j++)
+    {
+      ASSERT_EQ(GPU_SW_Rasterizer::g_dither_lut[i][j][0], 0);
+      ASSERT_EQ(GPU_SW_Rasterizer::g_dither_lut[i][j][GPU_SW_Rasterizer::DITHER_LUT_SIZE - 1], 31);
+    }
+  }
+}
+
+TEST(GPU_SW_Rasterizer, VectorSpanMatchesScalar)
+{
+  std::mt19937 rng(0x1234567u);
+  std::vector<u16> vram(VRAM_WIDTH * VRAM_HEIGHT);
+  for (u16& pixel : vram)
+  {
+    // Plenty of zero (transparent) texels and mask bits.
+    const u32 value = rng();
+    pixel = ((value >> 16) % 8 == 0) ? 0 : static_cast<u16>(value);
+  }
+
+  TestAllSpanVariants<0>(rng, vram);
+}
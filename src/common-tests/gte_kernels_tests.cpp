@@ -0,0 +1,256 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "core/gte_kernels.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+
+namespace {
+
+static constexpr u32 NUM_ITERATIONS = 100000;
+
+struct RecordedCase
+{
+  const char* name;
+  s16 M[9];
+  s32 T[3];
+  s16 V[3];
+  u8 shift;
+  bool lm;
+  s32 mac[3];
+  s32 ir[3];
+  s32 mac3_sar12;
+  u32 flags;
+};
+
+// Recorded from the per-step implementation the kernels replaced. Covers the saturation and wrapping corner cases, and
+// both sides of the vector path's translation limit.
+static constexpr RecordedCase s_recorded_cases[] = {
+  {"identity",
+   {4096, 0, 0, 0, 4096, 0, 0, 0, 4096},
+   {0, 0, 0},
+   {100, -200, 300},
+   12, false,
+   {100, -200, 300},
+   {100, -200, 300},
+   300, 0x00000000},
+  {"rotate and translate",
+   {3784, -1568, 0, 896, 3196, -2304, 1296, 2560, 3360},
+   {-120, 45, 2200},
+   {-512, 384, -96},
+   12, false,
+   {-740, 286, 2199},
+   {-740, 286, 2199},
+   2199, 0x00000000},
+  {"sf=0 wraps MAC",
+   {3784, -1568, 0, 896, 3196, -2304, 1296, 2560, 3360},
+   {-120, 45, 2200},
+   {-512, 384, -96},
+   0, false,
+   {-3031040, 1174016, 9008128},
+   {-32768, 32767, 32767},
+   2199, 0x01C00000},
+  {"lm clamps negative IR",
+   {2048, 2048, 2048, -2048, -2048, -2048, 256, 512, 768},
+   {0, 0, 0},
+   {32767, 32767, 32767},
+   12, true,
+   {49150, -49151, 12287},
+   {32767, 0, 12287},
+   12287, 0x01800000},
+  {"IR saturates",
+   {32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767},
+   {0, 0, 0},
+   {32767, 32767, 32767},
+   12, false,
+   {786384, 786384, 786384},
+   {32767, 32767, 32767},
+   786384, 0x01C00000},
+  {"IR saturates sf=0",
+   {32767, 32767, 32767, 0, 0, 0, -32767, -32767, -32767},
+   {0, 0, 0},
+   {32767, 32767, 32767},
+   0, false,
+   {-1073938429, 0, 1073938429},
+   {-32768, 0, 32767},
+   -786385, 0x01400000},
+  {"8000h*8000h pairs",
+   {-32768, -32768, -32768, -32768, -32768, 0, 0, 0, -32768},
+   {0, 0, 0},
+   {-32768, -32768, -32768},
+   12, false,
+   {786432, 524288, 262144},
+   {32767, 32767, 32767},
+   262144, 0x01C00000},
+  {"8000h*8000h pairs sf=0",
+   {-32768, -32768, -32768, -32768, -32768, 0, 0, 0, -32768},
+   {0, 0, 0},
+   {-32768, -32768, -32768},
+   0, true,
+   {-1073741824, -2147483648, 1073741824},
+   {0, 0, 32767},
+   262144, 0x01C00000},
+  {"MAC overflow and underflow",
+   {32767, 32767, 32767, -32768, -32768, -32768, 4096, 0, 0},
+   {2147483647, -2147483648, 2147483647},
+   {32767, 32767, 32767},
+   12, false,
+   {-2146697265, 2146697240, -2147450882},
+   {-32768, 32767, -32768},
+   -2147450882, 0x55C00000},
+  {"intermediate overflow wraps",
+   {32767, 0, 0, 0, 32767, 0, 0, 0, 32767},
+   {2147479552, -2147479552, 1073741824},
+   {-32768, 32767, -32768},
+   0, false,
+   {-1090486272, 1090453505, -1073709056},
+   {-32768, 32767, -32768},
+   1073479688, 0x01C00000},
+  {"largest fast path translation",
+   {4096, 4096, 4096, 4096, 4096, 4096, 4096, 4096, 4096},
+   {1073741823, -1073741824, 536870912},
+   {1, -1, 1},
+   12, false,
+   {1073741824, -1073741823, 536870913},
+   {32767, -32768, 32767},
+   536870913, 0x01C00000},
+  {"smallest slow path translation",
+   {4096, 4096, 4096, 4096, 4096, 4096, 4096, 4096, 4096},
+   {1073741824, -1073741825, 4096},
+   {1, -1, 1},
+   12, false,
+   {1073741825, -1073741824, 4097},
+   {32767, -32768, 4097},
+   4097, 0x01800000},
+  {"SAR rounds down",
+   {1, 0, 0, 0, 1, 0, 0, 0, 1},
+   {0, 0, 0},
+   {-1, -4095, -4097},
+   12, false,
+   {-1, -1, -2},
+   {-1, -1, -2},
+   -2, 0x00000000},
+  {"fraction carry",
+   {4095, 4095, 0, 4095, 4095, 0, 4095, 4095, 4095},
+   {-1, 1, 0},
+   {32767, 32767, 32767},
+   12, false,
+   {65517, 65519, 98277},
+   {32767, 32767, 32767},
+   98277, 0x01C00000},
+  {"RTP SZ3 with sf=0",
+   {0, 0, 32, 0, 64, 0, 128, 0, 0},
+   {0, 0, 7000},
+   {3000, -20000, 30000},
+   0, false,
+   {960000, -1280000, 29056000},
+   {32767, -32768, 32767},
+   7093, 0x01C00000},
+  {"lm IR3",
+   {0, 0, 4096, 0, 4096, 0, 4096, 0, 0},
+   {0, 0, -9},
+   {-30000, 0, 30000},
+   12, true,
+   {30000, 0, -30009},
+   {30000, 0, 0},
+   -30009, 0x00400000},
+};
+
+static void ExpectResultsEqual(const GTE_Kernels::MatVecResult& expected, const GTE_Kernels::MatVecResult& actual,
+                               u32 iteration)
+{
+  for (u32 i = 0; i < 3; i++)
+  {
+    ASSERT_EQ(expected.mac[i], actual.mac[i]) << "iteration=" << iteration << " row=" << i;
+    ASSERT_EQ(expected.ir[i], actual.ir[i]) << "iteration=" << iteration << " row=" << i;
+  }
+  ASSERT_EQ(expected.mac3_sar12, actual.mac3_sar12) << "iteration=" << iteration;
+  ASSERT_EQ(expected.flags, actual.flags) << "iteration=" << iteration;
+}
+
+static s16 RandomComponent(std::mt19937& rng)
+{
+  // Mostly fixed point values around 1.0, with the limits thrown in.
+  const u32 value = rng();
+  switch ((value >> 16) % 8)
+  {
+    case 0:
+      return static_cast<s16>((value & 1) ? 0x7FFF : -0x8000);
+    case 1:
+      return static_cast<s16>(value);
+    default:
+      return static_cast<s16>(static_cast<s32>(value % 0x4000) - 0x2000);
+  }
+}
+
+static s32 RandomTranslation(std::mt19937& rng)
+{
+  const u32 value = rng();
+  switch ((value >> 24) % 8)
+  {
+    case 0:
+      return static_cast<s32>(rng());
+    case 1:
+      return ((value & 1) ? 1 : -1) * static_cast<s32>((1u << 30) - (value % 2));
+    default:
+      return static_cast<s32>(value % 0x20000) - 0x10000;
+  }
+}
+
+} // namespace
+
+TEST(GTE_Kernels, MulMatVecMatchesRecordedResults)
+{
+  for (const RecordedCase& rc : s_recorded_cases)
+  {
+    SCOPED_TRACE(rc.name);
+
+    const GTE_Kernels::MatVecResult expected = {
+      {rc.mac[0], rc.mac[1], rc.mac[2]}, {rc.ir[0], rc.ir[1], rc.ir[2]}, rc.mac3_sar12, rc.flags};
+    const s16* const V[1] = {rc.V};
+
+    GTE_Kernels::MatVecResult scalar_res, res;
+    GTE_Kernels::MulMatVecScalar(&scalar_res, rc.M, rc.T, rc.V, rc.shift, rc.lm);
+    GTE_Kernels::MulMatVec<1>(&res, rc.M, rc.T, V, rc.shift, rc.lm);
+    ExpectResultsEqual(expected, scalar_res, 0);
+    ExpectResultsEqual(expected, res, 0);
+  }
+}
+
+TEST(GTE_Kernels, MulMatVecMatchesScalar)
+{
+  std::mt19937 rng(0x9E3779B9u);
+  for (u32 i = 0; i < NUM_ITERATIONS; i++)
+  {
+    s16 M[9];
+    s32 T[3];
+    s16 V[3][3];
+    for (s16& value : M)
+      value = RandomComponent(rng);
+    for (s32& value : T)
+      value = ((rng() % 4) == 0) ? 0 : RandomTranslation(rng);
+    for (auto& vertex : V)
+    {
+      for (s16& value : vertex)
+        value = RandomComponent(rng);
+    }
+
+    // Keep -8000h out of most matrices, otherwise the vector path is rarely taken.
+    if ((rng() % 4) != 0)
+      std::replace(std::begin(M), std::end(M), static_cast<s16>(-0x8000), static_cast<s16>(-0x7FFF));
+
+    const u8 shift = (rng() & 1) ? 12 : 0;
+    const bool lm = (rng() & 1) != 0;
+    const s16* const vertices[3] = {V[0], V[1], V[2]};
+
+    GTE_Kernels::MatVecResult res[3];
+    GTE_Kernels::MulMatVec<3>(res, M, T, vertices, shift, lm);
+    for (u32 j = 0; j < 3; j++)
+    {
+      GTE_Kernels::MatVecResult scalar_res;
+      GTE_Kernels::MulMatVecScalar(&scalar_res, M, T, V[j], shift, lm);
+      ExpectResultsEqual(scalar_res, res[j], i);
+    }
+  }
+}
@@ -0,0 +1,135 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "core/mdec_kernels.h"
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+
+static constexpr u32 NUM_ITERATIONS = 10000;
+
+// The float conversion the fixed point constants replaced. volatile keeps the compiler from fusing the G terms.
+static s16 FloatChromaToR(s16 cr)
+{
+  return static_cast<s16>(1.402f * static_cast<float>(cr));
+}
+
+static s16 FloatChromaToG(s16 cr, s16 cb)
+{
+  volatile float cb_term = -0.3437f * static_cast<float>(cb);
+  volatile float cr_term = -0.7143f * static_cast<float>(cr);
+  return static_cast<s16>(cb_term + cr_term);
+}
+
+static s16 FloatChromaToB(s16 cb)
+{
+  return static_cast<s16>(1.772f * static_cast<float>(cb));
+}
+
+static s16 RandomSample(std::mt19937& rng)
+{
+  // Decoded samples are clamped, so the extremes are common.
+  const u32 value = rng();
+  if ((value >> 16) % 8 == 0)
+    return (value & 1) ? 127 : -128;
+  return static_cast<s16>(static_cast<s32>(value % 256) - 128);
+}
+
+} // namespace
+
+TEST(MDEC_Kernels, IDCTMatchesScalar)
+{
+  std::mt19937 rng(0x1234567u);
+  std::array<s16, 64> scale_table;
+  for (u32 i = 0; i < NUM_ITERATIONS; i++)
+  {
+    // Games usually upload the standard table once, but make sure arbitrary ones work too.
+    if (i % 100 == 0)
+    {
+      for (s16& value : scale_table)
+      {
+        const u32 rand = rng();
+        value = ((rand >> 16) % 16 == 0) ? static_cast<s16>((rand & 1) ? 0x7FFF : -0x8000) : static_cast<s16>(rand);
+      }
+    }
+
+    // Mostly sparse blocks, like real streams, with some at the limits of the RLE decoder's clamp.
+    MDEC_Kernels::Block scalar_blk = {};
+    const u32 num_coefficients = 1 + (rng() % 64);
+    for (u32 j = 0; j < num_coefficients; j++)
+    {
+      const u32 rand = rng();
+      scalar_blk[rand % 64] = ((rand >> 8) % 8 == 0) ? static_cast<s16>((rand & 0x100) ? 0x3FF : -0x400) :
+                                                       static_cast<s16>(static_cast<s32>((rand >> 16) % 2048) - 1024);
+    }
+
+    MDEC_Kernels::Block vector_blk = scalar_blk;
+    MDEC_Kernels::IDCTScalar(scalar_blk.data(), scale_table.data());
+    MDEC_Kernels::IDCT(vector_blk.data(), scale_table.data());
+    for (u32 j = 0; j < 64; j++)
+      ASSERT_EQ(scalar_blk[j], vector_blk[j]) << "iteration=" << i << " coefficient=" << j;
+  }
+}
+
+TEST(MDEC_Kernels, FixedPointChromaMatchesFloat)
+{
+  for (s32 cr = -128; cr <= 127; cr++)
+  {
+    ASSERT_EQ(MDEC_Kernels::ChromaToR(static_cast<s16>(cr)), FloatChromaToR(static_cast<s16>(cr))) << "cr=" << cr;
+    ASSERT_EQ(MDEC_Kernels::ChromaToB(static_cast<s16>(cr)), FloatChromaToB(static_cast<s16>(cr))) << "cb=" << cr;
+    for (s32 cb = -128; cb <= 127; cb++)
+    {
+      ASSERT_EQ(MDEC_Kernels::ChromaToG(static_cast<s16>(cr), static_cast<s16>(cb)),
+                FloatChromaToG(static_cast<s16>(cr), static_cast<s16>(cb)))
+        << "cr=" << cr << " cb=" << cb;
+    }
+  }
+}
+
+TEST(MDEC_Kernels, YUVToRGBMatchesScalar)
+{
+  // Every (Cr, Cb) pair once, 64 per macroblock, in both output modes.
+  std::mt19937 rng(0x7654321u);
+  u32 chroma = 0;
+  while (chroma < 0x10000)
+  {
+    MDEC_Kernels::Macroblock blocks;
+    for (u32 i = 0; i < 64; i++, chroma++)
+    {
+      blocks[0][i] = static_cast<s16>(static_cast<s32>(chroma & 0xFF) - 128);
+      blocks[1][i] = static_cast<s16>(static_cast<s32>(chroma >> 8) - 128);
+    }
+    for (u32 i = 2; i < MDEC_Kernels::NUM_BLOCKS; i++)
+    {
+      for (s16& sample : blocks[i])
+        sample = RandomSample(rng);
+    }
+
+    for (const bool signed_output : {false, true})
+    {
+      std::array<u32, MDEC_Kernels::MACROBLOCK_PIXELS> scalar_out, vector_out;
+      MDEC_Kernels::YUVToRGBScalar(scalar_out.data(), blocks, signed_output);
+      MDEC_Kernels::YUVToRGB(vector_out.data(), blocks, signed_output);
+      for (u32 i = 0; i < MDEC_Kernels::MACROBLOCK_PIXELS; i++)
+        ASSERT_EQ(scalar_out[i], vector_out[i]) << "signed=" << signed_output << " pixel=" << i;
+    }
+  }
+}
+
+TEST(MDEC_Kernels, YToMonoMatchesScalar)
+{
+  // Every 16-bit input, the old IDCT routines are not clamped to 8 bits.
+  for (u32 base = 0; base < 0x10000; base += 64)
+  {
+    MDEC_Kernels::Block blk;
+    for (u32 i = 0; i < 64; i++)
+      blk[i] = static_cast<s16>(base + i);
+
+    std::array<u32, 64> scalar_out, vector_out;
+    MDEC_Kernels::YToMonoScalar(scalar_out.data(), blk);
+    MDEC_Kernels::YToMono(vector_out.data(), blk);
+    for (u32 i = 0; i < 64; i++)
+      ASSERT_EQ(scalar_out[i], vector_out[i]) << "input=" << blk[i];
+  }
+}
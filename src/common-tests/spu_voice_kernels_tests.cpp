@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "core/spu_voice_kernels.h"
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+
+static constexpr u32 NUM_ITERATIONS = 10000;
+
+} // namespace
+
+TEST(SPU_VoiceKernels, ExpandADPCMNibblesMatchesScalar)
+{
+  std::mt19937 rng(0x1234567u);
+  for (u32 i = 0; i < NUM_ITERATIONS; i++)
+  {
+    std::array<u8, SPU_VoiceKernels::ADPCM_BLOCK_SIZE> block;
+    for (u8& value : block)
+      value = static_cast<u8>(rng());
+
+    // Reserved shifts are mapped to 9 before decoding, so only 0..12 are valid.
+    const u8 shift = static_cast<u8>(rng() % 13);
+
+    std::array<s16, SPU_VoiceKernels::NUM_EXPANDED_ADPCM_SAMPLES> scalar_out, vector_out;
+    SPU_VoiceKernels::ExpandADPCMNibblesScalar(block.data(), shift, scalar_out.data());
+    SPU_VoiceKernels::ExpandADPCMNibbles(block.data(), shift, vector_out.data());
+    for (u32 j = 0; j < SPU_VoiceKernels::NUM_SAMPLES_PER_ADPCM_BLOCK; j++)
+      ASSERT_EQ(scalar_out[j], vector_out[j]) << "shift=" << static_cast<u32>(shift) << " sample=" << j;
+  }
+}
+
+TEST(SPU_VoiceKernels, InterpolateVoicesMatchesScalar)
+{
+  std::mt19937 rng(0x7654321u);
+  for (u32 i = 0; i < NUM_ITERATIONS; i++)
+  {
+    // Full-scale samples, including the extremes, which give the largest sums.
+    std::array<s16, 4> samples;
+    SPU_VoiceKernels::InterpolationInputs inputs;
+    for (u32 voice = 0; voice < SPU_VoiceKernels::NUM_VOICES; voice++)
+    {
+      for (s16& sample : samples)
+      {
+        const u32 value = rng();
+        sample = ((value >> 16) % 8 == 0) ? static_cast<s16>((value & 1) ? 0x7FFF : -0x8000) : static_cast<s16>(value);
+      }
+
+      if (rng() % 16 == 0)
+        inputs.ClearVoice(voice);
+      else
+        inputs.SetVoice(voice, &samples[3], static_cast<u8>(rng()));
+    }
+
+    std::array<s32, SPU_VoiceKernels::NUM_VOICES> scalar_out, vector_out;
+    SPU_VoiceKernels::InterpolateVoicesScalar(inputs, scalar_out.data());
+    SPU_VoiceKernels::InterpolateVoices(inputs, vector_out.data());
+    for (u32 voice = 0; voice < SPU_VoiceKernels::NUM_VOICES; voice++)
+      ASSERT_EQ(scalar_out[voice], vector_out[voice]) << "voice=" << voice;
+  }
+}
@@ -4,22 +4,39 @@
 #include "memmap.h"
 #include "align.h"
 #include "assert.h"
+#include "error.h"
 #include "log.h"
 #include "string_util.h"
 
 #include "fmt/format.h"
 
+#include <atomic>
+#include <cstring>
+
 #if defined(_WIN32)
 #include "windows_headers.h"
 #elif !defined(__ANDROID__)
 #include <cerrno>
+#include <csetjmp>
+#include <csignal>
 #include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #endif
 
 Log_SetChannel(MemoryArena);
 
+static bool AccessMappedFile(void* buffer, const u8* data, size_t size);
+
+static void TouchPages(const u8* data, size_t size)
+{
+  for (size_t offset = 0; offset < size; offset += HOST_PAGE_SIZE)
+    static_cast<void>(static_cast<const volatile u8*>(data)[offset]);
+  if (size > 0)
+    static_cast<void>(static_cast<const volatile u8*>(data)[size - 1]);
+}
+
 #ifdef _WIN32
 
 bool MemMap::MemProtect(void* baseaddr, size_t size, PageProtect mode)
@@ -267,6 +284,84 @@ bool SharedMemoryMappingArea::Unmap(void* map_base, size_t map_size)
   return true;
 }
 
+// Paging errors in file views are raised as EXCEPTION_IN_PAGE_ERROR. No objects with destructors allowed in here.
+bool AccessMappedFile(void* buffer, const u8* data, size_t size)
+{
+  __try
+  {
+    if (buffer)
+      std::memcpy(buffer, data, size);
+    else
+      TouchPages(data, size);
+  }
+  __except (GetExceptionCode() == EXCEPTION_IN_PAGE_ERROR ? EXCEPTION_EXECUTE_HANDLER : EXCEPTION_CONTINUE_SEARCH)
+  {
+    return false;
+  }
+
+  return true;
+}
+
+bool MappedFile::InstallFaultHandler()
+{
+  // structured exception handling doesn't need anything installed
+  return true;
+}
+
+bool MappedFile::Open(const char* path, Error* error)
+{
+  Close();
+
+  const HANDLE file = CreateFileW(StringUtil::UTF8StringToWideString(path).c_str(), GENERIC_READ,
+                                  FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    Error::SetWin32(error, GetLastError());
+    return false;
+  }
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+  {
+    Error::SetString(error, "File is empty or size could not be determined.");
+    CloseHandle(file);
+    return false;
+  }
+
+  // the view holds a reference to the mapping, so both handles can be closed once it's mapped
+  const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (!mapping)
+  {
+    Error::SetWin32(error, GetLastError());
+    return false;
+  }
+
+  void* ptr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  const DWORD map_error = GetLastError();
+  CloseHandle(mapping);
+  if (!ptr)
+  {
+    Error::SetWin32(error, map_error);
+    return false;
+  }
+
+  m_data = static_cast<const u8*>(ptr);
+  m_size = static_cast<size_t>(size.QuadPart);
+  return true;
+}
+
+void MappedFile::Close()
+{
+  if (!m_data)
+    return;
+
+  UnmapViewOfFile(m_data);
+  m_data = nullptr;
+  m_size = 0;
+}
+
 #else
 
 bool MemMap::MemProtect(void* baseaddr, size_t size, PageProtect mode)
@@ -397,4 +492,154 @@ bool SharedMemoryMappingArea::Unmap(void* map_base, size_t map_size)
   return true;
 }
 
+namespace {
+struct MappedFileAccess
+{
+  sigjmp_buf jmp;
+  const u8* start;
+  const u8* end;
+};
+} // namespace
+
+// Paging errors in file mappings are raised as SIGBUS. The handler only jumps out if the fault is in the range the
+// current thread is accessing, anything else goes to whichever handler was installed before us.
+static thread_local MappedFileAccess* s_mapped_file_access = nullptr;
+static struct sigaction s_mapped_file_old_sigbus_action;
+
+static void MappedFileSIGBUSHandler(int sig, siginfo_t* info, void* ctx)
+{
+  MappedFileAccess* access = s_mapped_file_access;
+  const u8* address = static_cast<const u8*>(info->si_addr);
+  if (access && address >= access->start && address < access->end)
+    siglongjmp(access->jmp, 1);
+
+  const struct sigaction& sa = s_mapped_file_old_sigbus_action;
+  if (sa.sa_flags & SA_SIGINFO)
+    sa.sa_sigaction(sig, info, ctx);
+  else if (sa.sa_handler == SIG_DFL)
+    signal(sig, SIG_DFL);
+  else if (sa.sa_handler != SIG_IGN)
+    sa.sa_handler(sig);
+}
+
+bool MappedFile::InstallFaultHandler()
+{
+  static const bool installed = []() {
+    struct sigaction sa = {};
+    sa.sa_sigaction = MappedFileSIGBUSHandler;
+    sa.sa_flags = SA_SIGINFO | SA_NODEFER;
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(SIGBUS, &sa, &s_mapped_file_old_sigbus_action) < 0)
+    {
+      Log_ErrorPrintf("sigaction(SIGBUS) failed: %d", errno);
+      return false;
+    }
+
+    return true;
+  }();
+  return installed;
+}
+
+bool AccessMappedFile(void* buffer, const u8* data, size_t size)
+{
+  // The signal mask is saved, in case another handler which was chained to us blocked SIGBUS.
+  MappedFileAccess access;
+  access.start = data;
+  access.end = data + size;
+  if (sigsetjmp(access.jmp, 1) != 0)
+  {
+    s_mapped_file_access = nullptr;
+    return false;
+  }
+
+  s_mapped_file_access = &access;
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+
+  if (buffer)
+    std::memcpy(buffer, data, size);
+  else
+    TouchPages(data, size);
+
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+  s_mapped_file_access = nullptr;
+  return true;
+}
+
+bool MappedFile::Open(const char* path, Error* error)
+{
+  Close();
+
+  const int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+  {
+    Error::SetErrno(error, errno);
+    return false;
+  }
+
+  struct stat sd;
+  if (fstat(fd, &sd) != 0 || sd.st_size <= 0)
+  {
+    Error::SetString(error, "File is empty or size could not be determined.");
+    close(fd);
+    return false;
+  }
+
+  // reads can't recover from paging errors without it
+  InstallFaultHandler();
+
+  // the mapping keeps the file referenced, so we don't need the descriptor afterwards
+  void* ptr = mmap(nullptr, static_cast<size_t>(sd.st_size), PROT_READ, MAP_SHARED, fd, 0);
+  const int map_errno = errno;
+  close(fd);
+  if (ptr == MAP_FAILED)
+  {
+    Error::SetErrno(error, map_errno);
+    return false;
+  }
+
+  m_data = static_cast<const u8*>(ptr);
+  m_size = static_cast<size_t>(sd.st_size);
+  return true;
+}
+
+void MappedFile::Close()
+{
+  if (!m_data)
+    return;
+
+  munmap(const_cast<u8*>(m_data), m_size);
+  m_data = nullptr;
+  m_size = 0;
+}
+
 #endif
+
+MappedFile::MappedFile() = default;
+
+MappedFile::~MappedFile()
+{
+  Close();
+}
+
+bool MappedFile::Read(void* buffer, size_t offset, size_t size, Error* error) const
+{
+  if (offset > m_size || size > (m_size - offset))
+  {
+    Error::SetString(error, "Read is past the end of the file.");
+    return false;
+  }
+
+  if (!AccessMappedFile(buffer, m_data + offset, size))
+  {
+    Error::SetString(error, "I/O error while reading mapped file.");
+    return false;
+  }
+
+  return true;
+}
+
+bool MappedFile::Prefault(size_t offset, size_t size, Error* error) const
+{
+  return Read(nullptr, offset, size, error);
+}
+
@@ -8,6 +8,8 @@
 #include <map>
 #include <string>
 
+class Error;
+
 #ifdef _WIN32
 
 // eww :/ but better than including windows.h
@@ -76,3 +78,38 @@ private:
   PlaceholderMap m_placeholder_ranges;
 #endif
 };
+
+/// Read-only view of an entire file. The file can still be appended to by other handles while mapped, but the view
+/// only covers the size at the time it was opened.
+class MappedFile
+{
+public:
+  MappedFile();
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ALWAYS_INLINE bool IsOpen() const { return (m_data != nullptr); }
+  ALWAYS_INLINE const u8* GetData() const { return m_data; }
+  ALWAYS_INLINE size_t GetSize() const { return m_size; }
+
+  /// Installs the handler which lets Read() and Prefault() recover from paging errors. Call it at startup, before
+  /// anything else which hooks SIGBUS (e.g. the fastmem page fault handler), so that those chain to it and restore it
+  /// when they're removed, instead of replacing it. Opening a file also installs it, if it hasn't been yet.
+  static bool InstallFaultHandler();
+
+  bool Open(const char* path, Error* error);
+  void Close();
+
+  /// Copies from the view. Unlike reading GetData() directly, an I/O error while paging the data in (e.g. the file was
+  /// truncated, or is on a network share which went away) fails the read instead of crashing.
+  bool Read(void* buffer, size_t offset, size_t size, Error* error) const;
+
+  /// Pages in a range of the view, with the same error handling as Read().
+  bool Prefault(size_t offset, size_t size, Error* error) const;
+
+private:
+  const u8* m_data = nullptr;
+  size_t m_size = 0;
+};
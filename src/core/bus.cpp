@@ -934,7 +934,7 @@ void Bus::RAMWriteHandler(VirtualMemoryAddress address, u32 value)
   const u32 offset = address & g_ram_mask;
   const u32 page_index = offset / HOST_PAGE_SIZE;
   if (g_ram_code_bits[page_index])
-    CPU::CodeCache::InvalidateBlocksWithPageIndex(page_index);
+    CPU::CodeCache::InvalidateBlocksInRange(offset, 1u << static_cast<u32>(size));
 
   if constexpr (size == MemoryAccessSize::Byte)
   {
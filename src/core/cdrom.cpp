@@ -724,6 +724,9 @@ void CDROM::InsertMedia(std::unique_ptr<CDImage> media, DiscRegion region)
   Log_InfoPrintf("Inserting new media, disc region: %s, console region: %s", Settings::GetDiscRegionName(region),
                  Settings::GetConsoleRegionName(System::GetRegion()));
 
+  // only the disc we're playing benefits from the read cache, so it's not set up when opening images
+  media->SetReadCache(g_settings.cdrom_chd_cache_hunks, g_settings.cdrom_chd_readahead_hunks);
+
   s_disc_region = region;
   m_reader.SetMedia(std::move(media));
   SetHoldPosition(0, true);
@@ -788,7 +791,7 @@ bool CDROM::PrecacheMedia()
   }
 
   HostInterfaceProgressCallback callback;
-  if (!m_reader.Precache(&callback))
+  if (!m_reader.Precache(&callback, g_settings.cdrom_preload_mapped_files))
   {
     Host::AddOSDMessage(TRANSLATE_STR("OSDMessage", "Precaching CD image failed, it may be unreliable."), 15.0f);
     return false;
@@ -2508,7 +2511,7 @@ bool CDROM::CompleteSeek()
         {
           if (logical)
           {
-            ProcessDataSectorHeader(m_reader.GetSectorBuffer().data());
+            ProcessDataSectorHeader(m_reader.GetSectorBuffer());
             seek_okay = (s_last_sector_header.minute == seek_mm && s_last_sector_header.second == seek_ss &&
                          s_last_sector_header.frame == seek_ff);
           }
@@ -2760,18 +2763,18 @@ void CDROM::DoSectorRead()
   }
   else
   {
-    ProcessDataSectorHeader(m_reader.GetSectorBuffer().data());
+    ProcessDataSectorHeader(m_reader.GetSectorBuffer());
   }
 
   u32 next_sector = s_current_lba + 1u;
   if (is_data_sector && s_drive_state == DriveState::Reading)
   {
-    ProcessDataSector(m_reader.GetSectorBuffer().data(), subq);
+    ProcessDataSector(m_reader.GetSectorBuffer(), subq);
   }
   else if (!is_data_sector &&
            (s_drive_state == DriveState::Playing || (s_drive_state == DriveState::Reading && s_mode.cdda)))
   {
-    ProcessCDDASector(m_reader.GetSectorBuffer().data(), subq);
+    ProcessCDDASector(m_reader.GetSectorBuffer(), subq);
 
     if (s_fast_forward_rate != 0)
       next_sector = s_current_lba + SignExtend32(s_fast_forward_rate);
@@ -3262,6 +3265,15 @@ void CDROM::DrawDebugWindow()
       ImGui::Text("Disc Position: MSF[%02u:%02u:%02u] LBA[%u]", disc_position.minute, disc_position.second,
                   disc_position.frame, disc_position.ToLBA());
 
+      if (m_reader.IsUsingThread())
+      {
+        const CDROMAsyncReader::Statistics stats = m_reader.GetStatistics();
+        ImGui::Text("Readahead: %u sectors, %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64
+                    " speculative hits, %" PRIu64 " waits",
+                    stats.readahead_depth, stats.readahead_hits, stats.readahead_misses, stats.speculative_hits,
+                    stats.waits);
+      }
+
       if (media->GetTrackNumber() > media->GetTrackCount())
       {
         ImGui::Text("Track Position: Lead-out");
@@ -19,9 +19,16 @@ void CDROMAsyncReader::StartThread(u32 readahead_count)
   if (IsUsingThread())
     StopThread();
 
+  // The ring is allocated for the deepest read-ahead, but starts at the configured count.
+  m_readahead_count = readahead_count;
+  m_readahead_depth.store(readahead_count);
   m_buffers.clear();
-  m_buffers.resize(readahead_count);
+  m_buffers.resize(readahead_count * MAX_READAHEAD_SCALE);
+  m_speculative_buffers.resize(readahead_count);
+  m_speculative_scratch.resize(readahead_count);
   EmptyBuffers();
+  EmptySpeculativeBuffers();
+  m_pending_read = false;
 
   m_shutdown_flag.store(false);
   m_read_thread = std::thread(&CDROMAsyncReader::WorkerThreadEntryPoint, this);
@@ -40,8 +47,15 @@ void CDROMAsyncReader::StopThread()
   }
 
   m_read_thread.join();
+  LogStatistics();
   EmptyBuffers();
+  EmptySpeculativeBuffers();
+  m_pending_read = false;
   m_buffers.clear();
+  m_speculative_buffers.clear();
+  m_speculative_scratch.clear();
+  m_readahead_count = 0;
+  m_readahead_depth.store(0);
 }
 
 void CDROMAsyncReader::SetMedia(std::unique_ptr<CDImage> media)
@@ -55,12 +69,15 @@ void CDROMAsyncReader::SetMedia(std::unique_ptr<CDImage> media)
 std::unique_ptr<CDImage> CDROMAsyncReader::RemoveMedia()
 {
   if (IsUsingThread())
+  {
     CancelReadahead();
+    LogStatistics();
+  }
 
   return std::move(m_media);
 }
 
-bool CDROMAsyncReader::Precache(ProgressCallback* callback)
+bool CDROMAsyncReader::Precache(ProgressCallback* callback, bool map_files)
 {
   WaitForIdle();
 
@@ -72,6 +89,14 @@ bool CDROMAsyncReader::Precache(ProgressCallback* callback)
 
   EmptyBuffers();
 
+  if (map_files)
+  {
+    // formats which can't be mapped are precached normally
+    const CDImage::PrecacheResult map_res = m_media->PreloadMappedFiles(callback);
+    if (map_res != CDImage::PrecacheResult::Unsupported)
+      return (map_res == CDImage::PrecacheResult::Success);
+  }
+
   const CDImage::PrecacheResult res = m_media->Precache(callback);
   if (res == CDImage::PrecacheResult::Unsupported)
   {
@@ -101,6 +126,8 @@ bool CDROMAsyncReader::Precache(ProgressCallback* callback)
 
 void CDROMAsyncReader::QueueReadSector(CDImage::LBA lba)
 {
+  m_pending_read = false;
+
   if (!IsUsingThread())
   {
     ReadSectorNonThreaded(lba);
@@ -126,21 +153,101 @@ void CDROMAsyncReader::QueueReadSector(CDImage::LBA lba)
       // great, don't need a seek, but still kick the thread to start reading ahead again
       Log_DebugPrintf("Readahead buffer hit for sector %u", lba);
       m_buffer_front.store(next_buffer);
-      m_buffer_count.fetch_sub(1);
+      m_readahead_hits.fetch_add(1, std::memory_order_relaxed);
+
+      // if that was the last buffered sector, the image can't keep up with the drive, so read further ahead
+      if (m_buffer_count.fetch_sub(1) <= 2)
+        IncreaseReadaheadDepth();
+
+      m_can_readahead.store(true);
+      m_do_read_cv.notify_one();
+      return;
+    }
+
+    // is it the sector which is being read right now? wait for it instead of starting over
+    if (m_buffers[buffer_front].lba + 1 == lba)
+    {
+      Log_DebugPrintf("Readahead buffer pending for sector %u", lba);
+      m_pending_read_lba = lba;
+      m_pending_read = true;
+
+      // the image can't keep up with the drive, so read further ahead
+      IncreaseReadaheadDepth();
+
+      // we'll be waiting on it, so make sure the wakeup isn't lost
+      std::unique_lock<std::mutex> lock(m_mutex);
       m_can_readahead.store(true);
       m_do_read_cv.notify_one();
       return;
     }
   }
 
-  // we need to toss away our readahead and start fresh
+  QueueSeek(lba);
+}
+
+void CDROMAsyncReader::IncreaseReadaheadDepth()
+{
+  const u32 depth = m_readahead_depth.load();
+  const u32 max_depth = static_cast<u32>(m_buffers.size());
+  if (depth < max_depth)
+  {
+    Log_DevPrintf("Increasing readahead to %u sectors", std::min(depth * 2, max_depth));
+    m_readahead_depth.store(std::min(depth * 2, max_depth));
+  }
+}
+
+void CDROMAsyncReader::QueueSeek(CDImage::LBA lba)
+{
+  // we need to toss away our readahead and start fresh, at the configured depth since the pattern changed
   Log_DebugPrintf("Readahead buffer miss, queueing seek to %u", lba);
+  m_readahead_misses.fetch_add(1, std::memory_order_relaxed);
+  m_readahead_depth.store(m_readahead_count);
   std::unique_lock<std::mutex> lock(m_mutex);
   m_next_position_set.store(true);
   m_next_position = lba;
   m_do_read_cv.notify_one();
 }
 
+void CDROMAsyncReader::CompletePendingRead()
+{
+  const CDImage::LBA lba = m_pending_read_lba;
+  m_pending_read = false;
+
+  if (m_buffer_count.load() < 2)
+  {
+    Common::Timer wait_timer;
+    Log_DebugPrintf("Sector %u pending, waiting", lba);
+    m_waits.fetch_add(1, std::memory_order_relaxed);
+
+    // wait until it's read, or the read thread stopped
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_waiting_for_read.store(true);
+    m_notify_read_complete_cv.wait(lock, [this]() {
+      return (m_buffer_count.load() > 1 || (!m_is_reading.load() && !m_can_readahead.load()));
+    });
+    m_waiting_for_read.store(false);
+
+    const double wait_time = wait_timer.GetTimeMilliseconds();
+    if (wait_time > 1.0f)
+      Log_DevPrintf("Had to wait %.2f msec for pending LBA %u", wait_time, lba);
+  }
+
+  const u32 buffer_front = m_buffer_front.load();
+  const u32 next_buffer = (buffer_front + 1) % static_cast<u32>(m_buffers.size());
+  if (m_buffer_count.load() > 1 && m_buffers[next_buffer].lba == lba)
+  {
+    m_buffer_front.store(next_buffer);
+    m_buffer_count.fetch_sub(1);
+    m_readahead_hits.fetch_add(1, std::memory_order_relaxed);
+    m_can_readahead.store(true);
+    m_do_read_cv.notify_one();
+    return;
+  }
+
+  // the read thread stopped or went somewhere else, so seek like any other miss
+  QueueSeek(lba);
+}
+
 bool CDROMAsyncReader::ReadSectorUncached(CDImage::LBA lba, CDImage::SubChannelQ* subq, SectorBuffer* data)
 {
   if (!IsUsingThread())
@@ -148,19 +255,53 @@ bool CDROMAsyncReader::ReadSectorUncached(CDImage::LBA lba, CDImage::SubChannelQ
 
   std::unique_lock lock(m_mutex);
 
-  // wait until the read thread is idle
+  // wait until the read thread is idle, it'll stop after the current sector
+  m_pause_requested.store(true);
   m_notify_read_complete_cv.wait(lock, [this]() { return !m_is_reading.load(); });
 
-  // read while the lock is held so it has to wait
-  const CDImage::LBA prev_lba = m_media->GetPositionOnDisc();
+  // read while the lock is held so it has to wait, read-ahead seeks back to where it was before continuing
   const bool result = InternalReadSectorUncached(lba, subq, data);
-  if (!m_media->Seek(prev_lba))
+
+  m_pause_requested.store(false);
+  m_do_read_cv.notify_one();
+  return result;
+}
+
+CDROMAsyncReader::Statistics CDROMAsyncReader::GetStatistics() const
+{
+  Statistics stats;
+  stats.readahead_hits = m_readahead_hits.load(std::memory_order_relaxed);
+  stats.readahead_misses = m_readahead_misses.load(std::memory_order_relaxed);
+  stats.speculative_hits = m_speculative_hits.load(std::memory_order_relaxed);
+  stats.speculative_sectors_read = m_speculative_sectors_read.load(std::memory_order_relaxed);
+  stats.waits = m_waits.load(std::memory_order_relaxed);
+  stats.readahead_depth = m_readahead_depth.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void CDROMAsyncReader::ResetStatistics()
+{
+  m_readahead_hits.store(0, std::memory_order_relaxed);
+  m_readahead_misses.store(0, std::memory_order_relaxed);
+  m_speculative_hits.store(0, std::memory_order_relaxed);
+  m_speculative_sectors_read.store(0, std::memory_order_relaxed);
+  m_waits.store(0, std::memory_order_relaxed);
+}
+
+void CDROMAsyncReader::LogStatistics()
+{
+  const Statistics stats = GetStatistics();
+  const u64 total = stats.readahead_hits + stats.readahead_misses;
+  if (total > 0)
   {
-    Log_ErrorPrintf("Failed to re-seek to cached position %u", prev_lba);
-    m_can_readahead.store(false);
+    Log_DevPrintf("Readahead: %" PRIu64 " hits, %" PRIu64 " misses (%.1f%% hit rate), %" PRIu64
+                  " speculative hits from %" PRIu64 " speculative reads, %" PRIu64 " waits, depth %u",
+                  stats.readahead_hits, stats.readahead_misses,
+                  (static_cast<double>(stats.readahead_hits) * 100.0) / static_cast<double>(total),
+                  stats.speculative_hits, stats.speculative_sectors_read, stats.waits, stats.readahead_depth);
   }
 
-  return result;
+  ResetStatistics();
 }
 
 bool CDROMAsyncReader::InternalReadSectorUncached(CDImage::LBA lba, CDImage::SubChannelQ* subq, SectorBuffer* data)
@@ -182,6 +323,9 @@ bool CDROMAsyncReader::InternalReadSectorUncached(CDImage::LBA lba, CDImage::Sub
 
 bool CDROMAsyncReader::WaitForReadToComplete()
 {
+  if (m_pending_read)
+    CompletePendingRead();
+
   // Safe without locking with memory_order_seq_cst.
   if (!m_next_position_set.load() && m_buffer_count.load() > 0)
   {
@@ -191,10 +335,14 @@ bool CDROMAsyncReader::WaitForReadToComplete()
 
   Common::Timer wait_timer;
   Log_DebugPrintf("Sector read pending, waiting");
+  m_waits.fetch_add(1, std::memory_order_relaxed);
 
+  // the read thread only takes the lock to wake us if we're waiting, so set the flag before checking the buffers
   std::unique_lock<std::mutex> lock(m_mutex);
+  m_waiting_for_read.store(true);
   m_notify_read_complete_cv.wait(
     lock, [this]() { return (m_buffer_count.load() > 0 || m_seek_error.load()) && !m_next_position_set.load(); });
+  m_waiting_for_read.store(false);
   if (m_seek_error.load())
   {
     m_seek_error.store(false);
@@ -226,21 +374,96 @@ void CDROMAsyncReader::EmptyBuffers()
   m_buffer_count.store(0);
 }
 
-bool CDROMAsyncReader::ReadSectorIntoBuffer(std::unique_lock<std::mutex>& lock)
+void CDROMAsyncReader::EmptySpeculativeBuffers()
 {
-  Common::Timer timer;
+  m_speculative_count = 0;
+}
 
-  const u32 slot = m_buffer_back.load();
-  m_buffer_back.store((slot + 1) % static_cast<u32>(m_buffers.size()));
+bool CDROMAsyncReader::SwapSpeculativeBuffers(CDImage::LBA lba)
+{
+  // keep whatever we read ahead past the current sector, in case the CDROM comes back to it
+  const u32 buffer_size = static_cast<u32>(m_buffers.size());
+  const u32 buffer_count = m_buffer_count.load();
+  const u32 buffer_front = m_buffer_front.load();
+  const u32 leftover_count =
+    std::min((buffer_count > 1) ? (buffer_count - 1) : 0u, static_cast<u32>(m_speculative_scratch.size()));
+  for (u32 i = 0; i < leftover_count; i++)
+    m_speculative_scratch[i] = m_buffers[(buffer_front + 1 + i) % buffer_size];
 
-  BufferSlot& buffer = m_buffers[slot];
-  buffer.lba = m_media->GetPositionOnDisc();
+  EmptyBuffers();
+
+  // is the seek target somewhere we left off previously?
+  const CDImage::LBA speculative_lba = (m_speculative_count > 0) ? m_speculative_buffers[0].lba : 0;
+  const bool hit = (m_speculative_count > 0 && lba >= speculative_lba && lba < (speculative_lba + m_speculative_count));
+  if (hit)
+  {
+    const u32 first = lba - speculative_lba;
+    const u32 count = m_speculative_count - first;
+    for (u32 i = 0; i < count; i++)
+      m_buffers[i] = m_speculative_buffers[first + i];
+
+    m_buffer_back.store(count % buffer_size);
+    m_buffer_count.store(count);
+    m_speculative_hits.fetch_add(1, std::memory_order_relaxed);
+    Log_DebugPrintf("Speculative buffer hit for sector %u, %u sectors available", lba, count);
+  }
+
+  // if we didn't get anything new, the old sectors are still a candidate
+  if (hit || leftover_count > 0)
+  {
+    std::swap(m_speculative_buffers, m_speculative_scratch);
+    m_speculative_count = leftover_count;
+  }
+
+  return hit;
+}
+
+void CDROMAsyncReader::ReadAhead(std::unique_lock<std::mutex>& lock)
+{
   m_is_reading.store(true);
   lock.unlock();
 
-  Log_TracePrintf("Reading LBA %u...", buffer.lba);
+  // the image may have been used for uncached or speculative reads since we last read ahead
+  const u32 buffer_size = static_cast<u32>(m_buffers.size());
+  bool result = true;
+  if (m_buffer_count.load() > 0)
+  {
+    const CDImage::LBA next_lba = m_buffers[(m_buffer_back.load() + buffer_size - 1) % buffer_size].lba + 1;
+    if (m_media->GetPositionOnDisc() != next_lba && !m_media->Seek(next_lba))
+    {
+      Log_WarningPrintf("Failed to seek to readahead position %u", next_lba);
+      result = false;
+    }
+  }
+
+  // readahead time! read as many sectors as we have space for
+  Log_DebugPrintf("Reading ahead %u sectors...", m_readahead_depth.load() - m_buffer_count.load());
+  while (result && m_buffer_count.load() < m_readahead_depth.load())
+  {
+    // a seek request came in while we're reading, or the CPU thread needs the image, so bail out
+    if (m_next_position_set.load() || m_pause_requested.load() || m_shutdown_flag.load())
+      break;
+
+    // stop reading if we hit the end or get an error
+    result = ReadSectorIntoBuffer();
+  }
+
+  lock.lock();
+  m_is_reading.store(false);
+  m_notify_read_complete_cv.notify_all();
+
+  // readahead buffer is full or errored at this point, unless we were interrupted
+  if (!result || m_buffer_count.load() >= m_readahead_depth.load())
+    m_can_readahead.store(false);
+}
+
+bool CDROMAsyncReader::ReadSectorIntoBuffer()
+{
+  Common::Timer timer;
 
-  buffer.result = m_media->ReadRawSector(buffer.data.data(), &buffer.subq);
+  const u32 slot = m_buffer_back.load();
+  BufferSlot& buffer = m_buffers[slot];
+  ReadSectorIntoSlot(buffer);
   if (buffer.result)
   {
     const double read_time = timer.GetTimeMilliseconds();
@@ -252,11 +475,64 @@ bool CDROMAsyncReader::ReadSectorIntoBuffer(std::unique_lock<std::mutex>& lock)
     Log_ErrorPrintf("Read of LBA %u failed", buffer.lba);
   }
 
+  // publish the sector, the CPU thread doesn't look at the slot until the count includes it
+  m_buffer_back.store((slot + 1) % static_cast<u32>(m_buffers.size()));
+  m_buffer_count.fetch_add(1);
+  if (m_waiting_for_read.load())
+  {
+    std::unique_lock lock(m_mutex);
+    m_notify_read_complete_cv.notify_all();
+  }
+
+  return true;
+}
+
+void CDROMAsyncReader::ReadSectorIntoSlot(BufferSlot& buffer)
+{
+  buffer.lba = m_media->GetPositionOnDisc();
+
+  Log_TracePrintf("Reading LBA %u...", buffer.lba);
+
+  // images held in memory can hand out the sector without it being copied
+  buffer.mapped_data = m_media->GetRawSectorPointer();
+  buffer.result = m_media->ReadRawSector(buffer.mapped_data ? nullptr : buffer.data.data(), &buffer.subq);
+}
+
+bool CDROMAsyncReader::ShouldReadSpeculativeSectors() const
+{
+  // only while idle, anything the CPU thread needs comes first
+  return (m_speculative_count > 0 && m_speculative_count < static_cast<u32>(m_speculative_buffers.size()) &&
+          m_buffer_count.load() >= m_readahead_depth.load() && !m_next_position_set.load() &&
+          !m_pause_requested.load() && !m_shutdown_flag.load());
+}
+
+void CDROMAsyncReader::ReadSpeculativeSectors(std::unique_lock<std::mutex>& lock)
+{
+  m_is_reading.store(true);
+  lock.unlock();
+
+  const CDImage::LBA start_lba = m_speculative_buffers[m_speculative_count - 1].lba + 1;
+  Log_DebugPrintf("Speculatively reading %u sectors from LBA %u...",
+                  static_cast<u32>(m_speculative_buffers.size()) - m_speculative_count, start_lba);
+
+  // read-ahead seeks back to its position when it next runs
+  if (m_media->GetPositionOnDisc() == start_lba || m_media->Seek(start_lba))
+  {
+    while (ShouldReadSpeculativeSectors())
+    {
+      BufferSlot& buffer = m_speculative_buffers[m_speculative_count];
+      ReadSectorIntoSlot(buffer);
+      m_speculative_sectors_read.fetch_add(1, std::memory_order_relaxed);
+      if (!buffer.result)
+        break;
+
+      m_speculative_count++;
+    }
+  }
+
   lock.lock();
   m_is_reading.store(false);
-  m_buffer_count.fetch_add(1);
   m_notify_read_complete_cv.notify_all();
-  return true;
 }
 
 void CDROMAsyncReader::ReadSectorNonThreaded(CDImage::LBA lba)
@@ -275,11 +551,7 @@ void CDROMAsyncReader::ReadSectorNonThreaded(CDImage::LBA lba)
   }
 
   BufferSlot& buffer = m_buffers.front();
-  buffer.lba = m_media->GetPositionOnDisc();
-
-  Log_TracePrintf("Reading LBA %u...", buffer.lba);
-
-  buffer.result = m_media->ReadRawSector(buffer.data.data(), &buffer.subq);
+  ReadSectorIntoSlot(buffer);
   if (buffer.result)
   {
     const double read_time = timer.GetTimeMilliseconds();
@@ -300,12 +572,16 @@ void CDROMAsyncReader::CancelReadahead()
 
   std::unique_lock lock(m_mutex);
 
-  // wait until the read thread is idle
+  // prevent it from doing any more, and wait until the read thread is idle
+  m_can_readahead.store(false);
+  m_pause_requested.store(true);
   m_notify_read_complete_cv.wait(lock, [this]() { return !m_is_reading.load(); });
+  m_pause_requested.store(false);
 
-  // prevent it from doing any more when it re-acquires the lock
-  m_can_readahead.store(false);
   EmptyBuffers();
+  EmptySpeculativeBuffers();
+  m_readahead_depth.store(m_readahead_count);
+  m_pending_read = false;
 }
 
 void CDROMAsyncReader::WorkerThreadEntryPoint()
@@ -314,8 +590,10 @@ void CDROMAsyncReader::WorkerThreadEntryPoint()
 
   for (;;)
   {
-    m_do_read_cv.wait(
-      lock, [this]() { return (m_shutdown_flag.load() || m_next_position_set.load() || m_can_readahead.load()); });
+    m_do_read_cv.wait(lock, [this]() {
+      return (m_shutdown_flag.load() ||
+              (!m_pause_requested.load() && (m_next_position_set.load() || m_can_readahead.load())));
+    });
     if (m_shutdown_flag.load())
       break;
 
@@ -323,21 +601,28 @@ void CDROMAsyncReader::WorkerThreadEntryPoint()
     {
       if (m_next_position_set.load())
       {
-        // discard buffers, we're seeking to a new location
+        // discard buffers, we're seeking to a new location, unless we already read it speculatively
         const CDImage::LBA seek_location = m_next_position.load();
-        EmptyBuffers();
+        const bool speculative_hit = SwapSpeculativeBuffers(seek_location);
+        const CDImage::LBA read_location = seek_location + m_buffer_count.load();
         m_next_position_set.store(false);
         m_seek_error.store(false);
+        if (speculative_hit)
+          m_notify_read_complete_cv.notify_all();
+
         m_is_reading.store(true);
         lock.unlock();
 
         // seek without lock held in case it takes time
-        Log_DebugPrintf("Seeking to LBA %u...", seek_location);
-        const bool seek_result = (m_media->GetPositionOnDisc() == seek_location || m_media->Seek(seek_location));
+        Log_DebugPrintf("Seeking to LBA %u...", read_location);
+        const bool seek_result = (m_media->GetPositionOnDisc() == read_location || m_media->Seek(read_location));
 
         lock.lock();
         m_is_reading.store(false);
 
+        // anyone waiting on the seek (e.g. uncached reads) can now proceed, even if we don't read ahead
+        m_notify_read_complete_cv.notify_all();
+
         // did another request come in? abort if so
         if (m_next_position_set.load())
           continue;
@@ -345,6 +630,14 @@ void CDROMAsyncReader::WorkerThreadEntryPoint()
         // did we fail the seek?
         if (!seek_result)
         {
+          // the sectors we already have are still good, but don't try to read ahead
+          if (speculative_hit)
+          {
+            m_can_readahead.store(false);
+            m_notify_read_complete_cv.notify_all();
+            break;
+          }
+
           // add the error result, and don't try to read ahead
           Log_WarningPrintf("Seek to LBA %u failed", seek_location);
           m_seek_error.store(true);
@@ -356,26 +649,15 @@ void CDROMAsyncReader::WorkerThreadEntryPoint()
         m_can_readahead.store(true);
       }
 
-      if (!m_can_readahead.load())
+      if (!m_can_readahead.load() || m_pause_requested.load())
         break;
 
-      // readahead time! read as many sectors as we have space for
-      Log_DebugPrintf("Reading ahead %u sectors...", static_cast<u32>(m_buffers.size()) - m_buffer_count.load());
-      while (m_buffer_count.load() < static_cast<u32>(m_buffers.size()))
-      {
-        if (m_next_position_set.load())
-        {
-          // a seek request came in while we're reading, so bail out
-          break;
-        }
+      ReadAhead(lock);
 
-        // stop reading if we hit the end or get an error
-        if (!ReadSectorIntoBuffer(lock))
-          break;
-      }
+      // use the idle time to extend the sectors we left behind at the last seek
+      if (ShouldReadSpeculativeSectors())
+        ReadSpeculativeSectors(lock);
 
-      // readahead buffer is full or errored at this point
-      m_can_readahead.store(false);
       break;
     }
   }
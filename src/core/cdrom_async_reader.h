@@ -19,20 +19,35 @@ public:
   struct BufferSlot
   {
     CDImage::LBA lba;
+    const u8* mapped_data; // points into the image when it's held in memory, otherwise the sector is in data
     SectorBuffer data;
     CDImage::SubChannelQ subq;
     bool result;
   };
 
+  struct Statistics
+  {
+    u64 readahead_hits;
+    u64 readahead_misses;
+    u64 speculative_hits;
+    u64 speculative_sectors_read;
+    u64 waits;
+    u32 readahead_depth;
+  };
+
   CDROMAsyncReader();
   ~CDROMAsyncReader();
 
   CDImage::LBA GetLastReadSector() const { return m_buffers[m_buffer_front.load()].lba; }
-  const SectorBuffer& GetSectorBuffer() const { return m_buffers[m_buffer_front.load()].data; }
+  const u8* GetSectorBuffer() const
+  {
+    const BufferSlot& slot = m_buffers[m_buffer_front.load()];
+    return slot.mapped_data ? slot.mapped_data : slot.data.data();
+  }
   const CDImage::SubChannelQ& GetSectorSubQ() const { return m_buffers[m_buffer_front.load()].subq; }
   u32 GetBufferedSectorCount() const { return m_buffer_count.load(); }
   bool HasBufferedSectors() const { return (m_buffer_count.load() > 0); }
-  u32 GetReadaheadCount() const { return static_cast<u32>(m_buffers.size()); }
+  u32 GetReadaheadCount() const { return m_readahead_count; }
 
   bool HasMedia() const { return static_cast<bool>(m_media); }
   const CDImage* GetMedia() const { return m_media.get(); }
@@ -46,7 +61,8 @@ public:
   std::unique_ptr<CDImage> RemoveMedia();
 
   /// Precaches image, either to memory, or using the underlying image precache.
-  bool Precache(ProgressCallback* callback);
+  /// If map_files is set, uncompressed images are mapped and preloaded into the page cache instead of copied.
+  bool Precache(ProgressCallback* callback, bool map_files);
 
   void QueueReadSector(CDImage::LBA lba);
 
@@ -56,12 +72,29 @@ public:
   /// Bypasses the sector cache and reads directly from the image.
   bool ReadSectorUncached(CDImage::LBA lba, CDImage::SubChannelQ* subq, SectorBuffer* data);
 
+  /// Returns read-ahead hit/miss counts since the media was last changed.
+  Statistics GetStatistics() const;
+  void ResetStatistics();
+
 private:
+  /// The read-ahead depth doubles up to this multiple of the configured count when the CDROM catches up with it.
+  static constexpr u32 MAX_READAHEAD_SCALE = 4;
+
+  void IncreaseReadaheadDepth();
+  void QueueSeek(CDImage::LBA lba);
+  void CompletePendingRead();
   void EmptyBuffers();
-  bool ReadSectorIntoBuffer(std::unique_lock<std::mutex>& lock);
+  void EmptySpeculativeBuffers();
+  bool SwapSpeculativeBuffers(CDImage::LBA lba);
+  void ReadAhead(std::unique_lock<std::mutex>& lock);
+  bool ReadSectorIntoBuffer();
+  void ReadSectorIntoSlot(BufferSlot& buffer);
+  void ReadSpeculativeSectors(std::unique_lock<std::mutex>& lock);
+  bool ShouldReadSpeculativeSectors() const;
   void ReadSectorNonThreaded(CDImage::LBA lba);
   bool InternalReadSectorUncached(CDImage::LBA lba, CDImage::SubChannelQ* subq, SectorBuffer* data);
   void CancelReadahead();
+  void LogStatistics();
 
   void WorkerThreadEntryPoint();
 
@@ -80,8 +113,34 @@ private:
   std::atomic_bool m_can_readahead{false};
   std::atomic_bool m_seek_error{false};
 
+  // Set by the CPU thread when it needs the read thread to stop between sectors, i.e. for uncached reads.
+  std::atomic_bool m_pause_requested{false};
+  std::atomic_bool m_waiting_for_read{false};
+
+  // Set when the CDROM asked for the sector the read thread is working on. Only accessed by the CPU thread.
+  CDImage::LBA m_pending_read_lba = 0;
+  bool m_pending_read = false;
+
+  // Single producer (read thread), single consumer (CPU thread). Only the read thread adds sectors, and only the CPU
+  // thread removes them, so neither needs the mutex while streaming.
   std::vector<BufferSlot> m_buffers;
   std::atomic<u32> m_buffer_front{0};
   std::atomic<u32> m_buffer_back{0};
   std::atomic<u32> m_buffer_count{0};
+  std::atomic<u32> m_readahead_depth{0};
+  u32 m_readahead_count = 0;
+
+  // Sectors which were read ahead but never used, because the CDROM seeked elsewhere. Games often return to where they
+  // left off, e.g. when streaming interleaved with other file reads, so these are kept (and topped up while the read
+  // thread is idle) to serve that seek without waiting for the image. Only accessed by the read thread, or while it
+  // is idle.
+  std::vector<BufferSlot> m_speculative_buffers;
+  std::vector<BufferSlot> m_speculative_scratch;
+  u32 m_speculative_count = 0;
+
+  std::atomic<u64> m_readahead_hits{0};
+  std::atomic<u64> m_readahead_misses{0};
+  std::atomic<u64> m_speculative_hits{0};
+  std::atomic<u64> m_speculative_sectors_read{0};
+  std::atomic<u64> m_waits{0};
 };
@@ -3,7 +3,9 @@
 
 #include "cpu_code_cache.h"
 #include "bus.h"
+#include "common/align.h"
 #include "common/assert.h"
+#include "common/bitutils.h"
 #include "common/log.h"
 #include "cpu_core.h"
 #include "cpu_core_private.h"
@@ -12,14 +14,43 @@
 #include "settings.h"
 #include "system.h"
 #include "timing_event.h"
+
+#include "common/byte_stream.h"
+#include "common/file_system.h"
+#include "common/path.h"
+
+#include "xxhash.h"
+
 Log_SetChannel(CPU::CodeCache);
 
 #ifdef ENABLE_RECOMPILER
 #include "cpu_recompiler_code_generator.h"
 #endif
 
+#include <optional>
 #include <zlib.h>
 
+void CPU::CodeBlock::Reset(const CodeBlockKey key_)
+{
+  CodeBlock block(key_);
+  block.instructions.swap(instructions);
+  block.link_predecessors.swap(link_predecessors);
+  block.link_successors.swap(link_successors);
+  block.threaded_instructions.swap(threaded_instructions);
+#ifdef ENABLE_RECOMPILER
+  block.loadstore_backpatch_info.swap(loadstore_backpatch_info);
+#endif
+
+  *this = std::move(block);
+  instructions.clear();
+  link_predecessors.clear();
+  link_successors.clear();
+  threaded_instructions.clear();
+#ifdef ENABLE_RECOMPILER
+  loadstore_backpatch_info.clear();
+#endif
+}
+
 namespace CPU::CodeCache {
 
 static constexpr bool USE_BLOCK_LINKING = true;
@@ -29,6 +60,33 @@ static constexpr u32 RECOMPILE_FRAMES_TO_FALL_BACK_TO_INTERPRETER = 100;
 static constexpr u32 RECOMPILE_COUNT_TO_FALL_BACK_TO_INTERPRETER = 20;
 static constexpr u32 INVALIDATE_THRESHOLD_TO_DISABLE_LINKING = 10;
 
+// Blocks ending in a jump are recompiled as superblocks after this many executions, which continue through jumps
+// until one can't be followed, or the limit is reached.
+static constexpr u32 SUPERBLOCK_EXECUTION_THRESHOLD = 256;
+static constexpr u32 MAX_SUPERBLOCK_INSTRUCTIONS = 256;
+
+// Writes to RAM code pages are filtered by which parts of the page contain code, so data stored in the same page
+// doesn't invalidate it.
+static constexpr u32 CODE_SUBPAGE_SIZE = 256;
+static constexpr u32 CODE_SUBPAGES_PER_PAGE = HOST_PAGE_SIZE / CODE_SUBPAGE_SIZE;
+static_assert(CODE_SUBPAGES_PER_PAGE <= 64, "Subpage mask fits in 64 bits");
+
+// Blocks are looked up through an open addressed table, which is grown when it's half full. Bit 1 of a block key is
+// never set, so it can't be mistaken for an empty slot.
+static constexpr u32 INITIAL_BLOCK_INDEX_SIZE = 16384;
+static constexpr u32 EMPTY_BLOCK_KEY = 0xFFFFFFFFu;
+
+// Blocks and page links are allocated in chunks, which are kept until shutdown.
+static constexpr u32 BLOCK_ARENA_CHUNK_SIZE = 1024;
+static constexpr u32 PAGE_LINK_ARENA_CHUNK_SIZE = 4096;
+
+// Persistent cache of block metadata, used to precompile blocks from previous sessions.
+// Bump the version whenever the decoding of blocks changes.
+static constexpr u32 PERSISTENT_CACHE_SIGNATURE = 0x4B4C4244; // DBLK
+static constexpr u32 PERSISTENT_CACHE_VERSION = 2;
+static constexpr u32 MAX_PERSISTENT_CACHE_BLOCKS = 65536;
+static constexpr u32 MAX_PERSISTENT_BLOCK_SUCCESSORS = 4;
+
 #ifdef ENABLE_RECOMPILER
 
 // Currently remapping the code buffer doesn't work in macOS or Haiku.
@@ -196,7 +254,6 @@ static void SetFastMap(u32 pc, CodeBlock::HostCodePointer function)
 
 #endif
 
-using BlockMap = std::unordered_map<u32, CodeBlock*>;
 using HostCodeMap = std::map<CodeBlock::HostCodePointer, CodeBlock*>;
 
 void LogCurrentState();
@@ -211,11 +268,30 @@ static CodeBlock* LookupBlock(CodeBlockKey key, bool allow_flush);
 /// The block can also be flushed if recompilation failed, so ignore the pointer if false is returned.
 static bool RevalidateBlock(CodeBlock* block, bool allow_flush);
 
+/// Reads the instructions for a block from guest memory, without generating any host code.
+static bool DecodeBlock(CodeBlock* block);
+
+/// Returns the address a superblock continues at, if the decoded instructions end in a jump which can be followed.
+static std::optional<u32> GetSuperblockContinuation(const CodeBlock* block);
+
 static bool CompileBlock(CodeBlock* block, bool allow_flush);
 static void RemoveReferencesToBlock(CodeBlock* block);
 static void AddBlockToPageMap(CodeBlock* block);
 static void RemoveBlockFromPageMap(CodeBlock* block);
 
+/// Returns a mask of the subpages a range of addresses within a page is in.
+static u64 GetCodeSubpages(PhysicalMemoryAddress start_address, PhysicalMemoryAddress end_address);
+
+/// Recalculates which parts of a RAM page contain code, and stops tracking writes to it if there's none left.
+static void UpdateRAMCodePage(u32 page_index);
+
+/// Invalidates the blocks, and removes them from every page they're in.
+static void InvalidateBlocks(const std::vector<CodeBlock*>& blocks);
+
+/// Returns true if the block's code is one contiguous range of RAM, which can be hashed directly.
+static bool CanHashBlockFromRAM(const CodeBlock* block);
+static u64 GetBlockRAMHash(const CodeBlock* block);
+
 /// Link block from to to. Returns the successor index.
 static void LinkBlock(CodeBlock* from, CodeBlock* to, void* host_pc, void* host_resolve_pc, u32 host_pc_size);
 
@@ -224,8 +300,69 @@ static void UnlinkBlock(CodeBlock* block);
 
 static void ClearState();
 
-static BlockMap s_blocks;
-static std::array<std::vector<CodeBlock*>, Bus::RAM_8MB_CODE_PAGE_COUNT> m_ram_block_map;
+struct BlockIndexEntry
+{
+  u32 key;
+  CodeBlock* block; // null for code which is always interpreted
+};
+
+/// Returns the index entry for the key, or nullptr if there isn't one. Only valid until the index is next changed.
+static BlockIndexEntry* FindBlockIndexEntry(u32 key);
+
+/// Adds the key to the index, or replaces its block if it's already there.
+static void SetBlockIndexEntry(u32 key, CodeBlock* block);
+static void RemoveBlockIndexEntry(BlockIndexEntry* entry);
+static u32 GetBlockIndexSlot(u32 key);
+static void ResizeBlockIndex(u32 size);
+
+/// Blocks come from the arena, and are returned to it when freed, keeping the memory allocated by their lists.
+static CodeBlock* AllocateBlock(CodeBlockKey key);
+static void FreeBlock(CodeBlock* block);
+
+static CodeBlockPageLink* AllocatePageLink();
+
+/// Returns the block's page links to the arena, without removing them from the page lists.
+static void ReleasePageLinks(CodeBlock* block);
+
+/// Removes all blocks from the page lists.
+static void ClearPageMap();
+
+static std::vector<BlockIndexEntry> s_block_index;
+static u32 s_block_index_count = 0;
+static u32 s_block_index_shift = 0;
+
+static std::vector<std::unique_ptr<CodeBlock[]>> s_block_arena;
+static std::vector<CodeBlock*> s_free_blocks;
+static std::vector<std::unique_ptr<CodeBlockPageLink[]>> s_page_link_arena;
+static CodeBlockPageLink* s_free_page_links = nullptr;
+
+static std::array<CodeBlockPageLink*, Bus::RAM_8MB_CODE_PAGE_COUNT> s_ram_page_blocks;
+static std::array<u64, Bus::RAM_8MB_CODE_PAGE_COUNT> s_ram_code_subpages;
+
+// Reused between invalidations, so writes to code don't allocate.
+static std::vector<CodeBlock*> s_invalidate_blocks;
+static std::vector<u32> s_invalidate_pages;
+
+struct PersistentBlockEntry
+{
+  CodeBlockKey key;
+  u32 instruction_count;
+  u64 instruction_hash;
+  bool can_link;
+  bool superblock;
+  u8 num_successors;
+  std::array<u32, MAX_PERSISTENT_BLOCK_SUCCESSORS> successors;
+};
+
+/// Blocks from the persistent cache which haven't been compiled yet, keyed by physical page.
+using PersistentBlockPageMap = std::unordered_map<u32, std::vector<PersistentBlockEntry>>;
+
+static u64 GetBlockInstructionHash(const CodeBlock* block);
+static void PrecompilePersistentBlocks(u32 page_index);
+static void SavePersistentCache();
+
+static std::string s_persistent_cache_path;
+static PersistentBlockPageMap s_persistent_block_pages;
 
 #ifdef ENABLE_RECOMPILER
 static HostCodeMap s_host_code_map;
@@ -233,6 +370,9 @@ static HostCodeMap s_host_code_map;
 static void AddBlockToHostCodeMap(CodeBlock* block);
 static void RemoveBlockFromHostCodeMap(CodeBlock* block);
 
+/// Recompiles a hot block as a superblock, following jumps at the end of the block.
+static void CompileSuperblock(CodeBlock* block);
+
 static bool InitializeFastmem();
 static void ShutdownFastmem();
 static Common::PageFaultHandler::HandlerResult LUTPageFaultHandler(void* exception_pc, void* fault_address,
@@ -245,7 +385,9 @@ static Common::PageFaultHandler::HandlerResult MMapPageFaultHandler(void* except
 
 void Initialize()
 {
-  Assert(s_blocks.empty());
+  Assert(s_block_index_count == 0);
+  if (s_block_index.empty())
+    ResizeBlockIndex(INITIAL_BLOCK_INDEX_SIZE);
 
 #ifdef ENABLE_RECOMPILER
   if (g_settings.IsUsingRecompiler())
@@ -280,24 +422,44 @@ void Initialize()
 
 void ClearState()
 {
-  Bus::ClearRAMCodePageFlags();
-  for (auto& it : m_ram_block_map)
-    it.clear();
+  ClearPageMap();
+
+  for (BlockIndexEntry& entry : s_block_index)
+  {
+    if (entry.key == EMPTY_BLOCK_KEY)
+      continue;
 
-  for (const auto& it : s_blocks)
-    delete it.second;
+    if (CodeBlock* block = entry.block; block)
+    {
+#ifdef ENABLE_RECOMPILER
+      // Only valid blocks point anywhere but the compile function, so there's no need to reset the whole fast map.
+      if (!block->invalidated)
+        SetFastMap(block->GetPC(), FastCompileBlockFunction);
+#endif
+      FreeBlock(block);
+    }
+
+    entry.key = EMPTY_BLOCK_KEY;
+    entry.block = nullptr;
+  }
+  s_block_index_count = 0;
 
-  s_blocks.clear();
 #ifdef ENABLE_RECOMPILER
   s_host_code_map.clear();
   s_code_buffer.Reset();
-  ResetFastMap();
 #endif
 }
 
 void Shutdown()
 {
+  ClosePersistentCache();
   ClearState();
+
+  s_block_index = std::vector<BlockIndexEntry>();
+  s_free_blocks = std::vector<CodeBlock*>();
+  s_block_arena = std::vector<std::unique_ptr<CodeBlock[]>>();
+  s_free_page_links = nullptr;
+  s_page_link_arena = std::vector<std::unique_ptr<CodeBlockPageLink[]>>();
 #ifdef ENABLE_RECOMPILER
   ShutdownFastmem();
   FreeFastMap();
@@ -305,7 +467,7 @@ void Shutdown()
 #endif
 }
 
-template<PGXPMode pgxp_mode>
+template<PGXPMode pgxp_mode, bool threaded>
 [[noreturn]] static void ExecuteImpl()
 {
   CodeBlockKey next_block_key;
@@ -341,7 +503,10 @@ template<PGXPMode pgxp_mode>
       if (g_settings.cpu_recompiler_icache)
         CheckAndUpdateICacheTags(block->icache_line_count, block->uncached_fetch_ticks);
 
-      InterpretCachedBlock<pgxp_mode>(*block);
+      if constexpr (threaded)
+        InterpretThreadedBlock(*block);
+      else
+        InterpretCachedBlock<pgxp_mode>(*block);
 
       if (g_state.pending_ticks >= g_state.downcount)
         break;
@@ -445,6 +610,22 @@ FastMapTable* GetFastMapPointer()
 
 #endif
 
+template<bool threaded>
+[[noreturn]] static void ExecuteInterpreter()
+{
+  if (g_settings.gpu_pgxp_enable)
+  {
+    if (g_settings.gpu_pgxp_cpu)
+      ExecuteImpl<PGXPMode::CPU, threaded>();
+    else
+      ExecuteImpl<PGXPMode::Memory, threaded>();
+  }
+  else
+  {
+    ExecuteImpl<PGXPMode::Disabled, threaded>();
+  }
+}
+
 [[noreturn]] void Execute()
 {
   switch (g_settings.cpu_execution_mode)
@@ -455,21 +636,13 @@ FastMapTable* GetFastMapPointer()
       break;
 #endif
 
+    case CPUExecutionMode::ThreadedInterpreter:
+      ExecuteInterpreter<true>();
+      break;
+
     default:
-    {
-      if (g_settings.gpu_pgxp_enable)
-      {
-        if (g_settings.gpu_pgxp_cpu)
-          ExecuteImpl<PGXPMode::CPU>();
-        else
-          ExecuteImpl<PGXPMode::Memory>();
-      }
-      else
-      {
-        ExecuteImpl<PGXPMode::Disabled>();
-      }
-    }
-    break;
+      ExecuteInterpreter<false>();
+      break;
   }
 }
 
@@ -574,17 +747,16 @@ CodeBlockKey GetNextBlockKey()
 static void FallbackExistingBlockToInterpreter(CodeBlock* block)
 {
   // Replace with null so we don't try to compile it again.
-  s_blocks.emplace(block->key.bits, nullptr);
-  delete block;
+  SetBlockIndexEntry(block->key.bits, nullptr);
+  FreeBlock(block);
 }
 
 CodeBlock* LookupBlock(CodeBlockKey key, bool allow_flush)
 {
-  BlockMap::iterator iter = s_blocks.find(key.bits);
-  if (iter != s_blocks.end())
+  if (const BlockIndexEntry* entry = FindBlockIndexEntry(key.bits); entry)
   {
     // ensure it hasn't been invalidated
-    CodeBlock* existing_block = iter->second;
+    CodeBlock* existing_block = entry->block;
     if (!existing_block || !existing_block->invalidated)
       return existing_block;
 
@@ -595,7 +767,7 @@ CodeBlock* LookupBlock(CodeBlockKey key, bool allow_flush)
       return nullptr;
   }
 
-  CodeBlock* block = new CodeBlock(key);
+  CodeBlock* block = AllocateBlock(key);
   block->recompile_frame_number = System::GetFrameNumber();
 
   if (CompileBlock(block, allow_flush))
@@ -611,29 +783,45 @@ CodeBlock* LookupBlock(CodeBlockKey key, bool allow_flush)
   else
   {
     Log_ErrorPrintf("Failed to compile block at PC=0x%08X", key.GetPC());
-    delete block;
+    FreeBlock(block);
     block = nullptr;
   }
 
   if (block || allow_flush)
-    s_blocks.emplace(key.bits, block);
+    SetBlockIndexEntry(key.bits, block);
+
+  // Pull in any blocks from previous sessions which live in the same page.
+  if (block && !s_persistent_block_pages.empty())
+    PrecompilePersistentBlocks(key.GetPCPhysicalAddress() / HOST_PAGE_SIZE);
 
   return block;
 }
 
 bool RevalidateBlock(CodeBlock* block, bool allow_flush)
 {
-  for (const CodeBlockInstruction& cbi : block->instructions)
+  if (CanHashBlockFromRAM(block))
   {
-    u32 new_code = 0;
-    SafeReadInstruction(cbi.pc, &new_code);
-    if (cbi.instruction.bits != new_code)
+    // much cheaper than reading the instructions back one at a time
+    if (GetBlockRAMHash(block) != block->ram_hash)
     {
-      Log_DebugPrintf("Block 0x%08X changed at PC 0x%08X - %08X to %08X - recompiling.", block->GetPC(), cbi.pc,
-                      cbi.instruction.bits, new_code);
+      Log_DebugPrintf("Block 0x%08X changed - recompiling.", block->GetPC());
       goto recompile;
     }
   }
+  else
+  {
+    for (const CodeBlockInstruction& cbi : block->instructions)
+    {
+      u32 new_code = 0;
+      SafeReadInstruction(cbi.pc, &new_code);
+      if (cbi.instruction.bits != new_code)
+      {
+        Log_DebugPrintf("Block 0x%08X changed at PC 0x%08X - %08X to %08X - recompiling.", block->GetPC(), cbi.pc,
+                        cbi.instruction.bits, new_code);
+        goto recompile;
+      }
+    }
+  }
 
   // re-add it to the page map since it's still up-to-date
   block->invalidated = false;
@@ -696,11 +884,11 @@ recompile:
   block->invalidated = false;
 
   // re-insert into the block map since we removed it earlier.
-  s_blocks.emplace(block->key.bits, block);
+  SetBlockIndexEntry(block->key.bits, block);
   return true;
 }
 
-bool CompileBlock(CodeBlock* block, bool allow_flush)
+bool DecodeBlock(CodeBlock* block)
 {
   u32 pc = block->GetPC();
   bool is_branch_delay_slot = false;
@@ -733,7 +921,7 @@ bool CompileBlock(CodeBlock* block, bool allow_flush)
     cbi.is_load_instruction = IsMemoryLoadInstruction(cbi.instruction);
     cbi.is_store_instruction = IsMemoryStoreInstruction(cbi.instruction);
     cbi.has_load_delay = InstructionHasLoadDelay(cbi.instruction);
-    cbi.can_trap = CanInstructionTrap(cbi.instruction, InUserMode());
+    cbi.can_trap = CanInstructionTrap(cbi.instruction, block->key.user_mode);
     cbi.is_direct_branch_instruction = IsDirectBranchInstruction(cbi.instruction);
 
     if (g_settings.cpu_recompiler_icache)
@@ -768,6 +956,7 @@ bool CompileBlock(CodeBlock* block, bool allow_flush)
 
       // change the pc for the second branch's delay slot, it comes from the first branch
       pc = GetDirectBranchTarget(prev_cbi.instruction, prev_cbi.pc);
+      block->contains_double_branches = true;
       Log_DevPrintf("Double branch at %08X, using delay slot from %08X -> %08X", cbi.pc, prev_cbi.pc, pc);
     }
 
@@ -777,7 +966,18 @@ bool CompileBlock(CodeBlock* block, bool allow_flush)
     // if we're in a branch delay slot, the block is now done
     // except if this is a branch in a branch delay slot, then we grab the one after that, and so on...
     if (is_branch_delay_slot && !cbi.is_branch_instruction)
-      break;
+    {
+      // superblocks carry on at the jump target instead
+      const std::optional<u32> continue_pc = block->superblock ? GetSuperblockContinuation(block) : std::nullopt;
+      if (!continue_pc.has_value())
+        break;
+
+      block->instructions[block->instructions.size() - 2].continues_superblock = true;
+      pc = continue_pc.value();
+      is_branch_delay_slot = false;
+      is_load_delay_slot = cbi.has_load_delay;
+      continue;
+    }
 
     // if this is a branch, we grab the next instruction (delay slot), and then exit
     is_branch_delay_slot = cbi.is_branch_instruction;
@@ -811,14 +1011,67 @@ bool CompileBlock(CodeBlock* block, bool allow_flush)
     return false;
   }
 
+  return true;
+}
+
+std::optional<u32> GetSuperblockContinuation(const CodeBlock* block)
+{
+  // Fetch timing for cached code assumes the block's instructions are contiguous.
+  const size_t count = block->instructions.size();
+  if (count < 2 || count >= MAX_SUPERBLOCK_INSTRUCTIONS || g_settings.cpu_recompiler_icache)
+    return std::nullopt;
+
+  // Only follow jumps which are always taken, conditional branches would need a side exit.
+  const CodeBlockInstruction& branch = block->instructions[count - 2];
+  const CodeBlockInstruction& delay_slot = block->instructions[count - 1];
+  const Instruction& instruction = branch.instruction;
+  if (branch.is_branch_delay_slot || delay_slot.is_branch_instruction ||
+      IsExitBlockInstruction(delay_slot.instruction) ||
+      !(instruction.op == InstructionOp::j || instruction.op == InstructionOp::jal ||
+        (instruction.op == InstructionOp::beq && instruction.i.rs == Reg::zero && instruction.i.rt == Reg::zero)))
+  {
+    return std::nullopt;
+  }
+
+  // Stay in the same segment and memory type, and don't loop back into code which is already part of the block.
+  const u32 target = GetDirectBranchTarget(instruction, branch.pc);
+  if (GetSegmentForAddress(target) != GetSegmentForAddress(block->GetPC()) ||
+      ((target & PHYSICAL_MEMORY_ADDRESS_MASK) < 0x200000) != block->IsInRAM() ||
+      std::any_of(block->instructions.begin(), block->instructions.end(),
+                  [target](const CodeBlockInstruction& cbi) { return cbi.pc == target; }))
+  {
+    return std::nullopt;
+  }
+
+  return target;
+}
+
+#ifdef ENABLE_RECOMPILER
+static bool HasCodeSpaceForBlock(const CodeBlock* block)
+{
+  return (s_code_buffer.GetFreeCodeSpace() >=
+            (block->instructions.size() * Recompiler::MAX_NEAR_HOST_BYTES_PER_INSTRUCTION) &&
+          s_code_buffer.GetFreeFarCodeSpace() >=
+            (block->instructions.size() * Recompiler::MAX_FAR_HOST_BYTES_PER_INSTRUCTION));
+}
+#endif
+
+bool CompileBlock(CodeBlock* block, bool allow_flush)
+{
+  if (!DecodeBlock(block))
+    return false;
+
+  if (CanHashBlockFromRAM(block))
+    block->ram_hash = GetBlockRAMHash(block);
+
+  if (g_settings.cpu_execution_mode == CPUExecutionMode::ThreadedInterpreter)
+    CompileThreadedBlock(block);
+
 #ifdef ENABLE_RECOMPILER
   if (g_settings.IsUsingRecompiler())
   {
     // Ensure we're not going to run out of space while compiling this block.
-    if (s_code_buffer.GetFreeCodeSpace() <
-          (block->instructions.size() * Recompiler::MAX_NEAR_HOST_BYTES_PER_INSTRUCTION) ||
-        s_code_buffer.GetFreeFarCodeSpace() <
-          (block->instructions.size() * Recompiler::MAX_FAR_HOST_BYTES_PER_INSTRUCTION))
+    if (!HasCodeSpaceForBlock(block))
     {
       if (allow_flush)
       {
@@ -832,6 +1085,12 @@ bool CompileBlock(CodeBlock* block, bool allow_flush)
       }
     }
 
+    // Blocks ending in a jump count their executions, and are recompiled as a superblock once they're hot.
+    block->superblock_countdown = (g_settings.cpu_recompiler_superblocks && !block->superblock && block->can_link &&
+                                   GetSuperblockContinuation(block).has_value()) ?
+                                    SUPERBLOCK_EXECUTION_THRESHOLD :
+                                    0;
+
     s_code_buffer.WriteProtect(false);
     Recompiler::CodeGenerator codegen(&s_code_buffer);
     const bool compile_result = codegen.CompileBlock(block, &block->host_code, &block->host_code_size);
@@ -850,6 +1109,44 @@ bool CompileBlock(CodeBlock* block, bool allow_flush)
 
 #ifdef ENABLE_RECOMPILER
 
+void CompileSuperblock(CodeBlock* block)
+{
+  // Called from the block itself, so it can't flush, and the old code has to stay around until it returns.
+  if (block->invalidated || block->superblock)
+    return;
+
+  CodeBlock temp_block(block->key);
+  temp_block.superblock = true;
+  if (!DecodeBlock(&temp_block) || temp_block.instructions.size() <= block->instructions.size())
+    return;
+
+  if (!HasCodeSpaceForBlock(&temp_block))
+  {
+    Log_DevPrintf("Not enough code space for superblock at 0x%08X", block->GetPC());
+    return;
+  }
+
+  RemoveReferencesToBlock(block);
+  block->superblock = true;
+  block->instructions.clear();
+  block->loadstore_backpatch_info.clear();
+
+  if (!CompileBlock(block, false))
+  {
+    Log_ErrorPrintf("Failed to compile superblock at 0x%08X, falling back to interpreter.", block->GetPC());
+    FallbackExistingBlockToInterpreter(block);
+    return;
+  }
+
+  AddBlockToPageMap(block);
+  SetFastMap(block->GetPC(), block->host_code);
+  AddBlockToHostCodeMap(block);
+  SetBlockIndexEntry(block->key.bits, block);
+
+  Log_DevPrintf("Recompiled block 0x%08X as a superblock of %zu instructions", block->GetPC(),
+                block->instructions.size());
+}
+
 void FastCompileBlockFunction()
 {
   CodeBlock* block = LookupBlock(GetNextBlockKey(), true);
@@ -927,37 +1224,102 @@ static void InvalidateBlock(CodeBlock* block, bool allow_frame_invalidation)
 #endif
 }
 
-void InvalidateBlocksWithPageIndex(u32 page_index)
+void InvalidateBlocks(const std::vector<CodeBlock*>& blocks)
 {
-  DebugAssert(page_index < Bus::RAM_8MB_CODE_PAGE_COUNT);
-  auto& blocks = m_ram_block_map[page_index];
+  s_invalidate_pages.clear();
   for (CodeBlock* block : blocks)
+  {
+    // Usually only one or two pages, so a linear search beats sorting afterwards.
+    for (const CodeBlockPageLink* link = block->page_links; link; link = link->next_in_block)
+    {
+      if (std::find(s_invalidate_pages.begin(), s_invalidate_pages.end(), link->page) == s_invalidate_pages.end())
+        s_invalidate_pages.push_back(link->page);
+    }
+
+    RemoveBlockFromPageMap(block);
     InvalidateBlock(block, true);
+  }
+
+  // Blocks will be re-added next execution.
+  for (const u32 page : s_invalidate_pages)
+    UpdateRAMCodePage(page);
+}
+
+void InvalidateBlocksWithPageIndex(u32 page_index)
+{
+  DebugAssert(page_index < Bus::RAM_8MB_CODE_PAGE_COUNT);
 
-  // Block will be re-added next execution.
-  blocks.clear();
+  // copy, since invalidating removes the blocks from the list
+  s_invalidate_blocks.clear();
+  for (const CodeBlockPageLink* link = s_ram_page_blocks[page_index]; link; link = link->next)
+    s_invalidate_blocks.push_back(link->block);
+
+  InvalidateBlocks(s_invalidate_blocks);
   Bus::ClearRAMCodePage(page_index);
 }
 
+void InvalidateBlocksInRange(PhysicalMemoryAddress address, u32 size)
+{
+  const PhysicalMemoryAddress end_address = address + size;
+  const u32 start_page = address / HOST_PAGE_SIZE;
+  const u32 end_page = std::min<u32>((end_address - 1) / HOST_PAGE_SIZE, Bus::RAM_8MB_CODE_PAGE_COUNT - 1);
+
+  s_invalidate_blocks.clear();
+  for (u32 page = start_page; page <= end_page; page++)
+  {
+    // Most writes to code pages are to the data around the code, so check the subpages before the blocks.
+    const PhysicalMemoryAddress page_address = page * HOST_PAGE_SIZE;
+    const u64 subpages =
+      GetCodeSubpages(std::max(address, page_address), std::min(end_address, page_address + HOST_PAGE_SIZE));
+    if (!(s_ram_code_subpages[page] & subpages))
+      continue;
+
+    for (const CodeBlockPageLink* link = s_ram_page_blocks[page]; link; link = link->next)
+    {
+      if (link->start_address >= end_address || link->end_address <= address)
+        continue;
+
+      CodeBlock* block = link->block;
+      if (block->superblock && std::none_of(block->instructions.begin(), block->instructions.end(),
+                                            [address, end_address](const CodeBlockInstruction& cbi) {
+                                              const PhysicalMemoryAddress pc = cbi.pc & PHYSICAL_MEMORY_ADDRESS_MASK;
+                                              return (pc < end_address && (pc + sizeof(Instruction)) > address);
+                                            }))
+      {
+        continue;
+      }
+
+      if (std::find(s_invalidate_blocks.begin(), s_invalidate_blocks.end(), block) == s_invalidate_blocks.end())
+        s_invalidate_blocks.push_back(block);
+    }
+  }
+
+  if (!s_invalidate_blocks.empty())
+    InvalidateBlocks(s_invalidate_blocks);
+}
+
 void InvalidateAll()
 {
-  for (auto& it : s_blocks)
+  for (const BlockIndexEntry& entry : s_block_index)
   {
-    CodeBlock* block = it.second;
+    CodeBlock* block = entry.block;
     if (block && !block->invalidated)
       InvalidateBlock(block, false);
   }
 
-  Bus::ClearRAMCodePageFlags();
-  for (auto& it : m_ram_block_map)
-    it.clear();
+  ClearPageMap();
 }
 
-void RemoveReferencesToBlock(CodeBlock* block)
+bool PrecompileBlock(VirtualMemoryAddress pc)
 {
-  BlockMap::iterator iter = s_blocks.find(block->key.GetPC());
-  Assert(iter != s_blocks.end() && iter->second == block);
+  CodeBlockKey key;
+  key.bits = 0;
+  key.SetPC(pc);
+  return (LookupBlock(key, true) != nullptr);
+}
 
+void RemoveReferencesToBlock(CodeBlock* block)
+{
 #ifdef ENABLE_RECOMPILER
   SetFastMap(block->GetPC(), FastCompileBlockFunction);
 #endif
@@ -972,7 +1334,159 @@ void RemoveReferencesToBlock(CodeBlock* block)
     RemoveBlockFromHostCodeMap(block);
 #endif
 
-  s_blocks.erase(iter);
+  BlockIndexEntry* entry = FindBlockIndexEntry(block->key.bits);
+  Assert(entry && entry->block == block);
+  RemoveBlockIndexEntry(entry);
+}
+
+u32 GetBlockIndexSlot(u32 key)
+{
+  // Fibonacci hashing, since keys are mostly sequential.
+  return (key * 0x9E3779B9u) >> s_block_index_shift;
+}
+
+BlockIndexEntry* FindBlockIndexEntry(u32 key)
+{
+  const u32 mask = static_cast<u32>(s_block_index.size()) - 1;
+  for (u32 slot = GetBlockIndexSlot(key);; slot = (slot + 1) & mask)
+  {
+    BlockIndexEntry& entry = s_block_index[slot];
+    if (entry.key == key)
+      return &entry;
+    else if (entry.key == EMPTY_BLOCK_KEY)
+      return nullptr;
+  }
+}
+
+void SetBlockIndexEntry(u32 key, CodeBlock* block)
+{
+  DebugAssert(key != EMPTY_BLOCK_KEY);
+  if ((s_block_index_count + 1) > (s_block_index.size() / 2))
+    ResizeBlockIndex(static_cast<u32>(s_block_index.size()) * 2);
+
+  const u32 mask = static_cast<u32>(s_block_index.size()) - 1;
+  for (u32 slot = GetBlockIndexSlot(key);; slot = (slot + 1) & mask)
+  {
+    BlockIndexEntry& entry = s_block_index[slot];
+    if (entry.key == key)
+    {
+      entry.block = block;
+      return;
+    }
+    else if (entry.key == EMPTY_BLOCK_KEY)
+    {
+      entry.key = key;
+      entry.block = block;
+      s_block_index_count++;
+      return;
+    }
+  }
+}
+
+void RemoveBlockIndexEntry(BlockIndexEntry* entry)
+{
+  // Shift later entries in the same run back into the hole, so lookups don't need tombstones.
+  const u32 mask = static_cast<u32>(s_block_index.size()) - 1;
+  u32 hole = static_cast<u32>(entry - s_block_index.data());
+  for (u32 slot = (hole + 1) & mask;; slot = (slot + 1) & mask)
+  {
+    BlockIndexEntry& next = s_block_index[slot];
+    if (next.key == EMPTY_BLOCK_KEY)
+      break;
+
+    // Only entries whose home slot isn't between the hole and their current slot can move back.
+    const u32 home = GetBlockIndexSlot(next.key);
+    if (((slot - home) & mask) >= ((slot - hole) & mask))
+    {
+      s_block_index[hole] = next;
+      hole = slot;
+    }
+  }
+
+  s_block_index[hole].key = EMPTY_BLOCK_KEY;
+  s_block_index[hole].block = nullptr;
+  s_block_index_count--;
+}
+
+void ResizeBlockIndex(u32 size)
+{
+  DebugAssert(Common::IsPow2(size));
+  std::vector<BlockIndexEntry> old_index(size, BlockIndexEntry{EMPTY_BLOCK_KEY, nullptr});
+  old_index.swap(s_block_index);
+  s_block_index_count = 0;
+  s_block_index_shift = 32 - CountTrailingZeros(size);
+
+  for (const BlockIndexEntry& entry : old_index)
+  {
+    if (entry.key != EMPTY_BLOCK_KEY)
+      SetBlockIndexEntry(entry.key, entry.block);
+  }
+}
+
+CodeBlock* AllocateBlock(CodeBlockKey key)
+{
+  if (s_free_blocks.empty())
+  {
+    CodeBlock* chunk = s_block_arena.emplace_back(std::make_unique<CodeBlock[]>(BLOCK_ARENA_CHUNK_SIZE)).get();
+    for (u32 i = 0; i < BLOCK_ARENA_CHUNK_SIZE; i++)
+      s_free_blocks.push_back(&chunk[BLOCK_ARENA_CHUNK_SIZE - 1 - i]);
+  }
+
+  CodeBlock* block = s_free_blocks.back();
+  s_free_blocks.pop_back();
+  block->Reset(key);
+  return block;
+}
+
+void FreeBlock(CodeBlock* block)
+{
+  DebugAssert(!block->page_links);
+  s_free_blocks.push_back(block);
+}
+
+CodeBlockPageLink* AllocatePageLink()
+{
+  if (!s_free_page_links)
+  {
+    CodeBlockPageLink* chunk =
+      s_page_link_arena.emplace_back(std::make_unique<CodeBlockPageLink[]>(PAGE_LINK_ARENA_CHUNK_SIZE)).get();
+    for (u32 i = 0; i < PAGE_LINK_ARENA_CHUNK_SIZE; i++)
+    {
+      chunk[i].next = s_free_page_links;
+      s_free_page_links = &chunk[i];
+    }
+  }
+
+  CodeBlockPageLink* link = s_free_page_links;
+  s_free_page_links = link->next;
+  return link;
+}
+
+void ReleasePageLinks(CodeBlock* block)
+{
+  CodeBlockPageLink* link = block->page_links;
+  while (link)
+  {
+    CodeBlockPageLink* next_in_block = link->next_in_block;
+    link->next = s_free_page_links;
+    s_free_page_links = link;
+    link = next_in_block;
+  }
+
+  block->page_links = nullptr;
+}
+
+void ClearPageMap()
+{
+  for (const BlockIndexEntry& entry : s_block_index)
+  {
+    if (entry.block)
+      ReleasePageLinks(entry.block);
+  }
+
+  Bus::ClearRAMCodePageFlags();
+  s_ram_page_blocks.fill(nullptr);
+  s_ram_code_subpages.fill(0);
 }
 
 void AddBlockToPageMap(CodeBlock* block)
@@ -980,12 +1494,40 @@ void AddBlockToPageMap(CodeBlock* block)
   if (!block->IsInRAM())
     return;
 
-  const u32 start_page = block->GetStartPageIndex();
-  const u32 end_page = block->GetEndPageIndex();
-  for (u32 page = start_page; page <= end_page; page++)
+  DebugAssert(!block->page_links);
+  for (const CodeBlockInstruction& cbi : block->instructions)
   {
-    m_ram_block_map[page].push_back(block);
-    Bus::SetRAMCodePage(page);
+    // superblocks can jump between pages, and back again
+    const PhysicalMemoryAddress pc = cbi.pc & PHYSICAL_MEMORY_ADDRESS_MASK;
+    const u32 page = pc / HOST_PAGE_SIZE;
+    CodeBlockPageLink* link = block->page_links;
+    while (link && link->page != page)
+      link = link->next_in_block;
+
+    if (!link)
+    {
+      link = AllocatePageLink();
+      link->block = block;
+      link->page = page;
+      link->start_address = pc;
+      link->end_address = pc + sizeof(Instruction);
+      link->next_in_block = block->page_links;
+      block->page_links = link;
+
+      link->prev = nullptr;
+      link->next = s_ram_page_blocks[page];
+      if (link->next)
+        link->next->prev = link;
+      s_ram_page_blocks[page] = link;
+      Bus::SetRAMCodePage(page);
+    }
+    else
+    {
+      link->start_address = std::min(link->start_address, pc);
+      link->end_address = std::max<PhysicalMemoryAddress>(link->end_address, pc + sizeof(Instruction));
+    }
+
+    s_ram_code_subpages[page] |= UINT64_C(1) << ((pc % HOST_PAGE_SIZE) / CODE_SUBPAGE_SIZE);
   }
 }
 
@@ -994,15 +1536,49 @@ void RemoveBlockFromPageMap(CodeBlock* block)
   if (!block->IsInRAM())
     return;
 
-  const u32 start_page = block->GetStartPageIndex();
-  const u32 end_page = block->GetEndPageIndex();
-  for (u32 page = start_page; page <= end_page; page++)
+  Assert(block->page_links);
+  for (CodeBlockPageLink* link = block->page_links; link; link = link->next_in_block)
   {
-    auto& page_blocks = m_ram_block_map[page];
-    auto page_block_iter = std::find(page_blocks.begin(), page_blocks.end(), block);
-    Assert(page_block_iter != page_blocks.end());
-    page_blocks.erase(page_block_iter);
+    if (link->prev)
+      link->prev->next = link->next;
+    else
+      s_ram_page_blocks[link->page] = link->next;
+    if (link->next)
+      link->next->prev = link->prev;
   }
+
+  ReleasePageLinks(block);
+}
+
+u64 GetCodeSubpages(PhysicalMemoryAddress start_address, PhysicalMemoryAddress end_address)
+{
+  const u32 first_subpage = (start_address % HOST_PAGE_SIZE) / CODE_SUBPAGE_SIZE;
+  const u32 last_subpage = ((end_address - 1) % HOST_PAGE_SIZE) / CODE_SUBPAGE_SIZE;
+  return (UINT64_C(2) << last_subpage) - (UINT64_C(1) << first_subpage);
+}
+
+void UpdateRAMCodePage(u32 page_index)
+{
+  // Superblocks can skip over subpages in their range, but it's only used to filter writes.
+  u64 subpages = 0;
+  for (const CodeBlockPageLink* link = s_ram_page_blocks[page_index]; link; link = link->next)
+    subpages |= GetCodeSubpages(link->start_address, link->end_address);
+
+  s_ram_code_subpages[page_index] = subpages;
+  if (!s_ram_page_blocks[page_index])
+    Bus::ClearRAMCodePage(page_index);
+}
+
+bool CanHashBlockFromRAM(const CodeBlock* block)
+{
+  // Double branches take the last instruction from the branch target, so the code isn't contiguous either.
+  return (block->IsInRAM() && !block->superblock && !block->contains_double_branches &&
+          (block->key.GetPCPhysicalAddress() + block->GetSizeInBytes()) <= Bus::g_ram_size);
+}
+
+u64 GetBlockRAMHash(const CodeBlock* block)
+{
+  return XXH64(&Bus::g_ram[block->key.GetPCPhysicalAddress()], block->GetSizeInBytes(), 0);
 }
 
 void LinkBlock(CodeBlock* from, CodeBlock* to, void* host_pc, void* host_resolve_pc, u32 host_pc_size)
@@ -1087,6 +1663,246 @@ void UnlinkBlock(CodeBlock* block)
 #endif
 }
 
+u64 GetBlockInstructionHash(const CodeBlock* block)
+{
+  u64 hash = 0;
+  for (const CodeBlockInstruction& cbi : block->instructions)
+  {
+    const u32 words[2] = {cbi.pc, cbi.instruction.bits};
+    hash = XXH64(words, sizeof(words), hash);
+  }
+
+  return hash;
+}
+
+void OpenPersistentCache(std::string path)
+{
+  if (s_persistent_cache_path == path)
+    return;
+
+  ClosePersistentCache();
+  s_persistent_cache_path = std::move(path);
+
+  std::unique_ptr<ByteStream> stream =
+    ByteStream::OpenFile(s_persistent_cache_path.c_str(), BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
+  if (!stream)
+  {
+    Log_DevPrintf("Persistent code cache '%s' does not exist.", s_persistent_cache_path.c_str());
+    return;
+  }
+
+  u32 signature, version, num_blocks;
+  if (!stream->ReadU32(&signature) || !stream->ReadU32(&version) || !stream->ReadU32(&num_blocks) ||
+      signature != PERSISTENT_CACHE_SIGNATURE || version != PERSISTENT_CACHE_VERSION ||
+      num_blocks > MAX_PERSISTENT_CACHE_BLOCKS)
+  {
+    Log_WarningPrintf("Persistent code cache '%s' is corrupted or out of date, ignoring.",
+                      s_persistent_cache_path.c_str());
+    return;
+  }
+
+  for (u32 i = 0; i < num_blocks; i++)
+  {
+    PersistentBlockEntry entry = {};
+    u8 flags;
+    if (!stream->ReadU32(&entry.key.bits) || !stream->ReadU32(&entry.instruction_count) ||
+        !stream->ReadU64(&entry.instruction_hash) || !stream->ReadU8(&flags) ||
+        !stream->ReadU8(&entry.num_successors) || entry.num_successors > MAX_PERSISTENT_BLOCK_SUCCESSORS ||
+        (entry.key.bits & 2u) != 0)
+    {
+      Log_WarningPrintf("Failed to read block %u from persistent code cache '%s'.", i, s_persistent_cache_path.c_str());
+      s_persistent_block_pages.clear();
+      return;
+    }
+
+    entry.can_link = (flags & 1u) != 0;
+    entry.superblock = (flags & 2u) != 0;
+    for (u32 j = 0; j < entry.num_successors; j++)
+    {
+      if (!stream->ReadU32(&entry.successors[j]))
+      {
+        s_persistent_block_pages.clear();
+        return;
+      }
+    }
+
+    s_persistent_block_pages[entry.key.GetPCPhysicalAddress() / HOST_PAGE_SIZE].push_back(entry);
+  }
+
+  Log_InfoPrintf("Loaded %u blocks from persistent code cache '%s'.", num_blocks, s_persistent_cache_path.c_str());
+}
+
+void ClosePersistentCache()
+{
+  if (s_persistent_cache_path.empty())
+    return;
+
+  SavePersistentCache();
+  s_persistent_cache_path = {};
+  s_persistent_block_pages.clear();
+}
+
+void SavePersistentCache()
+{
+  std::vector<PersistentBlockEntry> entries;
+  entries.reserve(s_block_index_count);
+
+  for (const BlockIndexEntry& index_entry : s_block_index)
+  {
+    const CodeBlock* block = index_entry.block;
+    if (!block || block->invalidated || block->instructions.empty())
+      continue;
+
+    PersistentBlockEntry& entry = entries.emplace_back();
+    entry.key = block->key;
+    entry.instruction_count = static_cast<u32>(block->instructions.size());
+    entry.instruction_hash = GetBlockInstructionHash(block);
+    entry.can_link = block->can_link;
+    entry.superblock = block->superblock;
+    entry.num_successors = 0;
+    for (const CodeBlock::LinkInfo& li : block->link_successors)
+    {
+      if (entry.num_successors == MAX_PERSISTENT_BLOCK_SUCCESSORS)
+        break;
+      entry.successors[entry.num_successors++] = li.block->key.bits;
+    }
+  }
+
+  // Keep blocks from previous sessions which weren't reached this time around.
+  for (const auto& it : s_persistent_block_pages)
+    entries.insert(entries.end(), it.second.begin(), it.second.end());
+
+  // Live blocks take priority over stale entries with the same key, since they're inserted first.
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const PersistentBlockEntry& lhs, const PersistentBlockEntry& rhs) {
+                     return lhs.key.bits < rhs.key.bits;
+                   });
+  entries.erase(std::unique(entries.begin(), entries.end(),
+                            [](const PersistentBlockEntry& lhs, const PersistentBlockEntry& rhs) {
+                              return lhs.key.bits == rhs.key.bits;
+                            }),
+                entries.end());
+  if (entries.size() > MAX_PERSISTENT_CACHE_BLOCKS)
+    entries.resize(MAX_PERSISTENT_CACHE_BLOCKS);
+
+  if (entries.empty())
+    return;
+
+  const std::string dir(Path::GetDirectory(s_persistent_cache_path));
+  if (!FileSystem::EnsureDirectoryExists(dir.c_str(), false))
+  {
+    Log_ErrorPrintf("Failed to create persistent code cache directory '%s'.", dir.c_str());
+    return;
+  }
+
+  std::unique_ptr<ByteStream> stream = ByteStream::OpenFile(
+    s_persistent_cache_path.c_str(), BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_TRUNCATE | BYTESTREAM_OPEN_WRITE |
+                                       BYTESTREAM_OPEN_ATOMIC_UPDATE | BYTESTREAM_OPEN_STREAMED);
+  if (!stream)
+  {
+    Log_ErrorPrintf("Failed to open persistent code cache '%s' for writing.", s_persistent_cache_path.c_str());
+    return;
+  }
+
+  bool result = stream->WriteU32(PERSISTENT_CACHE_SIGNATURE);
+  result = result && stream->WriteU32(PERSISTENT_CACHE_VERSION);
+  result = result && stream->WriteU32(static_cast<u32>(entries.size()));
+  for (const PersistentBlockEntry& entry : entries)
+  {
+    result = result && stream->WriteU32(entry.key.bits);
+    result = result && stream->WriteU32(entry.instruction_count);
+    result = result && stream->WriteU64(entry.instruction_hash);
+    result = result && stream->WriteU8((entry.can_link ? 1u : 0u) | (entry.superblock ? 2u : 0u));
+    result = result && stream->WriteU8(entry.num_successors);
+    for (u32 i = 0; i < entry.num_successors; i++)
+      result = result && stream->WriteU32(entry.successors[i]);
+  }
+
+  if (!result || !stream->Commit())
+  {
+    Log_ErrorPrintf("Failed to write persistent code cache '%s'.", s_persistent_cache_path.c_str());
+    stream->Discard();
+    return;
+  }
+
+  Log_InfoPrintf("Saved %zu blocks to persistent code cache '%s'.", entries.size(), s_persistent_cache_path.c_str());
+}
+
+void PrecompilePersistentBlocks(u32 page_index)
+{
+  const auto iter = s_persistent_block_pages.find(page_index);
+  if (iter == s_persistent_block_pages.end())
+    return;
+
+  // Compiling can look up further blocks in this page, so take the list out of the map first.
+  const std::vector<PersistentBlockEntry> entries = std::move(iter->second);
+  s_persistent_block_pages.erase(iter);
+
+  u32 num_compiled = 0;
+  u32 num_discarded = 0;
+  for (const PersistentBlockEntry& entry : entries)
+  {
+    if (FindBlockIndexEntry(entry.key.bits))
+      continue;
+
+    // Throw away anything which doesn't match what's in memory now.
+    CodeBlock temp_block(entry.key);
+    temp_block.superblock = entry.superblock;
+    if (!DecodeBlock(&temp_block) || temp_block.instructions.size() != entry.instruction_count ||
+        GetBlockInstructionHash(&temp_block) != entry.instruction_hash)
+    {
+      num_discarded++;
+      continue;
+    }
+
+    // Can't flush here, the caller is holding a block pointer.
+    CodeBlock* block = LookupBlock(entry.key, false);
+    if (!block)
+    {
+      num_discarded++;
+      continue;
+    }
+
+    block->can_link = entry.can_link;
+
+    // Superblocks are compiled when the block is first executed, rather than waiting for it to get hot again.
+    if (entry.superblock && block->superblock_countdown > 0)
+      block->superblock_countdown = 1;
+
+    num_compiled++;
+  }
+
+  // The recompiler links through backpatching when a branch is first taken, but the cached interpreter can have its
+  // successor lists restored directly.
+  if (!g_settings.IsUsingRecompiler())
+  {
+    for (const PersistentBlockEntry& entry : entries)
+    {
+      const BlockIndexEntry* from_entry = FindBlockIndexEntry(entry.key.bits);
+      CodeBlock* from = from_entry ? from_entry->block : nullptr;
+      if (!from || from->invalidated || !from->can_link)
+        continue;
+
+      for (u32 i = 0; i < entry.num_successors; i++)
+      {
+        const BlockIndexEntry* to_entry = FindBlockIndexEntry(entry.successors[i]);
+        CodeBlock* to = to_entry ? to_entry->block : nullptr;
+        if (!to || to->invalidated || !to->can_link ||
+            std::any_of(from->link_successors.begin(), from->link_successors.end(),
+                        [to](const CodeBlock::LinkInfo& li) { return li.block == to; }))
+        {
+          continue;
+        }
+
+        LinkBlock(from, to, nullptr, nullptr, 0);
+      }
+    }
+  }
+
+  Log_DevPrintf("Precompiled %u blocks in page %u from persistent cache, discarded %u.", num_compiled, page_index,
+                num_discarded);
+}
+
 #ifdef ENABLE_RECOMPILER
 
 void AddBlockToHostCodeMap(CodeBlock* block)
@@ -1179,12 +1995,13 @@ Common::PageFaultHandler::HandlerResult MMapPageFaultHandler(void* exception_pc,
         const u32 code_page_index = Bus::GetRAMCodePageIndex(fastmem_address);
         if (Bus::IsRAMCodePage(code_page_index))
         {
-          if (++lbi.fault_count < CODE_WRITE_FAULT_THRESHOLD_FOR_SLOWMEM)
-          {
-            InvalidateBlocksWithPageIndex(code_page_index);
+          // Only the blocks containing the written word are thrown away. If that leaves code in the page, it's still
+          // write protected, so the store has to go through slowmem, which checks each write.
+          InvalidateBlocksInRange((fastmem_address & Bus::g_ram_mask) & ~3u, sizeof(u32));
+          if (!Bus::IsRAMCodePage(code_page_index) && ++lbi.fault_count < CODE_WRITE_FAULT_THRESHOLD_FOR_SLOWMEM)
             return Common::PageFaultHandler::HandlerResult::ContinueExecution;
-          }
-          else
+
+          if (lbi.fault_count >= CODE_WRITE_FAULT_THRESHOLD_FOR_SLOWMEM)
           {
             Log_DevPrintf("Backpatching code write at %p (%08X) address %p (%08X) to slowmem after threshold",
                           exception_pc, lbi.guest_pc, fault_address, fastmem_address);
@@ -1286,6 +2103,11 @@ void CPU::Recompiler::Thunks::ResolveBranch(CodeBlock* block, void* host_pc, voi
   }
 }
 
+void CPU::Recompiler::Thunks::CompileSuperblock(CodeBlock* block)
+{
+  CPU::CodeCache::CompileSuperblock(block);
+}
+
 void CPU::Recompiler::Thunks::LogPC(u32 pc)
 {
 #if 1
@@ -10,6 +10,7 @@
 #include <array>
 #include <map>
 #include <memory>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -61,8 +62,34 @@ struct CodeBlockInstruction
   bool is_last_instruction : 1;
   bool has_load_delay : 1;
   bool can_trap : 1;
+  bool continues_superblock : 1;
 };
 
+struct ThreadedInstruction;
+using ThreadedInstructionHandler = void (*)(const ThreadedInstruction& ti);
+
+/// Instruction decoded ahead of time for the threaded interpreter. Register fields are extracted, and immediates are
+/// extended or turned into branch targets, so the handler doesn't have to look at the instruction bits again.
+struct ThreadedInstruction
+{
+  ThreadedInstructionHandler handler;
+  Instruction instruction;
+  u32 pc;
+  u32 imm;
+  Reg rs;
+  Reg rt;
+  Reg rd;
+  bool is_branch_delay_slot;
+
+  // The current instruction state is only written for instructions which can raise exceptions.
+  bool can_trap;
+
+  // Load delays only need to be updated around loads, and at the start of the block.
+  bool update_load_delay;
+};
+
+struct CodeBlockPageLink;
+
 struct CodeBlock
 {
   using HostCodePointer = void (*)();
@@ -75,8 +102,12 @@ struct CodeBlock
     u32 host_pc_size;
   };
 
+  CodeBlock() = default;
   CodeBlock(const CodeBlockKey key_) : key(key_) {}
 
+  /// Clears the block so it can be reused for another key, keeping the memory allocated by its lists.
+  void Reset(const CodeBlockKey key_);
+
   CodeBlockKey key;
   u32 host_code_size = 0;
   HostCodePointer host_code = nullptr;
@@ -85,6 +116,12 @@ struct CodeBlock
   std::vector<LinkInfo> link_predecessors;
   std::vector<LinkInfo> link_successors;
 
+  // Only used by the threaded interpreter.
+  std::vector<ThreadedInstruction> threaded_instructions;
+
+  // Entries in the block lists of each RAM page the block has code in, while it's valid.
+  CodeBlockPageLink* page_links = nullptr;
+
   TickCount uncached_fetch_ticks = 0;
   u32 icache_line_count = 0;
 
@@ -96,6 +133,13 @@ struct CodeBlock
   bool contains_double_branches = false;
   bool invalidated = false;
   bool can_link = true;
+  bool superblock = false;
+
+  // Hash of the block's code in RAM, so it can be revalidated without decoding it again. Not used for superblocks.
+  u64 ram_hash = 0;
+
+  // Executions left before the block is recompiled as a superblock, or zero if it won't be. Decremented by the JIT.
+  u32 superblock_countdown = 0;
 
   u32 recompile_frame_number = 0;
   u32 recompile_count = 0;
@@ -103,8 +147,6 @@ struct CodeBlock
 
   u32 GetPC() const { return key.GetPC(); }
   u32 GetSizeInBytes() const { return static_cast<u32>(instructions.size()) * sizeof(Instruction); }
-  u32 GetStartPageIndex() const { return (key.GetPCPhysicalAddress() / HOST_PAGE_SIZE); }
-  u32 GetEndPageIndex() const { return ((key.GetPCPhysicalAddress() + GetSizeInBytes()) / HOST_PAGE_SIZE); }
   bool IsInRAM() const
   {
     // TODO: Constant
@@ -112,6 +154,21 @@ struct CodeBlock
   }
 };
 
+/// Entry in the list of blocks with code in a RAM page. Blocks can have code in more than one page, so they also chain
+/// their own links together.
+struct CodeBlockPageLink
+{
+  CodeBlock* block;
+  CodeBlockPageLink* prev;
+  CodeBlockPageLink* next;
+  CodeBlockPageLink* next_in_block;
+  u32 page;
+
+  // Range of the block's code in this page. Superblocks might not have code in all of it.
+  PhysicalMemoryAddress start_address;
+  PhysicalMemoryAddress end_address;
+};
+
 namespace CodeCache {
 
 enum : u32
@@ -147,16 +204,36 @@ void Reinitialize();
 /// Invalidates all blocks which are in the range of the specified code page.
 void InvalidateBlocksWithPageIndex(u32 page_index);
 
+/// Invalidates the blocks containing code in the specified range of RAM. Other blocks in the same pages are left
+/// alone, so writes to data stored next to code don't force it to be recompiled.
+void InvalidateBlocksInRange(PhysicalMemoryAddress address, u32 size);
+
 /// Invalidates all blocks in the cache.
 void InvalidateAll();
 
+/// Compiles the block at the specified address ahead of it being executed, or revalidates it if it was invalidated.
+/// Returns false if the block can't be compiled, and will be interpreted instead.
+bool PrecompileBlock(VirtualMemoryAddress pc);
+
+/// Opens the persistent cache at the specified path, saving the previous one. Blocks recorded in the cache are
+/// precompiled the first time code in the same page is executed, as long as they still match memory.
+void OpenPersistentCache(std::string path);
+
+/// Writes all compiled blocks to the persistent cache, and closes it.
+void ClosePersistentCache();
+
 template<PGXPMode pgxp_mode>
 void InterpretCachedBlock(const CodeBlock& block);
 
 template<PGXPMode pgxp_mode>
 void InterpretUncachedBlock();
 
-/// Invalidates any code pages which overlap the specified range.
+/// Decodes the block's instructions for the threaded interpreter. Blocks are decoded for the current PGXP mode.
+void CompileThreadedBlock(CodeBlock* block);
+
+void InterpretThreadedBlock(const CodeBlock& block);
+
+/// Invalidates any blocks which overlap the specified range.
 ALWAYS_INLINE void InvalidateCodePages(PhysicalMemoryAddress address, u32 word_count)
 {
   const u32 start_page = address / HOST_PAGE_SIZE;
@@ -164,7 +241,10 @@ ALWAYS_INLINE void InvalidateCodePages(PhysicalMemoryAddress address, u32 word_c
   for (u32 page = start_page; page <= end_page; page++)
   {
     if (Bus::g_ram_code_bits[page])
-      CPU::CodeCache::InvalidateBlocksWithPageIndex(page);
+    {
+      CPU::CodeCache::InvalidateBlocksInRange(address, word_count * sizeof(u32));
+      break;
+    }
   }
 }
 
@@ -2230,6 +2230,7 @@ void CPU::Execute()
   {
     case CPUExecutionMode::Recompiler:
     case CPUExecutionMode::CachedInterpreter:
+    case CPUExecutionMode::ThreadedInterpreter:
       CodeCache::Execute();
       break;
 
@@ -2357,6 +2358,503 @@ template void CPU::CodeCache::InterpretUncachedBlock<PGXPMode::Disabled>();
 template void CPU::CodeCache::InterpretUncachedBlock<PGXPMode::Memory>();
 template void CPU::CodeCache::InterpretUncachedBlock<PGXPMode::CPU>();
 
+namespace CPU::ThreadedInterpreter {
+
+static void Nop(const ThreadedInstruction& ti)
+{
+}
+
+template<PGXPMode pgxp_mode>
+static void Fallback(const ThreadedInstruction& ti)
+{
+  ExecuteInstruction<pgxp_mode, false>();
+}
+
+template<InstructionFunct funct>
+static void ALUOp(const ThreadedInstruction& ti)
+{
+  const u32 lhs = ReadReg(ti.rs);
+  const u32 rhs = ReadReg(ti.rt);
+  u32 value;
+  if constexpr (funct == InstructionFunct::sll)
+    value = rhs << ti.imm;
+  else if constexpr (funct == InstructionFunct::srl)
+    value = rhs >> ti.imm;
+  else if constexpr (funct == InstructionFunct::sra)
+    value = static_cast<u32>(static_cast<s32>(rhs) >> ti.imm);
+  else if constexpr (funct == InstructionFunct::sllv)
+    value = rhs << (lhs & UINT32_C(0x1F));
+  else if constexpr (funct == InstructionFunct::srlv)
+    value = rhs >> (lhs & UINT32_C(0x1F));
+  else if constexpr (funct == InstructionFunct::srav)
+    value = static_cast<u32>(static_cast<s32>(rhs) >> (lhs & UINT32_C(0x1F)));
+  else if constexpr (funct == InstructionFunct::and_)
+    value = lhs & rhs;
+  else if constexpr (funct == InstructionFunct::or_)
+    value = lhs | rhs;
+  else if constexpr (funct == InstructionFunct::xor_)
+    value = lhs ^ rhs;
+  else if constexpr (funct == InstructionFunct::nor)
+    value = ~(lhs | rhs);
+  else if constexpr (funct == InstructionFunct::add || funct == InstructionFunct::addu)
+    value = lhs + rhs;
+  else if constexpr (funct == InstructionFunct::sub || funct == InstructionFunct::subu)
+    value = lhs - rhs;
+  else if constexpr (funct == InstructionFunct::slt)
+    value = BoolToUInt32(static_cast<s32>(lhs) < static_cast<s32>(rhs));
+  else if constexpr (funct == InstructionFunct::sltu)
+    value = BoolToUInt32(lhs < rhs);
+  else
+    static_assert(funct == InstructionFunct::sll, "Unhandled ALU op");
+
+  if constexpr (funct == InstructionFunct::add)
+  {
+    if (AddOverflow(lhs, rhs, value))
+    {
+      RaiseException(Exception::Ov);
+      return;
+    }
+  }
+  else if constexpr (funct == InstructionFunct::sub)
+  {
+    if (SubOverflow(lhs, rhs, value))
+    {
+      RaiseException(Exception::Ov);
+      return;
+    }
+  }
+
+  WriteReg(ti.rd, value);
+}
+
+template<InstructionFunct funct>
+static void MultDivOp(const ThreadedInstruction& ti)
+{
+  if constexpr (funct == InstructionFunct::mfhi)
+  {
+    WriteReg(ti.rd, g_state.regs.hi);
+  }
+  else if constexpr (funct == InstructionFunct::mflo)
+  {
+    WriteReg(ti.rd, g_state.regs.lo);
+  }
+  else if constexpr (funct == InstructionFunct::mthi)
+  {
+    g_state.regs.hi = ReadReg(ti.rs);
+  }
+  else if constexpr (funct == InstructionFunct::mtlo)
+  {
+    g_state.regs.lo = ReadReg(ti.rs);
+  }
+  else if constexpr (funct == InstructionFunct::mult || funct == InstructionFunct::multu)
+  {
+    const u32 lhs = ReadReg(ti.rs);
+    const u32 rhs = ReadReg(ti.rt);
+    const u64 result = (funct == InstructionFunct::mult) ?
+                         static_cast<u64>(static_cast<s64>(SignExtend64(lhs)) * static_cast<s64>(SignExtend64(rhs))) :
+                         (ZeroExtend64(lhs) * ZeroExtend64(rhs));
+    g_state.regs.hi = Truncate32(result >> 32);
+    g_state.regs.lo = Truncate32(result);
+  }
+  else if constexpr (funct == InstructionFunct::div)
+  {
+    const s32 num = static_cast<s32>(ReadReg(ti.rs));
+    const s32 denom = static_cast<s32>(ReadReg(ti.rt));
+    if (denom == 0)
+    {
+      g_state.regs.lo = (num >= 0) ? UINT32_C(0xFFFFFFFF) : UINT32_C(1);
+      g_state.regs.hi = static_cast<u32>(num);
+    }
+    else if (static_cast<u32>(num) == UINT32_C(0x80000000) && denom == -1)
+    {
+      g_state.regs.lo = UINT32_C(0x80000000);
+      g_state.regs.hi = 0;
+    }
+    else
+    {
+      g_state.regs.lo = static_cast<u32>(num / denom);
+      g_state.regs.hi = static_cast<u32>(num % denom);
+    }
+  }
+  else if constexpr (funct == InstructionFunct::divu)
+  {
+    const u32 num = ReadReg(ti.rs);
+    const u32 denom = ReadReg(ti.rt);
+    if (denom == 0)
+    {
+      g_state.regs.lo = UINT32_C(0xFFFFFFFF);
+      g_state.regs.hi = num;
+    }
+    else
+    {
+      g_state.regs.lo = num / denom;
+      g_state.regs.hi = num % denom;
+    }
+  }
+  else
+  {
+    static_assert(funct == InstructionFunct::mfhi, "Unhandled mult/div op");
+  }
+}
+
+template<InstructionOp op>
+static void ImmediateOp(const ThreadedInstruction& ti)
+{
+  // lui is decoded as an ori from $zero.
+  const u32 lhs = ReadReg(ti.rs);
+  u32 value;
+  if constexpr (op == InstructionOp::addi || op == InstructionOp::addiu)
+    value = lhs + ti.imm;
+  else if constexpr (op == InstructionOp::slti)
+    value = BoolToUInt32(static_cast<s32>(lhs) < static_cast<s32>(ti.imm));
+  else if constexpr (op == InstructionOp::sltiu)
+    value = BoolToUInt32(lhs < ti.imm);
+  else if constexpr (op == InstructionOp::andi)
+    value = lhs & ti.imm;
+  else if constexpr (op == InstructionOp::ori)
+    value = lhs | ti.imm;
+  else if constexpr (op == InstructionOp::xori)
+    value = lhs ^ ti.imm;
+  else
+    static_assert(op == InstructionOp::addi, "Unhandled immediate op");
+
+  if constexpr (op == InstructionOp::addi)
+  {
+    if (AddOverflow(lhs, ti.imm, value))
+    {
+      RaiseException(Exception::Ov);
+      return;
+    }
+  }
+
+  WriteReg(ti.rt, value);
+}
+
+template<InstructionOp op>
+static void Load(const ThreadedInstruction& ti)
+{
+  const VirtualMemoryAddress addr = ReadReg(ti.rs) + ti.imm;
+  u32 value;
+  if constexpr (op == InstructionOp::lb || op == InstructionOp::lbu)
+  {
+    u8 byte_value;
+    if (!ReadMemoryByte(addr, &byte_value))
+      return;
+
+    value = (op == InstructionOp::lb) ? SignExtend32(byte_value) : ZeroExtend32(byte_value);
+  }
+  else if constexpr (op == InstructionOp::lh || op == InstructionOp::lhu)
+  {
+    u16 halfword_value;
+    if (!ReadMemoryHalfWord(addr, &halfword_value))
+      return;
+
+    value = (op == InstructionOp::lh) ? SignExtend32(halfword_value) : ZeroExtend32(halfword_value);
+  }
+  else
+  {
+    static_assert(op == InstructionOp::lw, "Unhandled load op");
+    if (!ReadMemoryWord(addr, &value))
+      return;
+  }
+
+  WriteRegDelayed(ti.rt, value);
+}
+
+template<InstructionOp op>
+static void Store(const ThreadedInstruction& ti)
+{
+  const VirtualMemoryAddress addr = ReadReg(ti.rs) + ti.imm;
+  const u32 value = ReadReg(ti.rt);
+  if constexpr (op == InstructionOp::sb)
+    WriteMemoryByte(addr, value);
+  else if constexpr (op == InstructionOp::sh)
+    WriteMemoryHalfWord(addr, value);
+  else if constexpr (op == InstructionOp::sw)
+    WriteMemoryWord(addr, value);
+  else
+    static_assert(op == InstructionOp::sb, "Unhandled store op");
+}
+
+template<InstructionOp op>
+static void Branch(const ThreadedInstruction& ti)
+{
+  // We're still flagged as a branch delay slot even if the branch isn't taken.
+  g_state.next_instruction_is_branch_delay_slot = true;
+
+  bool branch;
+  if constexpr (op == InstructionOp::j)
+  {
+    branch = true;
+  }
+  else if constexpr (op == InstructionOp::jal)
+  {
+    WriteReg(Reg::ra, g_state.npc);
+    branch = true;
+  }
+  else if constexpr (op == InstructionOp::beq)
+    branch = (ReadReg(ti.rs) == ReadReg(ti.rt));
+  else if constexpr (op == InstructionOp::bne)
+    branch = (ReadReg(ti.rs) != ReadReg(ti.rt));
+  else if constexpr (op == InstructionOp::bgtz)
+    branch = (static_cast<s32>(ReadReg(ti.rs)) > 0);
+  else if constexpr (op == InstructionOp::blez)
+    branch = (static_cast<s32>(ReadReg(ti.rs)) <= 0);
+  else
+    static_assert(op == InstructionOp::j, "Unhandled branch op");
+
+  // Direct branch targets are always aligned.
+  if (branch)
+  {
+    g_state.npc = ti.imm;
+    g_state.branch_was_taken = true;
+  }
+}
+
+template<bool bgez, bool link>
+static void BranchZero(const ThreadedInstruction& ti)
+{
+  g_state.next_instruction_is_branch_delay_slot = true;
+  const bool branch = (static_cast<s32>(ReadReg(ti.rs)) < 0) ^ bgez;
+
+  // register is still linked even if the branch isn't taken
+  if constexpr (link)
+    WriteReg(Reg::ra, g_state.npc);
+
+  if (branch)
+  {
+    g_state.npc = ti.imm;
+    g_state.branch_was_taken = true;
+  }
+}
+
+template<bool link>
+static void JumpRegister(const ThreadedInstruction& ti)
+{
+  g_state.next_instruction_is_branch_delay_slot = true;
+  const u32 target = ReadReg(ti.rs);
+  if constexpr (link)
+    WriteReg(ti.rd, g_state.npc);
+
+  CPU::Branch(target);
+}
+
+/// Returns the handler for an instruction, or nullptr if it has to go through the full interpreter.
+static ThreadedInstructionHandler GetHandler(const CodeBlockInstruction& cbi)
+{
+  const Instruction inst = cbi.instruction;
+  if (inst.bits == 0)
+    return &Nop;
+
+  switch (inst.op)
+  {
+    case InstructionOp::funct:
+    {
+      switch (inst.r.funct)
+      {
+        // clang-format off
+        case InstructionFunct::sll: return &ALUOp<InstructionFunct::sll>;
+        case InstructionFunct::srl: return &ALUOp<InstructionFunct::srl>;
+        case InstructionFunct::sra: return &ALUOp<InstructionFunct::sra>;
+        case InstructionFunct::sllv: return &ALUOp<InstructionFunct::sllv>;
+        case InstructionFunct::srlv: return &ALUOp<InstructionFunct::srlv>;
+        case InstructionFunct::srav: return &ALUOp<InstructionFunct::srav>;
+        case InstructionFunct::and_: return &ALUOp<InstructionFunct::and_>;
+        case InstructionFunct::or_: return &ALUOp<InstructionFunct::or_>;
+        case InstructionFunct::xor_: return &ALUOp<InstructionFunct::xor_>;
+        case InstructionFunct::nor: return &ALUOp<InstructionFunct::nor>;
+        case InstructionFunct::add: return &ALUOp<InstructionFunct::add>;
+        case InstructionFunct::addu: return &ALUOp<InstructionFunct::addu>;
+        case InstructionFunct::sub: return &ALUOp<InstructionFunct::sub>;
+        case InstructionFunct::subu: return &ALUOp<InstructionFunct::subu>;
+        case InstructionFunct::slt: return &ALUOp<InstructionFunct::slt>;
+        case InstructionFunct::sltu: return &ALUOp<InstructionFunct::sltu>;
+        case InstructionFunct::mfhi: return &MultDivOp<InstructionFunct::mfhi>;
+        case InstructionFunct::mthi: return &MultDivOp<InstructionFunct::mthi>;
+        case InstructionFunct::mflo: return &MultDivOp<InstructionFunct::mflo>;
+        case InstructionFunct::mtlo: return &MultDivOp<InstructionFunct::mtlo>;
+        case InstructionFunct::mult: return &MultDivOp<InstructionFunct::mult>;
+        case InstructionFunct::multu: return &MultDivOp<InstructionFunct::multu>;
+        case InstructionFunct::div: return &MultDivOp<InstructionFunct::div>;
+        case InstructionFunct::divu: return &MultDivOp<InstructionFunct::divu>;
+        case InstructionFunct::jr: return cbi.is_branch_delay_slot ? nullptr : &JumpRegister<false>;
+        case InstructionFunct::jalr: return cbi.is_branch_delay_slot ? nullptr : &JumpRegister<true>;
+        default: return nullptr;
+        // clang-format on
+      }
+    }
+
+    // clang-format off
+    case InstructionOp::lui: return &ImmediateOp<InstructionOp::ori>;
+    case InstructionOp::addi: return &ImmediateOp<InstructionOp::addi>;
+    case InstructionOp::addiu: return &ImmediateOp<InstructionOp::addiu>;
+    case InstructionOp::slti: return &ImmediateOp<InstructionOp::slti>;
+    case InstructionOp::sltiu: return &ImmediateOp<InstructionOp::sltiu>;
+    case InstructionOp::andi: return &ImmediateOp<InstructionOp::andi>;
+    case InstructionOp::ori: return &ImmediateOp<InstructionOp::ori>;
+    case InstructionOp::xori: return &ImmediateOp<InstructionOp::xori>;
+    case InstructionOp::lb: return &Load<InstructionOp::lb>;
+    case InstructionOp::lbu: return &Load<InstructionOp::lbu>;
+    case InstructionOp::lh: return &Load<InstructionOp::lh>;
+    case InstructionOp::lhu: return &Load<InstructionOp::lhu>;
+    case InstructionOp::lw: return &Load<InstructionOp::lw>;
+    case InstructionOp::sb: return &Store<InstructionOp::sb>;
+    case InstructionOp::sh: return &Store<InstructionOp::sh>;
+    case InstructionOp::sw: return &Store<InstructionOp::sw>;
+    // clang-format on
+
+    default:
+      break;
+  }
+
+  // The targets of branches in delay slots depend on where the first branch went, so leave them to the interpreter.
+  if (cbi.is_branch_delay_slot)
+    return nullptr;
+
+  switch (inst.op)
+  {
+    // clang-format off
+    case InstructionOp::j: return &Branch<InstructionOp::j>;
+    case InstructionOp::jal: return &Branch<InstructionOp::jal>;
+    case InstructionOp::beq: return &Branch<InstructionOp::beq>;
+    case InstructionOp::bne: return &Branch<InstructionOp::bne>;
+    case InstructionOp::bgtz: return &Branch<InstructionOp::bgtz>;
+    case InstructionOp::blez: return &Branch<InstructionOp::blez>;
+    // clang-format on
+
+    case InstructionOp::b:
+    {
+      const u8 rt = static_cast<u8>(inst.i.rt.GetValue());
+      const bool bgez = ConvertToBoolUnchecked(rt & u8(1));
+      const bool link = (rt & u8(0x1E)) == u8(0x10);
+      if (link)
+        return bgez ? &BranchZero<true, true> : &BranchZero<false, true>;
+      else
+        return bgez ? &BranchZero<true, false> : &BranchZero<false, false>;
+    }
+
+    default:
+      return nullptr;
+  }
+}
+
+} // namespace CPU::ThreadedInterpreter
+
+void CPU::CodeCache::CompileThreadedBlock(CodeBlock* block)
+{
+  using namespace ThreadedInterpreter;
+
+  // PGXP needs to see every instruction, so those modes go through the full interpreter.
+  ThreadedInstructionHandler fallback_handler;
+  if (g_settings.gpu_pgxp_enable)
+    fallback_handler = g_settings.gpu_pgxp_cpu ? &Fallback<PGXPMode::CPU> : &Fallback<PGXPMode::Memory>;
+  else
+    fallback_handler = &Fallback<PGXPMode::Disabled>;
+
+  block->threaded_instructions.clear();
+  block->threaded_instructions.reserve(block->instructions.size());
+
+  // A load from the previous block could still be pending.
+  bool update_load_delay = true;
+
+  for (const CodeBlockInstruction& cbi : block->instructions)
+  {
+    const Instruction inst = cbi.instruction;
+    ThreadedInstruction& ti = block->threaded_instructions.emplace_back();
+    ti.handler = g_settings.gpu_pgxp_enable ? nullptr : GetHandler(cbi);
+    ti.instruction.bits = inst.bits;
+    ti.pc = cbi.pc;
+    ti.rs = inst.r.rs;
+    ti.rt = inst.r.rt;
+    ti.rd = inst.r.rd;
+    ti.is_branch_delay_slot = cbi.is_branch_delay_slot;
+    ti.can_trap = !ti.handler || cbi.can_trap;
+
+    // Anything going through the full interpreter could load into a register, or be in the delay slot of one.
+    ti.update_load_delay = update_load_delay || !ti.handler || cbi.has_load_delay || cbi.is_load_delay_slot;
+    update_load_delay = !ti.handler;
+
+    if (!ti.handler)
+    {
+      ti.handler = fallback_handler;
+      ti.imm = 0;
+    }
+    else if (inst.op == InstructionOp::funct)
+    {
+      ti.imm = inst.r.shamt;
+    }
+    else if (inst.op == InstructionOp::lui)
+    {
+      ti.rs = Reg::zero;
+      ti.imm = inst.i.imm_zext32() << 16;
+    }
+    else if (inst.op == InstructionOp::andi || inst.op == InstructionOp::ori || inst.op == InstructionOp::xori)
+    {
+      ti.imm = inst.i.imm_zext32();
+    }
+    else if (IsDirectBranchInstruction(inst))
+    {
+      ti.imm = GetDirectBranchTarget(inst, cbi.pc);
+    }
+    else
+    {
+      ti.imm = inst.i.imm_sext32();
+    }
+  }
+}
+
+void CPU::CodeCache::InterpretThreadedBlock(const CodeBlock& block)
+{
+  // set up the state so we've already fetched the instruction
+  DebugAssert(g_state.pc == block.GetPC());
+  g_state.npc = block.GetPC() + 4;
+  g_state.exception_raised = false;
+
+  const ThreadedInstruction* ti = block.threaded_instructions.data();
+  const ThreadedInstruction* const end = ti + block.threaded_instructions.size();
+  for (;;)
+  {
+    g_state.pending_ticks++;
+
+    // now executing the instruction we previously fetched
+    if (ti->can_trap)
+    {
+      g_state.current_instruction.bits = ti->instruction.bits;
+      g_state.current_instruction_pc = ti->pc;
+      g_state.current_instruction_in_branch_delay_slot = ti->is_branch_delay_slot;
+    }
+    g_state.current_instruction_was_branch_taken = g_state.branch_was_taken;
+    g_state.branch_was_taken = false;
+
+    // update pc
+    g_state.pc = g_state.npc;
+    g_state.npc += 4;
+
+    // no decoding needed, go straight to the handler
+    ti->handler(*ti);
+
+    // next load delay
+    if (ti->update_load_delay)
+      UpdateLoadDelay();
+
+    if (g_state.exception_raised)
+      break;
+
+    if ((++ti) == end)
+    {
+      // leave the state as if the last instruction had been fully executed
+      ti--;
+      g_state.current_instruction.bits = ti->instruction.bits;
+      g_state.current_instruction_pc = ti->pc;
+      g_state.current_instruction_in_branch_delay_slot = ti->is_branch_delay_slot;
+      break;
+    }
+  }
+
+  // cleanup so the interpreter can kick in if needed
+  g_state.next_instruction_is_branch_delay_slot = false;
+}
+
 bool CPU::Recompiler::Thunks::InterpretInstruction()
 {
   ExecuteInstruction<PGXPMode::Disabled, false>();
@@ -2755,7 +3253,7 @@ ALWAYS_INLINE bool CPU::DoSafeMemoryAccess(VirtualMemoryAddress address, u32& va
         {
           g_ram[offset] = Truncate8(value);
           if (g_ram_code_bits[page_index])
-            CPU::CodeCache::InvalidateBlocksWithPageIndex(page_index);
+            CPU::CodeCache::InvalidateBlocksInRange(offset, sizeof(u8));
         }
       }
       else if constexpr (size == MemoryAccessSize::HalfWord)
@@ -2767,7 +3265,7 @@ ALWAYS_INLINE bool CPU::DoSafeMemoryAccess(VirtualMemoryAddress address, u32& va
         {
           std::memcpy(&g_ram[offset], &new_value, sizeof(u16));
           if (g_ram_code_bits[page_index])
-            CPU::CodeCache::InvalidateBlocksWithPageIndex(page_index);
+            CPU::CodeCache::InvalidateBlocksInRange(offset, sizeof(u16));
         }
       }
       else if constexpr (size == MemoryAccessSize::Word)
@@ -2778,7 +3276,7 @@ ALWAYS_INLINE bool CPU::DoSafeMemoryAccess(VirtualMemoryAddress address, u32& va
         {
           std::memcpy(&g_ram[offset], &value, sizeof(u32));
           if (g_ram_code_bits[page_index])
-            CPU::CodeCache::InvalidateBlocksWithPageIndex(page_index);
+            CPU::CodeCache::InvalidateBlocksInRange(offset, sizeof(u32));
         }
       }
     }
@@ -31,6 +31,8 @@ bool CodeGenerator::CompileBlock(CodeBlock* block, CodeBlock::HostCodePointer* o
   m_fastmem_load_base_in_register = false;
   m_fastmem_store_base_in_register = false;
 
+  AnalyzeBlock();
+
   EmitBeginBlock(true);
   BlockPrologue();
 
@@ -56,8 +58,9 @@ bool CodeGenerator::CompileBlock(CodeBlock* block, CodeBlock::HostCodePointer* o
   }
 
   FinalizeBlock(out_host_code, out_host_code_size);
-  Log_ProfilePrintf("JIT block 0x%08X: %zu instructions (%u bytes), %u host bytes", block->GetPC(),
-                    block->instructions.size(), block->GetSizeInBytes(), *out_host_code_size);
+  Log_ProfilePrintf("JIT block 0x%08X: %zu instructions (%u bytes), %u eliminated, %u host bytes", block->GetPC(),
+                    block->instructions.size(), block->GetSizeInBytes(), m_num_eliminated_instructions,
+                    *out_host_code_size);
 
   DebugAssert(m_register_cache.GetUsedHostRegisters() == 0);
 
@@ -77,6 +80,9 @@ bool CodeGenerator::CompileInstruction(const CodeBlockInstruction& cbi)
     return true;
   }
 
+  if (GetEliminatedInstruction(cbi) != EliminatedInstruction::None)
+    return Compile_Eliminated(cbi);
+
   bool result;
   switch (cbi.instruction.op)
   {
@@ -223,6 +229,350 @@ bool CodeGenerator::CompileInstruction(const CodeBlockInstruction& cbi)
   return result;
 }
 
+enum class InstructionDataflow : u8
+{
+  Barrier,     // Can exit the block or observe guest state, so every register is live.
+  SideEffects, // Reads and writes registers, but has to be kept.
+  Pure,        // Only reads and writes registers, and can be removed if the result isn't used.
+};
+
+using KnownRegisters = std::array<std::optional<u32>, static_cast<u8>(Reg::count)>;
+
+static constexpr u64 ALL_REGISTERS_MASK = (UINT64_C(1) << static_cast<u8>(Reg::count)) - 1;
+
+static constexpr u64 GetRegisterMask(Reg reg)
+{
+  return (reg == Reg::zero) ? 0 : (UINT64_C(1) << static_cast<u8>(reg));
+}
+
+static InstructionDataflow GetInstructionDataflow(const CodeBlockInstruction& cbi, u64* reads, u64* writes)
+{
+  const Instruction inst = cbi.instruction;
+  *reads = ALL_REGISTERS_MASK;
+  *writes = 0;
+
+  switch (inst.op)
+  {
+    case InstructionOp::lui:
+      *reads = 0;
+      *writes = GetRegisterMask(inst.i.rt);
+      return InstructionDataflow::Pure;
+
+    case InstructionOp::ori:
+    case InstructionOp::andi:
+    case InstructionOp::xori:
+    case InstructionOp::addiu:
+    case InstructionOp::slti:
+    case InstructionOp::sltiu:
+      *reads = GetRegisterMask(inst.i.rs);
+      *writes = GetRegisterMask(inst.i.rt);
+      return InstructionDataflow::Pure;
+
+    case InstructionOp::lb:
+    case InstructionOp::lbu:
+    case InstructionOp::lh:
+    case InstructionOp::lhu:
+    case InstructionOp::lw:
+    case InstructionOp::lwl:
+    case InstructionOp::lwr:
+    {
+      // Loads only raise exceptions from the JIT when memory exceptions are enabled.
+      if (g_settings.cpu_recompiler_memory_exceptions)
+        return InstructionDataflow::Barrier;
+
+      const bool merge = (inst.op == InstructionOp::lwl || inst.op == InstructionOp::lwr);
+      *reads = GetRegisterMask(inst.i.rs) | (merge ? GetRegisterMask(inst.i.rt) : 0);
+      *writes = GetRegisterMask(inst.i.rt);
+      return InstructionDataflow::SideEffects;
+    }
+
+    case InstructionOp::j:
+    case InstructionOp::jal:
+    case InstructionOp::beq:
+    {
+      // Jumps inside a superblock don't leave it.
+      if (!cbi.continues_superblock)
+        return InstructionDataflow::Barrier;
+
+      *reads = 0;
+      *writes = (inst.op == InstructionOp::jal) ? GetRegisterMask(Reg::ra) : 0;
+      return InstructionDataflow::SideEffects;
+    }
+
+    case InstructionOp::funct:
+    {
+      switch (inst.r.funct)
+      {
+        case InstructionFunct::sll:
+        case InstructionFunct::srl:
+        case InstructionFunct::sra:
+          *reads = GetRegisterMask(inst.r.rt);
+          *writes = GetRegisterMask(inst.r.rd);
+          return InstructionDataflow::Pure;
+
+        case InstructionFunct::sllv:
+        case InstructionFunct::srlv:
+        case InstructionFunct::srav:
+        case InstructionFunct::addu:
+        case InstructionFunct::subu:
+        case InstructionFunct::and_:
+        case InstructionFunct::or_:
+        case InstructionFunct::xor_:
+        case InstructionFunct::nor:
+        case InstructionFunct::slt:
+        case InstructionFunct::sltu:
+          *reads = GetRegisterMask(inst.r.rs) | GetRegisterMask(inst.r.rt);
+          *writes = GetRegisterMask(inst.r.rd);
+          return InstructionDataflow::Pure;
+
+        case InstructionFunct::mfhi:
+          *reads = GetRegisterMask(Reg::hi);
+          *writes = GetRegisterMask(inst.r.rd);
+          return InstructionDataflow::Pure;
+
+        case InstructionFunct::mflo:
+          *reads = GetRegisterMask(Reg::lo);
+          *writes = GetRegisterMask(inst.r.rd);
+          return InstructionDataflow::Pure;
+
+        case InstructionFunct::mthi:
+          *reads = GetRegisterMask(inst.r.rs);
+          *writes = GetRegisterMask(Reg::hi);
+          return InstructionDataflow::Pure;
+
+        case InstructionFunct::mtlo:
+          *reads = GetRegisterMask(inst.r.rs);
+          *writes = GetRegisterMask(Reg::lo);
+          return InstructionDataflow::Pure;
+
+        case InstructionFunct::mult:
+        case InstructionFunct::multu:
+        case InstructionFunct::div:
+        case InstructionFunct::divu:
+          *reads = GetRegisterMask(inst.r.rs) | GetRegisterMask(inst.r.rt);
+          *writes = GetRegisterMask(Reg::hi) | GetRegisterMask(Reg::lo);
+          return InstructionDataflow::Pure;
+
+        default:
+          return InstructionDataflow::Barrier;
+      }
+    }
+
+    default:
+      return InstructionDataflow::Barrier;
+  }
+}
+
+/// Returns the value a pure instruction writes, if all of its inputs are known.
+static std::optional<u32> EvaluateConstantInstruction(const Instruction inst, const KnownRegisters& regs)
+{
+  const auto get = [&regs](Reg reg) { return regs[static_cast<u8>(reg)]; };
+
+  switch (inst.op)
+  {
+    case InstructionOp::lui:
+      return inst.i.imm_zext32() << 16;
+
+    case InstructionOp::ori:
+    case InstructionOp::andi:
+    case InstructionOp::xori:
+    case InstructionOp::addiu:
+    case InstructionOp::slti:
+    case InstructionOp::sltiu:
+    {
+      const std::optional<u32> lhs = get(inst.i.rs);
+      if (!lhs.has_value())
+        return std::nullopt;
+
+      switch (inst.op)
+      {
+        case InstructionOp::ori:
+          return lhs.value() | inst.i.imm_zext32();
+        case InstructionOp::andi:
+          return lhs.value() & inst.i.imm_zext32();
+        case InstructionOp::xori:
+          return lhs.value() ^ inst.i.imm_zext32();
+        case InstructionOp::addiu:
+          return lhs.value() + inst.i.imm_sext32();
+        case InstructionOp::slti:
+          return BoolToUInt32(static_cast<s32>(lhs.value()) < static_cast<s32>(inst.i.imm_sext32()));
+        default:
+          return BoolToUInt32(lhs.value() < inst.i.imm_sext32());
+      }
+    }
+
+    case InstructionOp::funct:
+    {
+      const std::optional<u32> lhs = get(inst.r.rs);
+      const std::optional<u32> rhs = get(inst.r.rt);
+      switch (inst.r.funct)
+      {
+        case InstructionFunct::sll:
+          return rhs.has_value() ? std::optional<u32>(rhs.value() << inst.r.shamt) : std::nullopt;
+        case InstructionFunct::srl:
+          return rhs.has_value() ? std::optional<u32>(rhs.value() >> inst.r.shamt) : std::nullopt;
+        case InstructionFunct::sra:
+          return rhs.has_value() ? std::optional<u32>(static_cast<u32>(static_cast<s32>(rhs.value()) >> inst.r.shamt)) :
+                                   std::nullopt;
+        case InstructionFunct::mfhi:
+          return get(Reg::hi);
+        case InstructionFunct::mflo:
+          return get(Reg::lo);
+        case InstructionFunct::mthi:
+        case InstructionFunct::mtlo:
+          return lhs;
+        default:
+          break;
+      }
+
+      if (!lhs.has_value() || !rhs.has_value())
+        return std::nullopt;
+
+      const u32 a = lhs.value();
+      const u32 b = rhs.value();
+      switch (inst.r.funct)
+      {
+        case InstructionFunct::sllv:
+          return b << (a & 0x1F);
+        case InstructionFunct::srlv:
+          return b >> (a & 0x1F);
+        case InstructionFunct::srav:
+          return static_cast<u32>(static_cast<s32>(b) >> (a & 0x1F));
+        case InstructionFunct::addu:
+          return a + b;
+        case InstructionFunct::subu:
+          return a - b;
+        case InstructionFunct::and_:
+          return a & b;
+        case InstructionFunct::or_:
+          return a | b;
+        case InstructionFunct::xor_:
+          return a ^ b;
+        case InstructionFunct::nor:
+          return ~(a | b);
+        case InstructionFunct::slt:
+          return BoolToUInt32(static_cast<s32>(a) < static_cast<s32>(b));
+        case InstructionFunct::sltu:
+          return BoolToUInt32(a < b);
+        default:
+          return std::nullopt;
+      }
+    }
+
+    default:
+      return std::nullopt;
+  }
+}
+
+void CodeGenerator::AnalyzeBlock()
+{
+  const std::vector<CodeBlockInstruction>& instructions = m_block->instructions;
+  m_eliminated_instructions.assign(instructions.size(), EliminatedInstruction::None);
+  m_num_eliminated_instructions = 0;
+
+  // PGXP tracks precision per register, so it has to see every write.
+  if (g_settings.UsingPGXPCPUMode())
+    return;
+
+  // Backwards liveness pass. Everything is live when the block exits, or when an instruction could raise an
+  // exception. Writes which happen in load delay slots, or are delayed themselves, don't hide earlier writes, since
+  // the interleaving depends on the pipeline state.
+  u64 live = ALL_REGISTERS_MASK;
+  for (size_t i = instructions.size(); i > 0; i--)
+  {
+    const CodeBlockInstruction& cbi = instructions[i - 1];
+    if (IsNopInstruction(cbi.instruction))
+      continue;
+
+    u64 reads, writes;
+    const InstructionDataflow dataflow = GetInstructionDataflow(cbi, &reads, &writes);
+    if (dataflow == InstructionDataflow::Barrier)
+    {
+      live = ALL_REGISTERS_MASK;
+      continue;
+    }
+
+    if (dataflow == InstructionDataflow::Pure && writes != 0 && (writes & live) == 0 && !cbi.is_load_delay_slot)
+    {
+      m_eliminated_instructions[i - 1] = EliminatedInstruction::DeadStore;
+      continue;
+    }
+
+    const u64 kills = (cbi.has_load_delay || cbi.is_load_delay_slot) ? 0 : writes;
+    live = (live & ~kills) | reads;
+  }
+
+  // Forwards constant propagation pass, skipping the dead stores, to find registers which are set to the value they
+  // already hold, usually the upper half of an address.
+  KnownRegisters known_regs;
+  known_regs[static_cast<u8>(Reg::zero)] = 0;
+  for (size_t i = 0; i < instructions.size(); i++)
+  {
+    const CodeBlockInstruction& cbi = instructions[i];
+    if (IsNopInstruction(cbi.instruction) || m_eliminated_instructions[i] != EliminatedInstruction::None)
+      continue;
+
+    u64 reads, writes;
+    const InstructionDataflow dataflow = GetInstructionDataflow(cbi, &reads, &writes);
+    if (dataflow == InstructionDataflow::Barrier)
+    {
+      // We don't know what it wrote.
+      known_regs.fill(std::nullopt);
+      known_regs[static_cast<u8>(Reg::zero)] = 0;
+      continue;
+    }
+
+    std::optional<u32> value;
+    if (dataflow == InstructionDataflow::Pure && (writes & (writes - 1)) == 0)
+      value = EvaluateConstantInstruction(cbi.instruction, known_regs);
+    else if (cbi.instruction.op == InstructionOp::jal)
+      value = cbi.pc + 8;
+
+    for (u8 reg = 0; reg < static_cast<u8>(Reg::count); reg++)
+    {
+      if (!(writes & (UINT64_C(1) << reg)))
+        continue;
+
+      if (value.has_value() && known_regs[reg] == value && dataflow == InstructionDataflow::Pure &&
+          !cbi.is_load_delay_slot)
+      {
+        m_eliminated_instructions[i] = EliminatedInstruction::RedundantConstant;
+      }
+
+      // Delayed loads land after the next instruction, unless it writes the same register.
+      known_regs[reg] = (cbi.has_load_delay || cbi.is_load_delay_slot) ? std::nullopt : value;
+    }
+  }
+
+  for (const EliminatedInstruction ei : m_eliminated_instructions)
+    m_num_eliminated_instructions += BoolToUInt32(ei != EliminatedInstruction::None);
+}
+
+CodeGenerator::EliminatedInstruction CodeGenerator::GetEliminatedInstruction(const CodeBlockInstruction& cbi) const
+{
+  return m_eliminated_instructions[static_cast<size_t>(&cbi - m_block_start)];
+}
+
+bool CodeGenerator::Compile_Eliminated(const CodeBlockInstruction& cbi)
+{
+  InstructionPrologue(cbi, 1);
+
+  // Redundant constants leave the register's value as-is, but dead stores mean it no longer matches the guest.
+  if (GetEliminatedInstruction(cbi) == EliminatedInstruction::DeadStore)
+  {
+    u64 reads, writes;
+    GetInstructionDataflow(cbi, &reads, &writes);
+    for (u8 reg = 0; reg < static_cast<u8>(Reg::count); reg++)
+    {
+      if (writes & (UINT64_C(1) << reg))
+        SpeculativeWriteReg(static_cast<Reg>(reg), std::nullopt);
+    }
+  }
+
+  InstructionEpilogue(cbi);
+  return true;
+}
+
 Value CodeGenerator::ConvertValueSize(const Value& value, RegSize size, bool sign_extend)
 {
   DebugAssert(value.size != size);
@@ -963,6 +1313,29 @@ void CodeGenerator::GenerateExceptionExit(const CodeBlockInstruction& cbi, Excep
 
 void CodeGenerator::BlockPrologue()
 {
+  if (m_block->superblock_countdown > 0)
+  {
+    // Once the block is hot, go back to the dispatcher before doing anything, and run the superblock instead.
+    Value countdown = m_register_cache.AllocateScratch(RegSize_32);
+    EmitLoadGlobal(countdown.GetHostRegister(), RegSize_32, &m_block->superblock_countdown);
+    EmitSub(countdown.GetHostRegister(), countdown.GetHostRegister(), Value::FromConstantU32(1), false);
+    EmitStoreGlobal(&m_block->superblock_countdown, countdown);
+
+    LabelType not_hot;
+    EmitConditionalBranch(Condition::NotZero, false, countdown.GetHostRegister(), RegSize_32, &not_hot);
+    countdown.ReleaseAndClear();
+
+    m_register_cache.PushState();
+    EmitBranch(GetCurrentFarCodePointer());
+    SwitchToFarCode();
+    EmitFunctionCall(nullptr, &CPU::Recompiler::Thunks::CompileSuperblock, Value::FromConstantPtr(m_block));
+    EmitEndBlock(true, true);
+    SwitchToNearCode();
+    m_register_cache.PopState();
+
+    EmitBindLabel(&not_hot);
+  }
+
   InitSpeculativeRegs();
 
   EmitStoreCPUStructField(offsetof(State, exception_raised), Value::FromConstantU8(0));
@@ -1612,7 +1985,14 @@ bool CodeGenerator::Compile_Store(const CodeBlockInstruction& cbi)
       const PhysicalMemoryAddress block_start = VirtualAddressToPhysical(m_block->GetPC());
       const PhysicalMemoryAddress block_end = VirtualAddressToPhysical(
         m_block->GetPC() + static_cast<u32>(m_block->instructions.size()) * sizeof(Instruction));
-      if (phys_addr >= block_start && phys_addr < block_end)
+      const bool in_block =
+        m_block->superblock ?
+          std::any_of(m_block->instructions.begin(), m_block->instructions.end(),
+                      [phys_addr](const CodeBlockInstruction& block_cbi) {
+                        return (VirtualAddressToPhysical(block_cbi.pc) == (phys_addr & ~3u));
+                      }) :
+          (phys_addr >= block_start && phys_addr < block_end);
+      if (in_block)
       {
         Log_WarningPrintf("Instruction %08X speculatively writes to %08X inside block %08X-%08X. Truncating block.",
                           cbi.pc, phys_addr, block_start, block_end);
@@ -2328,6 +2708,31 @@ bool CodeGenerator::Compile_Branch(const CodeBlockInstruction& cbi)
       m_register_cache.PopState();
     }
 
+    if (cbi.continues_superblock)
+    {
+      // The target was decoded after the delay slot, so keep going without leaving the block, and with the guest
+      // registers still in host registers. The new pc only has to be written when the superblock exits.
+      DebugAssert(condition == Condition::Always && branch_target.IsConstant());
+      Assert((m_current_instruction + 1) != m_block_end);
+      InstructionEpilogue(cbi);
+      m_current_instruction++;
+      if (!CompileInstruction(*m_current_instruction))
+        return false;
+
+      // unless the delay slot truncated the block
+      if ((m_current_instruction + 1) == m_block_end)
+      {
+        WriteNewPC(branch_target, true);
+      }
+      else
+      {
+        m_pc = static_cast<u32>(branch_target.constant_value);
+        m_pc_valid = true;
+      }
+
+      return true;
+    }
+
     if (can_link_block)
     {
       // if it's an in-block branch, compile the delay slot now
@@ -242,6 +242,20 @@ private:
   bool Compile_cop0(const CodeBlockInstruction& cbi);
   bool Compile_cop2(const CodeBlockInstruction& cbi);
 
+  //////////////////////////////////////////////////////////////////////////
+  // Dataflow Analysis
+  //////////////////////////////////////////////////////////////////////////
+  enum class EliminatedInstruction : u8
+  {
+    None,
+    DeadStore,        // The result is overwritten before anything can read it.
+    RedundantConstant // The register already holds the constant being written.
+  };
+
+  void AnalyzeBlock();
+  EliminatedInstruction GetEliminatedInstruction(const CodeBlockInstruction& cbi) const;
+  bool Compile_Eliminated(const CodeBlockInstruction& cbi);
+
   JitCodeBuffer* m_code_buffer;
   CodeBlock* m_block = nullptr;
   const CodeBlockInstruction* m_block_start = nullptr;
@@ -270,6 +284,9 @@ private:
   bool m_fastmem_load_base_in_register = false;
   bool m_fastmem_store_base_in_register = false;
 
+  std::vector<EliminatedInstruction> m_eliminated_instructions;
+  u32 m_num_eliminated_instructions = 0;
+
   //////////////////////////////////////////////////////////////////////////
   // Speculative Constants
   //////////////////////////////////////////////////////////////////////////
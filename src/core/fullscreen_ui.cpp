@@ -2967,6 +2967,13 @@ void FullscreenUI::DrawConsoleSettingsPage()
     bsi, FSUI_CSTR("Readahead Sectors"),
     FSUI_CSTR("Reduces hitches in emulation by reading/decompressing CD data asynchronously on a worker thread."),
     "CDROM", "ReadaheadSectors", Settings::DEFAULT_CDROM_READAHEAD_SECTORS, 0, 32, "%d sectors");
+  DrawIntRangeSetting(bsi, FSUI_CSTR("CHD Hunk Cache Size"),
+                      FSUI_CSTR("Number of decompressed blocks of CHD images to keep in memory."), "CDROM",
+                      "CHDCacheHunks", Settings::DEFAULT_CDROM_CHD_CACHE_HUNKS, 1, 256, "%d hunks");
+  DrawIntRangeSetting(
+    bsi, FSUI_CSTR("CHD Read-Ahead Hunks"),
+    FSUI_CSTR("Number of blocks of CHD images to decompress ahead of the current read position on a worker thread."),
+    "CDROM", "CHDReadaheadHunks", Settings::DEFAULT_CDROM_CHD_READAHEAD_HUNKS, 0, 32, "%d hunks");
 
   DrawToggleSetting(bsi, FSUI_CSTR("Enable Region Check"),
                     FSUI_CSTR("Simulates the region check present in original, unmodified consoles."), "CDROM",
@@ -3051,7 +3058,7 @@ void FullscreenUI::DrawEmulationSettingsPage()
   DrawIntRangeSetting(
     bsi, FSUI_CSTR("Rewind Save Slots"),
     FSUI_CSTR("How many saves will be kept for rewinding. Higher values have greater memory requirements."), "Main",
-    "RewindSaveSlots", 10, 1, 10000, "%d Frames");
+    "RewindSaveSlots", 30, 1, 100000, "%d Frames");
 
   const s32 runahead_frames = GetEffectiveIntSetting(bsi, "Main", "RunaheadFrameCount", 0);
   const bool runahead_enabled = (runahead_frames > 0);
@@ -3077,7 +3084,7 @@ void FullscreenUI::DrawEmulationSettingsPage()
   else if (rewind_enabled)
   {
     const float rewind_frequency = GetEffectiveFloatSetting(bsi, "Main", "RewindFrequency", 10.0f);
-    const s32 rewind_save_slots = GetEffectiveIntSetting(bsi, "Main", "RewindSaveSlots", 10);
+    const s32 rewind_save_slots = GetEffectiveIntSetting(bsi, "Main", "RewindSaveSlots", 30);
     const float duration =
       ((rewind_frequency <= std::numeric_limits<float>::epsilon()) ? (1.0f / 60.0f) : rewind_frequency) *
       static_cast<float>(rewind_save_slots);
@@ -3850,6 +3857,9 @@ void FullscreenUI::DrawDisplaySettingsPage()
       DrawToggleSetting(bsi, FSUI_CSTR("Threaded Rendering"),
                         FSUI_CSTR("Uses a second thread for drawing graphics. Speed boost, and safe to use."), "GPU",
                         "UseThread", true);
+      DrawIntRangeSetting(bsi, FSUI_CSTR("Rendering Worker Threads"),
+                          FSUI_CSTR("Splits drawing across additional threads in horizontal bands. 0 disables."), "GPU",
+                          "SoftwareRendererThreads", 0, 0, 15, "%d");
     }
     break;
 
@@ -4699,6 +4709,12 @@ void FullscreenUI::DrawAdvancedSettingsPage()
     bsi, FSUI_CSTR("Enable Recompiler Block Linking"),
     FSUI_CSTR("Performance enhancement - jumps directly between blocks instead of returning to the dispatcher."), "CPU",
     "RecompilerBlockLinking", true);
+  DrawToggleSetting(bsi, FSUI_CSTR("Enable Persistent Block Cache"),
+                    FSUI_CSTR("Saves compiled blocks on shutdown, and precompiles them on the next boot of the game."),
+                    "CPU", "RecompilerBlockCache", false);
+  DrawToggleSetting(bsi, FSUI_CSTR("Enable Recompiler Superblocks"),
+                    FSUI_CSTR("Recompiles frequently executed blocks together with the code they jump to."), "CPU",
+                    "RecompilerSuperblocks", false);
   DrawEnumSetting(bsi, FSUI_CSTR("Recompiler Fast Memory Access"),
                   FSUI_CSTR("Avoids calls to C++ code, significantly speeding up the recompiler."), "CPU",
                   "FastmemMode", Settings::DEFAULT_CPU_FASTMEM_MODE, &Settings::ParseCPUFastmemMode,
@@ -6914,6 +6930,8 @@ TRANSLATE_NOOP("FullscreenUI", "Behavior");
 TRANSLATE_NOOP("FullscreenUI", "Borderless Fullscreen");
 TRANSLATE_NOOP("FullscreenUI", "Buffer Size");
 TRANSLATE_NOOP("FullscreenUI", "CD-ROM Emulation");
+TRANSLATE_NOOP("FullscreenUI", "CHD Hunk Cache Size");
+TRANSLATE_NOOP("FullscreenUI", "CHD Read-Ahead Hunks");
 TRANSLATE_NOOP("FullscreenUI", "CPU Emulation");
 TRANSLATE_NOOP("FullscreenUI", "CPU Mode");
 TRANSLATE_NOOP("FullscreenUI", "Cancel");
@@ -7014,9 +7032,11 @@ TRANSLATE_NOOP("FullscreenUI", "Enable Fast Boot");
 TRANSLATE_NOOP("FullscreenUI", "Enable In-Game Overlays");
 TRANSLATE_NOOP("FullscreenUI", "Enable Overclocking");
 TRANSLATE_NOOP("FullscreenUI", "Enable PGXP Vertex Cache");
+TRANSLATE_NOOP("FullscreenUI", "Enable Persistent Block Cache");
 TRANSLATE_NOOP("FullscreenUI", "Enable Post Processing");
 TRANSLATE_NOOP("FullscreenUI", "Enable Recompiler Block Linking");
 TRANSLATE_NOOP("FullscreenUI", "Enable Recompiler ICache");
+TRANSLATE_NOOP("FullscreenUI", "Enable Recompiler Superblocks");
 TRANSLATE_NOOP("FullscreenUI", "Enable Recompiler Memory Exceptions");
 TRANSLATE_NOOP("FullscreenUI", "Enable Region Check");
 TRANSLATE_NOOP("FullscreenUI", "Enable Rewinding");
@@ -7168,6 +7188,8 @@ TRANSLATE_NOOP("FullscreenUI", "None (Double Speed)");
 TRANSLATE_NOOP("FullscreenUI", "None (Normal Speed)");
 TRANSLATE_NOOP("FullscreenUI", "Not Logged In");
 TRANSLATE_NOOP("FullscreenUI", "Not Scanning Subdirectories");
+TRANSLATE_NOOP("FullscreenUI", "Number of blocks of CHD images to decompress ahead of the current read position on a worker thread.");
+TRANSLATE_NOOP("FullscreenUI", "Number of decompressed blocks of CHD images to keep in memory.");
 TRANSLATE_NOOP("FullscreenUI", "OK");
 TRANSLATE_NOOP("FullscreenUI", "OSD Scale");
 TRANSLATE_NOOP("FullscreenUI", "On-Screen Display");
@@ -7217,6 +7239,7 @@ TRANSLATE_NOOP("FullscreenUI", "RAIntegration is being used instead of the built
 TRANSLATE_NOOP("FullscreenUI", "Read Speedup");
 TRANSLATE_NOOP("FullscreenUI", "Readahead Sectors");
 TRANSLATE_NOOP("FullscreenUI", "Recompiler Fast Memory Access");
+TRANSLATE_NOOP("FullscreenUI", "Recompiles frequently executed blocks together with the code they jump to.");
 TRANSLATE_NOOP("FullscreenUI", "Reduces \"wobbly\" polygons by attempting to preserve the fractional component through memory transfers.");
 TRANSLATE_NOOP("FullscreenUI", "Reduces hitches in emulation by reading/decompressing CD data asynchronously on a worker thread.");
 TRANSLATE_NOOP("FullscreenUI", "Reduces polygon Z-fighting through depth testing. Low compatibility with games.");
@@ -7231,6 +7254,7 @@ TRANSLATE_NOOP("FullscreenUI", "Removed stage {} ({}).");
 TRANSLATE_NOOP("FullscreenUI", "Removes this shader from the chain.");
 TRANSLATE_NOOP("FullscreenUI", "Renames existing save states when saving to a backup file.");
 TRANSLATE_NOOP("FullscreenUI", "Rendering");
+TRANSLATE_NOOP("FullscreenUI", "Rendering Worker Threads");
 TRANSLATE_NOOP("FullscreenUI", "Replaces these settings with a previously saved input profile.");
 TRANSLATE_NOOP("FullscreenUI", "Rescan All Games");
 TRANSLATE_NOOP("FullscreenUI", "Reset Memory Card Directory");
@@ -7256,6 +7280,7 @@ TRANSLATE_NOOP("FullscreenUI", "Save Screenshot");
 TRANSLATE_NOOP("FullscreenUI", "Save State");
 TRANSLATE_NOOP("FullscreenUI", "Save State On Exit");
 TRANSLATE_NOOP("FullscreenUI", "Saved {:%c}");
+TRANSLATE_NOOP("FullscreenUI", "Saves compiled blocks on shutdown, and precompiles them on the next boot of the game.");
 TRANSLATE_NOOP("FullscreenUI", "Saves screenshots at internal render resolution and without postprocessing.");
 TRANSLATE_NOOP("FullscreenUI", "Saves state periodically so you can rewind any mistakes while playing.");
 TRANSLATE_NOOP("FullscreenUI", "Scaled Dithering");
@@ -7326,6 +7351,7 @@ TRANSLATE_NOOP("FullscreenUI", "Spectator Mode");
 TRANSLATE_NOOP("FullscreenUI", "Speed Control");
 TRANSLATE_NOOP("FullscreenUI", "Speeds up CD-ROM reads by the specified factor. May improve loading speeds in some games, and break others.");
 TRANSLATE_NOOP("FullscreenUI", "Speeds up CD-ROM seeks by the specified factor. May improve loading speeds in some games, and break others.");
+TRANSLATE_NOOP("FullscreenUI", "Splits drawing across additional threads in horizontal bands. 0 disables.");
 TRANSLATE_NOOP("FullscreenUI", "Stage {}: {}");
 TRANSLATE_NOOP("FullscreenUI", "Start BIOS");
 TRANSLATE_NOOP("FullscreenUI", "Start Download");
@@ -12,6 +12,7 @@
 #include "common/byte_stream.h"
 #include "common/heterogeneous_containers.h"
 #include "common/log.h"
+#include "common/memmap.h"
 #include "common/path.h"
 #include "common/string_util.h"
 #include "common/timer.h"
@@ -19,8 +20,12 @@
 #include "rapidjson/document.h"
 #include "rapidjson/error/en.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iomanip>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <sstream>
 
@@ -35,17 +40,101 @@ namespace GameDatabase {
 enum : u32
 {
   GAME_DATABASE_CACHE_SIGNATURE = 0x45434C48,
-  GAME_DATABASE_CACHE_VERSION = 5,
+  GAME_DATABASE_CACHE_VERSION = 6,
 };
 
-static Entry* GetMutableEntry(const std::string_view& serial);
+// The database is compiled from JSON into a flat image, which is written to the cache directory and mapped on later
+// runs. Nothing is deserialized up front; entries are only materialized when they're looked up.
+//   ImageHeader
+//   ImageEntry[num_entries], sorted by serial
+//   ImageCode[num_codes], sorted by code
+//   ImageString[num_disc_set_serials]
+//   string data, with duplicate strings shared
+struct ImageHeader
+{
+  u32 signature;
+  u32 version;
+  u64 gamedb_timestamp;
+  u32 num_entries;
+  u32 num_codes;
+  u32 num_disc_set_serials;
+  u32 entries_offset;
+  u32 codes_offset;
+  u32 disc_set_serials_offset;
+};
+static_assert(sizeof(ImageHeader) == 40);
+
+struct ImageString
+{
+  u32 offset;
+  u32 length;
+};
+
+enum : u32
+{
+  IMAGE_HAS_DISPLAY_ACTIVE_START_OFFSET = (1u << 0),
+  IMAGE_HAS_DISPLAY_ACTIVE_END_OFFSET = (1u << 1),
+  IMAGE_HAS_DISPLAY_LINE_START_OFFSET = (1u << 2),
+  IMAGE_HAS_DISPLAY_LINE_END_OFFSET = (1u << 3),
+  IMAGE_HAS_DMA_MAX_SLICE_TICKS = (1u << 4),
+  IMAGE_HAS_DMA_HALT_TICKS = (1u << 5),
+  IMAGE_HAS_GPU_FIFO_SIZE = (1u << 6),
+  IMAGE_HAS_GPU_MAX_RUN_AHEAD = (1u << 7),
+  IMAGE_HAS_GPU_PGXP_TOLERANCE = (1u << 8),
+  IMAGE_HAS_GPU_PGXP_DEPTH_THRESHOLD = (1u << 9),
+};
 
-static bool LoadFromCache();
-static bool SaveToCache();
+struct ImageEntry
+{
+  ImageString serial;
+  ImageString title;
+  ImageString genre;
+  ImageString developer;
+  ImageString publisher;
+  ImageString disc_set_name;
+  u64 release_date;
+  u32 traits;
+  u32 optional_mask;
+  u32 dma_max_slice_ticks;
+  u32 dma_halt_ticks;
+  u32 gpu_fifo_size;
+  u32 gpu_max_run_ahead;
+  float gpu_pgxp_tolerance;
+  float gpu_pgxp_depth_threshold;
+  u32 first_disc_set_serial;
+  u32 num_disc_set_serials;
+  s16 display_active_start_offset;
+  s16 display_active_end_offset;
+  s8 display_line_start_offset;
+  s8 display_line_end_offset;
+  u8 min_players;
+  u8 max_players;
+  u8 min_blocks;
+  u8 max_blocks;
+  u16 supported_controllers;
+  u8 compatibility;
+  u8 padding[3];
+};
+static_assert(sizeof(ImageEntry) == 112);
+static_assert(static_cast<u32>(Trait::Count) <= 32, "Traits fit in image bitset");
 
-static bool LoadGameDBJson();
+struct ImageCode
+{
+  ImageString code;
+  u32 entry_index;
+};
+static_assert(sizeof(ImageCode) == 12);
+
+static std::string GetImageFile();
+static bool OpenImage();
+static bool BuildImage(u64 gamedb_ts);
+static bool SetImage(const u8* data, size_t size);
+static std::string_view GetImageString(const ImageString& str);
+static const Entry* GetImageEntry(u32 index);
+
+static bool LoadGameDBJson(std::vector<Entry>* entries, PreferUnorderedStringMap<u32>* code_lookup);
 static bool ParseJsonEntry(Entry* entry, const rapidjson::Value& value);
-static bool ParseJsonCodes(u32 index, const rapidjson::Value& value);
+static bool ParseJsonCodes(u32 index, const rapidjson::Value& value, PreferUnorderedStringMap<u32>* code_lookup);
 static bool LoadTrackHashes();
 
 std::array<const char*, static_cast<u32>(GameDatabase::Trait::Count)> s_trait_names = {{
@@ -74,8 +163,17 @@ std::array<const char*, static_cast<u32>(GameDatabase::Trait::Count)> s_trait_na
 static bool s_loaded = false;
 static bool s_track_hashes_loaded = false;
 
-static std::vector<GameDatabase::Entry> s_entries;
-static PreferUnorderedStringMap<u32> s_code_lookup;
+static MappedFile s_image_file;
+static std::vector<u8> s_image_buffer;
+static const u8* s_image_data = nullptr;
+static u32 s_image_size = 0;
+static const ImageHeader* s_image_header = nullptr;
+static const ImageEntry* s_image_entries = nullptr;
+static const ImageCode* s_image_codes = nullptr;
+static const ImageString* s_image_disc_set_serials = nullptr;
+
+static std::vector<std::unique_ptr<Entry>> s_materialized_entries;
+static std::mutex s_materialized_entries_mutex;
 
 static TrackHashesMap s_track_hashes_map;
 } // namespace GameDatabase
@@ -89,22 +187,23 @@ void GameDatabase::EnsureLoaded()
 
   s_loaded = true;
 
-  if (!LoadFromCache())
-  {
-    s_entries = {};
-    s_code_lookup = {};
-
-    LoadGameDBJson();
-    SaveToCache();
-  }
+  if (!OpenImage())
+    BuildImage(Host::GetResourceFileTimestamp("gamedb.json").value_or(0));
 
   Log_InfoPrintf("Database load took %.2f ms", timer.GetTimeMilliseconds());
 }
 
 void GameDatabase::Unload()
 {
-  s_entries = {};
-  s_code_lookup = {};
+  s_materialized_entries.clear();
+  s_image_data = nullptr;
+  s_image_size = 0;
+  s_image_header = nullptr;
+  s_image_entries = nullptr;
+  s_image_codes = nullptr;
+  s_image_disc_set_serials = nullptr;
+  s_image_buffer = {};
+  s_image_file.Close();
   s_loaded = false;
 }
 
@@ -114,9 +213,17 @@ const GameDatabase::Entry* GameDatabase::GetEntryForId(const std::string_view& c
     return nullptr;
 
   EnsureLoaded();
+  if (!s_image_header)
+    return nullptr;
 
-  auto iter = s_code_lookup.find(code);
-  return (iter != s_code_lookup.end()) ? &s_entries[iter->second] : nullptr;
+  const ImageCode* begin = s_image_codes;
+  const ImageCode* end = s_image_codes + s_image_header->num_codes;
+  const ImageCode* iter = std::lower_bound(
+    begin, end, code, [](const ImageCode& lhs, const std::string_view& rhs) { return GetImageString(lhs.code) < rhs; });
+  if (iter == end || GetImageString(iter->code) != code || iter->entry_index >= s_image_header->num_entries)
+    return nullptr;
+
+  return GetImageEntry(iter->entry_index);
 }
 
 std::string GameDatabase::GetSerialForDisc(CDImage* image)
@@ -162,19 +269,19 @@ const GameDatabase::Entry* GameDatabase::GetEntryForDisc(CDImage* image)
 const GameDatabase::Entry* GameDatabase::GetEntryForSerial(const std::string_view& serial)
 {
   EnsureLoaded();
+  if (!s_image_header)
+    return nullptr;
 
-  return GetMutableEntry(serial);
-}
-
-GameDatabase::Entry* GameDatabase::GetMutableEntry(const std::string_view& serial)
-{
-  for (Entry& entry : s_entries)
-  {
-    if (entry.serial == serial)
-      return &entry;
-  }
+  const ImageEntry* begin = s_image_entries;
+  const ImageEntry* end = s_image_entries + s_image_header->num_entries;
+  const ImageEntry* iter =
+    std::lower_bound(begin, end, serial, [](const ImageEntry& lhs, const std::string_view& rhs) {
+      return GetImageString(lhs.serial) < rhs;
+    });
+  if (iter == end || GetImageString(iter->serial) != serial)
+    return nullptr;
 
-  return nullptr;
+  return GetImageEntry(static_cast<u32>(iter - begin));
 }
 
 const char* GameDatabase::GetTraitName(Trait trait)
@@ -483,212 +590,267 @@ void GameDatabase::Entry::ApplySettings(Settings& settings, bool display_osd_mes
 #undef BIT_FOR
 }
 
-template<typename T>
-bool ReadOptionalFromStream(ByteStream* stream, std::optional<T>* dest)
-{
-  bool has_value;
-  if (!stream->Read2(&has_value, sizeof(has_value)))
-    return false;
-
-  if (!has_value)
-    return true;
-
-  T value;
-  if (!stream->Read2(&value, sizeof(T)))
-    return false;
-
-  *dest = value;
-  return true;
-}
-
-template<typename T>
-bool WriteOptionalToStream(ByteStream* stream, const std::optional<T>& src)
-{
-  const bool has_value = src.has_value();
-  if (!stream->Write2(&has_value, sizeof(has_value)))
-    return false;
-
-  if (!has_value)
-    return true;
-
-  return stream->Write2(&src.value(), sizeof(T));
-}
+//////////////////////////////////////////////////////////////////////////
+// Binary Image
+//////////////////////////////////////////////////////////////////////////
 
-static std::string GetCacheFile()
+std::string GameDatabase::GetImageFile()
 {
   return Path::Combine(EmuFolders::Cache, "gamedb.cache");
 }
 
-bool GameDatabase::LoadFromCache()
+bool GameDatabase::OpenImage()
 {
-  std::unique_ptr<ByteStream> stream(
-    ByteStream::OpenFile(GetCacheFile().c_str(), BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED));
-  if (!stream)
+  const std::string filename(GetImageFile());
+  if (!s_image_file.Open(filename.c_str(), nullptr))
   {
     Log_DevPrintf("Cache does not exist, loading full database.");
     return false;
   }
 
-  const u64 gamedb_ts = Host::GetResourceFileTimestamp("gamedb.json").value_or(0);
-
-  u32 signature, version, num_entries, num_codes;
-  u64 file_gamedb_ts;
-  if (!stream->ReadU32(&signature) || !stream->ReadU32(&version) || !stream->ReadU64(&file_gamedb_ts) ||
-      !stream->ReadU32(&num_entries) || !stream->ReadU32(&num_codes) || signature != GAME_DATABASE_CACHE_SIGNATURE ||
-      version != GAME_DATABASE_CACHE_VERSION)
+  if (!SetImage(s_image_file.GetData(), s_image_file.GetSize()))
   {
     Log_DevPrintf("Cache header is corrupted or version mismatch.");
+    s_image_file.Close();
     return false;
   }
 
-  if (gamedb_ts != file_gamedb_ts)
+  const u64 gamedb_ts = Host::GetResourceFileTimestamp("gamedb.json").value_or(0);
+  if (s_image_header->gamedb_timestamp != gamedb_ts)
   {
     Log_DevPrintf("Cache is out of date, recreating.");
+    s_image_header = nullptr;
+    s_image_file.Close();
     return false;
   }
 
-  s_entries.reserve(num_entries);
+  return true;
+}
 
-  for (u32 i = 0; i < num_entries; i++)
+bool GameDatabase::SetImage(const u8* data, size_t size)
+{
+  if (size < sizeof(ImageHeader) || size > std::numeric_limits<u32>::max() ||
+      (reinterpret_cast<uintptr_t>(data) % alignof(ImageHeader)) != 0)
   {
-    Entry& entry = s_entries.emplace_back();
-
-    constexpr u32 num_bytes = (static_cast<u32>(Trait::Count) + 7) / 8;
-    std::array<u8, num_bytes> bits;
-    u8 compatibility;
-    u32 num_disc_set_serials;
-
-    if (!stream->ReadSizePrefixedString(&entry.serial) || !stream->ReadSizePrefixedString(&entry.title) ||
-        !stream->ReadSizePrefixedString(&entry.genre) || !stream->ReadSizePrefixedString(&entry.developer) ||
-        !stream->ReadSizePrefixedString(&entry.publisher) || !stream->ReadU64(&entry.release_date) ||
-        !stream->ReadU8(&entry.min_players) || !stream->ReadU8(&entry.max_players) ||
-        !stream->ReadU8(&entry.min_blocks) || !stream->ReadU8(&entry.max_blocks) ||
-        !stream->ReadU16(&entry.supported_controllers) || !stream->ReadU8(&compatibility) ||
-        compatibility >= static_cast<u8>(GameDatabase::CompatibilityRating::Count) ||
-        !stream->Read2(bits.data(), num_bytes) ||
-        !ReadOptionalFromStream(stream.get(), &entry.display_active_start_offset) ||
-        !ReadOptionalFromStream(stream.get(), &entry.display_active_end_offset) ||
-        !ReadOptionalFromStream(stream.get(), &entry.display_line_start_offset) ||
-        !ReadOptionalFromStream(stream.get(), &entry.display_line_end_offset) ||
-        !ReadOptionalFromStream(stream.get(), &entry.dma_max_slice_ticks) ||
-        !ReadOptionalFromStream(stream.get(), &entry.dma_halt_ticks) ||
-        !ReadOptionalFromStream(stream.get(), &entry.gpu_fifo_size) ||
-        !ReadOptionalFromStream(stream.get(), &entry.gpu_max_run_ahead) ||
-        !ReadOptionalFromStream(stream.get(), &entry.gpu_pgxp_tolerance) ||
-        !ReadOptionalFromStream(stream.get(), &entry.gpu_pgxp_depth_threshold) ||
-        !stream->ReadSizePrefixedString(&entry.disc_set_name) || !stream->ReadU32(&num_disc_set_serials))
-    {
-      Log_DevPrintf("Cache entry is corrupted.");
-      return false;
-    }
-
-    if (num_disc_set_serials > 0)
-    {
-      entry.disc_set_serials.reserve(num_disc_set_serials);
-      for (u32 j = 0; j < num_disc_set_serials; j++)
-      {
-        if (!stream->ReadSizePrefixedString(&entry.disc_set_serials.emplace_back()))
-        {
-          Log_DevPrintf("Cache entry is corrupted.");
-          return false;
-        }
-      }
-    }
-
-    entry.compatibility = static_cast<GameDatabase::CompatibilityRating>(compatibility);
-    entry.traits.reset();
-    for (u32 j = 0; j < static_cast<int>(Trait::Count); j++)
-    {
-      if ((bits[j / 8] & (1u << (j % 8))) != 0)
-        entry.traits[j] = true;
-    }
+    return false;
   }
 
-  for (u32 i = 0; i < num_codes; i++)
+  const ImageHeader* header = reinterpret_cast<const ImageHeader*>(data);
+  const auto check_array = [size](u32 offset, u32 count, size_t element_size, size_t alignment) {
+    return (offset <= size && (offset % alignment) == 0 &&
+            (static_cast<u64>(count) * element_size) <= (size - offset));
+  };
+  if (header->signature != GAME_DATABASE_CACHE_SIGNATURE || header->version != GAME_DATABASE_CACHE_VERSION ||
+      !check_array(header->entries_offset, header->num_entries, sizeof(ImageEntry), alignof(ImageEntry)) ||
+      !check_array(header->codes_offset, header->num_codes, sizeof(ImageCode), alignof(ImageCode)) ||
+      !check_array(header->disc_set_serials_offset, header->num_disc_set_serials, sizeof(ImageString),
+                   alignof(ImageString)))
   {
-    std::string code;
-    u32 index;
-    if (!stream->ReadSizePrefixedString(&code) || !stream->ReadU32(&index) ||
-        index >= static_cast<u32>(s_entries.size()))
-    {
-      Log_DevPrintf("Cache code entry is corrupted.");
-      return false;
-    }
-
-    s_code_lookup.emplace(std::move(code), index);
+    return false;
   }
 
+  s_image_data = data;
+  s_image_size = static_cast<u32>(size);
+  s_image_header = header;
+  s_image_entries = reinterpret_cast<const ImageEntry*>(data + header->entries_offset);
+  s_image_codes = reinterpret_cast<const ImageCode*>(data + header->codes_offset);
+  s_image_disc_set_serials = reinterpret_cast<const ImageString*>(data + header->disc_set_serials_offset);
+  s_materialized_entries.clear();
+  s_materialized_entries.resize(header->num_entries);
   return true;
 }
 
-bool GameDatabase::SaveToCache()
+std::string_view GameDatabase::GetImageString(const ImageString& str)
 {
-  const u64 gamedb_ts = Host::GetResourceFileTimestamp("gamedb.json").value_or(0);
+  // bad references read as empty strings, rather than failing the whole lookup
+  if (str.offset > s_image_size || str.length > (s_image_size - str.offset))
+    return {};
 
-  std::unique_ptr<ByteStream> stream(
-    ByteStream::OpenFile(GetCacheFile().c_str(), BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_WRITE |
-                                                   BYTESTREAM_OPEN_TRUNCATE | BYTESTREAM_OPEN_STREAMED));
-  if (!stream)
-    return false;
+  return std::string_view(reinterpret_cast<const char*>(s_image_data + str.offset), str.length);
+}
+
+const GameDatabase::Entry* GameDatabase::GetImageEntry(u32 index)
+{
+  std::unique_lock lock(s_materialized_entries_mutex);
+  std::unique_ptr<Entry>& entry_ptr = s_materialized_entries[index];
+  if (entry_ptr)
+    return entry_ptr.get();
+
+  const ImageEntry& ie = s_image_entries[index];
+  entry_ptr = std::make_unique<Entry>();
+  Entry* entry = entry_ptr.get();
+  entry->serial = GetImageString(ie.serial);
+  entry->title = GetImageString(ie.title);
+  entry->genre = GetImageString(ie.genre);
+  entry->developer = GetImageString(ie.developer);
+  entry->publisher = GetImageString(ie.publisher);
+  entry->release_date = ie.release_date;
+  entry->min_players = ie.min_players;
+  entry->max_players = ie.max_players;
+  entry->min_blocks = ie.min_blocks;
+  entry->max_blocks = ie.max_blocks;
+  entry->supported_controllers = ie.supported_controllers;
+  entry->compatibility = (ie.compatibility < static_cast<u8>(CompatibilityRating::Count)) ?
+                           static_cast<CompatibilityRating>(ie.compatibility) :
+                           CompatibilityRating::Unknown;
+  for (u32 i = 0; i < static_cast<u32>(Trait::Count); i++)
+    entry->traits[i] = ((ie.traits & (1u << i)) != 0);
+
+  const auto get_optional = [&ie](u32 bit, auto value) {
+    return (ie.optional_mask & bit) ? std::optional<decltype(value)>(value) : std::nullopt;
+  };
+  entry->display_active_start_offset =
+    get_optional(IMAGE_HAS_DISPLAY_ACTIVE_START_OFFSET, ie.display_active_start_offset);
+  entry->display_active_end_offset = get_optional(IMAGE_HAS_DISPLAY_ACTIVE_END_OFFSET, ie.display_active_end_offset);
+  entry->display_line_start_offset = get_optional(IMAGE_HAS_DISPLAY_LINE_START_OFFSET, ie.display_line_start_offset);
+  entry->display_line_end_offset = get_optional(IMAGE_HAS_DISPLAY_LINE_END_OFFSET, ie.display_line_end_offset);
+  entry->dma_max_slice_ticks = get_optional(IMAGE_HAS_DMA_MAX_SLICE_TICKS, ie.dma_max_slice_ticks);
+  entry->dma_halt_ticks = get_optional(IMAGE_HAS_DMA_HALT_TICKS, ie.dma_halt_ticks);
+  entry->gpu_fifo_size = get_optional(IMAGE_HAS_GPU_FIFO_SIZE, ie.gpu_fifo_size);
+  entry->gpu_max_run_ahead = get_optional(IMAGE_HAS_GPU_MAX_RUN_AHEAD, ie.gpu_max_run_ahead);
+  entry->gpu_pgxp_tolerance = get_optional(IMAGE_HAS_GPU_PGXP_TOLERANCE, ie.gpu_pgxp_tolerance);
+  entry->gpu_pgxp_depth_threshold = get_optional(IMAGE_HAS_GPU_PGXP_DEPTH_THRESHOLD, ie.gpu_pgxp_depth_threshold);
+
+  entry->disc_set_name = GetImageString(ie.disc_set_name);
+  if (ie.first_disc_set_serial <= s_image_header->num_disc_set_serials &&
+      ie.num_disc_set_serials <= (s_image_header->num_disc_set_serials - ie.first_disc_set_serial))
+  {
+    entry->disc_set_serials.reserve(ie.num_disc_set_serials);
+    for (u32 i = 0; i < ie.num_disc_set_serials; i++)
+      entry->disc_set_serials.emplace_back(GetImageString(s_image_disc_set_serials[ie.first_disc_set_serial + i]));
+  }
 
-  bool result = stream->WriteU32(GAME_DATABASE_CACHE_SIGNATURE);
-  result = result && stream->WriteU32(GAME_DATABASE_CACHE_VERSION);
-  result = result && stream->WriteU64(static_cast<u64>(gamedb_ts));
+  return entry;
+}
 
-  result = result && stream->WriteU32(static_cast<u32>(s_entries.size()));
-  result = result && stream->WriteU32(static_cast<u32>(s_code_lookup.size()));
+bool GameDatabase::BuildImage(u64 gamedb_ts)
+{
+  std::vector<Entry> entries;
+  PreferUnorderedStringMap<u32> code_lookup;
+  if (!LoadGameDBJson(&entries, &code_lookup))
+    return false;
 
-  for (const Entry& entry : s_entries)
+  // sort by serial for binary searching, and remap the code indices to match
+  std::vector<u32> entry_order(entries.size());
+  for (u32 i = 0; i < static_cast<u32>(entries.size()); i++)
+    entry_order[i] = i;
+  std::stable_sort(entry_order.begin(), entry_order.end(),
+                   [&entries](u32 lhs, u32 rhs) { return (entries[lhs].serial < entries[rhs].serial); });
+
+  std::vector<u32> entry_remap(entries.size());
+  for (u32 i = 0; i < static_cast<u32>(entry_order.size()); i++)
+    entry_remap[entry_order[i]] = i;
+
+  std::vector<std::pair<std::string_view, u32>> codes;
+  codes.reserve(code_lookup.size());
+  for (const auto& [code, index] : code_lookup)
+    codes.emplace_back(code, entry_remap[index]);
+  std::sort(codes.begin(), codes.end());
+
+  u32 num_disc_set_serials = 0;
+  for (const Entry& entry : entries)
+    num_disc_set_serials += static_cast<u32>(entry.disc_set_serials.size());
+
+  const u32 entries_offset = sizeof(ImageHeader);
+  const u32 codes_offset = entries_offset + static_cast<u32>(entries.size() * sizeof(ImageEntry));
+  const u32 disc_set_serials_offset = codes_offset + static_cast<u32>(codes.size() * sizeof(ImageCode));
+  const u32 strings_offset = disc_set_serials_offset + num_disc_set_serials * static_cast<u32>(sizeof(ImageString));
+
+  std::vector<u8> image(strings_offset);
+  PreferUnorderedStringMap<ImageString> interned_strings;
+  const auto add_string = [&image, &interned_strings](const std::string_view& str) {
+    auto iter = interned_strings.find(str);
+    if (iter != interned_strings.end())
+      return iter->second;
+
+    const ImageString ret = {static_cast<u32>(image.size()), static_cast<u32>(str.length())};
+    image.insert(image.end(), str.begin(), str.end());
+    interned_strings.emplace(str, ret);
+    return ret;
+  };
+
+  u32 next_disc_set_serial = 0;
+  for (u32 i = 0; i < static_cast<u32>(entries.size()); i++)
   {
-    result = result && stream->WriteSizePrefixedString(entry.serial);
-    result = result && stream->WriteSizePrefixedString(entry.title);
-    result = result && stream->WriteSizePrefixedString(entry.genre);
-    result = result && stream->WriteSizePrefixedString(entry.developer);
-    result = result && stream->WriteSizePrefixedString(entry.publisher);
-    result = result && stream->WriteU64(entry.release_date);
-    result = result && stream->WriteU8(entry.min_players);
-    result = result && stream->WriteU8(entry.max_players);
-    result = result && stream->WriteU8(entry.min_blocks);
-    result = result && stream->WriteU8(entry.max_blocks);
-    result = result && stream->WriteU16(entry.supported_controllers);
-    result = result && stream->WriteU8(static_cast<u8>(entry.compatibility));
-
-    constexpr u32 num_bytes = (static_cast<u32>(Trait::Count) + 7) / 8;
-    std::array<u8, num_bytes> bits;
-    bits.fill(0);
-    for (u32 j = 0; j < static_cast<int>(Trait::Count); j++)
+    const Entry& entry = entries[entry_order[i]];
+    ImageEntry ie = {};
+    ie.serial = add_string(entry.serial);
+    ie.title = add_string(entry.title);
+    ie.genre = add_string(entry.genre);
+    ie.developer = add_string(entry.developer);
+    ie.publisher = add_string(entry.publisher);
+    ie.disc_set_name = add_string(entry.disc_set_name);
+    ie.release_date = entry.release_date;
+    ie.traits = static_cast<u32>(entry.traits.to_ulong());
+    ie.min_players = entry.min_players;
+    ie.max_players = entry.max_players;
+    ie.min_blocks = entry.min_blocks;
+    ie.max_blocks = entry.max_blocks;
+    ie.supported_controllers = entry.supported_controllers;
+    ie.compatibility = static_cast<u8>(entry.compatibility);
+
+    const auto set_optional = [&ie](u32 bit, auto* dest, const auto& value) {
+      if (value.has_value())
+      {
+        ie.optional_mask |= bit;
+        *dest = value.value();
+      }
+    };
+    set_optional(IMAGE_HAS_DISPLAY_ACTIVE_START_OFFSET, &ie.display_active_start_offset,
+                 entry.display_active_start_offset);
+    set_optional(IMAGE_HAS_DISPLAY_ACTIVE_END_OFFSET, &ie.display_active_end_offset, entry.display_active_end_offset);
+    set_optional(IMAGE_HAS_DISPLAY_LINE_START_OFFSET, &ie.display_line_start_offset, entry.display_line_start_offset);
+    set_optional(IMAGE_HAS_DISPLAY_LINE_END_OFFSET, &ie.display_line_end_offset, entry.display_line_end_offset);
+    set_optional(IMAGE_HAS_DMA_MAX_SLICE_TICKS, &ie.dma_max_slice_ticks, entry.dma_max_slice_ticks);
+    set_optional(IMAGE_HAS_DMA_HALT_TICKS, &ie.dma_halt_ticks, entry.dma_halt_ticks);
+    set_optional(IMAGE_HAS_GPU_FIFO_SIZE, &ie.gpu_fifo_size, entry.gpu_fifo_size);
+    set_optional(IMAGE_HAS_GPU_MAX_RUN_AHEAD, &ie.gpu_max_run_ahead, entry.gpu_max_run_ahead);
+    set_optional(IMAGE_HAS_GPU_PGXP_TOLERANCE, &ie.gpu_pgxp_tolerance, entry.gpu_pgxp_tolerance);
+    set_optional(IMAGE_HAS_GPU_PGXP_DEPTH_THRESHOLD, &ie.gpu_pgxp_depth_threshold, entry.gpu_pgxp_depth_threshold);
+
+    ie.first_disc_set_serial = next_disc_set_serial;
+    ie.num_disc_set_serials = static_cast<u32>(entry.disc_set_serials.size());
+    for (const std::string& serial : entry.disc_set_serials)
     {
-      if (entry.traits[j])
-        bits[j / 8] |= (1u << (j % 8));
+      const ImageString str = add_string(serial);
+      std::memcpy(&image[disc_set_serials_offset + next_disc_set_serial * sizeof(ImageString)], &str, sizeof(str));
+      next_disc_set_serial++;
     }
 
-    result = result && stream->Write2(bits.data(), num_bytes);
-
-    result = result && WriteOptionalToStream(stream.get(), entry.display_active_start_offset);
-    result = result && WriteOptionalToStream(stream.get(), entry.display_active_end_offset);
-    result = result && WriteOptionalToStream(stream.get(), entry.display_line_start_offset);
-    result = result && WriteOptionalToStream(stream.get(), entry.display_line_end_offset);
-    result = result && WriteOptionalToStream(stream.get(), entry.dma_max_slice_ticks);
-    result = result && WriteOptionalToStream(stream.get(), entry.dma_halt_ticks);
-    result = result && WriteOptionalToStream(stream.get(), entry.gpu_fifo_size);
-    result = result && WriteOptionalToStream(stream.get(), entry.gpu_max_run_ahead);
-    result = result && WriteOptionalToStream(stream.get(), entry.gpu_pgxp_tolerance);
-    result = result && WriteOptionalToStream(stream.get(), entry.gpu_pgxp_depth_threshold);
-
-    result = result && stream->WriteSizePrefixedString(entry.disc_set_name);
-    result = result && stream->WriteU32(static_cast<u32>(entry.disc_set_serials.size()));
-    for (const std::string& serial : entry.disc_set_serials)
-      result = result && stream->WriteSizePrefixedString(serial);
+    std::memcpy(&image[entries_offset + i * sizeof(ImageEntry)], &ie, sizeof(ie));
   }
 
-  for (const auto& it : s_code_lookup)
+  for (u32 i = 0; i < static_cast<u32>(codes.size()); i++)
   {
-    result = result && stream->WriteSizePrefixedString(it.first);
-    result = result && stream->WriteU32(it.second);
+    const ImageCode ic = {add_string(codes[i].first), codes[i].second};
+    std::memcpy(&image[codes_offset + i * sizeof(ImageCode)], &ic, sizeof(ic));
   }
 
-  result = result && stream->Flush();
-  return true;
+  const ImageHeader header = {GAME_DATABASE_CACHE_SIGNATURE,
+                              GAME_DATABASE_CACHE_VERSION,
+                              gamedb_ts,
+                              static_cast<u32>(entries.size()),
+                              static_cast<u32>(codes.size()),
+                              num_disc_set_serials,
+                              entries_offset,
+                              codes_offset,
+                              disc_set_serials_offset};
+  std::memcpy(image.data(), &header, sizeof(header));
+
+  // write it out for next time, but use the in-memory copy for this run
+  const std::string filename(GetImageFile());
+  std::unique_ptr<ByteStream> stream(ByteStream::OpenFile(
+    filename.c_str(), BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_TRUNCATE |
+                        BYTESTREAM_OPEN_ATOMIC_UPDATE | BYTESTREAM_OPEN_STREAMED));
+  if (!stream || !stream->Write2(image.data(), static_cast<u32>(image.size())) || !stream->Commit())
+  {
+    Log_WarningPrintf("Failed to write game database cache '%s'", filename.c_str());
+    if (stream)
+      stream->Discard();
+  }
+
+  s_image_buffer = std::move(image);
+  return SetImage(s_image_buffer.data(), s_image_buffer.size());
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -777,7 +939,7 @@ static std::optional<float> GetOptionalFloatFromObject(const rapidjson::Value& o
   return member->value.GetFloat();
 }
 
-bool GameDatabase::LoadGameDBJson()
+bool GameDatabase::LoadGameDBJson(std::vector<Entry>* entries, PreferUnorderedStringMap<u32>* code_lookup)
 {
   std::optional<std::string> gamedb_data(Host::ReadResourceFileToString("gamedb.json"));
   if (!gamedb_data.has_value())
@@ -803,23 +965,22 @@ bool GameDatabase::LoadGameDBJson()
   }
 
   const auto& jarray = json->GetArray();
-  s_entries.reserve(jarray.Size());
+  entries->reserve(jarray.Size());
 
   for (const rapidjson::Value& current : json->GetArray())
   {
-    // TODO: binary sort
-    const u32 index = static_cast<u32>(s_entries.size());
-    Entry& entry = s_entries.emplace_back();
+    const u32 index = static_cast<u32>(entries->size());
+    Entry& entry = entries->emplace_back();
     if (!ParseJsonEntry(&entry, current))
     {
-      s_entries.pop_back();
+      entries->pop_back();
       continue;
     }
 
-    ParseJsonCodes(index, current);
+    ParseJsonCodes(index, current, code_lookup);
   }
 
-  Log_InfoPrintf("Loaded %zu entries and %zu codes from database", s_entries.size(), s_code_lookup.size());
+  Log_InfoPrintf("Loaded %zu entries and %zu codes from database", entries->size(), code_lookup->size());
   return true;
 }
 
@@ -981,7 +1142,8 @@ bool GameDatabase::ParseJsonEntry(Entry* entry, const rapidjson::Value& value)
   return true;
 }
 
-bool GameDatabase::ParseJsonCodes(u32 index, const rapidjson::Value& value)
+bool GameDatabase::ParseJsonCodes(u32 index, const rapidjson::Value& value,
+                                  PreferUnorderedStringMap<u32>* code_lookup)
 {
   auto member = value.FindMember("codes");
   if (member == value.MemberEnd())
@@ -1006,14 +1168,14 @@ bool GameDatabase::ParseJsonCodes(u32 index, const rapidjson::Value& value)
     }
 
     const std::string_view code(current_code.GetString(), current_code.GetStringLength());
-    auto iter = s_code_lookup.find(code);
-    if (iter != s_code_lookup.end())
+    auto iter = code_lookup->find(code);
+    if (iter != code_lookup->end())
     {
       Log_WarningPrintf("Duplicate code '%.*s'", static_cast<int>(code.size()), code.data());
       continue;
     }
 
-    s_code_lookup.emplace(code, index);
+    code_lookup->emplace(code, index);
     added++;
   }
 
@@ -3,6 +3,7 @@
 
 #include "game_list.h"
 #include "bios.h"
+#include "game_database.h"
 #include "host.h"
 #include "psf_loader.h"
 #include "settings.h"
@@ -16,15 +17,26 @@
 #include "common/heterogeneous_containers.h"
 #include "common/http_downloader.h"
 #include "common/log.h"
+#include "common/memmap.h"
 #include "common/path.h"
 #include "common/progress_callback.h"
 #include "common/string_util.h"
+#include "common/threading.h"
+
+#include "xxhash.h"
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
 #include <ctime>
+#include <limits>
+#include <mutex>
 #include <string_view>
+#include <thread>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
@@ -39,7 +51,10 @@ namespace GameList {
 enum : u32
 {
   GAME_LIST_CACHE_SIGNATURE = 0x45434C47,
-  GAME_LIST_CACHE_VERSION = 34,
+  GAME_LIST_CACHE_VERSION = 35,
+
+  // the cache is rewritten with everything indexed once this many entries have been appended
+  GAME_LIST_CACHE_MAX_APPENDED_RECORDS = 32,
 
   PLAYED_TIME_SERIAL_LENGTH = 32,
   PLAYED_TIME_LAST_TIME_LENGTH = 20,  // uint64
@@ -54,7 +69,64 @@ struct PlayedTimeEntry
   std::time_t total_played_time;
 };
 
-using CacheMap = PreferUnorderedStringMap<Entry>;
+// The cache is a flat file which is mapped and read in place, rather than deserialized up front:
+//   CacheHeader
+//   CacheRecord[num_indexed_records]
+//   CacheIndexEntry[num_indexed_records], sorted by path hash
+//   string data for the indexed records
+//   appended records, each a CacheRecord directly followed by its string data
+// Strings are referenced by absolute offset into the file. New entries are appended to the end without touching the
+// rest of the file, and looked up through a small index built at load time.
+struct CacheHeader
+{
+  u32 signature;
+  u32 version;
+  u32 num_indexed_records;
+  u32 index_offset;
+  u32 appended_offset;
+  u32 reserved;
+};
+static_assert(sizeof(CacheHeader) == 24);
+
+struct CacheString
+{
+  u32 offset;
+  u32 length;
+};
+
+struct CacheRecord
+{
+  u64 hash;
+  u64 total_size;
+  u64 last_modified_time;
+  u64 release_date;
+  CacheString path;
+  CacheString serial;
+  CacheString title;
+  CacheString genre;
+  CacheString publisher;
+  CacheString developer;
+  u32 strings_size;
+  u16 supported_controllers;
+  u8 type;
+  u8 region;
+  u8 min_players;
+  u8 max_players;
+  u8 min_blocks;
+  u8 max_blocks;
+  u8 compatibility;
+  u8 padding[3];
+};
+static_assert(sizeof(CacheRecord) == 96);
+
+struct CacheIndexEntry
+{
+  u64 path_hash;
+  u32 record_offset;
+  u32 padding;
+};
+static_assert(sizeof(CacheIndexEntry) == 16);
+
 using PlayedTimeMap = PreferUnorderedStringMap<PlayedTimeEntry>;
 
 static_assert(std::is_same_v<decltype(Entry::hash), System::GameHash>);
@@ -68,15 +140,23 @@ static void ScanDirectory(const char* path, bool recursive, bool only_cache,
                           const std::vector<std::string>& excluded_paths, const PlayedTimeMap& played_time_map,
                           ProgressCallback* progress);
 static bool AddFileFromCache(const std::string& path, std::time_t timestamp, const PlayedTimeMap& played_time_map);
-static bool ScanFile(std::string path, std::time_t timestamp, std::unique_lock<std::recursive_mutex>& lock,
-                     const PlayedTimeMap& played_time_map);
+static void ScanFiles(FileSystem::FindResultsArray files, u32 files_done, const PlayedTimeMap& played_time_map,
+                      ProgressCallback* progress);
+static void AddScannedEntry(Entry entry, const PlayedTimeMap& played_time_map);
 
 static std::string GetCacheFilename();
 static void LoadCache();
-static bool LoadEntriesFromCache(ByteStream* stream);
+static bool ValidateCacheFile(const MappedFile& file, const CacheHeader** header,
+                              std::vector<CacheIndexEntry>* appended_index);
+static u64 GetCachePathHash(const std::string_view& path);
+static bool GetCacheString(const MappedFile& file, const CacheString& str, std::string_view* out);
+static bool ReadCacheRecord(const MappedFile& file, u32 offset, const std::string_view& path, Entry* entry);
+static CacheRecord MakeCacheRecord(const Entry& entry, u32 strings_offset, std::vector<u8>* strings);
 static bool OpenCacheForWriting();
 static bool WriteEntryToCache(const Entry* entry);
 static void CloseCacheFileStream();
+static void CloseCache();
+static void RewriteCache();
 static void DeleteCacheFile();
 
 static std::string GetPlayedTimeFile();
@@ -89,7 +169,10 @@ static PlayedTimeEntry UpdatePlayedTimeFile(const std::string& path, const std::
 
 static std::vector<GameList::Entry> s_entries;
 static std::recursive_mutex s_mutex;
-static GameList::CacheMap s_cache_map;
+static MappedFile s_cache_file;
+static const GameList::CacheHeader* s_cache_header = nullptr;
+static std::vector<GameList::CacheIndexEntry> s_cache_appended_index;
+static u32 s_cache_records_written = 0;
 static std::unique_ptr<ByteStream> s_cache_write_stream;
 
 static bool s_game_list_loaded = false;
@@ -284,86 +367,137 @@ bool GameList::PopulateEntryFromPath(const std::string& path, Entry* entry)
 
 bool GameList::GetGameListEntryFromCache(const std::string& path, Entry* entry)
 {
-  auto iter = s_cache_map.find(path);
-  if (iter == s_cache_map.end())
+  if (!s_cache_header)
     return false;
 
-  *entry = std::move(iter->second);
-  s_cache_map.erase(iter);
-  return true;
-}
+  const u64 path_hash = GetCachePathHash(path);
+  const auto hash_compare = [](const CacheIndexEntry& lhs, const CacheIndexEntry& rhs) {
+    return (lhs.path_hash < rhs.path_hash);
+  };
+  const CacheIndexEntry key = {path_hash, 0, 0};
 
-bool GameList::LoadEntriesFromCache(ByteStream* stream)
-{
-  u32 file_signature, file_version;
-  if (!stream->ReadU32(&file_signature) || !stream->ReadU32(&file_version) ||
-      file_signature != GAME_LIST_CACHE_SIGNATURE || file_version != GAME_LIST_CACHE_VERSION)
+  // appended records take priority, and the newest of them wins
+  const auto [appended_begin, appended_end] =
+    std::equal_range(s_cache_appended_index.begin(), s_cache_appended_index.end(), key, hash_compare);
+  for (auto it = appended_end; it != appended_begin;)
   {
-    Log_WarningPrintf("Game list cache is corrupted");
-    return false;
+    --it;
+    if (ReadCacheRecord(s_cache_file, it->record_offset, path, entry))
+      return true;
   }
 
-  while (stream->GetPosition() != stream->GetSize())
+  const CacheIndexEntry* index =
+    reinterpret_cast<const CacheIndexEntry*>(s_cache_file.GetData() + s_cache_header->index_offset);
+  const auto [begin, end] = std::equal_range(index, index + s_cache_header->num_indexed_records, key, hash_compare);
+  for (auto it = begin; it != end; ++it)
   {
-    std::string path;
-    Entry ge;
-
-    u8 type;
-    u8 region;
-    u8 compatibility_rating;
-
-    if (!stream->ReadU8(&type) || !stream->ReadU8(&region) || !stream->ReadSizePrefixedString(&path) ||
-        !stream->ReadSizePrefixedString(&ge.serial) || !stream->ReadSizePrefixedString(&ge.title) ||
-        !stream->ReadSizePrefixedString(&ge.genre) || !stream->ReadSizePrefixedString(&ge.publisher) ||
-        !stream->ReadSizePrefixedString(&ge.developer) || !stream->ReadU64(&ge.hash) ||
-        !stream->ReadU64(&ge.total_size) || !stream->ReadU64(reinterpret_cast<u64*>(&ge.last_modified_time)) ||
-        !stream->ReadU64(&ge.release_date) || !stream->ReadU16(&ge.supported_controllers) ||
-        !stream->ReadU8(&ge.min_players) || !stream->ReadU8(&ge.max_players) || !stream->ReadU8(&ge.min_blocks) ||
-        !stream->ReadU8(&ge.max_blocks) || !stream->ReadU8(&compatibility_rating) ||
-        region >= static_cast<u8>(DiscRegion::Count) || type >= static_cast<u8>(EntryType::Count) ||
-        compatibility_rating >= static_cast<u8>(GameDatabase::CompatibilityRating::Count))
-    {
-      Log_WarningPrintf("Game list cache entry is corrupted");
-      return false;
-    }
+    if (ReadCacheRecord(s_cache_file, it->record_offset, path, entry))
+      return true;
+  }
 
-    ge.path = path;
-    ge.region = static_cast<DiscRegion>(region);
-    ge.type = static_cast<EntryType>(type);
-    ge.compatibility = static_cast<GameDatabase::CompatibilityRating>(compatibility_rating);
+  return false;
+}
 
-    auto iter = s_cache_map.find(ge.path);
-    if (iter != s_cache_map.end())
-      iter->second = std::move(ge);
-    else
-      s_cache_map.emplace(std::move(path), std::move(ge));
+u64 GameList::GetCachePathHash(const std::string_view& path)
+{
+  return XXH64(path.data(), path.length(), 0);
+}
+
+bool GameList::GetCacheString(const MappedFile& file, const CacheString& str, std::string_view* out)
+{
+  if (str.offset > file.GetSize() || str.length > (file.GetSize() - str.offset))
+    return false;
+
+  *out = std::string_view(reinterpret_cast<const char*>(file.GetData() + str.offset), str.length);
+  return true;
+}
+
+bool GameList::ReadCacheRecord(const MappedFile& file, u32 offset, const std::string_view& path, Entry* entry)
+{
+  if (offset > file.GetSize() || sizeof(CacheRecord) > (file.GetSize() - offset))
+    return false;
+
+  CacheRecord rec;
+  std::memcpy(&rec, file.GetData() + offset, sizeof(rec));
+
+  // an empty path matches any record, used when compacting
+  std::string_view rec_path, serial, title, genre, publisher, developer;
+  if (!GetCacheString(file, rec.path, &rec_path) || (!path.empty() && rec_path != path) ||
+      !GetCacheString(file, rec.serial, &serial) || !GetCacheString(file, rec.title, &title) ||
+      !GetCacheString(file, rec.genre, &genre) || !GetCacheString(file, rec.publisher, &publisher) ||
+      !GetCacheString(file, rec.developer, &developer) || rec.region >= static_cast<u8>(DiscRegion::Count) ||
+      rec.type >= static_cast<u8>(EntryType::Count) ||
+      rec.compatibility >= static_cast<u8>(GameDatabase::CompatibilityRating::Count))
+  {
+    return false;
   }
 
+  entry->type = static_cast<EntryType>(rec.type);
+  entry->region = static_cast<DiscRegion>(rec.region);
+  entry->path = rec_path;
+  entry->serial = serial;
+  entry->title = title;
+  entry->genre = genre;
+  entry->publisher = publisher;
+  entry->developer = developer;
+  entry->hash = rec.hash;
+  entry->total_size = rec.total_size;
+  entry->last_modified_time = static_cast<std::time_t>(rec.last_modified_time);
+  entry->release_date = rec.release_date;
+  entry->supported_controllers = rec.supported_controllers;
+  entry->min_players = rec.min_players;
+  entry->max_players = rec.max_players;
+  entry->min_blocks = rec.min_blocks;
+  entry->max_blocks = rec.max_blocks;
+  entry->compatibility = static_cast<GameDatabase::CompatibilityRating>(rec.compatibility);
   return true;
 }
 
+GameList::CacheRecord GameList::MakeCacheRecord(const Entry& entry, u32 strings_offset, std::vector<u8>* strings)
+{
+  const size_t start_size = strings->size();
+  const auto add_string = [strings_offset, start_size, strings](const std::string& str) {
+    const CacheString ret = {strings_offset + static_cast<u32>(strings->size() - start_size),
+                             static_cast<u32>(str.length())};
+    strings->insert(strings->end(), str.begin(), str.end());
+    return ret;
+  };
+
+  CacheRecord rec = {};
+  rec.hash = entry.hash;
+  rec.total_size = entry.total_size;
+  rec.last_modified_time = static_cast<u64>(entry.last_modified_time);
+  rec.release_date = entry.release_date;
+  rec.path = add_string(entry.path);
+  rec.serial = add_string(entry.serial);
+  rec.title = add_string(entry.title);
+  rec.genre = add_string(entry.genre);
+  rec.publisher = add_string(entry.publisher);
+  rec.developer = add_string(entry.developer);
+  rec.strings_size = static_cast<u32>(strings->size() - start_size);
+  rec.supported_controllers = entry.supported_controllers;
+  rec.type = static_cast<u8>(entry.type);
+  rec.region = static_cast<u8>(entry.region);
+  rec.min_players = entry.min_players;
+  rec.max_players = entry.max_players;
+  rec.min_blocks = entry.min_blocks;
+  rec.max_blocks = entry.max_blocks;
+  rec.compatibility = static_cast<u8>(entry.compatibility);
+  return rec;
+}
+
 bool GameList::WriteEntryToCache(const Entry* entry)
 {
-  bool result = true;
-  result &= s_cache_write_stream->WriteU8(static_cast<u8>(entry->type));
-  result &= s_cache_write_stream->WriteU8(static_cast<u8>(entry->region));
-  result &= s_cache_write_stream->WriteSizePrefixedString(entry->path);
-  result &= s_cache_write_stream->WriteSizePrefixedString(entry->serial);
-  result &= s_cache_write_stream->WriteSizePrefixedString(entry->title);
-  result &= s_cache_write_stream->WriteSizePrefixedString(entry->genre);
-  result &= s_cache_write_stream->WriteSizePrefixedString(entry->publisher);
-  result &= s_cache_write_stream->WriteSizePrefixedString(entry->developer);
-  result &= s_cache_write_stream->WriteU64(entry->hash);
-  result &= s_cache_write_stream->WriteU64(entry->total_size);
-  result &= s_cache_write_stream->WriteU64(entry->last_modified_time);
-  result &= s_cache_write_stream->WriteU64(entry->release_date);
-  result &= s_cache_write_stream->WriteU16(entry->supported_controllers);
-  result &= s_cache_write_stream->WriteU8(entry->min_players);
-  result &= s_cache_write_stream->WriteU8(entry->max_players);
-  result &= s_cache_write_stream->WriteU8(entry->min_blocks);
-  result &= s_cache_write_stream->WriteU8(entry->max_blocks);
-  result &= s_cache_write_stream->WriteU8(static_cast<u8>(entry->compatibility));
-  return result;
+  const u32 record_offset = static_cast<u32>(s_cache_write_stream->GetPosition());
+
+  std::vector<u8> data(sizeof(CacheRecord));
+  const CacheRecord rec = MakeCacheRecord(*entry, record_offset + sizeof(CacheRecord), &data);
+  std::memcpy(data.data(), &rec, sizeof(rec));
+  if (!s_cache_write_stream->Write2(data.data(), static_cast<u32>(data.size())))
+    return false;
+
+  s_cache_records_written++;
+  return true;
 }
 
 static std::string GameList::GetCacheFilename()
@@ -371,19 +505,66 @@ static std::string GameList::GetCacheFilename()
   return Path::Combine(EmuFolders::Cache, "gamelist.cache");
 }
 
+bool GameList::ValidateCacheFile(const MappedFile& file, const CacheHeader** header,
+                                 std::vector<CacheIndexEntry>* appended_index)
+{
+  const size_t size = file.GetSize();
+  if (size < sizeof(CacheHeader) || size > std::numeric_limits<u32>::max())
+    return false;
+
+  const CacheHeader* hdr = reinterpret_cast<const CacheHeader*>(file.GetData());
+  if (hdr->signature != GAME_LIST_CACHE_SIGNATURE || hdr->version != GAME_LIST_CACHE_VERSION ||
+      hdr->index_offset < sizeof(CacheHeader) || (hdr->index_offset % alignof(CacheIndexEntry)) != 0 ||
+      hdr->index_offset > size ||
+      (static_cast<u64>(hdr->num_indexed_records) * sizeof(CacheIndexEntry)) > (size - hdr->index_offset) ||
+      hdr->appended_offset > size)
+  {
+    Log_WarningPrintf("Game list cache is corrupted");
+    return false;
+  }
+
+  // only the appended records need walking, the indexed records are used in place
+  appended_index->clear();
+  for (size_t offset = hdr->appended_offset; offset != size;)
+  {
+    CacheRecord rec;
+    std::string_view path;
+    if (sizeof(CacheRecord) > (size - offset))
+    {
+      Log_WarningPrintf("Game list cache entry is corrupted");
+      return false;
+    }
+
+    std::memcpy(&rec, file.GetData() + offset, sizeof(rec));
+    if (rec.strings_size > (size - offset - sizeof(CacheRecord)) || !GetCacheString(file, rec.path, &path))
+    {
+      Log_WarningPrintf("Game list cache entry is corrupted");
+      return false;
+    }
+
+    appended_index->push_back(CacheIndexEntry{GetCachePathHash(path), static_cast<u32>(offset), 0});
+    offset += sizeof(CacheRecord) + rec.strings_size;
+  }
+
+  std::stable_sort(
+    appended_index->begin(), appended_index->end(),
+    [](const CacheIndexEntry& lhs, const CacheIndexEntry& rhs) { return (lhs.path_hash < rhs.path_hash); });
+
+  *header = hdr;
+  return true;
+}
+
 void GameList::LoadCache()
 {
   std::string filename(GetCacheFilename());
-  std::unique_ptr<ByteStream> stream =
-    ByteStream::OpenFile(filename.c_str(), BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
-  if (!stream)
+  if (!s_cache_file.Open(filename.c_str(), nullptr))
     return;
 
-  if (!LoadEntriesFromCache(stream.get()))
+  if (!ValidateCacheFile(s_cache_file, &s_cache_header, &s_cache_appended_index))
   {
     Log_WarningPrintf("Deleting corrupted cache file '%s'", filename.c_str());
-    stream.reset();
-    s_cache_map.clear();
+    s_cache_file.Close();
+    s_cache_appended_index = {};
     DeleteCacheFile();
     return;
   }
@@ -418,8 +599,9 @@ bool GameList::OpenCacheForWriting()
     return false;
 
   // new cache file, write header
-  if (!s_cache_write_stream->WriteU32(GAME_LIST_CACHE_SIGNATURE) ||
-      !s_cache_write_stream->WriteU32(GAME_LIST_CACHE_VERSION))
+  const CacheHeader header = {GAME_LIST_CACHE_SIGNATURE, GAME_LIST_CACHE_VERSION, 0, sizeof(CacheHeader),
+                              sizeof(CacheHeader), 0};
+  if (!s_cache_write_stream->Write2(&header, sizeof(header)))
   {
     Log_ErrorPrintf("Failed to write game list cache header");
     s_cache_write_stream.reset();
@@ -439,6 +621,107 @@ void GameList::CloseCacheFileStream()
   s_cache_write_stream.reset();
 }
 
+void GameList::CloseCache()
+{
+  const size_t num_appended = s_cache_appended_index.size() + s_cache_records_written;
+  s_cache_file.Close();
+  s_cache_header = nullptr;
+  s_cache_appended_index = {};
+  s_cache_records_written = 0;
+
+  if (num_appended > GAME_LIST_CACHE_MAX_APPENDED_RECORDS)
+    RewriteCache();
+}
+
+void GameList::RewriteCache()
+{
+  const std::string filename(GetCacheFilename());
+  std::vector<Entry> entries;
+  {
+    // mapping has to be gone before the file is replaced
+    MappedFile file;
+    const CacheHeader* header;
+    std::vector<CacheIndexEntry> appended_index;
+    if (!file.Open(filename.c_str(), nullptr) || !ValidateCacheFile(file, &header, &appended_index))
+      return;
+
+    std::vector<u32> record_offsets;
+    record_offsets.reserve(header->num_indexed_records + appended_index.size());
+    const CacheIndexEntry* index = reinterpret_cast<const CacheIndexEntry*>(file.GetData() + header->index_offset);
+    for (u32 i = 0; i < header->num_indexed_records; i++)
+      record_offsets.push_back(index[i].record_offset);
+
+    // appended records are in file order, so later ones replace earlier ones with the same path
+    for (size_t offset = header->appended_offset; offset != file.GetSize();)
+    {
+      CacheRecord rec;
+      std::memcpy(&rec, file.GetData() + offset, sizeof(rec));
+      record_offsets.push_back(static_cast<u32>(offset));
+      offset += sizeof(CacheRecord) + rec.strings_size;
+    }
+
+    PreferUnorderedStringMap<size_t> entry_indices;
+    for (const u32 offset : record_offsets)
+    {
+      Entry entry;
+      if (!ReadCacheRecord(file, offset, {}, &entry))
+        continue;
+
+      auto iter = entry_indices.find(entry.path);
+      if (iter != entry_indices.end())
+      {
+        entries[iter->second] = std::move(entry);
+      }
+      else
+      {
+        entry_indices.emplace(entry.path, entries.size());
+        entries.push_back(std::move(entry));
+      }
+    }
+  }
+
+  const u32 num_records = static_cast<u32>(entries.size());
+  const u32 index_offset = sizeof(CacheHeader) + num_records * sizeof(CacheRecord);
+  const u32 strings_offset = index_offset + num_records * sizeof(CacheIndexEntry);
+
+  std::vector<u8> data(strings_offset);
+  std::vector<u8> strings;
+  std::vector<CacheIndexEntry> index;
+  index.reserve(num_records);
+  for (u32 i = 0; i < num_records; i++)
+  {
+    const u32 record_offset = sizeof(CacheHeader) + i * sizeof(CacheRecord);
+
+    // indexed records share one string table, so strings_size isn't needed to skip over them
+    CacheRecord rec = MakeCacheRecord(entries[i], strings_offset + static_cast<u32>(strings.size()), &strings);
+    rec.strings_size = 0;
+    std::memcpy(&data[record_offset], &rec, sizeof(rec));
+    index.push_back(CacheIndexEntry{GetCachePathHash(entries[i].path), record_offset, 0});
+  }
+
+  std::sort(index.begin(), index.end(),
+            [](const CacheIndexEntry& lhs, const CacheIndexEntry& rhs) { return (lhs.path_hash < rhs.path_hash); });
+  std::memcpy(&data[index_offset], index.data(), index.size() * sizeof(CacheIndexEntry));
+  data.insert(data.end(), strings.begin(), strings.end());
+
+  const CacheHeader header = {GAME_LIST_CACHE_SIGNATURE, GAME_LIST_CACHE_VERSION, num_records, index_offset,
+                              static_cast<u32>(data.size()), 0};
+  std::memcpy(data.data(), &header, sizeof(header));
+
+  std::unique_ptr<ByteStream> stream =
+    ByteStream::OpenFile(filename.c_str(), BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_TRUNCATE |
+                                             BYTESTREAM_OPEN_ATOMIC_UPDATE | BYTESTREAM_OPEN_STREAMED);
+  if (!stream || !stream->Write2(data.data(), static_cast<u32>(data.size())) || !stream->Commit())
+  {
+    Log_ErrorPrintf("Failed to rewrite game list cache '%s'", filename.c_str());
+    if (stream)
+      stream->Discard();
+    return;
+  }
+
+  Log_InfoPrintf("Rewrote game list cache with %u entries", num_records);
+}
+
 void GameList::DeleteCacheFile()
 {
   Assert(!s_cache_write_stream);
@@ -478,31 +761,126 @@ void GameList::ScanDirectory(const char* path, bool recursive, bool only_cache,
   progress->SetProgressRange(static_cast<u32>(files.size()));
   progress->SetProgressValue(0);
 
-  u32 files_scanned = 0;
+  // pull everything we can from the cache first, that's cheap, and leaves only new or changed files for the workers
+  FileSystem::FindResultsArray files_to_scan;
+  u32 files_done = 0;
   for (FILESYSTEM_FIND_DATA& ffd : files)
   {
-    files_scanned++;
+    if (progress->IsCancelled())
+      break;
 
-    if (progress->IsCancelled() || !GameList::IsScannableFilename(ffd.FileName) ||
-        IsPathExcluded(excluded_paths, ffd.FileName))
+    if (GameList::IsScannableFilename(ffd.FileName) && !IsPathExcluded(excluded_paths, ffd.FileName))
     {
-      continue;
+      std::unique_lock lock(s_mutex);
+      if (!GetEntryForPath(ffd.FileName.c_str()) &&
+          !AddFileFromCache(ffd.FileName, ffd.ModificationTime, played_time_map) && !only_cache)
+      {
+        files_to_scan.push_back(std::move(ffd));
+        continue;
+      }
     }
 
-    std::unique_lock lock(s_mutex);
-    if (GetEntryForPath(ffd.FileName.c_str()) ||
-        AddFileFromCache(ffd.FileName, ffd.ModificationTime, played_time_map) || only_cache)
+    files_done++;
+  }
+
+  progress->SetProgressValue(files_done);
+  if (!files_to_scan.empty() && !progress->IsCancelled())
+    ScanFiles(std::move(files_to_scan), files_done, played_time_map, progress);
+
+  progress->SetProgressValue(static_cast<u32>(files.size()));
+  progress->PopState();
+}
+
+void GameList::ScanFiles(FileSystem::FindResultsArray files, u32 files_done, const PlayedTimeMap& played_time_map,
+                         ProgressCallback* progress)
+{
+  // the database is loaded on demand, which isn't thread safe
+  GameDatabase::EnsureLoaded();
+
+  const u32 num_files = static_cast<u32>(files.size());
+  const u32 num_workers = std::clamp(std::thread::hardware_concurrency(), 1u, num_files);
+  Log_DevPrintf("Scanning %u files with %u workers", num_files, num_workers);
+
+  // Each file is an independent work item. Workers only parse the image, the results are handed back to this thread,
+  // which adds them to the list and cache in batches, and is the only one talking to the progress callback.
+  std::atomic<u32> next_file{0};
+  std::atomic_bool cancelled{false};
+  std::mutex results_mutex;
+  std::condition_variable results_cv;
+  std::vector<Entry> results;
+  u32 files_completed = 0;
+
+  auto worker = [&]() {
+    Threading::SetNameOfCurrentThread("Game List Scanner");
+
+    for (;;)
     {
-      continue;
+      const u32 index = next_file.fetch_add(1, std::memory_order_relaxed);
+      if (index >= num_files || cancelled.load(std::memory_order_relaxed))
+        break;
+
+      const FILESYSTEM_FIND_DATA& ffd = files[index];
+      Log_DevPrintf("Scanning '%s'...", ffd.FileName.c_str());
+
+      Entry entry;
+      const bool result = PopulateEntryFromPath(ffd.FileName, &entry);
+
+      std::unique_lock lock(results_mutex);
+      if (result)
+      {
+        entry.path = ffd.FileName;
+        entry.last_modified_time = ffd.ModificationTime;
+        results.push_back(std::move(entry));
+      }
+
+      files_completed++;
+      results_cv.notify_one();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(num_workers);
+  for (u32 i = 0; i < num_workers; i++)
+    workers.emplace_back(worker);
+
+  std::vector<Entry> batch;
+  std::unique_lock lock(results_mutex);
+  for (;;)
+  {
+    // wake up periodically even if nothing's finished, so cancelling stays responsive
+    results_cv.wait_for(lock, std::chrono::milliseconds(100),
+                        [&]() { return (!results.empty() || files_completed == num_files); });
+
+    batch.swap(results);
+    const u32 completed = files_completed;
+    lock.unlock();
+
+    if (!batch.empty())
+    {
+      progress->SetFormattedStatusText("Scanning '%s'...",
+                                       FileSystem::GetDisplayNameFromPath(batch.back().path).c_str());
     }
 
-    progress->SetFormattedStatusText("Scanning '%s'...", FileSystem::GetDisplayNameFromPath(ffd.FileName).c_str());
-    ScanFile(std::move(ffd.FileName), ffd.ModificationTime, lock, played_time_map);
-    progress->SetProgressValue(files_scanned);
+    for (Entry& entry : batch)
+      AddScannedEntry(std::move(entry), played_time_map);
+    batch.clear();
+
+    progress->SetProgressValue(files_done + completed);
+    if (progress->IsCancelled())
+      cancelled.store(true, std::memory_order_relaxed);
+
+    lock.lock();
+    if (files_completed == num_files || (cancelled.load(std::memory_order_relaxed) && results.empty()))
+      break;
   }
+  lock.unlock();
 
-  progress->SetProgressValue(files_scanned);
-  progress->PopState();
+  for (std::thread& thread : workers)
+    thread.join();
+
+  // anything which finished after we noticed the cancel is still worth keeping
+  for (Entry& entry : results)
+    AddScannedEntry(std::move(entry), played_time_map);
 }
 
 bool GameList::AddFileFromCache(const std::string& path, std::time_t timestamp, const PlayedTimeMap& played_time_map)
@@ -522,21 +900,8 @@ bool GameList::AddFileFromCache(const std::string& path, std::time_t timestamp,
   return true;
 }
 
-bool GameList::ScanFile(std::string path, std::time_t timestamp, std::unique_lock<std::recursive_mutex>& lock,
-                        const PlayedTimeMap& played_time_map)
+void GameList::AddScannedEntry(Entry entry, const PlayedTimeMap& played_time_map)
 {
-  // don't block UI while scanning
-  lock.unlock();
-
-  Log_DevPrintf("Scanning '%s'...", path.c_str());
-
-  Entry entry;
-  if (!PopulateEntryFromPath(path, &entry))
-    return false;
-
-  entry.path = std::move(path);
-  entry.last_modified_time = timestamp;
-
   if (s_cache_write_stream || OpenCacheForWriting())
   {
     if (!WriteEntryToCache(&entry))
@@ -550,9 +915,8 @@ bool GameList::ScanFile(std::string path, std::time_t timestamp, std::unique_loc
     entry.total_played_time = iter->second.total_played_time;
   }
 
-  lock.lock();
+  std::unique_lock lock(s_mutex);
   s_entries.push_back(std::move(entry));
-  return true;
 }
 
 std::unique_lock<std::recursive_mutex> GameList::GetLock()
@@ -658,7 +1022,7 @@ void GameList::Refresh(bool invalidate_cache, bool only_cache, ProgressCallback*
 
   // don't need unused cache entries
   CloseCacheFileStream();
-  s_cache_map.clear();
+  CloseCache();
 }
 
 std::string GameList::GetCoverImagePathForEntry(const Entry* entry)
@@ -25,6 +25,7 @@
 
 #include "stb_image_resize.h"
 #include "stb_image_write.h"
+#include "xxhash.h"
 
 #include <cmath>
 #include <thread>
@@ -2188,6 +2189,12 @@ bool GPU::DumpVRAMToFile(const char* filename)
   }
 }
 
+u64 GPU::GetVRAMHash()
+{
+  ReadVRAM(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
+  return XXH64(m_vram_ptr, VRAM_SIZE, 0);
+}
+
 bool GPU::DumpVRAMToFile(const char* filename, u32 width, u32 height, u32 stride, const void* buffer, bool remove_alpha)
 {
   auto fp = FileSystem::OpenManagedCFile(filename, "wb");
@@ -182,6 +182,9 @@ public:
   // Dumps raw VRAM to a file.
   bool DumpVRAMToFile(const char* filename);
 
+  // Reads back VRAM and returns a hash of its contents, for comparing runs.
+  u64 GetVRAMHash();
+
   // Ensures all buffered vertices are drawn.
   virtual void FlushRender();
 
@@ -2,23 +2,48 @@
 // SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
 
 #include "gpu_sw_backend.h"
+#include "gpu_sw_rasterizer.h"
+#include "settings.h"
 #include "system.h"
 
 #include "util/gpu_device.h"
 
+#include "common/log.h"
+
 #include <algorithm>
 
+Log_SetChannel(GPU_SW_Backend);
+
 GPU_SW_Backend::GPU_SW_Backend() : GPUBackend()
 {
   m_vram.fill(0);
   m_vram_ptr = m_vram.data();
 }
 
-GPU_SW_Backend::~GPU_SW_Backend() = default;
+GPU_SW_Backend::~GPU_SW_Backend()
+{
+  StopRenderWorkers();
+}
 
 bool GPU_SW_Backend::Initialize(bool force_thread)
 {
-  return GPUBackend::Initialize(force_thread);
+  if (!GPUBackend::Initialize(force_thread))
+    return false;
+
+  StartRenderWorkers(g_settings.gpu_sw_render_threads);
+  return true;
+}
+
+void GPU_SW_Backend::UpdateSettings()
+{
+  GPUBackend::UpdateSettings();
+
+  // Safe to touch the workers here, the base class has synchronized with the GPU thread.
+  if (m_render_workers.size() != std::min<u32>(g_settings.gpu_sw_render_threads, MAX_RENDER_WORKERS))
+  {
+    StopRenderWorkers();
+    StartRenderWorkers(g_settings.gpu_sw_render_threads);
+  }
 }
 
 void GPU_SW_Backend::Reset(bool clear_vram)
@@ -29,230 +54,231 @@ void GPU_SW_Backend::Reset(bool clear_vram)
     m_vram.fill(0);
 }
 
-void GPU_SW_Backend::DrawPolygon(const GPUBackendDrawPolygonCommand* cmd)
+void GPU_SW_Backend::Shutdown()
 {
-  const GPURenderCommand rc{cmd->rc.bits};
-  const bool dithering_enable = rc.IsDitheringEnabled() && cmd->draw_mode.dither_enable;
-
-  const DrawTriangleFunction DrawFunction = GetDrawTriangleFunction(
-    rc.shading_enable, rc.texture_enable, rc.raw_texture_enable, rc.transparency_enable, dithering_enable);
-
-  (this->*DrawFunction)(cmd, &cmd->vertices[0], &cmd->vertices[1], &cmd->vertices[2]);
-  if (rc.quad_polygon)
-    (this->*DrawFunction)(cmd, &cmd->vertices[2], &cmd->vertices[1], &cmd->vertices[3]);
+  GPUBackend::Shutdown();
+  StopRenderWorkers();
+  m_batch_buffer.clear();
+  m_batch_commands = 0;
 }
 
-void GPU_SW_Backend::DrawRectangle(const GPUBackendDrawRectangleCommand* cmd)
+void GPU_SW_Backend::StartRenderWorkers(u32 count)
 {
-  const GPURenderCommand rc{cmd->rc.bits};
+  count = std::min<u32>(count, MAX_RENDER_WORKERS);
+  if (count == 0)
+    return;
 
-  const DrawRectangleFunction DrawFunction =
-    GetDrawRectangleFunction(rc.texture_enable, rc.raw_texture_enable, rc.transparency_enable);
+  m_render_workers_shutdown.store(false);
+  m_render_workers.reserve(count);
+  for (u32 i = 0; i < count; i++)
+  {
+    std::unique_ptr<RenderWorker> worker = std::make_unique<RenderWorker>();
+    RenderWorker* worker_ptr = worker.get();
+    worker->thread.Start([this, worker_ptr]() { RenderWorkerThread(worker_ptr); });
+    m_render_workers.push_back(std::move(worker));
+  }
 
-  (this->*DrawFunction)(cmd);
+  Log_InfoPrintf("Started %u software renderer worker threads.", count);
 }
 
-void GPU_SW_Backend::DrawLine(const GPUBackendDrawLineCommand* cmd)
+void GPU_SW_Backend::StopRenderWorkers()
 {
-  const DrawLineFunction DrawFunction =
-    GetDrawLineFunction(cmd->rc.shading_enable, cmd->rc.transparency_enable, cmd->IsDitheringEnabled());
-
-  for (u16 i = 1; i < cmd->num_vertices; i++)
-    (this->*DrawFunction)(cmd, &cmd->vertices[i - 1], &cmd->vertices[i]);
-}
+  if (m_render_workers.empty())
+    return;
 
-constexpr GPU_SW_Backend::DitherLUT GPU_SW_Backend::ComputeDitherLUT()
-{
-  DitherLUT lut = {};
-  for (u32 i = 0; i < DITHER_MATRIX_SIZE; i++)
+  m_render_workers_shutdown.store(true);
+  for (std::unique_ptr<RenderWorker>& worker : m_render_workers)
   {
-    for (u32 j = 0; j < DITHER_MATRIX_SIZE; j++)
-    {
-      for (u32 value = 0; value < DITHER_LUT_SIZE; value++)
-      {
-        const s32 dithered_value = (static_cast<s32>(value) + DITHER_MATRIX[i][j]) >> 3;
-        lut[i][j][value] = static_cast<u8>((dithered_value < 0) ? 0 : ((dithered_value > 31) ? 31 : dithered_value));
-      }
-    }
+    worker->work_semaphore.Post();
+    worker->thread.Join();
   }
-  return lut;
-}
 
-static constexpr GPU_SW_Backend::DitherLUT s_dither_lut = GPU_SW_Backend::ComputeDitherLUT();
+  m_render_workers.clear();
+  Log_InfoPrint("Software renderer worker threads stopped.");
+}
 
-template<bool texture_enable, bool raw_texture_enable, bool transparency_enable, bool dithering_enable>
-void ALWAYS_INLINE_RELEASE GPU_SW_Backend::ShadePixel(const GPUBackendDrawCommand* cmd, u32 x, u32 y, u8 color_r,
-                                                      u8 color_g, u8 color_b, u8 texcoord_x, u8 texcoord_y)
+void GPU_SW_Backend::RenderWorkerThread(RenderWorker* worker)
 {
-  VRAMPixel color;
-  if constexpr (texture_enable)
-  {
-    // Apply texture window
-    texcoord_x = (texcoord_x & cmd->window.and_x) | cmd->window.or_x;
-    texcoord_y = (texcoord_y & cmd->window.and_y) | cmd->window.or_y;
+  Threading::SetNameOfCurrentThread("GPU SW Worker");
 
-    VRAMPixel texture_color;
-    switch (cmd->draw_mode.texture_mode)
-    {
-      case GPUTextureMode::Palette4Bit:
-      {
-        const u16 palette_value =
-          GetPixel((cmd->draw_mode.GetTexturePageBaseX() + ZeroExtend32(texcoord_x / 4)) % VRAM_WIDTH,
-                   (cmd->draw_mode.GetTexturePageBaseY() + ZeroExtend32(texcoord_y)) % VRAM_HEIGHT);
-        const u16 palette_index = (palette_value >> ((texcoord_x % 4) * 4)) & 0x0Fu;
-
-        texture_color.bits =
-          GetPixel((cmd->palette.GetXBase() + ZeroExtend32(palette_index)) % VRAM_WIDTH, cmd->palette.GetYBase());
-      }
+  for (;;)
+  {
+    worker->work_semaphore.Wait();
+    if (m_render_workers_shutdown.load())
       break;
 
-      case GPUTextureMode::Palette8Bit:
-      {
-        const u16 palette_value =
-          GetPixel((cmd->draw_mode.GetTexturePageBaseX() + ZeroExtend32(texcoord_x / 2)) % VRAM_WIDTH,
-                   (cmd->draw_mode.GetTexturePageBaseY() + ZeroExtend32(texcoord_y)) % VRAM_HEIGHT);
-        const u16 palette_index = (palette_value >> ((texcoord_x % 2) * 8)) & 0xFFu;
-        texture_color.bits =
-          GetPixel((cmd->palette.GetXBase() + ZeroExtend32(palette_index)) % VRAM_WIDTH, cmd->palette.GetYBase());
-      }
-      break;
+    ExecuteBatch(worker->clip_area);
+    m_render_done_semaphore.Post();
+  }
+}
 
-      default:
-      {
-        texture_color.bits = GetPixel((cmd->draw_mode.GetTexturePageBaseX() + ZeroExtend32(texcoord_x)) % VRAM_WIDTH,
-                                      (cmd->draw_mode.GetTexturePageBaseY() + ZeroExtend32(texcoord_y)) % VRAM_HEIGHT);
-      }
-      break;
-    }
+bool GPU_SW_Backend::TextureReadOverlapsDrawingArea(const GPUBackendDrawCommand* cmd) const
+{
+  // Drawing area is inclusive, reads can wrap around the right edge of VRAM.
+  const auto overlaps = [this](u32 left, u32 top, u32 width, u32 height) {
+    if (top > m_drawing_area.bottom || (top + height) <= m_drawing_area.top)
+      return false;
 
-    if (texture_color.bits == 0)
-      return;
+    const u32 right = left + width;
+    return (left <= m_drawing_area.right && right > m_drawing_area.left) ||
+           (right > VRAM_WIDTH && (right - VRAM_WIDTH) > m_drawing_area.left);
+  };
 
-    if constexpr (raw_texture_enable)
-    {
-      color.bits = texture_color.bits;
-    }
-    else
-    {
-      const u32 dither_y = (dithering_enable) ? (y & 3u) : 2u;
-      const u32 dither_x = (dithering_enable) ? (x & 3u) : 3u;
+  const Common::Rectangle<u32> page = cmd->draw_mode.GetTexturePageRectangle();
+  if (overlaps(page.left, page.top, page.GetWidth(), page.GetHeight()))
+    return true;
 
-      color.bits = (ZeroExtend16(s_dither_lut[dither_y][dither_x][(u16(texture_color.r) * u16(color_r)) >> 4]) << 0) |
-                   (ZeroExtend16(s_dither_lut[dither_y][dither_x][(u16(texture_color.g) * u16(color_g)) >> 4]) << 5) |
-                   (ZeroExtend16(s_dither_lut[dither_y][dither_x][(u16(texture_color.b) * u16(color_b)) >> 4]) << 10) |
-                   (texture_color.bits & 0x8000u);
-    }
-  }
-  else
+  if (cmd->draw_mode.IsUsingPalette())
   {
-    const u32 dither_y = (dithering_enable) ? (y & 3u) : 2u;
-    const u32 dither_x = (dithering_enable) ? (x & 3u) : 3u;
-
-    // Non-textured transparent polygons don't set bit 15, but are treated as transparent.
-    color.bits = (ZeroExtend16(s_dither_lut[dither_y][dither_x][color_r]) << 0) |
-                 (ZeroExtend16(s_dither_lut[dither_y][dither_x][color_g]) << 5) |
-                 (ZeroExtend16(s_dither_lut[dither_y][dither_x][color_b]) << 10) | (transparency_enable ? 0x8000u : 0);
+    const u32 palette_width = (cmd->draw_mode.texture_mode == GPUTextureMode::Palette4Bit) ? 16 : 256;
+    if (overlaps(cmd->palette.GetXBase(), cmd->palette.GetYBase(), palette_width, 1))
+      return true;
   }
 
-  const VRAMPixel bg_color{GetPixel(static_cast<u32>(x), static_cast<u32>(y))};
-  if constexpr (transparency_enable)
+  return false;
+}
+
+void GPU_SW_Backend::QueueDrawCommand(const GPUBackendDrawCommand* cmd, bool textured)
+{
+  if (textured && TextureReadOverlapsDrawingArea(cmd))
   {
-    if (color.bits & 0x8000u || !texture_enable)
-    {
-      // Based on blargg's efficient 15bpp pixel math.
-      u32 bg_bits = ZeroExtend32(bg_color.bits);
-      u32 fg_bits = ZeroExtend32(color.bits);
-      switch (cmd->draw_mode.transparency_mode)
-      {
-        case GPUTransparencyMode::HalfBackgroundPlusHalfForeground:
-        {
-          bg_bits |= 0x8000u;
-          color.bits = Truncate16(((fg_bits + bg_bits) - ((fg_bits ^ bg_bits) & 0x0421u)) >> 1);
-        }
-        break;
+    // Render-to-texture, bands would race with each other. Drain the batch and draw it on this thread instead.
+    FlushRender();
+    ExecuteDrawCommand(cmd, m_drawing_area);
+    return;
+  }
 
-        case GPUTransparencyMode::BackgroundPlusForeground:
-        {
-          bg_bits &= ~0x8000u;
+  const u8* cmd_ptr = reinterpret_cast<const u8*>(cmd);
+  m_batch_buffer.insert(m_batch_buffer.end(), cmd_ptr, cmd_ptr + cmd->size);
+  m_batch_commands++;
 
-          const u32 sum = fg_bits + bg_bits;
-          const u32 carry = (sum - ((fg_bits ^ bg_bits) & 0x8421u)) & 0x8420u;
+  if (m_batch_buffer.size() >= MAX_BATCH_SIZE)
+    FlushRender();
+}
 
-          color.bits = Truncate16((sum - carry) | (carry - (carry >> 5)));
-        }
-        break;
+void GPU_SW_Backend::ExecuteBatch(const Common::Rectangle<u32>& clip_area)
+{
+  const u8* ptr = m_batch_buffer.data();
+  const u8* end = ptr + m_batch_buffer.size();
+  while (ptr < end)
+  {
+    const GPUBackendDrawCommand* cmd = reinterpret_cast<const GPUBackendDrawCommand*>(ptr);
+    ExecuteDrawCommand(cmd, clip_area);
+    ptr += cmd->size;
+  }
+}
 
-        case GPUTransparencyMode::BackgroundMinusForeground:
-        {
-          bg_bits |= 0x8000u;
-          fg_bits &= ~0x8000u;
+void GPU_SW_Backend::ExecuteDrawCommand(const GPUBackendDrawCommand* cmd, const Common::Rectangle<u32>& clip_area)
+{
+  switch (cmd->type)
+  {
+    case GPUBackendCommandType::DrawPolygon:
+    {
+      const GPUBackendDrawPolygonCommand* pcmd = static_cast<const GPUBackendDrawPolygonCommand*>(cmd);
+      const GPURenderCommand rc{pcmd->rc.bits};
+      const bool dithering_enable = rc.IsDitheringEnabled() && pcmd->draw_mode.dither_enable;
 
-          const u32 diff = bg_bits - fg_bits + 0x108420u;
-          const u32 borrow = (diff - ((bg_bits ^ fg_bits) & 0x108420u)) & 0x108420u;
+      const DrawTriangleFunction DrawFunction = GetDrawTriangleFunction(
+        rc.shading_enable, rc.texture_enable, rc.raw_texture_enable, rc.transparency_enable, dithering_enable);
 
-          color.bits = Truncate16((diff - borrow) & (borrow - (borrow >> 5)));
-        }
-        break;
+      (this->*DrawFunction)(pcmd, clip_area, &pcmd->vertices[0], &pcmd->vertices[1], &pcmd->vertices[2]);
+      if (rc.quad_polygon)
+        (this->*DrawFunction)(pcmd, clip_area, &pcmd->vertices[2], &pcmd->vertices[1], &pcmd->vertices[3]);
+    }
+    break;
 
-        case GPUTransparencyMode::BackgroundPlusQuarterForeground:
-        {
-          bg_bits &= ~0x8000u;
-          fg_bits = ((fg_bits >> 2) & 0x1CE7u) | 0x8000u;
+    case GPUBackendCommandType::DrawRectangle:
+    {
+      const GPUBackendDrawRectangleCommand* rcmd = static_cast<const GPUBackendDrawRectangleCommand*>(cmd);
+      const GPURenderCommand rc{rcmd->rc.bits};
 
-          const u32 sum = fg_bits + bg_bits;
-          const u32 carry = (sum - ((fg_bits ^ bg_bits) & 0x8421u)) & 0x8420u;
+      const DrawRectangleFunction DrawFunction =
+        GetDrawRectangleFunction(rc.texture_enable, rc.raw_texture_enable, rc.transparency_enable);
 
-          color.bits = Truncate16((sum - carry) | (carry - (carry >> 5)));
-        }
-        break;
+      (this->*DrawFunction)(rcmd, clip_area);
+    }
+    break;
 
-        default:
-          break;
-      }
+    case GPUBackendCommandType::DrawLine:
+    {
+      const GPUBackendDrawLineCommand* lcmd = static_cast<const GPUBackendDrawLineCommand*>(cmd);
+      const DrawLineFunction DrawFunction =
+        GetDrawLineFunction(lcmd->rc.shading_enable, lcmd->rc.transparency_enable, lcmd->IsDitheringEnabled());
 
-      // See above.
-      if constexpr (!texture_enable)
-        color.bits &= ~0x8000u;
+      for (u16 i = 1; i < lcmd->num_vertices; i++)
+        (this->*DrawFunction)(lcmd, clip_area, &lcmd->vertices[i - 1], &lcmd->vertices[i]);
     }
+    break;
+
+    default:
+      UnreachableCode();
+      break;
   }
+}
 
-  const u16 mask_and = cmd->params.GetMaskAND();
-  if ((bg_color.bits & mask_and) != 0)
-    return;
+void GPU_SW_Backend::DrawPolygon(const GPUBackendDrawPolygonCommand* cmd)
+{
+  if (!m_render_workers.empty())
+    QueueDrawCommand(cmd, cmd->rc.texture_enable);
+  else
+    ExecuteDrawCommand(cmd, m_drawing_area);
+}
+
+void GPU_SW_Backend::DrawRectangle(const GPUBackendDrawRectangleCommand* cmd)
+{
+  if (!m_render_workers.empty())
+    QueueDrawCommand(cmd, cmd->rc.texture_enable);
+  else
+    ExecuteDrawCommand(cmd, m_drawing_area);
+}
 
-  SetPixel(static_cast<u32>(x), static_cast<u32>(y), color.bits | cmd->params.GetMaskOR());
+void GPU_SW_Backend::DrawLine(const GPUBackendDrawLineCommand* cmd)
+{
+  if (!m_render_workers.empty())
+    QueueDrawCommand(cmd, false);
+  else
+    ExecuteDrawCommand(cmd, m_drawing_area);
 }
 
 template<bool texture_enable, bool raw_texture_enable, bool transparency_enable>
-void GPU_SW_Backend::DrawRectangle(const GPUBackendDrawRectangleCommand* cmd)
+void GPU_SW_Backend::DrawRectangle(const GPUBackendDrawRectangleCommand* cmd,
+                                   const Common::Rectangle<u32>& clip_area)
 {
   const s32 origin_x = cmd->x;
   const s32 origin_y = cmd->y;
   const auto [r, g, b] = UnpackColorRGB24(cmd->color);
   const auto [origin_texcoord_x, origin_texcoord_y] = UnpackTexcoord(cmd->texcoord);
 
+  // Each row is drawn as a flat-shaded span, with the U coordinate stepping by one texel per pixel.
+  const s32 start_x = std::max(origin_x, static_cast<s32>(clip_area.left));
+  const s32 end_x = std::min(origin_x + static_cast<s32>(cmd->width), static_cast<s32>(clip_area.right) + 1);
+  if (start_x >= end_x)
+    return;
+
+  GPU_SW_Rasterizer::SpanInterpolants ig;
+  ig.u = ZeroExtend32(Truncate8(ZeroExtend32(origin_texcoord_x) + static_cast<u32>(start_x - origin_x)))
+         << GPU_SW_Rasterizer::SPAN_FRACTIONAL_BITS;
+  ig.r = ZeroExtend32(r) << GPU_SW_Rasterizer::SPAN_FRACTIONAL_BITS;
+  ig.g = ZeroExtend32(g) << GPU_SW_Rasterizer::SPAN_FRACTIONAL_BITS;
+  ig.b = ZeroExtend32(b) << GPU_SW_Rasterizer::SPAN_FRACTIONAL_BITS;
+
+  GPU_SW_Rasterizer::SpanInterpolants step = {};
+  step.u = 1u << GPU_SW_Rasterizer::SPAN_FRACTIONAL_BITS;
+
   for (u32 offset_y = 0; offset_y < cmd->height; offset_y++)
   {
     const s32 y = origin_y + static_cast<s32>(offset_y);
-    if (y < static_cast<s32>(m_drawing_area.top) || y > static_cast<s32>(m_drawing_area.bottom) ||
+    if (y < static_cast<s32>(clip_area.top) || y > static_cast<s32>(clip_area.bottom) ||
         (cmd->params.interlaced_rendering && cmd->params.active_line_lsb == (Truncate8(static_cast<u32>(y)) & 1u)))
     {
       continue;
     }
 
-    const u8 texcoord_y = Truncate8(ZeroExtend32(origin_texcoord_y) + offset_y);
-
-    for (u32 offset_x = 0; offset_x < cmd->width; offset_x++)
-    {
-      const s32 x = origin_x + static_cast<s32>(offset_x);
-      if (x < static_cast<s32>(m_drawing_area.left) || x > static_cast<s32>(m_drawing_area.right))
-        continue;
-
-      const u8 texcoord_x = Truncate8(ZeroExtend32(origin_texcoord_x) + offset_x);
+    ig.v = ZeroExtend32(Truncate8(ZeroExtend32(origin_texcoord_y) + offset_y))
+           << GPU_SW_Rasterizer::SPAN_FRACTIONAL_BITS;
 
-      ShadePixel<texture_enable, raw_texture_enable, transparency_enable, false>(
-        cmd, static_cast<u32>(x), static_cast<u32>(y), r, g, b, texcoord_x, texcoord_y);
-    }
+    GPU_SW_Rasterizer::DrawSpan<false, texture_enable, raw_texture_enable, transparency_enable, false>(
+      m_vram.data(), cmd, static_cast<u32>(start_x), static_cast<u32>(y), static_cast<u32>(end_x - start_x), ig, step);
   }
 }
 
@@ -364,8 +390,8 @@ void ALWAYS_INLINE_RELEASE GPU_SW_Backend::AddIDeltas_DY(i_group& ig, const i_de
 
 template<bool shading_enable, bool texture_enable, bool raw_texture_enable, bool transparency_enable,
          bool dithering_enable>
-void GPU_SW_Backend::DrawSpan(const GPUBackendDrawPolygonCommand* cmd, s32 y, s32 x_start, s32 x_bound, i_group ig,
-                              const i_deltas& idl)
+void GPU_SW_Backend::DrawSpan(const GPUBackendDrawPolygonCommand* cmd, const Common::Rectangle<u32>& clip_area, s32 y,
+                              s32 x_start, s32 x_bound, i_group ig, const i_deltas& idl)
 {
   if (cmd->params.interlaced_rendering && cmd->params.active_line_lsb == (Truncate8(static_cast<u32>(y)) & 1u))
     return;
@@ -374,16 +400,16 @@ void GPU_SW_Backend::DrawSpan(const GPUBackendDrawPolygonCommand* cmd, s32 y, s3
   s32 w = x_bound - x_start;
   s32 x = TruncateGPUVertexPosition(x_start);
 
-  if (x < static_cast<s32>(m_drawing_area.left))
+  if (x < static_cast<s32>(clip_area.left))
   {
-    s32 delta = static_cast<s32>(m_drawing_area.left) - x;
+    s32 delta = static_cast<s32>(clip_area.left) - x;
     x_ig_adjust += delta;
     x += delta;
     w -= delta;
   }
 
-  if ((x + w) > (static_cast<s32>(m_drawing_area.right) + 1))
-    w = static_cast<s32>(m_drawing_area.right) + 1 - x;
+  if ((x + w) > (static_cast<s32>(clip_area.right) + 1))
+    w = static_cast<s32>(clip_area.right) + 1 - x;
 
   if (w <= 0)
     return;
@@ -391,26 +417,17 @@ void GPU_SW_Backend::DrawSpan(const GPUBackendDrawPolygonCommand* cmd, s32 y, s3
   AddIDeltas_DX<shading_enable, texture_enable>(ig, idl, x_ig_adjust);
   AddIDeltas_DY<shading_enable, texture_enable>(ig, idl, y);
 
-  do
-  {
-    const u32 r = ig.r >> (COORD_FBS + COORD_POST_PADDING);
-    const u32 g = ig.g >> (COORD_FBS + COORD_POST_PADDING);
-    const u32 b = ig.b >> (COORD_FBS + COORD_POST_PADDING);
-    const u32 u = ig.u >> (COORD_FBS + COORD_POST_PADDING);
-    const u32 v = ig.v >> (COORD_FBS + COORD_POST_PADDING);
-
-    ShadePixel<texture_enable, raw_texture_enable, transparency_enable, dithering_enable>(
-      cmd, static_cast<u32>(x), static_cast<u32>(y), Truncate8(r), Truncate8(g), Truncate8(b), Truncate8(u),
-      Truncate8(v));
-
-    x++;
-    AddIDeltas_DX<shading_enable, texture_enable>(ig, idl);
-  } while (--w > 0);
+  static_assert((COORD_FBS + COORD_POST_PADDING) == GPU_SW_Rasterizer::SPAN_FRACTIONAL_BITS);
+  const GPU_SW_Rasterizer::SpanInterpolants start = {ig.u, ig.v, ig.r, ig.g, ig.b};
+  const GPU_SW_Rasterizer::SpanInterpolants step = {idl.du_dx, idl.dv_dx, idl.dr_dx, idl.dg_dx, idl.db_dx};
+  GPU_SW_Rasterizer::DrawSpan<shading_enable, texture_enable, raw_texture_enable, transparency_enable,
+                              dithering_enable>(m_vram.data(), cmd, static_cast<u32>(x), static_cast<u32>(y),
+                                                static_cast<u32>(w), start, step);
 }
 
 template<bool shading_enable, bool texture_enable, bool raw_texture_enable, bool transparency_enable,
          bool dithering_enable>
-void GPU_SW_Backend::DrawTriangle(const GPUBackendDrawPolygonCommand* cmd,
+void GPU_SW_Backend::DrawTriangle(const GPUBackendDrawPolygonCommand* cmd, const Common::Rectangle<u32>& clip_area,
                                   const GPUBackendDrawPolygonCommand::Vertex* v0,
                                   const GPUBackendDrawPolygonCommand::Vertex* v1,
                                   const GPUBackendDrawPolygonCommand::Vertex* v2)
@@ -568,14 +585,14 @@ void GPU_SW_Backend::DrawTriangle(const GPUBackendDrawPolygonCommand* cmd,
 
         s32 y = TruncateGPUVertexPosition(yi);
 
-        if (y < static_cast<s32>(m_drawing_area.top))
+        if (y < static_cast<s32>(clip_area.top))
           break;
 
-        if (y > static_cast<s32>(m_drawing_area.bottom))
+        if (y > static_cast<s32>(clip_area.bottom))
           continue;
 
         DrawSpan<shading_enable, texture_enable, raw_texture_enable, transparency_enable, dithering_enable>(
-          cmd, yi, GetPolyXFP_Int(lc), GetPolyXFP_Int(rc), ig, idl);
+          cmd, clip_area, yi, GetPolyXFP_Int(lc), GetPolyXFP_Int(rc), ig, idl);
       }
     }
     else
@@ -584,14 +601,14 @@ void GPU_SW_Backend::DrawTriangle(const GPUBackendDrawPolygonCommand* cmd,
       {
         s32 y = TruncateGPUVertexPosition(yi);
 
-        if (y > static_cast<s32>(m_drawing_area.bottom))
+        if (y > static_cast<s32>(clip_area.bottom))
           break;
 
-        if (y >= static_cast<s32>(m_drawing_area.top))
+        if (y >= static_cast<s32>(clip_area.top))
         {
 
           DrawSpan<shading_enable, texture_enable, raw_texture_enable, transparency_enable, dithering_enable>(
-            cmd, yi, GetPolyXFP_Int(lc), GetPolyXFP_Int(rc), ig, idl);
+            cmd, clip_area, yi, GetPolyXFP_Int(lc), GetPolyXFP_Int(rc), ig, idl);
         }
 
         yi++;
@@ -636,8 +653,8 @@ static ALWAYS_INLINE_RELEASE s64 LineDivide(s64 delta, s32 dk)
 }
 
 template<bool shading_enable, bool transparency_enable, bool dithering_enable>
-void GPU_SW_Backend::DrawLine(const GPUBackendDrawLineCommand* cmd, const GPUBackendDrawLineCommand::Vertex* p0,
-                              const GPUBackendDrawLineCommand::Vertex* p1)
+void GPU_SW_Backend::DrawLine(const GPUBackendDrawLineCommand* cmd, const Common::Rectangle<u32>& clip_area,
+                              const GPUBackendDrawLineCommand::Vertex* p0, const GPUBackendDrawLineCommand::Vertex* p1)
 {
   const s32 i_dx = std::abs(p1->x - p0->x);
   const s32 i_dy = std::abs(p1->y - p0->y);
@@ -697,15 +714,15 @@ void GPU_SW_Backend::DrawLine(const GPUBackendDrawLineCommand* cmd, const GPUBac
     const s32 y = (cur_point.y >> Line_XY_FractBits) & 2047;
 
     if ((!cmd->params.interlaced_rendering || cmd->params.active_line_lsb != (Truncate8(static_cast<u32>(y)) & 1u)) &&
-        x >= static_cast<s32>(m_drawing_area.left) && x <= static_cast<s32>(m_drawing_area.right) &&
-        y >= static_cast<s32>(m_drawing_area.top) && y <= static_cast<s32>(m_drawing_area.bottom))
+        x >= static_cast<s32>(clip_area.left) && x <= static_cast<s32>(clip_area.right) &&
+        y >= static_cast<s32>(clip_area.top) && y <= static_cast<s32>(clip_area.bottom))
     {
       const u8 r = shading_enable ? static_cast<u8>(cur_point.r >> Line_RGB_FractBits) : p0->r;
       const u8 g = shading_enable ? static_cast<u8>(cur_point.g >> Line_RGB_FractBits) : p0->g;
       const u8 b = shading_enable ? static_cast<u8>(cur_point.b >> Line_RGB_FractBits) : p0->b;
 
-      ShadePixel<false, false, transparency_enable, dithering_enable>(cmd, static_cast<u32>(x), static_cast<u32>(y), r,
-                                                                      g, b, 0, 0);
+      GPU_SW_Rasterizer::ShadePixel<false, false, transparency_enable, dithering_enable>(
+        m_vram.data(), cmd, static_cast<u32>(x), static_cast<u32>(y), r, g, b, 0, 0);
     }
 
     cur_point.x += step.dx_dk;
@@ -874,7 +891,43 @@ void GPU_SW_Backend::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 wi
   }
 }
 
-void GPU_SW_Backend::FlushRender() {}
+void GPU_SW_Backend::FlushRender()
+{
+  if (m_batch_buffer.empty())
+    return;
+
+  // Split the drawing area into horizontal bands, one per thread. The calling thread takes the first band.
+  const u32 num_rows =
+    (m_drawing_area.bottom >= m_drawing_area.top) ? (m_drawing_area.bottom - m_drawing_area.top + 1) : 0;
+  const u32 num_bands = std::min<u32>(static_cast<u32>(m_render_workers.size()) + 1, num_rows / MIN_RENDER_BAND_HEIGHT);
+  if (num_bands <= 1 || m_batch_commands < MIN_PARALLEL_BATCH_COMMANDS)
+  {
+    ExecuteBatch(m_drawing_area);
+  }
+  else
+  {
+    const auto get_band = [this, num_rows, num_bands](u32 band) {
+      return Common::Rectangle<u32>(m_drawing_area.left, m_drawing_area.top + (num_rows * band) / num_bands,
+                                    m_drawing_area.right,
+                                    m_drawing_area.top + (num_rows * (band + 1)) / num_bands - 1);
+    };
+
+    for (u32 i = 1; i < num_bands; i++)
+    {
+      RenderWorker* worker = m_render_workers[i - 1].get();
+      worker->clip_area = get_band(i);
+      worker->work_semaphore.Post();
+    }
+
+    ExecuteBatch(get_band(0));
+
+    for (u32 i = 1; i < num_bands; i++)
+      m_render_done_semaphore.Wait();
+  }
+
+  m_batch_buffer.clear();
+  m_batch_commands = 0;
+}
 
 void GPU_SW_Backend::DrawingAreaChanged() {}
 
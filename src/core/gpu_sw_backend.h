@@ -4,6 +4,7 @@
 #pragma once
 #include "gpu_backend.h"
 #include <array>
+#include <atomic>
 #include <memory>
 #include <vector>
 
@@ -14,18 +15,15 @@ public:
   ~GPU_SW_Backend() override;
 
   bool Initialize(bool force_thread) override;
+  void UpdateSettings() override;
   void Reset(bool clear_vram) override;
+  void Shutdown() override;
 
   ALWAYS_INLINE_RELEASE u16 GetPixel(const u32 x, const u32 y) const { return m_vram[VRAM_WIDTH * y + x]; }
   ALWAYS_INLINE_RELEASE const u16* GetPixelPtr(const u32 x, const u32 y) const { return &m_vram[VRAM_WIDTH * y + x]; }
   ALWAYS_INLINE_RELEASE u16* GetPixelPtr(const u32 x, const u32 y) { return &m_vram[VRAM_WIDTH * y + x]; }
   ALWAYS_INLINE_RELEASE void SetPixel(const u32 x, const u32 y, const u16 value) { m_vram[VRAM_WIDTH * y + x] = value; }
 
-  // this is actually (31 * 255) >> 4) == 494, but to simplify addressing we use the next power of two (512)
-  static constexpr u32 DITHER_LUT_SIZE = 512;
-  using DitherLUT = std::array<std::array<std::array<u8, 512>, DITHER_MATRIX_SIZE>, DITHER_MATRIX_SIZE>;
-  static constexpr DitherLUT ComputeDitherLUT();
-
 protected:
   union VRAMPixel
   {
@@ -99,16 +97,43 @@ protected:
   void DrawingAreaChanged() override;
 
   //////////////////////////////////////////////////////////////////////////
-  // Rasterization
+  // Parallel rendering
   //////////////////////////////////////////////////////////////////////////
-  template<bool texture_enable, bool raw_texture_enable, bool transparency_enable, bool dithering_enable>
-  void ShadePixel(const GPUBackendDrawCommand* cmd, u32 x, u32 y, u8 color_r, u8 color_g, u8 color_b, u8 texcoord_x,
-                  u8 texcoord_y);
+  enum : u32
+  {
+    MAX_RENDER_WORKERS = 15,
+    MIN_RENDER_BAND_HEIGHT = 16,
+    MIN_PARALLEL_BATCH_COMMANDS = 4,
+    MAX_BATCH_SIZE = 256 * 1024,
+  };
+
+  struct RenderWorker
+  {
+    Threading::Thread thread;
+    Threading::KernelSemaphore work_semaphore;
+    Common::Rectangle<u32> clip_area{};
+  };
+
+  void StartRenderWorkers(u32 count);
+  void StopRenderWorkers();
+  void RenderWorkerThread(RenderWorker* worker);
 
+  /// Returns true if the primitive samples texels or CLUT entries from inside the drawing area, which means it can
+  /// observe pixels written by other bands and must be rasterized serially.
+  bool TextureReadOverlapsDrawingArea(const GPUBackendDrawCommand* cmd) const;
+
+  void QueueDrawCommand(const GPUBackendDrawCommand* cmd, bool textured);
+  void ExecuteBatch(const Common::Rectangle<u32>& clip_area);
+  void ExecuteDrawCommand(const GPUBackendDrawCommand* cmd, const Common::Rectangle<u32>& clip_area);
+
+  //////////////////////////////////////////////////////////////////////////
+  // Rasterization
+  //////////////////////////////////////////////////////////////////////////
   template<bool texture_enable, bool raw_texture_enable, bool transparency_enable>
-  void DrawRectangle(const GPUBackendDrawRectangleCommand* cmd);
+  void DrawRectangle(const GPUBackendDrawRectangleCommand* cmd, const Common::Rectangle<u32>& clip_area);
 
-  using DrawRectangleFunction = void (GPU_SW_Backend::*)(const GPUBackendDrawRectangleCommand* cmd);
+  using DrawRectangleFunction = void (GPU_SW_Backend::*)(const GPUBackendDrawRectangleCommand* cmd,
+                                                         const Common::Rectangle<u32>& clip_area);
   DrawRectangleFunction GetDrawRectangleFunction(bool texture_enable, bool raw_texture_enable,
                                                  bool transparency_enable);
 
@@ -142,15 +167,17 @@ protected:
 
   template<bool shading_enable, bool texture_enable, bool raw_texture_enable, bool transparency_enable,
            bool dithering_enable>
-  void DrawSpan(const GPUBackendDrawPolygonCommand* cmd, s32 y, s32 x_start, s32 x_bound, i_group ig,
-                const i_deltas& idl);
+  void DrawSpan(const GPUBackendDrawPolygonCommand* cmd, const Common::Rectangle<u32>& clip_area, s32 y, s32 x_start,
+                s32 x_bound, i_group ig, const i_deltas& idl);
 
   template<bool shading_enable, bool texture_enable, bool raw_texture_enable, bool transparency_enable,
            bool dithering_enable>
-  void DrawTriangle(const GPUBackendDrawPolygonCommand* cmd, const GPUBackendDrawPolygonCommand::Vertex* v0,
-                    const GPUBackendDrawPolygonCommand::Vertex* v1, const GPUBackendDrawPolygonCommand::Vertex* v2);
+  void DrawTriangle(const GPUBackendDrawPolygonCommand* cmd, const Common::Rectangle<u32>& clip_area,
+                    const GPUBackendDrawPolygonCommand::Vertex* v0, const GPUBackendDrawPolygonCommand::Vertex* v1,
+                    const GPUBackendDrawPolygonCommand::Vertex* v2);
 
   using DrawTriangleFunction = void (GPU_SW_Backend::*)(const GPUBackendDrawPolygonCommand* cmd,
+                                                        const Common::Rectangle<u32>& clip_area,
                                                         const GPUBackendDrawPolygonCommand::Vertex* v0,
                                                         const GPUBackendDrawPolygonCommand::Vertex* v1,
                                                         const GPUBackendDrawPolygonCommand::Vertex* v2);
@@ -158,13 +185,23 @@ protected:
                                                bool transparency_enable, bool dithering_enable);
 
   template<bool shading_enable, bool transparency_enable, bool dithering_enable>
-  void DrawLine(const GPUBackendDrawLineCommand* cmd, const GPUBackendDrawLineCommand::Vertex* p0,
-                const GPUBackendDrawLineCommand::Vertex* p1);
+  void DrawLine(const GPUBackendDrawLineCommand* cmd, const Common::Rectangle<u32>& clip_area,
+                const GPUBackendDrawLineCommand::Vertex* p0, const GPUBackendDrawLineCommand::Vertex* p1);
 
   using DrawLineFunction = void (GPU_SW_Backend::*)(const GPUBackendDrawLineCommand* cmd,
+                                                    const Common::Rectangle<u32>& clip_area,
                                                     const GPUBackendDrawLineCommand::Vertex* p0,
                                                     const GPUBackendDrawLineCommand::Vertex* p1);
   DrawLineFunction GetDrawLineFunction(bool shading_enable, bool transparency_enable, bool dithering_enable);
 
   std::array<u16, VRAM_WIDTH * VRAM_HEIGHT> m_vram;
+
+  // Draw commands are copied here when rendering is split across workers. Every worker replays the whole batch in
+  // submission order, clipped to its own band of rows, so ordering within each band matches the serial renderer.
+  std::vector<u8> m_batch_buffer;
+  u32 m_batch_commands = 0;
+
+  std::vector<std::unique_ptr<RenderWorker>> m_render_workers;
+  Threading::KernelSemaphore m_render_done_semaphore;
+  std::atomic_bool m_render_workers_shutdown{false};
 };
@@ -0,0 +1,674 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+#include "gpu_types.h"
+
+#include "common/intrin.h"
+
+#include <algorithm>
+#include <array>
+
+// Span rasterization shared by the software renderer. DrawSpanScalar() is the reference implementation, DrawSpan()
+// processes eight pixels at a time when SSE2 or NEON is available, and must produce identical output.
+
+#if defined(CPU_ARCH_SSE) || defined(CPU_ARCH_NEON)
+#define GPU_SW_RASTERIZER_VECTOR 1
+#endif
+
+namespace GPU_SW_Rasterizer {
+
+// this is actually (31 * 255) >> 4) == 494, but to simplify addressing we use the next power of two (512)
+static constexpr u32 DITHER_LUT_SIZE = 512;
+using DitherLUT = std::array<std::array<std::array<u8, DITHER_LUT_SIZE>, DITHER_MATRIX_SIZE>, DITHER_MATRIX_SIZE>;
+
+constexpr DitherLUT ComputeDitherLUT()
+{
+  DitherLUT lut = {};
+  for (u32 i = 0; i < DITHER_MATRIX_SIZE; i++)
+  {
+    for (u32 j = 0; j < DITHER_MATRIX_SIZE; j++)
+    {
+      for (u32 value = 0; value < DITHER_LUT_SIZE; value++)
+      {
+        const s32 dithered_value = (static_cast<s32>(value) + DITHER_MATRIX[i][j]) >> 3;
+        lut[i][j][value] = static_cast<u8>((dithered_value < 0) ? 0 : ((dithered_value > 31) ? 31 : dithered_value));
+      }
+    }
+  }
+  return lut;
+}
+
+inline constexpr DitherLUT g_dither_lut = ComputeDitherLUT();
+
+/// Fractional bits of span interpolants.
+static constexpr u32 SPAN_FRACTIONAL_BITS = 24;
+
+/// Vertex attributes at the first pixel of a span, or the per-pixel step, in 8.24 fixed point.
+struct SpanInterpolants
+{
+  u32 u, v;
+  u32 r, g, b;
+};
+
+/// Fetches a texel, coordinates should already have the texture window applied.
+ALWAYS_INLINE_RELEASE static u16 GetTexturePixel(const u16* vram, const GPUBackendDrawCommand* cmd, u8 texcoord_x,
+                                                 u8 texcoord_y)
+{
+  switch (cmd->draw_mode.texture_mode)
+  {
+    case GPUTextureMode::Palette4Bit:
+    {
+      const u16 palette_value =
+        vram[VRAM_WIDTH * ((cmd->draw_mode.GetTexturePageBaseY() + ZeroExtend32(texcoord_y)) % VRAM_HEIGHT) +
+             ((cmd->draw_mode.GetTexturePageBaseX() + ZeroExtend32(texcoord_x / 4)) % VRAM_WIDTH)];
+      const u16 palette_index = (palette_value >> ((texcoord_x % 4) * 4)) & 0x0Fu;
+      return vram[VRAM_WIDTH * cmd->palette.GetYBase() +
+                  ((cmd->palette.GetXBase() + ZeroExtend32(palette_index)) % VRAM_WIDTH)];
+    }
+
+    case GPUTextureMode::Palette8Bit:
+    {
+      const u16 palette_value =
+        vram[VRAM_WIDTH * ((cmd->draw_mode.GetTexturePageBaseY() + ZeroExtend32(texcoord_y)) % VRAM_HEIGHT) +
+             ((cmd->draw_mode.GetTexturePageBaseX() + ZeroExtend32(texcoord_x / 2)) % VRAM_WIDTH)];
+      const u16 palette_index = (palette_value >> ((texcoord_x % 2) * 8)) & 0xFFu;
+      return vram[VRAM_WIDTH * cmd->palette.GetYBase() +
+                  ((cmd->palette.GetXBase() + ZeroExtend32(palette_index)) % VRAM_WIDTH)];
+    }
+
+    default:
+    {
+      return vram[VRAM_WIDTH * ((cmd->draw_mode.GetTexturePageBaseY() + ZeroExtend32(texcoord_y)) % VRAM_HEIGHT) +
+                  ((cmd->draw_mode.GetTexturePageBaseX() + ZeroExtend32(texcoord_x)) % VRAM_WIDTH)];
+    }
+  }
+}
+
+template<bool texture_enable, bool raw_texture_enable, bool transparency_enable, bool dithering_enable>
+ALWAYS_INLINE_RELEASE static void ShadePixel(u16* vram, const GPUBackendDrawCommand* cmd, u32 x, u32 y, u8 color_r,
+                                             u8 color_g, u8 color_b, u8 texcoord_x, u8 texcoord_y)
+{
+  u16 color;
+  if constexpr (texture_enable)
+  {
+    // Apply texture window
+    texcoord_x = (texcoord_x & cmd->window.and_x) | cmd->window.or_x;
+    texcoord_y = (texcoord_y & cmd->window.and_y) | cmd->window.or_y;
+
+    const u16 texture_color = GetTexturePixel(vram, cmd, texcoord_x, texcoord_y);
+    if (texture_color == 0)
+      return;
+
+    if constexpr (raw_texture_enable)
+    {
+      color = texture_color;
+    }
+    else
+    {
+      const u32 dither_y = (dithering_enable) ? (y & 3u) : 2u;
+      const u32 dither_x = (dithering_enable) ? (x & 3u) : 3u;
+      const u16 texture_r = texture_color & 0x1Fu;
+      const u16 texture_g = (texture_color >> 5) & 0x1Fu;
+      const u16 texture_b = (texture_color >> 10) & 0x1Fu;
+
+      color = (ZeroExtend16(g_dither_lut[dither_y][dither_x][(texture_r * u16(color_r)) >> 4]) << 0) |
+              (ZeroExtend16(g_dither_lut[dither_y][dither_x][(texture_g * u16(color_g)) >> 4]) << 5) |
+              (ZeroExtend16(g_dither_lut[dither_y][dither_x][(texture_b * u16(color_b)) >> 4]) << 10) |
+              (texture_color & 0x8000u);
+    }
+  }
+  else
+  {
+    const u32 dither_y = (dithering_enable) ? (y & 3u) : 2u;
+    const u32 dither_x = (dithering_enable) ? (x & 3u) : 3u;
+
+    // Non-textured transparent polygons don't set bit 15, but are treated as transparent.
+    color = (ZeroExtend16(g_dither_lut[dither_y][dither_x][color_r]) << 0) |
+            (ZeroExtend16(g_dither_lut[dither_y][dither_x][color_g]) << 5) |
+            (ZeroExtend16(g_dither_lut[dither_y][dither_x][color_b]) << 10) | (transparency_enable ? 0x8000u : 0);
+  }
+
+  u16* const pixel_ptr = &vram[VRAM_WIDTH * y + x];
+  const u16 bg_color = *pixel_ptr;
+  if constexpr (transparency_enable)
+  {
+    if (color & 0x8000u || !texture_enable)
+    {
+      // Based on blargg's efficient 15bpp pixel math.
+      u32 bg_bits = ZeroExtend32(bg_color);
+      u32 fg_bits = ZeroExtend32(color);
+      switch (cmd->draw_mode.transparency_mode)
+      {
+        case GPUTransparencyMode::HalfBackgroundPlusHalfForeground:
+        {
+          bg_bits |= 0x8000u;
+          color = Truncate16(((fg_bits + bg_bits) - ((fg_bits ^ bg_bits) & 0x0421u)) >> 1);
+        }
+        break;
+
+        case GPUTransparencyMode::BackgroundPlusForeground:
+        {
+          bg_bits &= ~0x8000u;
+
+          const u32 sum = fg_bits + bg_bits;
+          const u32 carry = (sum - ((fg_bits ^ bg_bits) & 0x8421u)) & 0x8420u;
+
+          color = Truncate16((sum - carry) | (carry - (carry >> 5)));
+        }
+        break;
+
+        case GPUTransparencyMode::BackgroundMinusForeground:
+        {
+          bg_bits |= 0x8000u;
+          fg_bits &= ~0x8000u;
+
+          const u32 diff = bg_bits - fg_bits + 0x108420u;
+          const u32 borrow = (diff - ((bg_bits ^ fg_bits) & 0x108420u)) & 0x108420u;
+
+          color = Truncate16((diff - borrow) & (borrow - (borrow >> 5)));
+        }
+        break;
+
+        case GPUTransparencyMode::BackgroundPlusQuarterForeground:
+        {
+          bg_bits &= ~0x8000u;
+          fg_bits = ((fg_bits >> 2) & 0x1CE7u) | 0x8000u;
+
+          const u32 sum = fg_bits + bg_bits;
+          const u32 carry = (sum - ((fg_bits ^ bg_bits) & 0x8421u)) & 0x8420u;
+
+          color = Truncate16((sum - carry) | (carry - (carry >> 5)));
+        }
+        break;
+
+        default:
+          break;
+      }
+
+      // See above.
+      if constexpr (!texture_enable)
+        color &= ~0x8000u;
+    }
+  }
+
+  const u16 mask_and = cmd->params.GetMaskAND();
+  if ((bg_color & mask_and) != 0)
+    return;
+
+  *pixel_ptr = color | cmd->params.GetMaskOR();
+}
+
+template<bool shading_enable, bool texture_enable, bool raw_texture_enable, bool transparency_enable,
+         bool dithering_enable>
+ALWAYS_INLINE_RELEASE static void DrawSpanScalar(u16* vram, const GPUBackendDrawCommand* cmd, u32 x, u32 y, u32 width,
+                                                 SpanInterpolants ig, const SpanInterpolants& step)
+{
+  for (; width > 0; width--, x++)
+  {
+    ShadePixel<texture_enable, raw_texture_enable, transparency_enable, dithering_enable>(
+      vram, cmd, x, y, Truncate8(ig.r >> SPAN_FRACTIONAL_BITS), Truncate8(ig.g >> SPAN_FRACTIONAL_BITS),
+      Truncate8(ig.b >> SPAN_FRACTIONAL_BITS), Truncate8(ig.u >> SPAN_FRACTIONAL_BITS),
+      Truncate8(ig.v >> SPAN_FRACTIONAL_BITS));
+
+    if constexpr (shading_enable)
+    {
+      ig.r += step.r;
+      ig.g += step.g;
+      ig.b += step.b;
+    }
+
+    if constexpr (texture_enable)
+    {
+      ig.u += step.u;
+      ig.v += step.v;
+    }
+  }
+}
+
+#ifdef GPU_SW_RASTERIZER_VECTOR
+
+namespace Vector {
+
+static constexpr u32 PIXELS_PER_VECTOR = 8;
+
+#if defined(CPU_ARCH_SSE)
+
+using U16 = __m128i;
+using U32 = __m128i;
+
+ALWAYS_INLINE static U16 Set1U16(u16 value)
+{
+  return _mm_set1_epi16(static_cast<s16>(value));
+}
+ALWAYS_INLINE static U16 LoadU16(const u16* ptr)
+{
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+}
+ALWAYS_INLINE static void StoreU16(u16* ptr, U16 value)
+{
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), value);
+}
+ALWAYS_INLINE static U16 AddU16(U16 lhs, U16 rhs)
+{
+  return _mm_add_epi16(lhs, rhs);
+}
+ALWAYS_INLINE static U16 SubU16(U16 lhs, U16 rhs)
+{
+  return _mm_sub_epi16(lhs, rhs);
+}
+ALWAYS_INLINE static U16 MulU16(U16 lhs, U16 rhs)
+{
+  return _mm_mullo_epi16(lhs, rhs);
+}
+ALWAYS_INLINE static U16 And(U16 lhs, U16 rhs)
+{
+  return _mm_and_si128(lhs, rhs);
+}
+ALWAYS_INLINE static U16 Or(U16 lhs, U16 rhs)
+{
+  return _mm_or_si128(lhs, rhs);
+}
+ALWAYS_INLINE static U16 Not(U16 value)
+{
+  return _mm_xor_si128(value, _mm_set1_epi32(-1));
+}
+ALWAYS_INLINE static U16 Select(U16 mask, U16 if_true, U16 if_false)
+{
+  return _mm_or_si128(_mm_and_si128(mask, if_true), _mm_andnot_si128(mask, if_false));
+}
+ALWAYS_INLINE static U16 CompareEqU16(U16 lhs, U16 rhs)
+{
+  return _mm_cmpeq_epi16(lhs, rhs);
+}
+ALWAYS_INLINE static U16 MinS16(U16 lhs, U16 rhs)
+{
+  return _mm_min_epi16(lhs, rhs);
+}
+ALWAYS_INLINE static U16 MaxS16(U16 lhs, U16 rhs)
+{
+  return _mm_max_epi16(lhs, rhs);
+}
+template<int n>
+ALWAYS_INLINE static U16 ShiftLeftU16(U16 value)
+{
+  return _mm_slli_epi16(value, n);
+}
+template<int n>
+ALWAYS_INLINE static U16 ShiftRightU16(U16 value)
+{
+  return _mm_srli_epi16(value, n);
+}
+template<int n>
+ALWAYS_INLINE static U16 ShiftRightS16(U16 value)
+{
+  return _mm_srai_epi16(value, n);
+}
+
+ALWAYS_INLINE static U32 Set1U32(u32 value)
+{
+  return _mm_set1_epi32(static_cast<s32>(value));
+}
+ALWAYS_INLINE static U32 SetU32(u32 v0, u32 v1, u32 v2, u32 v3)
+{
+  return _mm_setr_epi32(static_cast<s32>(v0), static_cast<s32>(v1), static_cast<s32>(v2), static_cast<s32>(v3));
+}
+ALWAYS_INLINE static U32 AddU32(U32 lhs, U32 rhs)
+{
+  return _mm_add_epi32(lhs, rhs);
+}
+
+/// Returns the integer part of two vectors of interpolants, as eight 16-bit lanes.
+ALWAYS_INLINE static U16 PackInterpolants(U32 lo, U32 hi)
+{
+  return _mm_packs_epi32(_mm_srli_epi32(lo, SPAN_FRACTIONAL_BITS), _mm_srli_epi32(hi, SPAN_FRACTIONAL_BITS));
+}
+
+#elif defined(CPU_ARCH_NEON)
+
+using U16 = uint16x8_t;
+using U32 = uint32x4_t;
+
+ALWAYS_INLINE static U16 Set1U16(u16 value)
+{
+  return vdupq_n_u16(value);
+}
+ALWAYS_INLINE static U16 LoadU16(const u16* ptr)
+{
+  return vld1q_u16(ptr);
+}
+ALWAYS_INLINE static void StoreU16(u16* ptr, U16 value)
+{
+  vst1q_u16(ptr, value);
+}
+ALWAYS_INLINE static U16 AddU16(U16 lhs, U16 rhs)
+{
+  return vaddq_u16(lhs, rhs);
+}
+ALWAYS_INLINE static U16 SubU16(U16 lhs, U16 rhs)
+{
+  return vsubq_u16(lhs, rhs);
+}
+ALWAYS_INLINE static U16 MulU16(U16 lhs, U16 rhs)
+{
+  return vmulq_u16(lhs, rhs);
+}
+ALWAYS_INLINE static U16 And(U16 lhs, U16 rhs)
+{
+  return vandq_u16(lhs, rhs);
+}
+ALWAYS_INLINE static U16 Or(U16 lhs, U16 rhs)
+{
+  return vorrq_u16(lhs, rhs);
+}
+ALWAYS_INLINE static U16 Not(U16 value)
+{
+  return vmvnq_u16(value);
+}
+ALWAYS_INLINE static U16 Select(U16 mask, U16 if_true, U16 if_false)
+{
+  return vbslq_u16(mask, if_true, if_false);
+}
+ALWAYS_INLINE static U16 CompareEqU16(U16 lhs, U16 rhs)
+{
+  return vceqq_u16(lhs, rhs);
+}
+ALWAYS_INLINE static U16 MinS16(U16 lhs, U16 rhs)
+{
+  return vreinterpretq_u16_s16(vminq_s16(vreinterpretq_s16_u16(lhs), vreinterpretq_s16_u16(rhs)));
+}
+ALWAYS_INLINE static U16 MaxS16(U16 lhs, U16 rhs)
+{
+  return vreinterpretq_u16_s16(vmaxq_s16(vreinterpretq_s16_u16(lhs), vreinterpretq_s16_u16(rhs)));
+}
+template<int n>
+ALWAYS_INLINE static U16 ShiftLeftU16(U16 value)
+{
+  return vshlq_n_u16(value, n);
+}
+template<int n>
+ALWAYS_INLINE static U16 ShiftRightU16(U16 value)
+{
+  return vshrq_n_u16(value, n);
+}
+template<int n>
+ALWAYS_INLINE static U16 ShiftRightS16(U16 value)
+{
+  return vreinterpretq_u16_s16(vshrq_n_s16(vreinterpretq_s16_u16(value), n));
+}
+
+ALWAYS_INLINE static U32 Set1U32(u32 value)
+{
+  return vdupq_n_u32(value);
+}
+ALWAYS_INLINE static U32 SetU32(u32 v0, u32 v1, u32 v2, u32 v3)
+{
+  alignas(16) const u32 values[4] = {v0, v1, v2, v3};
+  return vld1q_u32(values);
+}
+ALWAYS_INLINE static U32 AddU32(U32 lhs, U32 rhs)
+{
+  return vaddq_u32(lhs, rhs);
+}
+
+/// Returns the integer part of two vectors of interpolants, as eight 16-bit lanes.
+ALWAYS_INLINE static U16 PackInterpolants(U32 lo, U32 hi)
+{
+  return vshrq_n_u16(vcombine_u16(vshrn_n_u32(lo, 16), vshrn_n_u32(hi, 16)), SPAN_FRACTIONAL_BITS - 16);
+}
+
+#endif
+
+/// One interpolated attribute for eight consecutive pixels.
+struct Interpolant
+{
+  U32 lo, hi, step;
+
+  ALWAYS_INLINE void Init(u32 start, u32 pixel_step)
+  {
+    lo = SetU32(start, start + pixel_step, start + pixel_step * 2, start + pixel_step * 3);
+    hi = AddU32(lo, Set1U32(pixel_step * 4));
+    step = Set1U32(pixel_step * PIXELS_PER_VECTOR);
+  }
+
+  ALWAYS_INLINE U16 Get() const { return PackInterpolants(lo, hi); }
+
+  ALWAYS_INLINE void Step()
+  {
+    lo = AddU32(lo, step);
+    hi = AddU32(hi, step);
+  }
+};
+
+} // namespace Vector
+
+#endif // GPU_SW_RASTERIZER_VECTOR
+
+/// Returns true if a textured span can sample its own output, i.e. the texture page or CLUT overlaps the span.
+/// The vector path fetches a whole block of texels before writing, so these spans must be drawn pixel by pixel.
+ALWAYS_INLINE_RELEASE static bool SpanSamplesItself(const GPUBackendDrawCommand* cmd, u32 x, u32 y, u32 width)
+{
+  // Reads wrap around the right edge of VRAM, spans never do.
+  const auto overlaps = [x, width](u32 start, u32 count) {
+    const u32 end = start + count;
+    return (start < (x + width) && end > x) || (end > VRAM_WIDTH && (end - VRAM_WIDTH) > x);
+  };
+
+  const u32 page_y = cmd->draw_mode.GetTexturePageBaseY();
+  if (y >= page_y && y < (page_y + TEXTURE_PAGE_HEIGHT))
+  {
+    const Common::Rectangle<u32> page = cmd->draw_mode.GetTexturePageRectangle();
+    if (overlaps(page.left, page.GetWidth()))
+      return true;
+  }
+
+  if (cmd->draw_mode.IsUsingPalette() && y == cmd->palette.GetYBase())
+  {
+    const u32 palette_width = (cmd->draw_mode.texture_mode == GPUTextureMode::Palette4Bit) ? 16 : 256;
+    if (overlaps(cmd->palette.GetXBase(), palette_width))
+      return true;
+  }
+
+  return false;
+}
+
+template<bool shading_enable, bool texture_enable, bool raw_texture_enable, bool transparency_enable,
+         bool dithering_enable>
+static void DrawSpan(u16* vram, const GPUBackendDrawCommand* cmd, u32 x, u32 y, u32 width, SpanInterpolants ig,
+                     const SpanInterpolants& step)
+{
+#ifdef GPU_SW_RASTERIZER_VECTOR
+  using namespace Vector;
+
+  if (width >= PIXELS_PER_VECTOR && (!texture_enable || !SpanSamplesItself(cmd, x, y, width)))
+  {
+    Interpolant vr, vg, vb, vu, vv;
+    const U16 sr = Set1U16(Truncate8(ig.r >> SPAN_FRACTIONAL_BITS));
+    const U16 sg = Set1U16(Truncate8(ig.g >> SPAN_FRACTIONAL_BITS));
+    const U16 sb = Set1U16(Truncate8(ig.b >> SPAN_FRACTIONAL_BITS));
+    if constexpr (shading_enable)
+    {
+      vr.Init(ig.r, step.r);
+      vg.Init(ig.g, step.g);
+      vb.Init(ig.b, step.b);
+    }
+    if constexpr (texture_enable)
+    {
+      vu.Init(ig.u, step.u);
+      vv.Init(ig.v, step.v);
+    }
+
+    // x advances by a multiple of four, so the dither pattern is the same for every block in the span.
+    U16 dither_offsets;
+    if constexpr (dithering_enable)
+    {
+      alignas(16) u16 offsets[PIXELS_PER_VECTOR];
+      for (u32 i = 0; i < PIXELS_PER_VECTOR; i++)
+        offsets[i] = static_cast<u16>(DITHER_MATRIX[y & 3u][(x + i) & 3u]);
+      dither_offsets = LoadU16(offsets);
+    }
+    else
+    {
+      dither_offsets = Set1U16(static_cast<u16>(DITHER_MATRIX[2][3]));
+    }
+
+    const U16 zero = Set1U16(0);
+    const U16 all_ones = Set1U16(0xFFFFu);
+    const U16 five_bits = Set1U16(0x1Fu);
+    const U16 mask_and = Set1U16(cmd->params.GetMaskAND());
+    const U16 mask_or = Set1U16(cmd->params.GetMaskOR());
+    const auto dither = [&](U16 value) {
+      return MinS16(MaxS16(ShiftRightS16<3>(AddU16(value, dither_offsets)), zero), five_bits);
+    };
+
+    u16* pixel_ptr = &vram[VRAM_WIDTH * y + x];
+    u32 pixels_done = 0;
+    do
+    {
+      U16 r = sr, g = sg, b = sb;
+      if constexpr (shading_enable)
+      {
+        r = vr.Get();
+        g = vg.Get();
+        b = vb.Get();
+      }
+
+      U16 write_mask = all_ones;
+      U16 fg_r, fg_g, fg_b, fg_top;
+      if constexpr (texture_enable)
+      {
+        // No gathers in SSE2/NEON, so the texel and CLUT lookups are scalar.
+        alignas(16) u16 texcoord_x[PIXELS_PER_VECTOR];
+        alignas(16) u16 texcoord_y[PIXELS_PER_VECTOR];
+        alignas(16) u16 texels[PIXELS_PER_VECTOR];
+        StoreU16(texcoord_x, Or(And(vu.Get(), Set1U16(cmd->window.and_x)), Set1U16(cmd->window.or_x)));
+        StoreU16(texcoord_y, Or(And(vv.Get(), Set1U16(cmd->window.and_y)), Set1U16(cmd->window.or_y)));
+        for (u32 i = 0; i < PIXELS_PER_VECTOR; i++)
+          texels[i] = GetTexturePixel(vram, cmd, static_cast<u8>(texcoord_x[i]), static_cast<u8>(texcoord_y[i]));
+
+        const U16 texel = LoadU16(texels);
+        write_mask = Not(CompareEqU16(texel, zero));
+        fg_r = And(texel, five_bits);
+        fg_g = And(ShiftRightU16<5>(texel), five_bits);
+        fg_b = And(ShiftRightU16<10>(texel), five_bits);
+        fg_top = And(texel, Set1U16(0x8000u));
+        if constexpr (!raw_texture_enable)
+        {
+          fg_r = dither(ShiftRightU16<4>(MulU16(fg_r, r)));
+          fg_g = dither(ShiftRightU16<4>(MulU16(fg_g, g)));
+          fg_b = dither(ShiftRightU16<4>(MulU16(fg_b, b)));
+        }
+      }
+      else
+      {
+        // Non-textured transparent polygons are always blended, but don't set bit 15.
+        fg_r = dither(r);
+        fg_g = dither(g);
+        fg_b = dither(b);
+        fg_top = zero;
+      }
+
+      const U16 bg = LoadU16(pixel_ptr);
+      if constexpr (transparency_enable)
+      {
+        // With the foreground's bit 15 set, blargg's packed math reduces to these per-channel operations.
+        const U16 bg_r = And(bg, five_bits);
+        const U16 bg_g = And(ShiftRightU16<5>(bg), five_bits);
+        const U16 bg_b = And(ShiftRightU16<10>(bg), five_bits);
+        U16 blend_r, blend_g, blend_b;
+        switch (cmd->draw_mode.transparency_mode)
+        {
+          case GPUTransparencyMode::HalfBackgroundPlusHalfForeground:
+          {
+            blend_r = ShiftRightU16<1>(AddU16(bg_r, fg_r));
+            blend_g = ShiftRightU16<1>(AddU16(bg_g, fg_g));
+            blend_b = ShiftRightU16<1>(AddU16(bg_b, fg_b));
+          }
+          break;
+
+          case GPUTransparencyMode::BackgroundPlusForeground:
+          {
+            blend_r = MinS16(AddU16(bg_r, fg_r), five_bits);
+            blend_g = MinS16(AddU16(bg_g, fg_g), five_bits);
+            blend_b = MinS16(AddU16(bg_b, fg_b), five_bits);
+          }
+          break;
+
+          case GPUTransparencyMode::BackgroundMinusForeground:
+          {
+            blend_r = MaxS16(SubU16(bg_r, fg_r), zero);
+            blend_g = MaxS16(SubU16(bg_g, fg_g), zero);
+            blend_b = MaxS16(SubU16(bg_b, fg_b), zero);
+          }
+          break;
+
+          case GPUTransparencyMode::BackgroundPlusQuarterForeground:
+          default:
+          {
+            blend_r = MinS16(AddU16(bg_r, ShiftRightU16<2>(fg_r)), five_bits);
+            blend_g = MinS16(AddU16(bg_g, ShiftRightU16<2>(fg_g)), five_bits);
+            blend_b = MinS16(AddU16(bg_b, ShiftRightU16<2>(fg_b)), five_bits);
+          }
+          break;
+        }
+
+        if constexpr (texture_enable)
+        {
+          const U16 blend_mask = Not(CompareEqU16(fg_top, zero));
+          fg_r = Select(blend_mask, blend_r, fg_r);
+          fg_g = Select(blend_mask, blend_g, fg_g);
+          fg_b = Select(blend_mask, blend_b, fg_b);
+        }
+        else
+        {
+          fg_r = blend_r;
+          fg_g = blend_g;
+          fg_b = blend_b;
+        }
+      }
+
+      const U16 color = Or(Or(Or(fg_r, ShiftLeftU16<5>(fg_g)), ShiftLeftU16<10>(fg_b)), Or(fg_top, mask_or));
+      write_mask = And(write_mask, CompareEqU16(And(bg, mask_and), zero));
+      StoreU16(pixel_ptr, Select(write_mask, color, bg));
+
+      if constexpr (shading_enable)
+      {
+        vr.Step();
+        vg.Step();
+        vb.Step();
+      }
+      if constexpr (texture_enable)
+      {
+        vu.Step();
+        vv.Step();
+      }
+
+      pixel_ptr += PIXELS_PER_VECTOR;
+      pixels_done += PIXELS_PER_VECTOR;
+      width -= PIXELS_PER_VECTOR;
+    } while (width >= PIXELS_PER_VECTOR);
+
+    if (width == 0)
+      return;
+
+    // Finish off the remaining pixels with the scalar path.
+    x += pixels_done;
+    if constexpr (shading_enable)
+    {
+      ig.r += step.r * pixels_done;
+      ig.g += step.g * pixels_done;
+      ig.b += step.b * pixels_done;
+    }
+    if constexpr (texture_enable)
+    {
+      ig.u += step.u * pixels_done;
+      ig.v += step.v * pixels_done;
+    }
+  }
+#endif
+
+  DrawSpanScalar<shading_enable, texture_enable, raw_texture_enable, transparency_enable, dithering_enable>(
+    vram, cmd, x, y, width, ig, step);
+}
+
+} // namespace GPU_SW_Rasterizer
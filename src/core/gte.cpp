@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
 
 #include "gte.h"
+#include "gte_kernels.h"
 
 #include "cpu_core.h"
 #include "cpu_core_private.h"
@@ -475,38 +476,25 @@ ALWAYS_INLINE static u32 UNRDivide(u32 lhs, u32 rhs)
   return std::min<u32>(0x1FFFF, result);
 }
 
-static void MulMatVec(const s16* M_, const s16 Vx, const s16 Vy, const s16 Vz, u8 shift, bool lm)
+ALWAYS_INLINE static void SetMACAndIR(const GTE_Kernels::MatVecResult& res, u32 flags)
 {
-#define M(i, j) M_[((i)*3) + (j)]
-#define dot3(i)                                                                                                        \
-  TruncateAndSetMACAndIR<i + 1>(SignExtendMACResult<i + 1>((s64(M(i, 0)) * s64(Vx)) + (s64(M(i, 1)) * s64(Vy))) +      \
-                                  (s64(M(i, 2)) * s64(Vz)),                                                            \
-                                shift, lm)
+  REGS.MAC1 = res.mac[0];
+  REGS.MAC2 = res.mac[1];
+  REGS.MAC3 = res.mac[2];
 
-  dot3(0);
-  dot3(1);
-  dot3(2);
+  // store sign-extended 16-bit values as 32-bit
+  REGS.dr32[9] = res.ir[0];
+  REGS.dr32[10] = res.ir[1];
+  REGS.dr32[11] = res.ir[2];
 
-#undef dot3
-#undef M
+  REGS.FLAG.bits |= flags;
 }
 
-static void MulMatVec(const s16* M_, const s32 T[3], const s16 Vx, const s16 Vy, const s16 Vz, u8 shift, bool lm)
+static void MulMatVec(const s16* M, const s32 T[3], const s16 V[3], u8 shift, bool lm)
 {
-#define M(i, j) M_[((i)*3) + (j)]
-#define dot3(i)                                                                                                        \
-  TruncateAndSetMACAndIR<i + 1>(                                                                                       \
-    SignExtendMACResult<i + 1>(SignExtendMACResult<i + 1>((s64(T[i]) << 12) + (s64(M(i, 0)) * s64(Vx))) +              \
-                               (s64(M(i, 1)) * s64(Vy))) +                                                             \
-      (s64(M(i, 2)) * s64(Vz)),                                                                                        \
-    shift, lm)
-
-  dot3(0);
-  dot3(1);
-  dot3(2);
-
-#undef dot3
-#undef M
+  GTE_Kernels::MatVecResult res;
+  GTE_Kernels::MulMatVec<1>(&res, M, T, &V, shift, lm);
+  SetMACAndIR(res, res.flags);
 }
 
 static void MulMatVecBuggy(const s16* M_, const s32 T[3], const s16 Vx, const s16 Vy, const s16 Vz, u8 shift, bool lm)
@@ -569,9 +557,14 @@ static void Execute_MVMVA(Instruction inst)
   const s16 Vy = *V[1];
   const s16 Vz = *V[2];
   if (inst.mvmva_translation_vector != 2)
-    MulMatVec(M, T, Vx, Vy, Vz, inst.GetShift(), inst.lm);
+  {
+    const s16 Vxyz[3] = {Vx, Vy, Vz};
+    MulMatVec(M, T, Vxyz, inst.GetShift(), inst.lm);
+  }
   else
+  {
     MulMatVecBuggy(M, T, Vx, Vy, Vz, inst.GetShift(), inst.lm);
+  }
 
   REGS.FLAG.UpdateError();
 }
@@ -617,34 +610,21 @@ static void Execute_OP(Instruction inst)
   REGS.FLAG.UpdateError();
 }
 
-static void RTPS(const s16 V[3], u8 shift, bool lm, bool last)
+static void RTPS(const GTE_Kernels::MatVecResult& res, const s16 V[3], u8 shift, bool lm, bool last)
 {
-#define dot3(i)                                                                                                        \
-  SignExtendMACResult<i + 1>(SignExtendMACResult<i + 1>((s64(REGS.TR[i]) << 12) + (s64(REGS.RT[i][0]) * s64(V[0]))) +  \
-                             (s64(REGS.RT[i][1]) * s64(V[1]))) +                                                       \
-    (s64(REGS.RT[i][2]) * s64(V[2]))
-
   // IR1 = MAC1 = (TRX*1000h + RT11*VX0 + RT12*VY0 + RT13*VZ0) SAR (sf*12)
   // IR2 = MAC2 = (TRY*1000h + RT21*VX0 + RT22*VY0 + RT23*VZ0) SAR (sf*12)
   // IR3 = MAC3 = (TRZ*1000h + RT31*VX0 + RT32*VY0 + RT33*VZ0) SAR (sf*12)
-  const s64 x = dot3(0);
-  const s64 y = dot3(1);
-  const s64 z = dot3(2);
-  TruncateAndSetMAC<1>(x, shift);
-  TruncateAndSetMAC<2>(y, shift);
-  TruncateAndSetMAC<3>(z, shift);
-  TruncateAndSetIR<1>(REGS.MAC1, lm);
-  TruncateAndSetIR<2>(REGS.MAC2, lm);
-
   // The command does saturate IR1,IR2,IR3 to -8000h..+7FFFh (regardless of lm bit). When using RTP with sf=0, then the
   // IR3 saturation flag (FLAG.22) gets set <only> if "MAC3 SAR 12" exceeds -8000h..+7FFFh (although IR3 is saturated
   // when "MAC3" exceeds -8000h..+7FFFh).
-  TruncateAndSetIR<3>(s32(z >> 12), false);
-  REGS.dr32[11] = std::clamp(REGS.MAC3, lm ? 0 : IR123_MIN_VALUE, IR123_MAX_VALUE);
-#undef dot3
+  const u32 ir3_saturated = (res.mac3_sar12 < IR123_MIN_VALUE || res.mac3_sar12 > IR123_MAX_VALUE) ?
+                              GTE_Kernels::FLAG_IR3_SATURATED :
+                              0u;
+  SetMACAndIR(res, (res.flags & ~GTE_Kernels::FLAG_IR3_SATURATED) | ir3_saturated);
 
   // SZ3 = MAC3 SAR ((1-sf)*12)                           ;ScreenZ FIFO 0..+FFFFh
-  PushSZ(s32(z >> 12));
+  PushSZ(res.mac3_sar12);
 
   // MAC0=(((H*20000h/SZ3)+1)/2)*IR1+OFX, SX2=MAC0/10000h ;ScrX FIFO -400h..+3FFh
   // MAC0=(((H*20000h/SZ3)+1)/2)*IR2+OFY, SY2=MAC0/10000h ;ScrY FIFO -400h..+3FFh
@@ -691,6 +671,11 @@ static void RTPS(const s16 V[3], u8 shift, bool lm, bool last)
 
     if (g_settings.gpu_pgxp_preserve_proj_fp)
     {
+      // Flags were already set from the same sums.
+      u32 unused_flags = 0;
+      const s64 x = GTE_Kernels::DotRowScalar(REGS.RT[0], REGS.TR[0], V, 0, unused_flags);
+      const s64 y = GTE_Kernels::DotRowScalar(REGS.RT[1], REGS.TR[1], V, 1, unused_flags);
+      const s64 z = GTE_Kernels::DotRowScalar(REGS.RT[2], REGS.TR[2], V, 2, unused_flags);
       precise_sz3 = float(z) / 4096.0f;
       precise_ir1 = float(x) / (static_cast<float>(1 << shift));
       precise_ir2 = float(y) / (static_cast<float>(1 << shift));
@@ -766,7 +751,15 @@ static void RTPS(const s16 V[3], u8 shift, bool lm, bool last)
 static void Execute_RTPS(Instruction inst)
 {
   REGS.FLAG.Clear();
-  RTPS(REGS.V0, inst.GetShift(), inst.lm, true);
+
+  const u8 shift = inst.GetShift();
+  const bool lm = inst.lm;
+  const s16* const V[1] = {REGS.V0};
+
+  GTE_Kernels::MatVecResult res;
+  GTE_Kernels::MulMatVec<1>(&res, &REGS.RT[0][0], REGS.TR, V, shift, lm);
+  RTPS(res, REGS.V0, shift, lm, true);
+
   REGS.FLAG.UpdateError();
 }
 
@@ -777,9 +770,14 @@ static void Execute_RTPT(Instruction inst)
   const u8 shift = inst.GetShift();
   const bool lm = inst.lm;
 
-  RTPS(REGS.V0, shift, lm, false);
-  RTPS(REGS.V1, shift, lm, false);
-  RTPS(REGS.V2, shift, lm, true);
+  const s16* const V[3] = {REGS.V0, REGS.V1, REGS.V2};
+
+  // The products don't depend on anything the projections write, so all three vertices can be transformed at once.
+  GTE_Kernels::MatVecResult res[3];
+  GTE_Kernels::MulMatVec<3>(res, &REGS.RT[0][0], REGS.TR, V, shift, lm);
+  RTPS(res[0], REGS.V0, shift, lm, false);
+  RTPS(res[1], REGS.V1, shift, lm, false);
+  RTPS(res[2], REGS.V2, shift, lm, true);
 
   REGS.FLAG.UpdateError();
 }
@@ -847,13 +845,35 @@ static ALWAYS_INLINE void InterpolateColor(s64 in_MAC1, s64 in_MAC2, s64 in_MAC3
   TruncateAndSetMACAndIR<3>(s64(s32(REGS.IR3) * s32(REGS.IR0)) + in_MAC3, shift, lm);
 }
 
-static void NCS(const s16 V[3], u8 shift, bool lm)
+template<u32 count>
+static void LightVertices(GTE_Kernels::MatVecResult* results, const s16* const* V, u8 shift, bool lm)
 {
+  static constexpr s32 zero_T[3] = {};
+
   // [IR1,IR2,IR3] = [MAC1,MAC2,MAC3] = (LLM*V0) SAR (sf*12)
-  MulMatVec(&REGS.LLM[0][0], V[0], V[1], V[2], shift, lm);
+  GTE_Kernels::MatVecResult llm_results[count];
+  GTE_Kernels::MulMatVec<count>(llm_results, &REGS.LLM[0][0], zero_T, V, shift, lm);
+
+  s16 IR[count][3];
+  const s16* IR_ptrs[count];
+  for (u32 i = 0; i < count; i++)
+  {
+    IR[i][0] = static_cast<s16>(llm_results[i].ir[0]);
+    IR[i][1] = static_cast<s16>(llm_results[i].ir[1]);
+    IR[i][2] = static_cast<s16>(llm_results[i].ir[2]);
+    IR_ptrs[i] = IR[i];
+    REGS.FLAG.bits |= llm_results[i].flags;
+  }
 
   // [IR1,IR2,IR3] = [MAC1,MAC2,MAC3] = (BK*1000h + LCM*IR) SAR (sf*12)
-  MulMatVec(&REGS.LCM[0][0], REGS.BK, REGS.IR1, REGS.IR2, REGS.IR3, shift, lm);
+  // Each vertex only depends on its own intermediate IR, so the vertices of NCT/NCCT/NCDT are lit together, and the
+  // remaining per-vertex steps start from the result.
+  GTE_Kernels::MulMatVec<count>(results, &REGS.LCM[0][0], REGS.BK, IR_ptrs, shift, lm);
+}
+
+static void NCS(const GTE_Kernels::MatVecResult& light)
+{
+  SetMACAndIR(light, light.flags);
 
   // Color FIFO = [MAC1/16,MAC2/16,MAC3/16,CODE], [IR1,IR2,IR3] = [MAC1,MAC2,MAC3]
   PushRGBFromMAC();
@@ -863,7 +883,13 @@ static void Execute_NCS(Instruction inst)
 {
   REGS.FLAG.Clear();
 
-  NCS(REGS.V0, inst.GetShift(), inst.lm);
+  const u8 shift = inst.GetShift();
+  const bool lm = inst.lm;
+  const s16* const V[1] = {REGS.V0};
+
+  GTE_Kernels::MatVecResult light;
+  LightVertices<1>(&light, V, shift, lm);
+  NCS(light);
 
   REGS.FLAG.UpdateError();
 }
@@ -875,20 +901,20 @@ static void Execute_NCT(Instruction inst)
   const u8 shift = inst.GetShift();
   const bool lm = inst.lm;
 
-  NCS(REGS.V0, shift, lm);
-  NCS(REGS.V1, shift, lm);
-  NCS(REGS.V2, shift, lm);
+  const s16* const V[3] = {REGS.V0, REGS.V1, REGS.V2};
+
+  GTE_Kernels::MatVecResult light[3];
+  LightVertices<3>(light, V, shift, lm);
+  NCS(light[0]);
+  NCS(light[1]);
+  NCS(light[2]);
 
   REGS.FLAG.UpdateError();
 }
 
-static void NCCS(const s16 V[3], u8 shift, bool lm)
+static void NCCS(const GTE_Kernels::MatVecResult& light, u8 shift, bool lm)
 {
-  // [IR1,IR2,IR3] = [MAC1,MAC2,MAC3] = (LLM*V0) SAR (sf*12)
-  MulMatVec(&REGS.LLM[0][0], V[0], V[1], V[2], shift, lm);
-
-  // [IR1,IR2,IR3] = [MAC1,MAC2,MAC3] = (BK*1000h + LCM*IR) SAR (sf*12)
-  MulMatVec(&REGS.LCM[0][0], REGS.BK, REGS.IR1, REGS.IR2, REGS.IR3, shift, lm);
+  SetMACAndIR(light, light.flags);
 
   // [MAC1,MAC2,MAC3] = [R*IR1,G*IR2,B*IR3] SHL 4          ;<--- for NCDx/NCCx
   // [MAC1,MAC2,MAC3] = [MAC1,MAC2,MAC3] SAR (sf*12)       ;<--- for NCDx/NCCx
@@ -904,7 +930,13 @@ static void Execute_NCCS(Instruction inst)
 {
   REGS.FLAG.Clear();
 
-  NCCS(REGS.V0, inst.GetShift(), inst.lm);
+  const u8 shift = inst.GetShift();
+  const bool lm = inst.lm;
+  const s16* const V[1] = {REGS.V0};
+
+  GTE_Kernels::MatVecResult light;
+  LightVertices<1>(&light, V, shift, lm);
+  NCCS(light, shift, lm);
 
   REGS.FLAG.UpdateError();
 }
@@ -916,20 +948,20 @@ static void Execute_NCCT(Instruction inst)
   const u8 shift = inst.GetShift();
   const bool lm = inst.lm;
 
-  NCCS(REGS.V0, shift, lm);
-  NCCS(REGS.V1, shift, lm);
-  NCCS(REGS.V2, shift, lm);
+  const s16* const V[3] = {REGS.V0, REGS.V1, REGS.V2};
+
+  GTE_Kernels::MatVecResult light[3];
+  LightVertices<3>(light, V, shift, lm);
+  NCCS(light[0], shift, lm);
+  NCCS(light[1], shift, lm);
+  NCCS(light[2], shift, lm);
 
   REGS.FLAG.UpdateError();
 }
 
-static void NCDS(const s16 V[3], u8 shift, bool lm)
+static void NCDS(const GTE_Kernels::MatVecResult& light, u8 shift, bool lm)
 {
-  // [IR1,IR2,IR3] = [MAC1,MAC2,MAC3] = (LLM*V0) SAR (sf*12)
-  MulMatVec(&REGS.LLM[0][0], V[0], V[1], V[2], shift, lm);
-
-  // [IR1,IR2,IR3] = [MAC1,MAC2,MAC3] = (BK*1000h + LCM*IR) SAR (sf*12)
-  MulMatVec(&REGS.LCM[0][0], REGS.BK, REGS.IR1, REGS.IR2, REGS.IR3, shift, lm);
+  SetMACAndIR(light, light.flags);
 
   // No need to assign these to MAC[1-3], as it'll never overflow.
   // [MAC1,MAC2,MAC3] = [R*IR1,G*IR2,B*IR3] SHL 4          ;<--- for NCDx/NCCx
@@ -948,7 +980,13 @@ static void Execute_NCDS(Instruction inst)
 {
   REGS.FLAG.Clear();
 
-  NCDS(REGS.V0, inst.GetShift(), inst.lm);
+  const u8 shift = inst.GetShift();
+  const bool lm = inst.lm;
+  const s16* const V[1] = {REGS.V0};
+
+  GTE_Kernels::MatVecResult light;
+  LightVertices<1>(&light, V, shift, lm);
+  NCDS(light, shift, lm);
 
   REGS.FLAG.UpdateError();
 }
@@ -960,9 +998,13 @@ static void Execute_NCDT(Instruction inst)
   const u8 shift = inst.GetShift();
   const bool lm = inst.lm;
 
-  NCDS(REGS.V0, shift, lm);
-  NCDS(REGS.V1, shift, lm);
-  NCDS(REGS.V2, shift, lm);
+  const s16* const V[3] = {REGS.V0, REGS.V1, REGS.V2};
+
+  GTE_Kernels::MatVecResult light[3];
+  LightVertices<3>(light, V, shift, lm);
+  NCDS(light[0], shift, lm);
+  NCDS(light[1], shift, lm);
+  NCDS(light[2], shift, lm);
 
   REGS.FLAG.UpdateError();
 }
@@ -975,7 +1017,8 @@ static void Execute_CC(Instruction inst)
   const bool lm = inst.lm;
 
   // [IR1,IR2,IR3] = [MAC1,MAC2,MAC3] = (BK*1000h + LCM*IR) SAR (sf*12)
-  MulMatVec(&REGS.LCM[0][0], REGS.BK, REGS.IR1, REGS.IR2, REGS.IR3, shift, lm);
+  const s16 IR[3] = {REGS.IR1, REGS.IR2, REGS.IR3};
+  MulMatVec(&REGS.LCM[0][0], REGS.BK, IR, shift, lm);
 
   // [MAC1,MAC2,MAC3] = [R*IR1,G*IR2,B*IR3] SHL 4
   // [MAC1,MAC2,MAC3] = [MAC1,MAC2,MAC3] SAR (sf*12)
@@ -997,7 +1040,8 @@ static void Execute_CDP(Instruction inst)
   const bool lm = inst.lm;
 
   // [IR1,IR2,IR3] = [MAC1,MAC2,MAC3] = (BK*1000h + LCM*IR) SAR (sf*12)
-  MulMatVec(&REGS.LCM[0][0], REGS.BK, REGS.IR1, REGS.IR2, REGS.IR3, shift, lm);
+  const s16 IR[3] = {REGS.IR1, REGS.IR2, REGS.IR3};
+  MulMatVec(&REGS.LCM[0][0], REGS.BK, IR, shift, lm);
 
   // No need to assign these to MAC[1-3], as it'll never overflow.
   // [MAC1,MAC2,MAC3] = [R*IR1,G*IR2,B*IR3] SHL 4
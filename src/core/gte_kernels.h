@@ -0,0 +1,234 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+
+#include "common/bitutils.h"
+#include "common/intrin.h"
+#include "common/types.h"
+
+#include <algorithm>
+
+// Matrix/vector products for the GTE's RTPS/RTPT, MVMVA and NCx/NCCx/NCDx/CC/CDP commands. The *Scalar() functions
+// are the reference implementations, which track the 44-bit intermediate overflow flags after every addition like the
+// hardware. MulMatVec() computes all three rows of each product at once with SSE2 or NEON when the matrix and
+// translation vector rule out intermediate overflow, and falls back to the scalar path otherwise, so results and FLAG
+// bits never depend on which path was taken.
+
+#if defined(CPU_ARCH_SSE) || defined(CPU_ARCH_NEON)
+#define GTE_KERNELS_VECTOR 1
+#endif
+
+namespace GTE_Kernels {
+
+static constexpr s64 MAC123_MIN_VALUE = -(INT64_C(1) << 43);
+static constexpr s64 MAC123_MAX_VALUE = (INT64_C(1) << 43) - 1;
+static constexpr s32 IR123_MIN_VALUE = -(INT64_C(1) << 15);
+static constexpr s32 IR123_MAX_VALUE = (INT64_C(1) << 15) - 1;
+
+// FLAG bits for row 0 (MAC1/IR1), shift right by the row index for the others.
+static constexpr u32 FLAG_MAC1_OVERFLOW = (1u << 30);
+static constexpr u32 FLAG_MAC1_UNDERFLOW = (1u << 27);
+static constexpr u32 FLAG_IR1_SATURATED = (1u << 24);
+static constexpr u32 FLAG_IR3_SATURATED = (FLAG_IR1_SATURATED >> 2);
+
+/// [MAC1,MAC2,MAC3] = (T*1000h + M*V) SAR shift, [IR1,IR2,IR3] = [MAC1,MAC2,MAC3] saturated.
+struct MatVecResult
+{
+  s32 mac[3];
+  s32 ir[3];
+
+  /// Unshifted row 2 SAR 12, i.e. SZ3 for RTPS.
+  s32 mac3_sar12;
+
+  /// MAC overflow and IR saturation bits, to be ORed into FLAG.
+  u32 flags;
+
+  bool operator==(const MatVecResult& rhs) const = default;
+};
+
+ALWAYS_INLINE static void CheckMACOverflow(s64 value, u32 row, u32& flags)
+{
+  if (value < MAC123_MIN_VALUE)
+    flags |= FLAG_MAC1_UNDERFLOW >> row;
+  else if (value > MAC123_MAX_VALUE)
+    flags |= FLAG_MAC1_OVERFLOW >> row;
+}
+
+/// One row of T*1000h + M*V. Intermediate sums are checked and wrapped to 44 bits, the final sum is not.
+ALWAYS_INLINE static s64 DotRowScalar(const s16* M_row, s32 T, const s16* V, u32 row, u32& flags)
+{
+  s64 value = (s64(T) << 12) + (s64(M_row[0]) * s64(V[0]));
+  CheckMACOverflow(value, row, flags);
+  value = SignExtendN<44>(value) + (s64(M_row[1]) * s64(V[1]));
+  CheckMACOverflow(value, row, flags);
+  return SignExtendN<44>(value) + (s64(M_row[2]) * s64(V[2]));
+}
+
+ALWAYS_INLINE_RELEASE static void MulMatVecScalar(MatVecResult* res, const s16* M, const s32* T, const s16* V, u8 shift,
+                                                  bool lm)
+{
+  const s32 ir_min = lm ? 0 : IR123_MIN_VALUE;
+  u32 flags = 0;
+  for (u32 row = 0; row < 3; row++)
+  {
+    const s64 value = DotRowScalar(&M[row * 3], T[row], V, row, flags);
+    CheckMACOverflow(value, row, flags);
+
+    const s32 mac = static_cast<s32>(value >> shift);
+    res->mac[row] = mac;
+    res->ir[row] = std::clamp(mac, ir_min, IR123_MAX_VALUE);
+    flags |= (mac < ir_min || mac > IR123_MAX_VALUE) ? (FLAG_IR1_SATURATED >> row) : 0u;
+    if (row == 2)
+      res->mac3_sar12 = static_cast<s32>(value >> 12);
+  }
+
+  res->flags = flags;
+}
+
+#ifdef GTE_KERNELS_VECTOR
+
+/// The vector path keeps everything in 32-bit lanes, computing M*V as (M0*Vx + M1*Vy) + M2*Vz. That is exact unless
+/// both products of the first pair are 8000h*8000h, so matrices containing -8000h take the scalar path. With
+/// |T| < 2^30, no sum can exceed 44 bits, so the MAC overflow flags can not be set and only the final IR saturation
+/// needs to be checked, which is done for all three rows at once.
+ALWAYS_INLINE static bool CanUseVectorMulMatVec(const s16* M, const s32* T)
+{
+  for (u32 i = 0; i < 9; i++)
+  {
+    if (M[i] == IR123_MIN_VALUE)
+      return false;
+  }
+  for (u32 i = 0; i < 3; i++)
+  {
+    if ((static_cast<u32>(T[i]) + (1u << 30)) >= (1u << 31))
+      return false;
+  }
+  return true;
+}
+
+ALWAYS_INLINE static u32 SaturationMaskToFlags(u32 mask)
+{
+  return ((mask & 1u) * FLAG_IR1_SATURATED) | ((mask & 2u) * (FLAG_IR1_SATURATED >> 2)) |
+         ((mask & 4u) * (FLAG_IR1_SATURATED >> 4));
+}
+
+#if defined(CPU_ARCH_SSE)
+
+template<u32 count>
+ALWAYS_INLINE_RELEASE static void MulMatVecVector(MatVecResult* results, const s16* M, const s32* T,
+                                                  const s16* const* V, u8 shift, bool lm)
+{
+  // Rows in 32-bit lanes, the fourth lane is zero.
+  const __m128i m01 = _mm_setr_epi16(M[0], M[1], M[3], M[4], M[6], M[7], 0, 0);
+  const __m128i m2 = _mm_setr_epi16(M[2], 0, M[5], 0, M[8], 0, 0, 0);
+  const __m128i t = _mm_setr_epi32(T[0], T[1], T[2], 0);
+  const __m128i t_shl12 = _mm_slli_epi32(t, 12);
+  const __m128i frac_mask = _mm_set1_epi32(0xFFF);
+  const __m128i ir_min = _mm_set1_epi32(lm ? 0 : IR123_MIN_VALUE);
+  const __m128i ir_max = _mm_set1_epi32(IR123_MAX_VALUE);
+
+  for (u32 i = 0; i < count; i++)
+  {
+    const s16* v = V[i];
+    const __m128i vxy = _mm_set1_epi32(static_cast<s32>(ZeroExtend32(static_cast<u16>(v[0])) |
+                                                        (ZeroExtend32(static_cast<u16>(v[1])) << 16)));
+    const __m128i vz = _mm_set1_epi32(ZeroExtend32(static_cast<u16>(v[2])));
+    const __m128i a = _mm_madd_epi16(m01, vxy);
+    const __m128i b = _mm_madd_epi16(m2, vz);
+
+    // (T*1000h + a + b) SAR 12 without leaving 32 bits, the carry from the fractional parts is added separately.
+    const __m128i frac = _mm_add_epi32(_mm_and_si128(a, frac_mask), _mm_and_si128(b, frac_mask));
+    const __m128i sar12 = _mm_add_epi32(_mm_add_epi32(t, _mm_srai_epi32(a, 12)),
+                                        _mm_add_epi32(_mm_srai_epi32(b, 12), _mm_srli_epi32(frac, 12)));
+    const __m128i mac = shift ? sar12 : _mm_add_epi32(t_shl12, _mm_add_epi32(a, b));
+
+    const __m128i saturated = _mm_or_si128(_mm_cmplt_epi32(mac, ir_min), _mm_cmpgt_epi32(mac, ir_max));
+    const __m128i ir = _mm_max_epi16(_mm_packs_epi32(mac, mac), _mm_packs_epi32(ir_min, ir_min));
+
+    MatVecResult& res = results[i];
+    alignas(16) s32 mac_values[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(mac_values), mac);
+    res.mac[0] = mac_values[0];
+    res.mac[1] = mac_values[1];
+    res.mac[2] = mac_values[2];
+    res.ir[0] = static_cast<s16>(_mm_extract_epi16(ir, 0));
+    res.ir[1] = static_cast<s16>(_mm_extract_epi16(ir, 1));
+    res.ir[2] = static_cast<s16>(_mm_extract_epi16(ir, 2));
+    res.mac3_sar12 = _mm_cvtsi128_si32(_mm_shuffle_epi32(sar12, _MM_SHUFFLE(2, 2, 2, 2)));
+    res.flags = SaturationMaskToFlags(static_cast<u32>(_mm_movemask_ps(_mm_castsi128_ps(saturated))));
+  }
+}
+
+#elif defined(CPU_ARCH_NEON)
+
+template<u32 count>
+ALWAYS_INLINE_RELEASE static void MulMatVecVector(MatVecResult* results, const s16* M, const s32* T,
+                                                  const s16* const* V, u8 shift, bool lm)
+{
+  // Matrix columns, rows in lanes, the fourth lane is zero.
+  const s16 cols[3][4] = {{M[0], M[3], M[6], 0}, {M[1], M[4], M[7], 0}, {M[2], M[5], M[8], 0}};
+  const int16x4_t col0 = vld1_s16(cols[0]);
+  const int16x4_t col1 = vld1_s16(cols[1]);
+  const int16x4_t col2 = vld1_s16(cols[2]);
+  const s32 t_values[4] = {T[0], T[1], T[2], 0};
+  const int32x4_t t = vld1q_s32(t_values);
+  const int32x4_t t_shl12 = vshlq_n_s32(t, 12);
+  const int32x4_t frac_mask = vdupq_n_s32(0xFFF);
+  const int32x4_t ir_min = vdupq_n_s32(lm ? 0 : IR123_MIN_VALUE);
+  const int32x4_t ir_max = vdupq_n_s32(IR123_MAX_VALUE);
+  static constexpr u32 row_bits[4] = {1, 2, 4, 0};
+  const uint32x4_t row_mask = vld1q_u32(row_bits);
+
+  for (u32 i = 0; i < count; i++)
+  {
+    const s16* v = V[i];
+    const int32x4_t a = vmlal_n_s16(vmull_n_s16(col0, v[0]), col1, v[1]);
+    const int32x4_t b = vmull_n_s16(col2, v[2]);
+
+    // (T*1000h + a + b) SAR 12 without leaving 32 bits, the carry from the fractional parts is added separately.
+    const int32x4_t frac = vaddq_s32(vandq_s32(a, frac_mask), vandq_s32(b, frac_mask));
+    const int32x4_t sar12 =
+      vaddq_s32(vaddq_s32(t, vshrq_n_s32(a, 12)), vaddq_s32(vshrq_n_s32(b, 12), vshrq_n_s32(frac, 12)));
+    const int32x4_t mac = shift ? sar12 : vaddq_s32(t_shl12, vaddq_s32(a, b));
+
+    const uint32x4_t saturated = vorrq_u32(vcltq_s32(mac, ir_min), vcgtq_s32(mac, ir_max));
+    const int32x4_t ir = vmaxq_s32(vminq_s32(mac, ir_max), ir_min);
+
+    MatVecResult& res = results[i];
+    s32 mac_values[4], ir_values[4];
+    vst1q_s32(mac_values, mac);
+    vst1q_s32(ir_values, ir);
+    res.mac[0] = mac_values[0];
+    res.mac[1] = mac_values[1];
+    res.mac[2] = mac_values[2];
+    res.ir[0] = ir_values[0];
+    res.ir[1] = ir_values[1];
+    res.ir[2] = ir_values[2];
+    res.mac3_sar12 = vgetq_lane_s32(sar12, 2);
+    res.flags = SaturationMaskToFlags(vaddvq_u32(vandq_u32(saturated, row_mask)));
+  }
+}
+
+#endif
+
+#endif // GTE_KERNELS_VECTOR
+
+/// Multiplies count vectors by the same matrix and translation vector, e.g. the three vertices of RTPT/NCCT.
+template<u32 count>
+ALWAYS_INLINE_RELEASE static void MulMatVec(MatVecResult* results, const s16* M, const s32* T, const s16* const* V,
+                                            u8 shift, bool lm)
+{
+#ifdef GTE_KERNELS_VECTOR
+  if (CanUseVectorMulMatVec(M, T))
+  {
+    MulMatVecVector<count>(results, M, T, V, shift, lm);
+    return;
+  }
+#endif
+
+  for (u32 i = 0; i < count; i++)
+    MulMatVecScalar(&results[i], M, T, V[i], shift, lm);
+}
+
+} // namespace GTE_Kernels
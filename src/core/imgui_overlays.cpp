@@ -369,6 +369,11 @@ void ImGuiManager::DrawPerformanceOverlay()
           text.append_fmt("{}{}", first ? "" : "/", "CI");
           first = false;
         }
+        else if (g_settings.cpu_execution_mode == CPUExecutionMode::ThreadedInterpreter)
+        {
+          text.append_fmt("{}{}", first ? "" : "/", "TI");
+          first = false;
+        }
         else
         {
           if (g_settings.cpu_recompiler_icache)
@@ -6,6 +6,7 @@
 #include "dma.h"
 #include "host.h"
 #include "interrupt_controller.h"
+#include "mdec_kernels.h"
 #include "system.h"
 
 #include "util/imgui_manager.h"
@@ -111,11 +112,7 @@ static void CopyOutBlock(void* param, TickCount ticks, TickCount ticks_late);
 // from nocash spec
 static bool rl_decode_block(s16* blk, const u8* qt);
 static void IDCT(s16* blk);
-static void IDCT_New(s16* blk);
 static void IDCT_Old(s16* blk);
-static void yuv_to_rgb(u32 xx, u32 yy, const std::array<s16, 64>& Crblk, const std::array<s16, 64>& Cbblk,
-                       const std::array<s16, 64>& Yblk);
-static void y_to_mono(const std::array<s16, 64>& Yblk);
 
 static StatusRegister s_status = {};
 static bool s_enable_dma_in = false;
@@ -133,7 +130,7 @@ static std::array<u8, 64> s_iq_y{};
 static std::array<s16, 64> s_scale_table{};
 
 // blocks, for colour: 0 - Crblk, 1 - Cbblk, 2-5 - Y 1-4
-static std::array<std::array<s16, 64>, NUM_BLOCKS> s_blocks;
+static MDEC_Kernels::Macroblock s_blocks;
 static u32 s_current_block = 0;        // block (0-5)
 static u32 s_current_coefficient = 64; // k (in block)
 static u16 s_current_q_scale = 0;
@@ -510,7 +507,7 @@ bool MDEC::DecodeMonoMacroblock()
   ResetDecoder();
   s_state = State::WritingMacroblock;
 
-  y_to_mono(s_blocks[0]);
+  MDEC_Kernels::YToMono(s_block_rgb.data(), s_blocks[0]);
 
   ScheduleBlockCopyOut(TICKS_PER_BLOCK * 6);
 
@@ -536,10 +533,7 @@ bool MDEC::DecodeColoredMacroblock()
   ResetDecoder();
   s_state = State::WritingMacroblock;
 
-  yuv_to_rgb(0, 0, s_blocks[0], s_blocks[1], s_blocks[2]);
-  yuv_to_rgb(8, 0, s_blocks[0], s_blocks[1], s_blocks[3]);
-  yuv_to_rgb(0, 8, s_blocks[0], s_blocks[1], s_blocks[4]);
-  yuv_to_rgb(8, 8, s_blocks[0], s_blocks[1], s_blocks[5]);
+  MDEC_Kernels::YUVToRGB(s_block_rgb.data(), s_blocks, s_status.data_output_signed);
   s_total_blocks_decoded += 4;
 
   ScheduleBlockCopyOut(TICKS_PER_BLOCK * 6);
@@ -772,34 +766,7 @@ void MDEC::IDCT(s16* blk)
   if (g_settings.use_old_mdec_routines) [[unlikely]]
     IDCT_Old(blk);
   else
-    IDCT_New(blk);
-}
-
-void MDEC::IDCT_New(s16* blk)
-{
-  std::array<s32, 64> temp;
-  for (u32 x = 0; x < 8; x++)
-  {
-    for (u32 y = 0; y < 8; y++)
-    {
-      // TODO: We could alter zigzag and invert scale_table to get these in row-major order,
-      // in which case we could do optimize this to a vector multiply.
-      s32 sum = 0;
-      for (u32 z = 0; z < 8; z++)
-        sum += s32(blk[y + z * 8]) * s32(s_scale_table[x + z * 8] / 8);
-      temp[x + y * 8] = static_cast<s32>((sum + 0xfff) / 0x2000);
-    }
-  }
-  for (u32 x = 0; x < 8; x++)
-  {
-    for (u32 y = 0; y < 8; y++)
-    {
-      s32 sum = 0;
-      for (u32 z = 0; z < 8; z++)
-        sum += temp[y + z * 8] * s32(s_scale_table[x + z * 8] / 8);
-      blk[x + y * 8] = static_cast<s16>(std::clamp<s32>((sum + 0xfff) / 0x2000, -128, 127));
-    }
-  }
+    MDEC_Kernels::IDCT(blk, s_scale_table.data());
 }
 
 void MDEC::IDCT_Old(s16* blk)
@@ -829,45 +796,6 @@ void MDEC::IDCT_Old(s16* blk)
   }
 }
 
-void MDEC::yuv_to_rgb(u32 xx, u32 yy, const std::array<s16, 64>& Crblk, const std::array<s16, 64>& Cbblk,
-                      const std::array<s16, 64>& Yblk)
-{
-  const s16 addval = s_status.data_output_signed ? 0 : 0x80;
-  for (u32 y = 0; y < 8; y++)
-  {
-    for (u32 x = 0; x < 8; x++)
-    {
-      s16 R = Crblk[((x + xx) / 2) + ((y + yy) / 2) * 8];
-      s16 B = Cbblk[((x + xx) / 2) + ((y + yy) / 2) * 8];
-      s16 G = static_cast<s16>((-0.3437f * static_cast<float>(B)) + (-0.7143f * static_cast<float>(R)));
-
-      R = static_cast<s16>(1.402f * static_cast<float>(R));
-      B = static_cast<s16>(1.772f * static_cast<float>(B));
-
-      s16 Y = Yblk[x + y * 8];
-      R = static_cast<s16>(std::clamp(static_cast<int>(Y) + R, -128, 127)) + addval;
-      G = static_cast<s16>(std::clamp(static_cast<int>(Y) + G, -128, 127)) + addval;
-      B = static_cast<s16>(std::clamp(static_cast<int>(Y) + B, -128, 127)) + addval;
-
-      s_block_rgb[(x + xx) + ((y + yy) * 16)] = ZeroExtend32(static_cast<u16>(R)) |
-                                                (ZeroExtend32(static_cast<u16>(G)) << 8) |
-                                                (ZeroExtend32(static_cast<u16>(B)) << 16);
-    }
-  }
-}
-
-void MDEC::y_to_mono(const std::array<s16, 64>& Yblk)
-{
-  for (u32 i = 0; i < 64; i++)
-  {
-    s16 Y = Yblk[i];
-    Y = SignExtendN<10, s16>(Y);
-    Y = std::clamp<s16>(Y, -128, 127);
-    Y += 128;
-    s_block_rgb[i] = static_cast<u32>(Y) & 0xFF;
-  }
-}
-
 void MDEC::HandleSetQuantTableCommand()
 {
   DebugAssert(s_remaining_halfwords >= 32);
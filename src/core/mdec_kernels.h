@@ -0,0 +1,473 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+
+#include "common/bitutils.h"
+#include "common/intrin.h"
+#include "common/types.h"
+
+#include <algorithm>
+#include <array>
+
+// IDCT and colour conversion for the MDEC. The vector IDCT() accumulates in 32 bits and rounds each pass with the
+// same truncating division as IDCTScalar(), and both colour conversions use the fixed point constants below, so FMV
+// frames come out bit-identical on either path. regtest -mdecbench checks this.
+
+#if defined(CPU_ARCH_SSE) || defined(CPU_ARCH_NEON)
+#define MDEC_KERNELS_VECTOR 1
+#endif
+
+namespace MDEC_Kernels {
+
+static constexpr u32 BLOCK_SIZE = 64;
+static constexpr u32 NUM_BLOCKS = 6;
+static constexpr u32 MACROBLOCK_PIXELS = 256;
+
+using Block = std::array<s16, BLOCK_SIZE>;
+
+/// Cr, Cb, then the four Y blocks in top-left, top-right, bottom-left, bottom-right order.
+using Macroblock = std::array<Block, NUM_BLOCKS>;
+
+/// Signed division by a power of two, rounding towards zero like C division.
+template<u32 shift>
+ALWAYS_INLINE static s32 TruncatingShift(s32 value)
+{
+  return (value + ((value >> 31) & ((1 << shift) - 1))) >> shift;
+}
+
+// The hardware colour conversion constants are 1.402, -0.3437, -0.7143 and 1.772, and we used to evaluate them in
+// single precision floats. The fixed point versions below give identical results for every chroma value the IDCT
+// can produce ([-128, 127]), without depending on whether the compiler contracts the expression into a FMA.
+static constexpr s32 CR_TO_R = 11485;    // 1.402 * 2^13
+static constexpr s32 CB_TO_G = -360396;  // -0.3437 * 2^20
+static constexpr s32 CR_TO_G = -748997;  // -0.7143 * 2^20
+static constexpr s32 CB_TO_B = 7258;     // 1.772 * 2^12
+static constexpr u32 CR_TO_R_SHIFT = 13;
+static constexpr u32 CHROMA_TO_G_SHIFT = 20;
+static constexpr u32 CB_TO_B_SHIFT = 12;
+
+ALWAYS_INLINE static s16 ChromaToR(s16 cr)
+{
+  return static_cast<s16>(TruncatingShift<CR_TO_R_SHIFT>(s32(cr) * CR_TO_R));
+}
+
+ALWAYS_INLINE static s16 ChromaToG(s16 cr, s16 cb)
+{
+  return static_cast<s16>(TruncatingShift<CHROMA_TO_G_SHIFT>(s32(cb) * CB_TO_G + s32(cr) * CR_TO_G));
+}
+
+ALWAYS_INLINE static s16 ChromaToB(s16 cb)
+{
+  return static_cast<s16>(TruncatingShift<CB_TO_B_SHIFT>(s32(cb) * CB_TO_B));
+}
+
+ALWAYS_INLINE static u32 PackRGB(s16 r, s16 g, s16 b)
+{
+  // Negative components in signed output mode deliberately spill into the neighbouring bytes, as they always have.
+  return ZeroExtend32(static_cast<u16>(r)) | (ZeroExtend32(static_cast<u16>(g)) << 8) |
+         (ZeroExtend32(static_cast<u16>(b)) << 16);
+}
+
+/// Inverse DCT of one block in place. Coefficients must be in [-1024, 1023], as produced by the RLE decoder.
+ALWAYS_INLINE_RELEASE static void IDCTScalar(s16* blk, const s16* scale_table)
+{
+  std::array<s32, 64> temp;
+  for (u32 x = 0; x < 8; x++)
+  {
+    for (u32 y = 0; y < 8; y++)
+    {
+      s32 sum = 0;
+      for (u32 z = 0; z < 8; z++)
+        sum += s32(blk[y + z * 8]) * s32(scale_table[x + z * 8] / 8);
+      temp[x + y * 8] = static_cast<s32>((sum + 0xfff) / 0x2000);
+    }
+  }
+  for (u32 x = 0; x < 8; x++)
+  {
+    for (u32 y = 0; y < 8; y++)
+    {
+      s32 sum = 0;
+      for (u32 z = 0; z < 8; z++)
+        sum += temp[y + z * 8] * s32(scale_table[x + z * 8] / 8);
+      blk[x + y * 8] = static_cast<s16>(std::clamp<s32>((sum + 0xfff) / 0x2000, -128, 127));
+    }
+  }
+}
+
+/// Converts a decoded colour macroblock to 16x16 24-bit pixels. Input samples must be in [-128, 127].
+ALWAYS_INLINE_RELEASE static void YUVToRGBScalar(u32* rgb_out, const Macroblock& blocks, bool signed_output)
+{
+  const s16 addval = signed_output ? 0 : 0x80;
+  for (u32 y = 0; y < 16; y++)
+  {
+    for (u32 x = 0; x < 16; x++)
+    {
+      const s16 Cr = blocks[0][(x / 2) + (y / 2) * 8];
+      const s16 Cb = blocks[1][(x / 2) + (y / 2) * 8];
+      const s16 Y = blocks[2 + (x / 8) + (y / 8) * 2][(x % 8) + (y % 8) * 8];
+
+      const s16 R = static_cast<s16>(std::clamp(static_cast<int>(Y) + ChromaToR(Cr), -128, 127)) + addval;
+      const s16 G = static_cast<s16>(std::clamp(static_cast<int>(Y) + ChromaToG(Cr, Cb), -128, 127)) + addval;
+      const s16 B = static_cast<s16>(std::clamp(static_cast<int>(Y) + ChromaToB(Cb), -128, 127)) + addval;
+      rgb_out[x + y * 16] = PackRGB(R, G, B);
+    }
+  }
+}
+
+/// Converts a decoded Y block to 8x8 8-bit pixels.
+ALWAYS_INLINE_RELEASE static void YToMonoScalar(u32* mono_out, const Block& blk)
+{
+  for (u32 i = 0; i < 64; i++)
+  {
+    s16 Y = blk[i];
+    Y = SignExtendN<10, s16>(Y);
+    Y = std::clamp<s16>(Y, -128, 127);
+    Y += 128;
+    mono_out[i] = static_cast<u32>(Y) & 0xFF;
+  }
+}
+
+#ifdef MDEC_KERNELS_VECTOR
+
+#if defined(CPU_ARCH_SSE)
+
+template<u32 shift>
+ALWAYS_INLINE static __m128i TruncatingShiftVector(__m128i value)
+{
+  const __m128i bias = _mm_and_si128(_mm_srai_epi32(value, 31), _mm_set1_epi32((1 << shift) - 1));
+  return _mm_srai_epi32(_mm_add_epi32(value, bias), shift);
+}
+
+ALWAYS_INLINE static __m128i LoadScaleRow(const s16* scale_table, u32 row)
+{
+  // scale / 8, rounding towards zero.
+  const __m128i scale = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&scale_table[row * 8]));
+  return _mm_srai_epi16(_mm_add_epi16(scale, _mm_and_si128(_mm_srai_epi16(scale, 15), _mm_set1_epi16(7))), 3);
+}
+
+template<u32 lane>
+ALWAYS_INLINE static __m128i BroadcastPair(__m128i pairs)
+{
+  return _mm_shuffle_epi32(pairs, _MM_SHUFFLE(lane, lane, lane, lane));
+}
+
+template<u32 lane>
+ALWAYS_INLINE static void IDCTPass1Column(__m128i* temp_t, const __m128i (&blk_pairs)[2][4],
+                                          const __m128i (&scale_pairs)[2][4])
+{
+  // temp_t[x][y] = sum(z, blk[z][y] * scale[z][x]), for x = lane and x = lane + 4.
+  __m128i lo_lo = _mm_setzero_si128(), lo_hi = _mm_setzero_si128();
+  __m128i hi_lo = _mm_setzero_si128(), hi_hi = _mm_setzero_si128();
+  for (u32 p = 0; p < 4; p++)
+  {
+    const __m128i lo_coeff = BroadcastPair<lane>(scale_pairs[0][p]);
+    const __m128i hi_coeff = BroadcastPair<lane>(scale_pairs[1][p]);
+    lo_lo = _mm_add_epi32(lo_lo, _mm_madd_epi16(blk_pairs[0][p], lo_coeff));
+    lo_hi = _mm_add_epi32(lo_hi, _mm_madd_epi16(blk_pairs[1][p], lo_coeff));
+    hi_lo = _mm_add_epi32(hi_lo, _mm_madd_epi16(blk_pairs[0][p], hi_coeff));
+    hi_hi = _mm_add_epi32(hi_hi, _mm_madd_epi16(blk_pairs[1][p], hi_coeff));
+  }
+
+  const __m128i round = _mm_set1_epi32(0xfff);
+  temp_t[lane] = _mm_packs_epi32(TruncatingShiftVector<13>(_mm_add_epi32(lo_lo, round)),
+                                 TruncatingShiftVector<13>(_mm_add_epi32(lo_hi, round)));
+  temp_t[lane + 4] = _mm_packs_epi32(TruncatingShiftVector<13>(_mm_add_epi32(hi_lo, round)),
+                                     TruncatingShiftVector<13>(_mm_add_epi32(hi_hi, round)));
+}
+
+ALWAYS_INLINE_RELEASE static void IDCT(s16* blk, const s16* scale_table)
+{
+  // Interleave pairs of rows, so each madd does two steps of the dot product. scale_pairs[h][p] holds
+  // (scale[2p][x], scale[2p+1][x]) for x in [4h, 4h+3], blk_pairs[h][p] likewise for the block.
+  __m128i scale_pairs[2][4];
+  __m128i blk_pairs[2][4];
+  for (u32 p = 0; p < 4; p++)
+  {
+    const __m128i scale_even = LoadScaleRow(scale_table, p * 2);
+    const __m128i scale_odd = LoadScaleRow(scale_table, p * 2 + 1);
+    scale_pairs[0][p] = _mm_unpacklo_epi16(scale_even, scale_odd);
+    scale_pairs[1][p] = _mm_unpackhi_epi16(scale_even, scale_odd);
+
+    const __m128i blk_even = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&blk[p * 16]));
+    const __m128i blk_odd = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&blk[p * 16 + 8]));
+    blk_pairs[0][p] = _mm_unpacklo_epi16(blk_even, blk_odd);
+    blk_pairs[1][p] = _mm_unpackhi_epi16(blk_even, blk_odd);
+  }
+
+  // First pass produces the intermediate transposed, |temp| <= 4097 so it fits in 16 bits.
+  __m128i temp_t[8];
+  IDCTPass1Column<0>(temp_t, blk_pairs, scale_pairs);
+  IDCTPass1Column<1>(temp_t, blk_pairs, scale_pairs);
+  IDCTPass1Column<2>(temp_t, blk_pairs, scale_pairs);
+  IDCTPass1Column<3>(temp_t, blk_pairs, scale_pairs);
+
+  // blk[y][x] = sum(z, temp_t[y][z] * scale[z][x])
+  const __m128i round = _mm_set1_epi32(0xfff);
+  for (u32 y = 0; y < 8; y++)
+  {
+    const __m128i row = temp_t[y];
+    const __m128i coeff0 = BroadcastPair<0>(row);
+    const __m128i coeff1 = BroadcastPair<1>(row);
+    const __m128i coeff2 = BroadcastPair<2>(row);
+    const __m128i coeff3 = BroadcastPair<3>(row);
+
+    __m128i lo = _mm_madd_epi16(scale_pairs[0][0], coeff0);
+    lo = _mm_add_epi32(lo, _mm_madd_epi16(scale_pairs[0][1], coeff1));
+    lo = _mm_add_epi32(lo, _mm_madd_epi16(scale_pairs[0][2], coeff2));
+    lo = _mm_add_epi32(lo, _mm_madd_epi16(scale_pairs[0][3], coeff3));
+    __m128i hi = _mm_madd_epi16(scale_pairs[1][0], coeff0);
+    hi = _mm_add_epi32(hi, _mm_madd_epi16(scale_pairs[1][1], coeff1));
+    hi = _mm_add_epi32(hi, _mm_madd_epi16(scale_pairs[1][2], coeff2));
+    hi = _mm_add_epi32(hi, _mm_madd_epi16(scale_pairs[1][3], coeff3));
+
+    __m128i result = _mm_packs_epi32(TruncatingShiftVector<13>(_mm_add_epi32(lo, round)),
+                                     TruncatingShiftVector<13>(_mm_add_epi32(hi, round)));
+    result = _mm_min_epi16(_mm_max_epi16(result, _mm_set1_epi16(-128)), _mm_set1_epi16(127));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&blk[y * 8]), result);
+  }
+}
+
+ALWAYS_INLINE static void StorePixels(u32* rgb_out, __m128i y, __m128i r, __m128i g, __m128i b, __m128i addval)
+{
+  const __m128i min = _mm_set1_epi16(-128);
+  const __m128i max = _mm_set1_epi16(127);
+  r = _mm_add_epi16(_mm_min_epi16(_mm_max_epi16(_mm_add_epi16(y, r), min), max), addval);
+  g = _mm_add_epi16(_mm_min_epi16(_mm_max_epi16(_mm_add_epi16(y, g), min), max), addval);
+  b = _mm_add_epi16(_mm_min_epi16(_mm_max_epi16(_mm_add_epi16(y, b), min), max), addval);
+
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i lo = _mm_or_si128(
+    _mm_or_si128(_mm_unpacklo_epi16(r, zero), _mm_slli_epi32(_mm_unpacklo_epi16(g, zero), 8)),
+    _mm_slli_epi32(_mm_unpacklo_epi16(b, zero), 16));
+  const __m128i hi = _mm_or_si128(
+    _mm_or_si128(_mm_unpackhi_epi16(r, zero), _mm_slli_epi32(_mm_unpackhi_epi16(g, zero), 8)),
+    _mm_slli_epi32(_mm_unpackhi_epi16(b, zero), 16));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(rgb_out), lo);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(rgb_out + 4), hi);
+}
+
+ALWAYS_INLINE_RELEASE static void YUVToRGB(u32* rgb_out, const Macroblock& blocks, bool signed_output)
+{
+  // CB_TO_G/CR_TO_G don't fit in 16 bits, so split them into (hi << 8) + lo, and evaluate both halves with madd.
+  static constexpr s32 CB_TO_G_HI = (CB_TO_G >> 8);
+  static constexpr s32 CB_TO_G_LO = (CB_TO_G & 0xFF);
+  static constexpr s32 CR_TO_G_HI = (CR_TO_G >> 8);
+  static constexpr s32 CR_TO_G_LO = (CR_TO_G & 0xFF);
+  const __m128i r_coeff = _mm_set1_epi32(CR_TO_R << 16);
+  const __m128i b_coeff = _mm_set1_epi32(CB_TO_B);
+  const __m128i g_coeff_hi = _mm_set1_epi32((CR_TO_G_HI << 16) | (CB_TO_G_HI & 0xFFFF));
+  const __m128i g_coeff_lo = _mm_set1_epi32((CR_TO_G_LO << 16) | CB_TO_G_LO);
+  const __m128i addval = _mm_set1_epi16(signed_output ? 0 : 0x80);
+
+  for (u32 cy = 0; cy < 8; cy++)
+  {
+    // (Cb, Cr) pairs for chroma columns 0-3 and 4-7.
+    const __m128i cr = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&blocks[0][cy * 8]));
+    const __m128i cb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&blocks[1][cy * 8]));
+    const __m128i chroma_lo = _mm_unpacklo_epi16(cb, cr);
+    const __m128i chroma_hi = _mm_unpackhi_epi16(cb, cr);
+
+    const __m128i r = _mm_packs_epi32(TruncatingShiftVector<CR_TO_R_SHIFT>(_mm_madd_epi16(chroma_lo, r_coeff)),
+                                      TruncatingShiftVector<CR_TO_R_SHIFT>(_mm_madd_epi16(chroma_hi, r_coeff)));
+    const __m128i b = _mm_packs_epi32(TruncatingShiftVector<CB_TO_B_SHIFT>(_mm_madd_epi16(chroma_lo, b_coeff)),
+                                      TruncatingShiftVector<CB_TO_B_SHIFT>(_mm_madd_epi16(chroma_hi, b_coeff)));
+    const __m128i g_lo = _mm_add_epi32(_mm_slli_epi32(_mm_madd_epi16(chroma_lo, g_coeff_hi), 8),
+                                       _mm_madd_epi16(chroma_lo, g_coeff_lo));
+    const __m128i g_hi = _mm_add_epi32(_mm_slli_epi32(_mm_madd_epi16(chroma_hi, g_coeff_hi), 8),
+                                       _mm_madd_epi16(chroma_hi, g_coeff_lo));
+    const __m128i g = _mm_packs_epi32(TruncatingShiftVector<CHROMA_TO_G_SHIFT>(g_lo),
+                                      TruncatingShiftVector<CHROMA_TO_G_SHIFT>(g_hi));
+
+    // Each chroma sample covers 2x2 pixels.
+    const __m128i r_left = _mm_unpacklo_epi16(r, r);
+    const __m128i r_right = _mm_unpackhi_epi16(r, r);
+    const __m128i g_left = _mm_unpacklo_epi16(g, g);
+    const __m128i g_right = _mm_unpackhi_epi16(g, g);
+    const __m128i b_left = _mm_unpacklo_epi16(b, b);
+    const __m128i b_right = _mm_unpackhi_epi16(b, b);
+
+    const Block& y_left = blocks[2 + (cy / 4) * 2];
+    const Block& y_right = blocks[3 + (cy / 4) * 2];
+    for (u32 i = 0; i < 2; i++)
+    {
+      const u32 py = cy * 2 + i;
+      const u32 by = py % 8;
+      StorePixels(&rgb_out[py * 16], _mm_loadu_si128(reinterpret_cast<const __m128i*>(&y_left[by * 8])), r_left,
+                  g_left, b_left, addval);
+      StorePixels(&rgb_out[py * 16 + 8], _mm_loadu_si128(reinterpret_cast<const __m128i*>(&y_right[by * 8])),
+                  r_right, g_right, b_right, addval);
+    }
+  }
+}
+
+ALWAYS_INLINE_RELEASE static void YToMono(u32* mono_out, const Block& blk)
+{
+  const __m128i min = _mm_set1_epi16(-128);
+  const __m128i max = _mm_set1_epi16(127);
+  const __m128i bias = _mm_set1_epi16(128);
+  const __m128i mask = _mm_set1_epi16(0xFF);
+  const __m128i zero = _mm_setzero_si128();
+  for (u32 i = 0; i < 64; i += 8)
+  {
+    // SignExtendN<10>() in the scalar version is a no-op, the shift happens after promotion to int.
+    __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&blk[i]));
+    y = _mm_and_si128(_mm_add_epi16(_mm_min_epi16(_mm_max_epi16(y, min), max), bias), mask);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&mono_out[i]), _mm_unpacklo_epi16(y, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&mono_out[i + 4]), _mm_unpackhi_epi16(y, zero));
+  }
+}
+
+#elif defined(CPU_ARCH_NEON)
+
+template<u32 shift>
+ALWAYS_INLINE static int32x4_t TruncatingShiftVector(int32x4_t value)
+{
+  return vshrq_n_s32(vaddq_s32(value, vandq_s32(vshrq_n_s32(value, 31), vdupq_n_s32((1 << shift) - 1))), shift);
+}
+
+ALWAYS_INLINE static int16x8_t IDCTRound(int32x4_t lo, int32x4_t hi)
+{
+  const int32x4_t round = vdupq_n_s32(0xfff);
+  return vcombine_s16(vmovn_s32(TruncatingShiftVector<13>(vaddq_s32(lo, round))),
+                      vmovn_s32(TruncatingShiftVector<13>(vaddq_s32(hi, round))));
+}
+
+ALWAYS_INLINE_RELEASE static void IDCT(s16* blk, const s16* scale_table)
+{
+  alignas(16) s16 scale[64];
+  int16x8_t scale_rows[8];
+  int16x8_t blk_rows[8];
+  for (u32 z = 0; z < 8; z++)
+  {
+    // scale / 8, rounding towards zero.
+    const int16x8_t row = vld1q_s16(&scale_table[z * 8]);
+    scale_rows[z] = vshrq_n_s16(vaddq_s16(row, vandq_s16(vshrq_n_s16(row, 15), vdupq_n_s16(7))), 3);
+    vst1q_s16(&scale[z * 8], scale_rows[z]);
+    blk_rows[z] = vld1q_s16(&blk[z * 8]);
+  }
+
+  // temp_t[x][y] = sum(z, blk[z][y] * scale[z][x]), |temp| <= 4097 so it fits in 16 bits.
+  alignas(16) s16 temp_t[64];
+  for (u32 x = 0; x < 8; x++)
+  {
+    int32x4_t lo = vmull_n_s16(vget_low_s16(blk_rows[0]), scale[x]);
+    int32x4_t hi = vmull_high_n_s16(blk_rows[0], scale[x]);
+    for (u32 z = 1; z < 8; z++)
+    {
+      lo = vmlal_n_s16(lo, vget_low_s16(blk_rows[z]), scale[z * 8 + x]);
+      hi = vmlal_high_n_s16(hi, blk_rows[z], scale[z * 8 + x]);
+    }
+    vst1q_s16(&temp_t[x * 8], IDCTRound(lo, hi));
+  }
+
+  // blk[y][x] = sum(z, temp_t[y][z] * scale[z][x])
+  for (u32 y = 0; y < 8; y++)
+  {
+    int32x4_t lo = vmull_n_s16(vget_low_s16(scale_rows[0]), temp_t[y * 8]);
+    int32x4_t hi = vmull_high_n_s16(scale_rows[0], temp_t[y * 8]);
+    for (u32 z = 1; z < 8; z++)
+    {
+      lo = vmlal_n_s16(lo, vget_low_s16(scale_rows[z]), temp_t[y * 8 + z]);
+      hi = vmlal_high_n_s16(hi, scale_rows[z], temp_t[y * 8 + z]);
+    }
+    vst1q_s16(&blk[y * 8], vminq_s16(vmaxq_s16(IDCTRound(lo, hi), vdupq_n_s16(-128)), vdupq_n_s16(127)));
+  }
+}
+
+ALWAYS_INLINE static void StorePixels(u32* rgb_out, int16x8_t y, int16x8_t r, int16x8_t g, int16x8_t b,
+                                      int16x8_t addval)
+{
+  const int16x8_t min = vdupq_n_s16(-128);
+  const int16x8_t max = vdupq_n_s16(127);
+  const uint16x8_t ur = vreinterpretq_u16_s16(vaddq_s16(vminq_s16(vmaxq_s16(vaddq_s16(y, r), min), max), addval));
+  const uint16x8_t ug = vreinterpretq_u16_s16(vaddq_s16(vminq_s16(vmaxq_s16(vaddq_s16(y, g), min), max), addval));
+  const uint16x8_t ub = vreinterpretq_u16_s16(vaddq_s16(vminq_s16(vmaxq_s16(vaddq_s16(y, b), min), max), addval));
+
+  const uint32x4_t lo = vorrq_u32(vorrq_u32(vmovl_u16(vget_low_u16(ur)), vshlq_n_u32(vmovl_u16(vget_low_u16(ug)), 8)),
+                                  vshlq_n_u32(vmovl_u16(vget_low_u16(ub)), 16));
+  const uint32x4_t hi = vorrq_u32(vorrq_u32(vmovl_high_u16(ur), vshlq_n_u32(vmovl_high_u16(ug), 8)),
+                                  vshlq_n_u32(vmovl_high_u16(ub), 16));
+  vst1q_u32(rgb_out, lo);
+  vst1q_u32(rgb_out + 4, hi);
+}
+
+ALWAYS_INLINE_RELEASE static void YUVToRGB(u32* rgb_out, const Macroblock& blocks, bool signed_output)
+{
+  const int16x8_t addval = vdupq_n_s16(signed_output ? 0 : 0x80);
+
+  for (u32 cy = 0; cy < 8; cy++)
+  {
+    const int16x8_t cr = vld1q_s16(&blocks[0][cy * 8]);
+    const int16x8_t cb = vld1q_s16(&blocks[1][cy * 8]);
+
+    const int16x8_t r = vcombine_s16(
+      vmovn_s32(TruncatingShiftVector<CR_TO_R_SHIFT>(vmull_n_s16(vget_low_s16(cr), static_cast<s16>(CR_TO_R)))),
+      vmovn_s32(TruncatingShiftVector<CR_TO_R_SHIFT>(vmull_high_n_s16(cr, static_cast<s16>(CR_TO_R)))));
+    const int16x8_t b = vcombine_s16(
+      vmovn_s32(TruncatingShiftVector<CB_TO_B_SHIFT>(vmull_n_s16(vget_low_s16(cb), static_cast<s16>(CB_TO_B)))),
+      vmovn_s32(TruncatingShiftVector<CB_TO_B_SHIFT>(vmull_high_n_s16(cb, static_cast<s16>(CB_TO_B)))));
+    const int32x4_t g_lo =
+      vmlaq_n_s32(vmulq_n_s32(vmovl_s16(vget_low_s16(cb)), CB_TO_G), vmovl_s16(vget_low_s16(cr)), CR_TO_G);
+    const int32x4_t g_hi = vmlaq_n_s32(vmulq_n_s32(vmovl_high_s16(cb), CB_TO_G), vmovl_high_s16(cr), CR_TO_G);
+    const int16x8_t g = vcombine_s16(vmovn_s32(TruncatingShiftVector<CHROMA_TO_G_SHIFT>(g_lo)),
+                                     vmovn_s32(TruncatingShiftVector<CHROMA_TO_G_SHIFT>(g_hi)));
+
+    // Each chroma sample covers 2x2 pixels.
+    const int16x8_t r_left = vzip1q_s16(r, r);
+    const int16x8_t r_right = vzip2q_s16(r, r);
+    const int16x8_t g_left = vzip1q_s16(g, g);
+    const int16x8_t g_right = vzip2q_s16(g, g);
+    const int16x8_t b_left = vzip1q_s16(b, b);
+    const int16x8_t b_right = vzip2q_s16(b, b);
+
+    const Block& y_left = blocks[2 + (cy / 4) * 2];
+    const Block& y_right = blocks[3 + (cy / 4) * 2];
+    for (u32 i = 0; i < 2; i++)
+    {
+      const u32 py = cy * 2 + i;
+      const u32 by = py % 8;
+      StorePixels(&rgb_out[py * 16], vld1q_s16(&y_left[by * 8]), r_left, g_left, b_left, addval);
+      StorePixels(&rgb_out[py * 16 + 8], vld1q_s16(&y_right[by * 8]), r_right, g_right, b_right, addval);
+    }
+  }
+}
+
+ALWAYS_INLINE_RELEASE static void YToMono(u32* mono_out, const Block& blk)
+{
+  const int16x8_t min = vdupq_n_s16(-128);
+  const int16x8_t max = vdupq_n_s16(127);
+  const int16x8_t bias = vdupq_n_s16(128);
+  for (u32 i = 0; i < 64; i += 8)
+  {
+    // SignExtendN<10>() in the scalar version is a no-op, the shift happens after promotion to int.
+    int16x8_t y = vld1q_s16(&blk[i]);
+    y = vaddq_s16(vminq_s16(vmaxq_s16(y, min), max), bias);
+    const uint16x8_t u = vandq_u16(vreinterpretq_u16_s16(y), vdupq_n_u16(0xFF));
+    vst1q_u32(&mono_out[i], vmovl_u16(vget_low_u16(u)));
+    vst1q_u32(&mono_out[i + 4], vmovl_high_u16(u));
+  }
+}
+
+#endif
+
+#else
+
+ALWAYS_INLINE static void IDCT(s16* blk, const s16* scale_table)
+{
+  IDCTScalar(blk, scale_table);
+}
+
+ALWAYS_INLINE static void YUVToRGB(u32* rgb_out, const Macroblock& blocks, bool signed_output)
+{
+  YUVToRGBScalar(rgb_out, blocks, signed_output);
+}
+
+ALWAYS_INLINE static void YToMono(u32* mono_out, const Block& blk)
+{
+  YToMonoScalar(mono_out, blk);
+}
+
+#endif // MDEC_KERNELS_VECTOR
+
+} // namespace MDEC_Kernels
@@ -64,6 +64,8 @@ struct Settings
   bool cpu_recompiler_memory_exceptions = false;
   bool cpu_recompiler_block_linking = true;
   bool cpu_recompiler_icache = false;
+  bool cpu_recompiler_block_cache = false;
+  bool cpu_recompiler_superblocks = false;
   CPUFastmemMode cpu_fastmem_mode = DEFAULT_CPU_FASTMEM_MODE;
 
   float emulation_speed = 1.0f;
@@ -89,7 +91,7 @@ struct Settings
 
   bool rewind_enable = false;
   float rewind_save_frequency = 10.0f;
-  u32 rewind_save_slots = 10;
+  u32 rewind_save_slots = 30;
   u32 runahead_frames = 0;
 
   GPURenderer gpu_renderer = DEFAULT_GPU_RENDERER;
@@ -98,6 +100,7 @@ struct Settings
   u32 gpu_multisamples = 1;
   bool gpu_use_thread = true;
   bool gpu_use_software_renderer_for_readbacks = false;
+  u32 gpu_sw_render_threads = 0;
   bool gpu_threaded_presentation = true;
   bool gpu_use_debug_device = false;
   bool gpu_disable_shader_cache = false;
@@ -151,8 +154,11 @@ struct Settings
   float gpu_pgxp_depth_clear_threshold = DEFAULT_GPU_PGXP_DEPTH_THRESHOLD / GPU_PGXP_DEPTH_THRESHOLD_SCALE;
 
   u8 cdrom_readahead_sectors = DEFAULT_CDROM_READAHEAD_SECTORS;
+  u32 cdrom_chd_cache_hunks = DEFAULT_CDROM_CHD_CACHE_HUNKS;
+  u32 cdrom_chd_readahead_hunks = DEFAULT_CDROM_CHD_READAHEAD_HUNKS;
   bool cdrom_region_check = false;
   bool cdrom_load_image_to_ram = false;
+  bool cdrom_preload_mapped_files = false;
   bool cdrom_load_image_patches = false;
   bool cdrom_mute_cd_audio = false;
   u32 cdrom_read_speedup = 1;
@@ -453,6 +459,8 @@ struct Settings
   static constexpr float DEFAULT_OSD_SCALE = 100.0f;
 
   static constexpr u8 DEFAULT_CDROM_READAHEAD_SECTORS = 8;
+  static constexpr u32 DEFAULT_CDROM_CHD_CACHE_HUNKS = 16;
+  static constexpr u32 DEFAULT_CDROM_CHD_READAHEAD_HUNKS = 2;
 
 #ifndef __ANDROID__
   // Android still defaults to digital controller for now.
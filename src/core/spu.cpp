@@ -7,6 +7,8 @@
 #include "host.h"
 #include "imgui.h"
 #include "interrupt_controller.h"
+#include "spu_reverb.h"
+#include "spu_voice_kernels.h"
 #include "system.h"
 
 #include "util/audio_stream.h"
@@ -17,10 +19,12 @@
 #include "common/bitfield.h"
 #include "common/bitutils.h"
 #include "common/fifo_queue.h"
+#include "common/file_system.h"
 #include "common/log.h"
 #include "common/path.h"
 
 #include <memory>
+#include <vector>
 
 Log_SetChannel(SPU);
 
@@ -50,9 +54,11 @@ enum : u32
   SYSCLK_TICKS_PER_SPU_TICK = static_cast<u32>(System::MASTER_CLOCK) / static_cast<u32>(SAMPLE_RATE), // 0x300
   CAPTURE_BUFFER_SIZE_PER_CHANNEL = 0x400,
   MINIMUM_TICKS_BETWEEN_KEY_ON_OFF = 2,
-  NUM_REVERB_REGS = 32,
   FIFO_SIZE_IN_HALFWORDS = 32
 };
+static_assert(NUM_VOICES == SPU_VoiceKernels::NUM_VOICES);
+static_assert(NUM_SAMPLES_PER_ADPCM_BLOCK == SPU_VoiceKernels::NUM_SAMPLES_PER_ADPCM_BLOCK);
+
 enum : s16
 {
   ENVELOPE_MIN_VOLUME = 0,
@@ -204,6 +210,7 @@ struct ADPCMBlock
 
   u8 GetNibble(u32 index) const { return (data[index / 2] >> ((index % 2) * 4)) & 0x0F; }
 };
+static_assert(sizeof(ADPCMBlock) == SPU_VoiceKernels::ADPCM_BLOCK_SIZE);
 
 struct VolumeEnvelope
 {
@@ -262,7 +269,6 @@ struct Voice
   void ForceOff();
 
   void DecodeBlock(const ADPCMBlock& block);
-  s32 Interpolate() const;
 
   // Switches to the specified phase, filling in target.
   void UpdateADSREnvelope();
@@ -271,41 +277,14 @@ struct Voice
   void TickADSR();
 };
 
-struct ReverbRegisters
+struct ReverbCapture
 {
-  s16 vLOUT;
-  s16 vROUT;
-  u16 mBASE;
-
-  union
-  {
-    struct
-    {
-      u16 FB_SRC_A;
-      u16 FB_SRC_B;
-      s16 IIR_ALPHA;
-      s16 ACC_COEF_A;
-      s16 ACC_COEF_B;
-      s16 ACC_COEF_C;
-      s16 ACC_COEF_D;
-      s16 IIR_COEF;
-      s16 FB_ALPHA;
-      s16 FB_X;
-      u16 IIR_DEST_A[2];
-      u16 ACC_SRC_A[2];
-      u16 ACC_SRC_B[2];
-      u16 IIR_SRC_A[2];
-      u16 IIR_DEST_B[2];
-      u16 ACC_SRC_C[2];
-      u16 ACC_SRC_D[2];
-      u16 IIR_SRC_B[2];
-      u16 MIX_DEST_A[2];
-      u16 MIX_DEST_B[2];
-      s16 IN_COEF[2];
-    };
-
-    u16 rev[NUM_REVERB_REGS];
-  };
+  std::string filename;
+  bool master_enable;
+  SPU_Reverb::State initial_state;
+  std::vector<u8> initial_ram;
+  std::vector<SPU_Reverb::CaptureFrame> frames;
+  std::vector<SPU_Reverb::CaptureWrite> writes;
 };
 
 static ADSRPhase GetNextADSRPhase(ADSRPhase phase);
@@ -327,14 +306,13 @@ static void WriteToCaptureBuffer(u32 index, s16 value);
 static void IncrementCaptureBufferPosition();
 
 static void ReadADPCMBlock(u16 address, ADPCMBlock* block);
-static std::tuple<s32, s32> SampleVoice(u32 voice_index);
+static void PrepareVoiceInterpolation(u32 voice_index, SPU_VoiceKernels::InterpolationInputs* inputs);
+static std::tuple<s32, s32> SampleVoice(u32 voice_index, s32 interpolated_sample);
 
 static void UpdateNoise();
 
-static u32 ReverbMemoryAddress(u32 address);
-static s16 ReverbRead(u32 address, s32 offset = 0);
-static void ReverbWrite(u32 address, s16 data);
 static void ProcessReverb(s16 left_in, s16 right_in, s32* left_out, s32* right_out);
+static void CaptureReverbWrite(u16 reg, u16 value);
 
 static void Execute(void* param, TickCount ticks, TickCount ticks_late);
 static void UpdateEventInterval();
@@ -390,12 +368,9 @@ static u32 s_noise_count = 0;
 static u32 s_noise_level = 0;
 
 static u32 s_reverb_on_register = 0;
-static u32 s_reverb_base_address = 0;
-static u32 s_reverb_current_address = 0;
-static ReverbRegisters s_reverb_registers{};
-static std::array<std::array<s16, 128>, 2> s_reverb_downsample_buffer;
-static std::array<std::array<s16, 64>, 2> s_reverb_upsample_buffer;
-static s32 s_reverb_resample_buffer_position = 0;
+static SPU_Reverb::State s_reverb{};
+static bool s_reverb_vectorized = true;
+static std::unique_ptr<ReverbCapture> s_reverb_capture;
 
 static std::array<Voice, NUM_VOICES> s_voices{};
 
@@ -496,12 +471,8 @@ void SPU::Reset()
   s_noise_level = 1;
 
   s_reverb_on_register = 0;
-  s_reverb_registers = {};
-  s_reverb_registers.mBASE = 0;
-  s_reverb_base_address = s_reverb_current_address = ZeroExtend32(s_reverb_registers.mBASE) << 2;
-  s_reverb_downsample_buffer = {};
-  s_reverb_upsample_buffer = {};
-  s_reverb_resample_buffer_position = 0;
+  s_reverb = {};
+  SPU_Reverb::SetBaseAddress(s_reverb, 0);
 
   for (u32 i = 0; i < NUM_VOICES; i++)
   {
@@ -552,17 +523,17 @@ bool SPU::DoState(StateWrapper& sw)
   sw.Do(&s_noise_count);
   sw.Do(&s_noise_level);
   sw.Do(&s_reverb_on_register);
-  sw.Do(&s_reverb_base_address);
-  sw.Do(&s_reverb_current_address);
-  sw.Do(&s_reverb_registers.vLOUT);
-  sw.Do(&s_reverb_registers.vROUT);
-  sw.Do(&s_reverb_registers.mBASE);
-  sw.DoArray(s_reverb_registers.rev, NUM_REVERB_REGS);
+  sw.Do(&s_reverb.base_address);
+  sw.Do(&s_reverb.current_address);
+  sw.Do(&s_reverb.regs.vLOUT);
+  sw.Do(&s_reverb.regs.vROUT);
+  sw.Do(&s_reverb.regs.mBASE);
+  sw.DoArray(s_reverb.regs.rev, SPU_Reverb::NUM_REGISTERS);
   for (u32 i = 0; i < 2; i++)
-    sw.DoArray(s_reverb_downsample_buffer.data(), s_reverb_downsample_buffer.size());
+    sw.DoArray(s_reverb.downsample_buffer.data(), s_reverb.downsample_buffer.size());
   for (u32 i = 0; i < 2; i++)
-    sw.DoArray(s_reverb_upsample_buffer.data(), s_reverb_upsample_buffer.size());
-  sw.Do(&s_reverb_resample_buffer_position);
+    sw.DoArray(s_reverb.upsample_buffer.data(), s_reverb.upsample_buffer.size());
+  sw.Do(&s_reverb.resample_buffer_position);
   for (u32 i = 0; i < NUM_VOICES; i++)
   {
     Voice& v = s_voices[i];
@@ -591,6 +562,12 @@ bool SPU::DoState(StateWrapper& sw)
   {
     UpdateEventInterval();
     UpdateTransferEvent();
+
+    if (s_reverb_capture)
+    {
+      Log_WarningPrintf("Discarding reverb capture after state load.");
+      s_reverb_capture.reset();
+    }
   }
 
   return !sw.HasError();
@@ -607,10 +584,10 @@ u16 SPU::ReadRegister(u32 offset)
       return s_main_volume_right_reg.bits;
 
     case 0x1F801D84 - SPU_BASE:
-      return s_reverb_registers.vLOUT;
+      return s_reverb.regs.vLOUT;
 
     case 0x1F801D86 - SPU_BASE:
-      return s_reverb_registers.vROUT;
+      return s_reverb.regs.vROUT;
 
     case 0x1F801D88 - SPU_BASE:
       return Truncate16(s_key_on_register);
@@ -649,7 +626,7 @@ u16 SPU::ReadRegister(u32 offset)
       return Truncate16(s_endx_register >> 16);
 
     case 0x1F801DA2 - SPU_BASE:
-      return s_reverb_registers.mBASE;
+      return s_reverb.regs.mBASE;
 
     case 0x1F801DA4 - SPU_BASE:
       Log_TracePrintf("SPU IRQ address -> 0x%04X", ZeroExtend32(s_irq_address));
@@ -702,7 +679,7 @@ u16 SPU::ReadRegister(u32 offset)
         return ReadVoiceRegister(offset);
 
       if (offset >= (0x1F801DC0 - SPU_BASE) && offset < (0x1F801E00 - SPU_BASE))
-        return s_reverb_registers.rev[(offset - (0x1F801DC0 - SPU_BASE)) / 2];
+        return s_reverb.regs.rev[(offset - (0x1F801DC0 - SPU_BASE)) / 2];
 
       if (offset >= (0x1F801E00 - SPU_BASE) && offset < (0x1F801E60 - SPU_BASE))
       {
@@ -746,7 +723,7 @@ void SPU::WriteRegister(u32 offset, u16 value)
     {
       Log_DebugPrintf("SPU reverb output volume left <- 0x%04X", ZeroExtend32(value));
       GeneratePendingSamples();
-      s_reverb_registers.vLOUT = value;
+      s_reverb.regs.vLOUT = value;
       return;
     }
 
@@ -754,7 +731,7 @@ void SPU::WriteRegister(u32 offset, u16 value)
     {
       Log_DebugPrintf("SPU reverb output volume right <- 0x%04X", ZeroExtend32(value));
       GeneratePendingSamples();
-      s_reverb_registers.vROUT = value;
+      s_reverb.regs.vROUT = value;
       return;
     }
 
@@ -843,9 +820,9 @@ void SPU::WriteRegister(u32 offset, u16 value)
     {
       Log_DebugPrintf("SPU reverb base address < 0x%04X", ZeroExtend32(value));
       GeneratePendingSamples();
-      s_reverb_registers.mBASE = value;
-      s_reverb_base_address = ZeroExtend32(value << 2) & 0x3FFFFu;
-      s_reverb_current_address = s_reverb_base_address;
+      SPU_Reverb::SetBaseAddress(s_reverb, value);
+      if (s_reverb_capture)
+        CaptureReverbWrite(SPU_Reverb::CAPTURE_REGISTER_MBASE, value);
     }
     break;
 
@@ -922,6 +899,9 @@ void SPU::WriteRegister(u32 offset, u16 value)
           s_voices[i].ForceOff();
       }
 
+      if (s_reverb_capture && new_value.reverb_master_enable != s_SPUCNT.reverb_master_enable)
+        CaptureReverbWrite(SPU_Reverb::CAPTURE_REGISTER_MASTER_ENABLE, new_value.reverb_master_enable);
+
       s_SPUCNT.bits = new_value.bits;
       s_SPUSTAT.mode = s_SPUCNT.mode.GetValue();
 
@@ -994,7 +974,9 @@ void SPU::WriteRegister(u32 offset, u16 value)
         const u32 reg = (offset - (0x1F801DC0 - SPU_BASE)) / 2;
         Log_DebugPrintf("SPU reverb register %u <- 0x%04X", reg, value);
         GeneratePendingSamples();
-        s_reverb_registers.rev[reg] = value;
+        s_reverb.regs.rev[reg] = value;
+        if (s_reverb_capture)
+          CaptureReverbWrite(static_cast<u16>(reg), value);
         return;
       }
 
@@ -1526,6 +1508,67 @@ bool SPU::StopDumpingAudio()
   return true;
 }
 
+bool SPU::IsReverbVectorized()
+{
+#ifdef SPU_REVERB_VECTOR
+  return s_reverb_vectorized;
+#else
+  return false;
+#endif
+}
+
+void SPU::SetReverbVectorized(bool enabled)
+{
+  s_reverb_vectorized = enabled;
+}
+
+bool SPU::IsCapturingReverb()
+{
+  return static_cast<bool>(s_reverb_capture);
+}
+
+void SPU::StartReverbCapture(const char* filename)
+{
+  s_reverb_capture = std::make_unique<ReverbCapture>();
+  s_reverb_capture->filename = filename;
+  s_reverb_capture->master_enable = s_SPUCNT.reverb_master_enable;
+  s_reverb_capture->initial_state = s_reverb;
+  s_reverb_capture->initial_ram.assign(s_ram.begin(), s_ram.end());
+}
+
+bool SPU::StopReverbCapture()
+{
+  if (!s_reverb_capture)
+    return false;
+
+  const std::unique_ptr<ReverbCapture> capture = std::move(s_reverb_capture);
+  const SPU_Reverb::CaptureHeader header = {SPU_Reverb::CAPTURE_MAGIC, SPU_Reverb::CAPTURE_VERSION,
+                                            static_cast<u32>(capture->frames.size()),
+                                            static_cast<u32>(capture->writes.size()), capture->master_enable};
+
+  auto fp = FileSystem::OpenManagedCFile(capture->filename.c_str(), "wb");
+  if (!fp || std::fwrite(&header, sizeof(header), 1, fp.get()) != 1 ||
+      std::fwrite(&capture->initial_state, sizeof(capture->initial_state), 1, fp.get()) != 1 ||
+      std::fwrite(capture->initial_ram.data(), capture->initial_ram.size(), 1, fp.get()) != 1 ||
+      (!capture->frames.empty() && std::fwrite(capture->frames.data(), sizeof(SPU_Reverb::CaptureFrame),
+                                               capture->frames.size(), fp.get()) != capture->frames.size()) ||
+      (!capture->writes.empty() && std::fwrite(capture->writes.data(), sizeof(SPU_Reverb::CaptureWrite),
+                                               capture->writes.size(), fp.get()) != capture->writes.size()))
+  {
+    Log_ErrorPrintf("Failed to write reverb capture to '%s'", capture->filename.c_str());
+    return false;
+  }
+
+  Log_InfoPrintf("Wrote %zu frames and %zu register writes of reverb to '%s'", capture->frames.size(),
+                 capture->writes.size(), capture->filename.c_str());
+  return true;
+}
+
+void SPU::CaptureReverbWrite(u16 reg, u16 value)
+{
+  s_reverb_capture->writes.push_back({static_cast<u32>(s_reverb_capture->frames.size()), reg, value});
+}
+
 const std::array<u8, SPU::RAM_SIZE>& SPU::GetRAM()
 {
   return s_ram;
@@ -1796,101 +1839,36 @@ void SPU::Voice::DecodeBlock(const ADPCMBlock& block)
   const s32 filter_neg = filter_table_neg[filter_index];
   s16 last_samples[2] = {adpcm_last_samples[0], adpcm_last_samples[1]};
 
-  // samples
-  for (u32 i = 0; i < NUM_SAMPLES_PER_ADPCM_BLOCK; i++)
+  // extend 4-bit to 16-bit and apply shift from header
+  alignas(16) std::array<s16, SPU_VoiceKernels::NUM_EXPANDED_ADPCM_SAMPLES> expanded;
+  SPU_VoiceKernels::ExpandADPCMNibbles(reinterpret_cast<const u8*>(&block), shift, expanded.data());
+
+  s16* const samples = &current_block_samples[NUM_SAMPLES_FROM_LAST_ADPCM_BLOCK];
+  if (filter_index == 0)
   {
-    // extend 4-bit to 16-bit, apply shift from header and mix in previous samples
-    s32 sample = s32(static_cast<s16>(ZeroExtend16(block.GetNibble(i)) << 12) >> shift);
-    sample += (last_samples[0] * filter_pos) >> 6;
-    sample += (last_samples[1] * filter_neg) >> 6;
+    // no prediction, the samples are already in range
+    std::copy_n(expanded.begin(), NUM_SAMPLES_PER_ADPCM_BLOCK, samples);
+    last_samples[0] = samples[NUM_SAMPLES_PER_ADPCM_BLOCK - 1];
+    last_samples[1] = samples[NUM_SAMPLES_PER_ADPCM_BLOCK - 2];
+  }
+  else
+  {
+    // mix in previous samples
+    for (u32 i = 0; i < NUM_SAMPLES_PER_ADPCM_BLOCK; i++)
+    {
+      s32 sample = s32(expanded[i]);
+      sample += (last_samples[0] * filter_pos) >> 6;
+      sample += (last_samples[1] * filter_neg) >> 6;
 
-    last_samples[1] = last_samples[0];
-    current_block_samples[NUM_SAMPLES_FROM_LAST_ADPCM_BLOCK + i] = last_samples[0] = static_cast<s16>(Clamp16(sample));
+      last_samples[1] = last_samples[0];
+      samples[i] = last_samples[0] = static_cast<s16>(Clamp16(sample));
+    }
   }
 
   std::copy(last_samples, last_samples + countof(last_samples), adpcm_last_samples.begin());
   current_block_flags.bits = block.flags.bits;
 }
 
-s32 SPU::Voice::Interpolate() const
-{
-  static constexpr std::array<s16, 0x200> gauss = {{
-    -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, //
-    -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, //
-    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0001, //
-    0x0001, 0x0001, 0x0001, 0x0002, 0x0002, 0x0002, 0x0003, 0x0003, //
-    0x0003, 0x0004, 0x0004, 0x0005, 0x0005, 0x0006, 0x0007, 0x0007, //
-    0x0008, 0x0009, 0x0009, 0x000A, 0x000B, 0x000C, 0x000D, 0x000E, //
-    0x000F, 0x0010, 0x0011, 0x0012, 0x0013, 0x0015, 0x0016, 0x0018, // entry
-    0x0019, 0x001B, 0x001C, 0x001E, 0x0020, 0x0021, 0x0023, 0x0025, // 000..07F
-    0x0027, 0x0029, 0x002C, 0x002E, 0x0030, 0x0033, 0x0035, 0x0038, //
-    0x003A, 0x003D, 0x0040, 0x0043, 0x0046, 0x0049, 0x004D, 0x0050, //
-    0x0054, 0x0057, 0x005B, 0x005F, 0x0063, 0x0067, 0x006B, 0x006F, //
-    0x0074, 0x0078, 0x007D, 0x0082, 0x0087, 0x008C, 0x0091, 0x0096, //
-    0x009C, 0x00A1, 0x00A7, 0x00AD, 0x00B3, 0x00BA, 0x00C0, 0x00C7, //
-    0x00CD, 0x00D4, 0x00DB, 0x00E3, 0x00EA, 0x00F2, 0x00FA, 0x0101, //
-    0x010A, 0x0112, 0x011B, 0x0123, 0x012C, 0x0135, 0x013F, 0x0148, //
-    0x0152, 0x015C, 0x0166, 0x0171, 0x017B, 0x0186, 0x0191, 0x019C, //
-    0x01A8, 0x01B4, 0x01C0, 0x01CC, 0x01D9, 0x01E5, 0x01F2, 0x0200, //
-    0x020D, 0x021B, 0x0229, 0x0237, 0x0246, 0x0255, 0x0264, 0x0273, //
-    0x0283, 0x0293, 0x02A3, 0x02B4, 0x02C4, 0x02D6, 0x02E7, 0x02F9, //
-    0x030B, 0x031D, 0x0330, 0x0343, 0x0356, 0x036A, 0x037E, 0x0392, //
-    0x03A7, 0x03BC, 0x03D1, 0x03E7, 0x03FC, 0x0413, 0x042A, 0x0441, //
-    0x0458, 0x0470, 0x0488, 0x04A0, 0x04B9, 0x04D2, 0x04EC, 0x0506, //
-    0x0520, 0x053B, 0x0556, 0x0572, 0x058E, 0x05AA, 0x05C7, 0x05E4, // entry
-    0x0601, 0x061F, 0x063E, 0x065C, 0x067C, 0x069B, 0x06BB, 0x06DC, // 080..0FF
-    0x06FD, 0x071E, 0x0740, 0x0762, 0x0784, 0x07A7, 0x07CB, 0x07EF, //
-    0x0813, 0x0838, 0x085D, 0x0883, 0x08A9, 0x08D0, 0x08F7, 0x091E, //
-    0x0946, 0x096F, 0x0998, 0x09C1, 0x09EB, 0x0A16, 0x0A40, 0x0A6C, //
-    0x0A98, 0x0AC4, 0x0AF1, 0x0B1E, 0x0B4C, 0x0B7A, 0x0BA9, 0x0BD8, //
-    0x0C07, 0x0C38, 0x0C68, 0x0C99, 0x0CCB, 0x0CFD, 0x0D30, 0x0D63, //
-    0x0D97, 0x0DCB, 0x0E00, 0x0E35, 0x0E6B, 0x0EA1, 0x0ED7, 0x0F0F, //
-    0x0F46, 0x0F7F, 0x0FB7, 0x0FF1, 0x102A, 0x1065, 0x109F, 0x10DB, //
-    0x1116, 0x1153, 0x118F, 0x11CD, 0x120B, 0x1249, 0x1288, 0x12C7, //
-    0x1307, 0x1347, 0x1388, 0x13C9, 0x140B, 0x144D, 0x1490, 0x14D4, //
-    0x1517, 0x155C, 0x15A0, 0x15E6, 0x162C, 0x1672, 0x16B9, 0x1700, //
-    0x1747, 0x1790, 0x17D8, 0x1821, 0x186B, 0x18B5, 0x1900, 0x194B, //
-    0x1996, 0x19E2, 0x1A2E, 0x1A7B, 0x1AC8, 0x1B16, 0x1B64, 0x1BB3, //
-    0x1C02, 0x1C51, 0x1CA1, 0x1CF1, 0x1D42, 0x1D93, 0x1DE5, 0x1E37, //
-    0x1E89, 0x1EDC, 0x1F2F, 0x1F82, 0x1FD6, 0x202A, 0x207F, 0x20D4, //
-    0x2129, 0x217F, 0x21D5, 0x222C, 0x2282, 0x22DA, 0x2331, 0x2389, // entry
-    0x23E1, 0x2439, 0x2492, 0x24EB, 0x2545, 0x259E, 0x25F8, 0x2653, // 100..17F
-    0x26AD, 0x2708, 0x2763, 0x27BE, 0x281A, 0x2876, 0x28D2, 0x292E, //
-    0x298B, 0x29E7, 0x2A44, 0x2AA1, 0x2AFF, 0x2B5C, 0x2BBA, 0x2C18, //
-    0x2C76, 0x2CD4, 0x2D33, 0x2D91, 0x2DF0, 0x2E4F, 0x2EAE, 0x2F0D, //
-    0x2F6C, 0x2FCC, 0x302B, 0x308B, 0x30EA, 0x314A, 0x31AA, 0x3209, //
-    0x3269, 0x32C9, 0x3329, 0x3389, 0x33E9, 0x3449, 0x34A9, 0x3509, //
-    0x3569, 0x35C9, 0x3629, 0x3689, 0x36E8, 0x3748, 0x37A8, 0x3807, //
-    0x3867, 0x38C6, 0x3926, 0x3985, 0x39E4, 0x3A43, 0x3AA2, 0x3B00, //
-    0x3B5F, 0x3BBD, 0x3C1B, 0x3C79, 0x3CD7, 0x3D35, 0x3D92, 0x3DEF, //
-    0x3E4C, 0x3EA9, 0x3F05, 0x3F62, 0x3FBD, 0x4019, 0x4074, 0x40D0, //
-    0x412A, 0x4185, 0x41DF, 0x4239, 0x4292, 0x42EB, 0x4344, 0x439C, //
-    0x43F4, 0x444C, 0x44A3, 0x44FA, 0x4550, 0x45A6, 0x45FC, 0x4651, //
-    0x46A6, 0x46FA, 0x474E, 0x47A1, 0x47F4, 0x4846, 0x4898, 0x48E9, //
-    0x493A, 0x498A, 0x49D9, 0x4A29, 0x4A77, 0x4AC5, 0x4B13, 0x4B5F, //
-    0x4BAC, 0x4BF7, 0x4C42, 0x4C8D, 0x4CD7, 0x4D20, 0x4D68, 0x4DB0, //
-    0x4DF7, 0x4E3E, 0x4E84, 0x4EC9, 0x4F0E, 0x4F52, 0x4F95, 0x4FD7, // entry
-    0x5019, 0x505A, 0x509A, 0x50DA, 0x5118, 0x5156, 0x5194, 0x51D0, // 180..1FF
-    0x520C, 0x5247, 0x5281, 0x52BA, 0x52F3, 0x532A, 0x5361, 0x5397, //
-    0x53CC, 0x5401, 0x5434, 0x5467, 0x5499, 0x54CA, 0x54FA, 0x5529, //
-    0x5558, 0x5585, 0x55B2, 0x55DE, 0x5609, 0x5632, 0x565B, 0x5684, //
-    0x56AB, 0x56D1, 0x56F6, 0x571B, 0x573E, 0x5761, 0x5782, 0x57A3, //
-    0x57C3, 0x57E2, 0x57FF, 0x581C, 0x5838, 0x5853, 0x586D, 0x5886, //
-    0x589E, 0x58B5, 0x58CB, 0x58E0, 0x58F4, 0x5907, 0x5919, 0x592A, //
-    0x593A, 0x5949, 0x5958, 0x5965, 0x5971, 0x597C, 0x5986, 0x598F, //
-    0x5997, 0x599E, 0x59A4, 0x59A9, 0x59AD, 0x59B0, 0x59B2, 0x59B3  //
-  }};
-
-  const u8 i = counter.interpolation_index;
-  const u32 s = NUM_SAMPLES_FROM_LAST_ADPCM_BLOCK + ZeroExtend32(counter.sample_index.GetValue());
-
-  s32 out = s32(gauss[0x0FF - i]) * s32(current_block_samples[s - 3]);
-  out += s32(gauss[0x1FF - i]) * s32(current_block_samples[s - 2]);
-  out += s32(gauss[0x100 + i]) * s32(current_block_samples[s - 1]);
-  out += s32(gauss[0x000 + i]) * s32(current_block_samples[s - 0]);
-  return out >> 15;
-}
-
 void SPU::ReadADPCMBlock(u16 address, ADPCMBlock* block)
 {
   u32 ram_address = (ZeroExtend32(address) * 8) & RAM_MASK;
@@ -1918,22 +1896,14 @@ void SPU::ReadADPCMBlock(u16 address, ADPCMBlock* block)
   }
 }
 
-ALWAYS_INLINE_RELEASE std::tuple<s32, s32> SPU::SampleVoice(u32 voice_index)
+ALWAYS_INLINE_RELEASE void SPU::PrepareVoiceInterpolation(u32 voice_index,
+                                                           SPU_VoiceKernels::InterpolationInputs* inputs)
 {
   Voice& voice = s_voices[voice_index];
   if (!voice.IsOn() && !s_SPUCNT.irq9_enable)
   {
-    voice.last_volume = 0;
-
-#ifdef SPU_DUMP_ALL_VOICES
-    if (s_voice_dump_writers[voice_index])
-    {
-      const s16 dump_samples[2] = {0, 0};
-      s_voice_dump_writers[voice_index]->WriteFrames(dump_samples, 1);
-    }
-#endif
-
-    return {};
+    inputs->ClearVoice(voice_index);
+    return;
   }
 
   if (!voice.has_samples)
@@ -1951,15 +1921,39 @@ ALWAYS_INLINE_RELEASE std::tuple<s32, s32> SPU::SampleVoice(u32 voice_index)
   }
 
   // skip interpolation when the volume is muted anyway
+  if (voice.regs.adsr_volume == 0 || IsVoiceNoiseEnabled(voice_index))
+  {
+    inputs->ClearVoice(voice_index);
+    return;
+  }
+
+  const u32 s = NUM_SAMPLES_FROM_LAST_ADPCM_BLOCK + ZeroExtend32(voice.counter.sample_index.GetValue());
+  inputs->SetVoice(voice_index, &voice.current_block_samples[s], voice.counter.interpolation_index);
+}
+
+ALWAYS_INLINE_RELEASE std::tuple<s32, s32> SPU::SampleVoice(u32 voice_index, s32 interpolated_sample)
+{
+  Voice& voice = s_voices[voice_index];
+  if (!voice.IsOn() && !s_SPUCNT.irq9_enable)
+  {
+    voice.last_volume = 0;
+
+#ifdef SPU_DUMP_ALL_VOICES
+    if (s_voice_dump_writers[voice_index])
+    {
+      const s16 dump_samples[2] = {0, 0};
+      s_voice_dump_writers[voice_index]->WriteFrames(dump_samples, 1);
+    }
+#endif
+
+    return {};
+  }
+
   s32 volume;
   if (voice.regs.adsr_volume != 0)
   {
-    // interpolate/sample and apply ADSR volume
-    s32 sample;
-    if (IsVoiceNoiseEnabled(voice_index))
-      sample = GetVoiceNoiseLevel();
-    else
-      sample = voice.Interpolate();
+    // sample and apply ADSR volume
+    const s32 sample = IsVoiceNoiseEnabled(voice_index) ? s32(GetVoiceNoiseLevel()) : interpolated_sample;
 
     volume = ApplyVolume(sample, voice.regs.adsr_volume);
   }
@@ -2056,187 +2050,27 @@ void SPU::UpdateNoise()
   s_noise_level = (s_noise_level << 1) | noise_wave_add[(s_noise_level >> 10) & 63u];
 }
 
-/************************************************************************/
-/* Reverb algorithm from Mednafen-PSX                                   */
-/************************************************************************/
-
-u32 SPU::ReverbMemoryAddress(u32 address)
-{
-  // Ensures address does not leave the reverb work area.
-  static constexpr u32 MASK = (RAM_SIZE - 1) / 2;
-  u32 offset = s_reverb_current_address + (address & MASK);
-  offset += s_reverb_base_address & ((s32)(offset << 13) >> 31);
-
-  // We address RAM in bytes. TODO: Change this to words.
-  return (offset & MASK) * 2u;
-}
-
-s16 SPU::ReverbRead(u32 address, s32 offset)
-{
-  // TODO: This should check interrupts.
-  const u32 real_address = ReverbMemoryAddress((address << 2) + offset);
-
-  s16 data;
-  std::memcpy(&data, &s_ram[real_address], sizeof(data));
-  return data;
-}
-
-void SPU::ReverbWrite(u32 address, s16 data)
-{
-  // TODO: This should check interrupts.
-  const u32 real_address = ReverbMemoryAddress(address << 2);
-  std::memcpy(&s_ram[real_address], &data, sizeof(data));
-}
-
-// Zeroes optimized out; middle removed too(it's 16384)
-static constexpr std::array<s16, 20> s_reverb_resample_coefficients = {
-  -1, 2, -10, 35, -103, 266, -616, 1332, -2960, 10246, 10246, -2960, 1332, -616, 266, -103, 35, -10, 2, -1,
-};
 static s16 s_last_reverb_input[2];
 static s32 s_last_reverb_output[2];
 
-ALWAYS_INLINE static s32 Reverb4422(const s16* src)
-{
-  s32 out = 0; // 32-bits is adequate(it won't overflow)
-  for (u32 i = 0; i < 20; i++)
-    out += s_reverb_resample_coefficients[i] * src[i * 2];
-
-  // Middle non-zero
-  out += 0x4000 * src[19];
-  out >>= 15;
-  return std::clamp<s32>(out, -32768, 32767);
-}
-
-template<bool phase>
-ALWAYS_INLINE static s32 Reverb2244(const s16* src)
-{
-  s32 out; // 32-bits is adequate(it won't overflow)
-  if (phase)
-  {
-    // Middle non-zero
-    out = src[9];
-  }
-  else
-  {
-    out = 0;
-    for (u32 i = 0; i < 20; i++)
-      out += s_reverb_resample_coefficients[i] * src[i];
-
-    out >>= 14;
-    out = std::clamp<s32>(out, -32768, 32767);
-  }
-
-  return out;
-}
-
-ALWAYS_INLINE static s16 ReverbSat(s32 val)
-{
-  return static_cast<s16>(std::clamp<s32>(val, -0x8000, 0x7FFF));
-}
-
-ALWAYS_INLINE static s16 ReverbNeg(s16 samp)
-{
-  if (samp == -32768)
-    return 0x7FFF;
-
-  return -samp;
-}
-
-ALWAYS_INLINE static s32 IIASM(const s16 IIR_ALPHA, const s16 insamp)
-{
-  if (IIR_ALPHA == -32768)
-  {
-    if (insamp == -32768)
-      return 0;
-    else
-      return insamp * -65536;
-  }
-  else
-    return insamp * (32768 - IIR_ALPHA);
-}
-
 void SPU::ProcessReverb(s16 left_in, s16 right_in, s32* left_out, s32* right_out)
 {
   s_last_reverb_input[0] = left_in;
   s_last_reverb_input[1] = right_in;
-  s_reverb_downsample_buffer[0][s_reverb_resample_buffer_position | 0x00] = left_in;
-  s_reverb_downsample_buffer[0][s_reverb_resample_buffer_position | 0x40] = left_in;
-  s_reverb_downsample_buffer[1][s_reverb_resample_buffer_position | 0x00] = right_in;
-  s_reverb_downsample_buffer[1][s_reverb_resample_buffer_position | 0x40] = right_in;
 
   s32 out[2];
-  if (s_reverb_resample_buffer_position & 1u)
-  {
-    std::array<s32, 2> downsampled;
-    for (unsigned lr = 0; lr < 2; lr++)
-      downsampled[lr] = Reverb4422(&s_reverb_downsample_buffer[lr][(s_reverb_resample_buffer_position - 38) & 0x3F]);
-
-    for (unsigned lr = 0; lr < 2; lr++)
-    {
-      if (s_SPUCNT.reverb_master_enable)
-      {
-        const s16 IIR_INPUT_A =
-          ReverbSat((((ReverbRead(s_reverb_registers.IIR_SRC_A[lr ^ 0]) * s_reverb_registers.IIR_COEF) >> 14) +
-                     ((downsampled[lr] * s_reverb_registers.IN_COEF[lr]) >> 14)) >>
-                    1);
-        const s16 IIR_INPUT_B =
-          ReverbSat((((ReverbRead(s_reverb_registers.IIR_SRC_B[lr ^ 1]) * s_reverb_registers.IIR_COEF) >> 14) +
-                     ((downsampled[lr] * s_reverb_registers.IN_COEF[lr]) >> 14)) >>
-                    1);
-        const s16 IIR_A =
-          ReverbSat((((IIR_INPUT_A * s_reverb_registers.IIR_ALPHA) >> 14) +
-                     (IIASM(s_reverb_registers.IIR_ALPHA, ReverbRead(s_reverb_registers.IIR_DEST_A[lr], -1)) >> 14)) >>
-                    1);
-        const s16 IIR_B =
-          ReverbSat((((IIR_INPUT_B * s_reverb_registers.IIR_ALPHA) >> 14) +
-                     (IIASM(s_reverb_registers.IIR_ALPHA, ReverbRead(s_reverb_registers.IIR_DEST_B[lr], -1)) >> 14)) >>
-                    1);
-
-        ReverbWrite(s_reverb_registers.IIR_DEST_A[lr], IIR_A);
-        ReverbWrite(s_reverb_registers.IIR_DEST_B[lr], IIR_B);
-      }
-
-      const s32 ACC = ((ReverbRead(s_reverb_registers.ACC_SRC_A[lr]) * s_reverb_registers.ACC_COEF_A) >> 14) +
-                      ((ReverbRead(s_reverb_registers.ACC_SRC_B[lr]) * s_reverb_registers.ACC_COEF_B) >> 14) +
-                      ((ReverbRead(s_reverb_registers.ACC_SRC_C[lr]) * s_reverb_registers.ACC_COEF_C) >> 14) +
-                      ((ReverbRead(s_reverb_registers.ACC_SRC_D[lr]) * s_reverb_registers.ACC_COEF_D) >> 14);
-
-      const s16 FB_A = ReverbRead(s_reverb_registers.MIX_DEST_A[lr] - s_reverb_registers.FB_SRC_A);
-      const s16 FB_B = ReverbRead(s_reverb_registers.MIX_DEST_B[lr] - s_reverb_registers.FB_SRC_B);
-      const s16 MDA = ReverbSat((ACC + ((FB_A * ReverbNeg(s_reverb_registers.FB_ALPHA)) >> 14)) >> 1);
-      const s16 MDB = ReverbSat(
-        FB_A +
-        ((((MDA * s_reverb_registers.FB_ALPHA) >> 14) + ((FB_B * ReverbNeg(s_reverb_registers.FB_X)) >> 14)) >> 1));
-      const s16 IVB = ReverbSat(FB_B + ((MDB * s_reverb_registers.FB_X) >> 15));
-
-      if (s_SPUCNT.reverb_master_enable)
-      {
-        ReverbWrite(s_reverb_registers.MIX_DEST_A[lr], MDA);
-        ReverbWrite(s_reverb_registers.MIX_DEST_B[lr], MDB);
-      }
-
-      s_reverb_upsample_buffer[lr][(s_reverb_resample_buffer_position >> 1) | 0x20] =
-        s_reverb_upsample_buffer[lr][s_reverb_resample_buffer_position >> 1] = IVB;
-    }
-
-    s_reverb_current_address = (s_reverb_current_address + 1) & 0x3FFFFu;
-    if (s_reverb_current_address == 0)
-      s_reverb_current_address = s_reverb_base_address;
-
-    for (unsigned lr = 0; lr < 2; lr++)
-      out[lr] =
-        Reverb2244<false>(&s_reverb_upsample_buffer[lr][((s_reverb_resample_buffer_position >> 1) - 19) & 0x1F]);
-  }
+#ifdef SPU_REVERB_VECTOR
+  if (s_reverb_vectorized)
+    SPU_Reverb::Process<true>(s_reverb, s_ram.data(), s_SPUCNT.reverb_master_enable, left_in, right_in, out);
   else
-  {
-    for (unsigned lr = 0; lr < 2; lr++)
-      out[lr] = Reverb2244<true>(&s_reverb_upsample_buffer[lr][((s_reverb_resample_buffer_position >> 1) - 19) & 0x1F]);
-  }
+#endif
+    SPU_Reverb::Process<false>(s_reverb, s_ram.data(), s_SPUCNT.reverb_master_enable, left_in, right_in, out);
 
-  s_reverb_resample_buffer_position = (s_reverb_resample_buffer_position + 1) & 0x3F;
+  if (s_reverb_capture) [[unlikely]]
+    s_reverb_capture->frames.push_back({left_in, right_in});
 
-  s_last_reverb_output[0] = *left_out = ApplyVolume(out[0], s_reverb_registers.vLOUT);
-  s_last_reverb_output[1] = *right_out = ApplyVolume(out[1], s_reverb_registers.vROUT);
+  s_last_reverb_output[0] = *left_out = ApplyVolume(out[0], s_reverb.regs.vLOUT);
+  s_last_reverb_output[1] = *right_out = ApplyVolume(out[1], s_reverb.regs.vROUT);
 
 #ifdef SPU_DUMP_ALL_VOICES
   if (s_voice_dump_writers[NUM_VOICES])
@@ -2283,9 +2117,18 @@ void SPU::Execute(void* param, TickCount ticks, TickCount ticks_late)
 
       u32 reverb_on_register = s_reverb_on_register;
 
+      // Decode new blocks and interpolate every voice up front. Sampling a voice never changes the position of
+      // another, so this produces the same samples as interpolating each voice as it is mixed.
+      SPU_VoiceKernels::InterpolationInputs interpolation_inputs;
+      for (u32 voice = 0; voice < NUM_VOICES; voice++)
+        PrepareVoiceInterpolation(voice, &interpolation_inputs);
+
+      alignas(16) std::array<s32, NUM_VOICES> interpolated_samples;
+      SPU_VoiceKernels::InterpolateVoices(interpolation_inputs, interpolated_samples.data());
+
       for (u32 voice = 0; voice < NUM_VOICES; voice++)
       {
-        const auto [left, right] = SampleVoice(voice);
+        const auto [left, right] = SampleVoice(voice, interpolated_samples[voice]);
         left_sum += left;
         right_sum += right;
 
@@ -2553,12 +2396,12 @@ void SPU::DrawDebugStateWindow()
     ImGui::TextColored(s_SPUCNT.external_audio_reverb ? active_color : inactive_color, "External Audio Enable: %s",
                        s_SPUCNT.external_audio_reverb ? "Yes" : "No");
 
-    ImGui::Text("Base Address: 0x%08X (%04X)", s_reverb_base_address, s_reverb_registers.mBASE);
-    ImGui::Text("Current Address: 0x%08X", s_reverb_current_address);
+    ImGui::Text("Base Address: 0x%08X (%04X)", s_reverb.base_address, s_reverb.regs.mBASE);
+    ImGui::Text("Current Address: 0x%08X", s_reverb.current_address);
     ImGui::Text("Current Amplitude: Input (%d, %d) Output (%d, %d)", s_last_reverb_input[0], s_last_reverb_input[1],
                 s_last_reverb_output[0], s_last_reverb_output[1]);
-    ImGui::Text("Output Volume: Left %d%% Right %d%%", ApplyVolume(100, s_reverb_registers.vLOUT),
-                ApplyVolume(100, s_reverb_registers.vROUT));
+    ImGui::Text("Output Volume: Left %d%% Right %d%%", ApplyVolume(100, s_reverb.regs.vLOUT),
+                ApplyVolume(100, s_reverb.regs.vROUT));
 
     ImGui::Text("Pitch Modulation: ");
     for (u32 i = 1; i < NUM_VOICES; i++)
@@ -45,6 +45,15 @@ bool StartDumpingAudio(const char* filename);
 /// Stops dumping audio to file, if started.
 bool StopDumpingAudio();
 
+/// Selects the SSE2/NEON reverb implementation, when available. The scalar implementation is the reference.
+bool IsReverbVectorized();
+void SetReverbVectorized(bool enabled);
+
+/// Records the reverb input and register writes to a file, for replaying in the reverb benchmark.
+bool IsCapturingReverb();
+void StartReverbCapture(const char* filename);
+bool StopReverbCapture();
+
 /// Access to SPU RAM.
 const std::array<u8, RAM_SIZE>& GetRAM();
 std::array<u8, RAM_SIZE>& GetWritableRAM();
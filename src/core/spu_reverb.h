@@ -0,0 +1,469 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+
+#include "common/bitutils.h"
+#include "common/intrin.h"
+#include "common/types.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+// Reverb algorithm from Mednafen-PSX, shared by the SPU and the reverb benchmark. Process<false>() is the reference
+// implementation. Process<true>() runs the resampling filters and work area address calculation with SSE2 or NEON,
+// and must produce identical output and SPU RAM contents.
+
+#if defined(CPU_ARCH_SSE) || defined(CPU_ARCH_NEON)
+#define SPU_REVERB_VECTOR 1
+#endif
+
+namespace SPU_Reverb {
+
+static constexpr u32 RAM_SIZE = 512 * 1024;
+static constexpr u32 NUM_REGISTERS = 32;
+
+struct Registers
+{
+  s16 vLOUT;
+  s16 vROUT;
+  u16 mBASE;
+
+  union
+  {
+    struct
+    {
+      u16 FB_SRC_A;
+      u16 FB_SRC_B;
+      s16 IIR_ALPHA;
+      s16 ACC_COEF_A;
+      s16 ACC_COEF_B;
+      s16 ACC_COEF_C;
+      s16 ACC_COEF_D;
+      s16 IIR_COEF;
+      s16 FB_ALPHA;
+      s16 FB_X;
+      u16 IIR_DEST_A[2];
+      u16 ACC_SRC_A[2];
+      u16 ACC_SRC_B[2];
+      u16 IIR_SRC_A[2];
+      u16 IIR_DEST_B[2];
+      u16 ACC_SRC_C[2];
+      u16 ACC_SRC_D[2];
+      u16 IIR_SRC_B[2];
+      u16 MIX_DEST_A[2];
+      u16 MIX_DEST_B[2];
+      s16 IN_COEF[2];
+    };
+
+    u16 rev[NUM_REGISTERS];
+  };
+};
+
+struct State
+{
+  Registers regs;
+  u32 base_address;
+  u32 current_address;
+  std::array<std::array<s16, 128>, 2> downsample_buffer;
+  std::array<std::array<s16, 64>, 2> upsample_buffer;
+  s32 resample_buffer_position;
+};
+static_assert(std::is_trivially_copyable_v<State>);
+
+/// Writes mBASE, which also restarts the work area at the new base.
+ALWAYS_INLINE static void SetBaseAddress(State& state, u16 value)
+{
+  state.regs.mBASE = value;
+  state.base_address = ZeroExtend32(value << 2) & 0x3FFFFu;
+  state.current_address = state.base_address;
+}
+
+// Zeroes optimized out; middle removed too(it's 16384)
+inline constexpr std::array<s16, 20> g_resample_coefficients = {
+  -1, 2, -10, 35, -103, 266, -616, 1332, -2960, 10246, 10246, -2960, 1332, -616, 266, -103, 35, -10, 2, -1,
+};
+
+ALWAYS_INLINE static s32 Downsample4422Scalar(const s16* src)
+{
+  s32 out = 0; // 32-bits is adequate(it won't overflow)
+  for (u32 i = 0; i < 20; i++)
+    out += g_resample_coefficients[i] * src[i * 2];
+
+  // Middle non-zero
+  out += 0x4000 * src[19];
+  out >>= 15;
+  return std::clamp<s32>(out, -32768, 32767);
+}
+
+ALWAYS_INLINE static s32 Upsample2244Scalar(const s16* src)
+{
+  s32 out = 0; // 32-bits is adequate(it won't overflow)
+  for (u32 i = 0; i < 20; i++)
+    out += g_resample_coefficients[i] * src[i];
+
+  out >>= 14;
+  return std::clamp<s32>(out, -32768, 32767);
+}
+
+// Work area taps, i.e. addresses read or written by one reverb step. The first 24 mirror rev[8..31], so they can be
+// widened straight from the registers, the remainder are derived addresses.
+enum : u32
+{
+  TAP_IIR_DEST_A = 2,
+  TAP_ACC_SRC_A = 4,
+  TAP_ACC_SRC_B = 6,
+  TAP_IIR_SRC_A = 8,
+  TAP_IIR_DEST_B = 10,
+  TAP_ACC_SRC_C = 12,
+  TAP_ACC_SRC_D = 14,
+  TAP_IIR_SRC_B = 16,
+  TAP_MIX_DEST_A = 18,
+  TAP_MIX_DEST_B = 20,
+  TAP_IIR_PREV_A = 24, // IIR_DEST_A - 1
+  TAP_IIR_PREV_B = 26, // IIR_DEST_B - 1
+  TAP_FB_A = 28,       // MIX_DEST_A - FB_SRC_A
+  TAP_FB_B = 30,       // MIX_DEST_B - FB_SRC_B
+  NUM_TAPS = 32,
+
+  FIRST_TAP_REGISTER = 8,
+  NUM_REGISTER_TAPS = 24,
+};
+static_assert(offsetof(Registers, IIR_DEST_A) == offsetof(Registers, rev[FIRST_TAP_REGISTER + TAP_IIR_DEST_A]));
+static_assert(offsetof(Registers, MIX_DEST_B) == offsetof(Registers, rev[FIRST_TAP_REGISTER + TAP_MIX_DEST_B]));
+
+using Taps = std::array<u32, NUM_TAPS>;
+
+/// Converts a halfword offset relative to the current address to a byte address in SPU RAM.
+ALWAYS_INLINE static u32 MemoryAddress(const State& state, u32 address)
+{
+  // Ensures address does not leave the reverb work area.
+  static constexpr u32 MASK = (RAM_SIZE - 1) / 2;
+  u32 offset = state.current_address + (address & MASK);
+  offset += state.base_address & ((s32)(offset << 13) >> 31);
+
+  // We address RAM in bytes. TODO: Change this to words.
+  return (offset & MASK) * 2u;
+}
+
+ALWAYS_INLINE static void ComputeTapsScalar(const State& state, Taps* taps)
+{
+  for (u32 i = 0; i < NUM_REGISTER_TAPS; i++)
+    (*taps)[i] = MemoryAddress(state, ZeroExtend32(state.regs.rev[FIRST_TAP_REGISTER + i]) << 2);
+
+  for (u32 lr = 0; lr < 2; lr++)
+  {
+    (*taps)[TAP_IIR_PREV_A + lr] = MemoryAddress(state, (ZeroExtend32(state.regs.IIR_DEST_A[lr]) << 2) - 1u);
+    (*taps)[TAP_IIR_PREV_B + lr] = MemoryAddress(state, (ZeroExtend32(state.regs.IIR_DEST_B[lr]) << 2) - 1u);
+    (*taps)[TAP_FB_A + lr] =
+      MemoryAddress(state, static_cast<u32>(state.regs.MIX_DEST_A[lr] - state.regs.FB_SRC_A) << 2);
+    (*taps)[TAP_FB_B + lr] =
+      MemoryAddress(state, static_cast<u32>(state.regs.MIX_DEST_B[lr] - state.regs.FB_SRC_B) << 2);
+  }
+}
+
+#ifdef SPU_REVERB_VECTOR
+
+/// Downsampling filter taps in even lanes for a pairwise multiply-add, with the middle tap in lane 19.
+inline constexpr std::array<s16, 40> g_downsample_coefficients = []() {
+  std::array<s16, 40> coefficients = {};
+  for (u32 i = 0; i < 20; i++)
+    coefficients[i * 2] = g_resample_coefficients[i];
+  coefficients[19] = 0x4000;
+  return coefficients;
+}();
+
+/// Upsampling filter taps, padded to a whole number of vectors.
+inline constexpr std::array<s16, 24> g_upsample_coefficients = []() {
+  std::array<s16, 24> coefficients = {};
+  for (u32 i = 0; i < 20; i++)
+    coefficients[i] = g_resample_coefficients[i];
+  return coefficients;
+}();
+
+/// Multiplies count * 8 samples by coefficients and sums the products. The sum fits in 32 bits for any input.
+template<u32 count>
+ALWAYS_INLINE static s32 DotProduct(const s16* src, const s16* coefficients)
+{
+#if defined(CPU_ARCH_SSE)
+  __m128i sum = _mm_setzero_si128();
+  for (u32 i = 0; i < count; i++)
+  {
+    sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 8)),
+                                            _mm_loadu_si128(reinterpret_cast<const __m128i*>(coefficients + i * 8))));
+  }
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sum);
+#elif defined(CPU_ARCH_NEON)
+  int32x4_t sum = vdupq_n_s32(0);
+  for (u32 i = 0; i < count; i++)
+  {
+    const int16x8_t s = vld1q_s16(src + i * 8);
+    const int16x8_t c = vld1q_s16(coefficients + i * 8);
+    sum = vmlal_s16(sum, vget_low_s16(s), vget_low_s16(c));
+    sum = vmlal_high_s16(sum, s, c);
+  }
+  return vaddvq_s32(sum);
+#endif
+}
+
+/// Reads 40 samples from src, i.e. one past the last tap.
+ALWAYS_INLINE static s32 Downsample4422(const s16* src)
+{
+  const s32 out = DotProduct<5>(src, g_downsample_coefficients.data()) >> 15;
+  return std::clamp<s32>(out, -32768, 32767);
+}
+
+/// Reads 24 samples from src, i.e. four past the last tap.
+ALWAYS_INLINE static s32 Upsample2244(const s16* src)
+{
+  const s32 out = DotProduct<3>(src, g_upsample_coefficients.data()) >> 14;
+  return std::clamp<s32>(out, -32768, 32767);
+}
+
+ALWAYS_INLINE static void ComputeTaps(const State& state, Taps* taps)
+{
+  alignas(16) Taps offsets;
+  for (u32 lr = 0; lr < 2; lr++)
+  {
+    offsets[TAP_IIR_PREV_A + lr] = (ZeroExtend32(state.regs.IIR_DEST_A[lr]) << 2) - 1u;
+    offsets[TAP_IIR_PREV_B + lr] = (ZeroExtend32(state.regs.IIR_DEST_B[lr]) << 2) - 1u;
+    offsets[TAP_FB_A + lr] = static_cast<u32>(state.regs.MIX_DEST_A[lr] - state.regs.FB_SRC_A) << 2;
+    offsets[TAP_FB_B + lr] = static_cast<u32>(state.regs.MIX_DEST_B[lr] - state.regs.FB_SRC_B) << 2;
+  }
+
+  // Same as MemoryAddress(), four taps at a time.
+#if defined(CPU_ARCH_SSE)
+  const __m128i zero = _mm_setzero_si128();
+  for (u32 i = 0; i < NUM_REGISTER_TAPS; i += 8)
+  {
+    const __m128i regs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state.regs.rev[FIRST_TAP_REGISTER + i]));
+    _mm_store_si128(reinterpret_cast<__m128i*>(&offsets[i]), _mm_slli_epi32(_mm_unpacklo_epi16(regs, zero), 2));
+    _mm_store_si128(reinterpret_cast<__m128i*>(&offsets[i + 4]), _mm_slli_epi32(_mm_unpackhi_epi16(regs, zero), 2));
+  }
+
+  const __m128i mask = _mm_set1_epi32((RAM_SIZE - 1) / 2);
+  const __m128i current = _mm_set1_epi32(static_cast<s32>(state.current_address));
+  const __m128i base = _mm_set1_epi32(static_cast<s32>(state.base_address));
+  for (u32 i = 0; i < NUM_TAPS; i += 4)
+  {
+    __m128i offset =
+      _mm_add_epi32(current, _mm_and_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(&offsets[i])), mask));
+    offset = _mm_add_epi32(offset, _mm_and_si128(base, _mm_srai_epi32(_mm_slli_epi32(offset, 13), 31)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&(*taps)[i]), _mm_slli_epi32(_mm_and_si128(offset, mask), 1));
+  }
+#elif defined(CPU_ARCH_NEON)
+  for (u32 i = 0; i < NUM_REGISTER_TAPS; i += 8)
+  {
+    const uint16x8_t regs = vld1q_u16(&state.regs.rev[FIRST_TAP_REGISTER + i]);
+    vst1q_u32(&offsets[i], vshll_n_u16(vget_low_u16(regs), 2));
+    vst1q_u32(&offsets[i + 4], vshll_high_n_u16(regs, 2));
+  }
+
+  const uint32x4_t mask = vdupq_n_u32((RAM_SIZE - 1) / 2);
+  const uint32x4_t current = vdupq_n_u32(state.current_address);
+  const uint32x4_t base = vdupq_n_u32(state.base_address);
+  for (u32 i = 0; i < NUM_TAPS; i += 4)
+  {
+    uint32x4_t offset = vaddq_u32(current, vandq_u32(vld1q_u32(&offsets[i]), mask));
+    const uint32x4_t wrap = vreinterpretq_u32_s32(vshrq_n_s32(vreinterpretq_s32_u32(vshlq_n_u32(offset, 13)), 31));
+    offset = vaddq_u32(offset, vandq_u32(base, wrap));
+    vst1q_u32(&(*taps)[i], vshlq_n_u32(vandq_u32(offset, mask), 1));
+  }
+#endif
+}
+
+#endif
+
+ALWAYS_INLINE static s16 ReverbRead(const u8* ram, u32 address)
+{
+  // TODO: This should check interrupts.
+  s16 data;
+  std::memcpy(&data, &ram[address], sizeof(data));
+  return data;
+}
+
+ALWAYS_INLINE static void ReverbWrite(u8* ram, u32 address, s16 data)
+{
+  // TODO: This should check interrupts.
+  std::memcpy(&ram[address], &data, sizeof(data));
+}
+
+ALWAYS_INLINE static s16 ReverbSat(s32 val)
+{
+  return static_cast<s16>(std::clamp<s32>(val, -0x8000, 0x7FFF));
+}
+
+ALWAYS_INLINE static s16 ReverbNeg(s16 samp)
+{
+  if (samp == -32768)
+    return 0x7FFF;
+
+  return -samp;
+}
+
+ALWAYS_INLINE static s32 IIASM(const s16 IIR_ALPHA, const s16 insamp)
+{
+  if (IIR_ALPHA == -32768)
+  {
+    if (insamp == -32768)
+      return 0;
+    else
+      return insamp * -65536;
+  }
+  else
+    return insamp * (32768 - IIR_ALPHA);
+}
+
+/// Runs the reverb for one output sample, returning the output before the reverb output volume is applied.
+template<bool vectorized>
+ALWAYS_INLINE_RELEASE static void Process(State& state, u8* ram, bool master_enable, s16 left_in, s16 right_in,
+                                          s32* out)
+{
+  const Registers& regs = state.regs;
+  const s32 position = state.resample_buffer_position;
+  state.downsample_buffer[0][position | 0x00] = left_in;
+  state.downsample_buffer[0][position | 0x40] = left_in;
+  state.downsample_buffer[1][position | 0x00] = right_in;
+  state.downsample_buffer[1][position | 0x40] = right_in;
+
+  if (position & 1u)
+  {
+    std::array<s32, 2> downsampled;
+    alignas(16) Taps taps;
+#ifdef SPU_REVERB_VECTOR
+    if constexpr (vectorized)
+    {
+      for (unsigned lr = 0; lr < 2; lr++)
+        downsampled[lr] = Downsample4422(&state.downsample_buffer[lr][(position - 38) & 0x3F]);
+      ComputeTaps(state, &taps);
+    }
+    else
+#endif
+    {
+      for (unsigned lr = 0; lr < 2; lr++)
+        downsampled[lr] = Downsample4422Scalar(&state.downsample_buffer[lr][(position - 38) & 0x3F]);
+      ComputeTapsScalar(state, &taps);
+    }
+
+    for (unsigned lr = 0; lr < 2; lr++)
+    {
+      if (master_enable)
+      {
+        const s16 IIR_INPUT_A = ReverbSat((((ReverbRead(ram, taps[TAP_IIR_SRC_A + (lr ^ 0)]) * regs.IIR_COEF) >> 14) +
+                                           ((downsampled[lr] * regs.IN_COEF[lr]) >> 14)) >>
+                                          1);
+        const s16 IIR_INPUT_B = ReverbSat((((ReverbRead(ram, taps[TAP_IIR_SRC_B + (lr ^ 1)]) * regs.IIR_COEF) >> 14) +
+                                           ((downsampled[lr] * regs.IN_COEF[lr]) >> 14)) >>
+                                          1);
+        const s16 IIR_A =
+          ReverbSat((((IIR_INPUT_A * regs.IIR_ALPHA) >> 14) +
+                     (IIASM(regs.IIR_ALPHA, ReverbRead(ram, taps[TAP_IIR_PREV_A + lr])) >> 14)) >>
+                    1);
+        const s16 IIR_B =
+          ReverbSat((((IIR_INPUT_B * regs.IIR_ALPHA) >> 14) +
+                     (IIASM(regs.IIR_ALPHA, ReverbRead(ram, taps[TAP_IIR_PREV_B + lr])) >> 14)) >>
+                    1);
+
+        ReverbWrite(ram, taps[TAP_IIR_DEST_A + lr], IIR_A);
+        ReverbWrite(ram, taps[TAP_IIR_DEST_B + lr], IIR_B);
+      }
+
+      const s32 ACC = ((ReverbRead(ram, taps[TAP_ACC_SRC_A + lr]) * regs.ACC_COEF_A) >> 14) +
+                      ((ReverbRead(ram, taps[TAP_ACC_SRC_B + lr]) * regs.ACC_COEF_B) >> 14) +
+                      ((ReverbRead(ram, taps[TAP_ACC_SRC_C + lr]) * regs.ACC_COEF_C) >> 14) +
+                      ((ReverbRead(ram, taps[TAP_ACC_SRC_D + lr]) * regs.ACC_COEF_D) >> 14);
+
+      const s16 FB_A = ReverbRead(ram, taps[TAP_FB_A + lr]);
+      const s16 FB_B = ReverbRead(ram, taps[TAP_FB_B + lr]);
+      const s16 MDA = ReverbSat((ACC + ((FB_A * ReverbNeg(regs.FB_ALPHA)) >> 14)) >> 1);
+      const s16 MDB =
+        ReverbSat(FB_A + ((((MDA * regs.FB_ALPHA) >> 14) + ((FB_B * ReverbNeg(regs.FB_X)) >> 14)) >> 1));
+      const s16 IVB = ReverbSat(FB_B + ((MDB * regs.FB_X) >> 15));
+
+      if (master_enable)
+      {
+        ReverbWrite(ram, taps[TAP_MIX_DEST_A + lr], MDA);
+        ReverbWrite(ram, taps[TAP_MIX_DEST_B + lr], MDB);
+      }
+
+      state.upsample_buffer[lr][(position >> 1) | 0x20] = state.upsample_buffer[lr][position >> 1] = IVB;
+    }
+
+    state.current_address = (state.current_address + 1) & 0x3FFFFu;
+    if (state.current_address == 0)
+      state.current_address = state.base_address;
+
+#ifdef SPU_REVERB_VECTOR
+    if constexpr (vectorized)
+    {
+      for (unsigned lr = 0; lr < 2; lr++)
+        out[lr] = Upsample2244(&state.upsample_buffer[lr][((position >> 1) - 19) & 0x1F]);
+    }
+    else
+#endif
+    {
+      for (unsigned lr = 0; lr < 2; lr++)
+        out[lr] = Upsample2244Scalar(&state.upsample_buffer[lr][((position >> 1) - 19) & 0x1F]);
+    }
+  }
+  else
+  {
+    // Middle non-zero
+    for (unsigned lr = 0; lr < 2; lr++)
+      out[lr] = state.upsample_buffer[lr][((((position >> 1) - 19) & 0x1F) + 9)];
+  }
+
+  state.resample_buffer_position = (position + 1) & 0x3F;
+}
+
+// Reverb captures record the reverb input and register writes of a running game, so the implementations can be
+// benchmarked and compared outside of the emulator. The file is a CaptureHeader, the initial State, the initial SPU
+// RAM, then num_frames CaptureFrames and num_writes CaptureWrites.
+static constexpr u32 CAPTURE_MAGIC = 0x42565253; // SRVB
+static constexpr u32 CAPTURE_VERSION = 1;
+
+/// Register index of a write to mBASE.
+static constexpr u16 CAPTURE_REGISTER_MBASE = NUM_REGISTERS;
+
+/// Register index of a change to SPUCNT's reverb master enable bit.
+static constexpr u16 CAPTURE_REGISTER_MASTER_ENABLE = NUM_REGISTERS + 1;
+
+struct CaptureHeader
+{
+  u32 magic;
+  u32 version;
+  u32 num_frames;
+  u32 num_writes;
+  u32 master_enable;
+};
+
+struct CaptureFrame
+{
+  s16 left_in;
+  s16 right_in;
+};
+
+/// Applies to the state before the frame with the same index is processed.
+struct CaptureWrite
+{
+  u32 frame;
+  u16 reg;
+  u16 value;
+};
+
+ALWAYS_INLINE static void ApplyCaptureWrite(State& state, bool* master_enable, const CaptureWrite& write)
+{
+  if (write.reg < NUM_REGISTERS)
+    state.regs.rev[write.reg] = write.value;
+  else if (write.reg == CAPTURE_REGISTER_MBASE)
+    SetBaseAddress(state, write.value);
+  else if (write.reg == CAPTURE_REGISTER_MASTER_ENABLE)
+    *master_enable = (write.value != 0);
+}
+
+} // namespace SPU_Reverb
@@ -0,0 +1,248 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+
+#include "common/intrin.h"
+#include "common/types.h"
+
+#include <array>
+
+// Gaussian interpolation for all 24 voices at once, with one voice per vector lane, and ADPCM nibble expansion for a
+// whole block. Building with SPU_FORCE_SCALAR_VOICE_KERNELS defined makes the SPU use InterpolateVoicesScalar() and
+// ExpandADPCMNibblesScalar() instead, so regtest -dumpaudio output can be compared between the two builds.
+
+#if (defined(CPU_ARCH_SSE) || defined(CPU_ARCH_NEON)) && !defined(SPU_FORCE_SCALAR_VOICE_KERNELS)
+#define SPU_VOICE_KERNELS_VECTOR 1
+#endif
+
+namespace SPU_VoiceKernels {
+
+static constexpr u32 NUM_VOICES = 24;
+static constexpr u32 NUM_SAMPLES_PER_ADPCM_BLOCK = 28;
+static constexpr u32 ADPCM_BLOCK_SIZE = 16;
+
+/// Number of samples written by ExpandADPCMNibbles(), rounded up to a whole number of vectors.
+static constexpr u32 NUM_EXPANDED_ADPCM_SAMPLES = 32;
+
+inline constexpr std::array<s16, 0x200> g_gauss_table = {{
+  -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, //
+  -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, //
+  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0001, //
+  0x0001, 0x0001, 0x0001, 0x0002, 0x0002, 0x0002, 0x0003, 0x0003, //
+  0x0003, 0x0004, 0x0004, 0x0005, 0x0005, 0x0006, 0x0007, 0x0007, //
+  0x0008, 0x0009, 0x0009, 0x000A, 0x000B, 0x000C, 0x000D, 0x000E, //
+  0x000F, 0x0010, 0x0011, 0x0012, 0x0013, 0x0015, 0x0016, 0x0018, // entry
+  0x0019, 0x001B, 0x001C, 0x001E, 0x0020, 0x0021, 0x0023, 0x0025, // 000..07F
+  0x0027, 0x0029, 0x002C, 0x002E, 0x0030, 0x0033, 0x0035, 0x0038, //
+  0x003A, 0x003D, 0x0040, 0x0043, 0x0046, 0x0049, 0x004D, 0x0050, //
+  0x0054, 0x0057, 0x005B, 0x005F, 0x0063, 0x0067, 0x006B, 0x006F, //
+  0x0074, 0x0078, 0x007D, 0x0082, 0x0087, 0x008C, 0x0091, 0x0096, //
+  0x009C, 0x00A1, 0x00A7, 0x00AD, 0x00B3, 0x00BA, 0x00C0, 0x00C7, //
+  0x00CD, 0x00D4, 0x00DB, 0x00E3, 0x00EA, 0x00F2, 0x00FA, 0x0101, //
+  0x010A, 0x0112, 0x011B, 0x0123, 0x012C, 0x0135, 0x013F, 0x0148, //
+  0x0152, 0x015C, 0x0166, 0x0171, 0x017B, 0x0186, 0x0191, 0x019C, //
+  0x01A8, 0x01B4, 0x01C0, 0x01CC, 0x01D9, 0x01E5, 0x01F2, 0x0200, //
+  0x020D, 0x021B, 0x0229, 0x0237, 0x0246, 0x0255, 0x0264, 0x0273, //
+  0x0283, 0x0293, 0x02A3, 0x02B4, 0x02C4, 0x02D6, 0x02E7, 0x02F9, //
+  0x030B, 0x031D, 0x0330, 0x0343, 0x0356, 0x036A, 0x037E, 0x0392, //
+  0x03A7, 0x03BC, 0x03D1, 0x03E7, 0x03FC, 0x0413, 0x042A, 0x0441, //
+  0x0458, 0x0470, 0x0488, 0x04A0, 0x04B9, 0x04D2, 0x04EC, 0x0506, //
+  0x0520, 0x053B, 0x0556, 0x0572, 0x058E, 0x05AA, 0x05C7, 0x05E4, // entry
+  0x0601, 0x061F, 0x063E, 0x065C, 0x067C, 0x069B, 0x06BB, 0x06DC, // 080..0FF
+  0x06FD, 0x071E, 0x0740, 0x0762, 0x0784, 0x07A7, 0x07CB, 0x07EF, //
+  0x0813, 0x0838, 0x085D, 0x0883, 0x08A9, 0x08D0, 0x08F7, 0x091E, //
+  0x0946, 0x096F, 0x0998, 0x09C1, 0x09EB, 0x0A16, 0x0A40, 0x0A6C, //
+  0x0A98, 0x0AC4, 0x0AF1, 0x0B1E, 0x0B4C, 0x0B7A, 0x0BA9, 0x0BD8, //
+  0x0C07, 0x0C38, 0x0C68, 0x0C99, 0x0CCB, 0x0CFD, 0x0D30, 0x0D63, //
+  0x0D97, 0x0DCB, 0x0E00, 0x0E35, 0x0E6B, 0x0EA1, 0x0ED7, 0x0F0F, //
+  0x0F46, 0x0F7F, 0x0FB7, 0x0FF1, 0x102A, 0x1065, 0x109F, 0x10DB, //
+  0x1116, 0x1153, 0x118F, 0x11CD, 0x120B, 0x1249, 0x1288, 0x12C7, //
+  0x1307, 0x1347, 0x1388, 0x13C9, 0x140B, 0x144D, 0x1490, 0x14D4, //
+  0x1517, 0x155C, 0x15A0, 0x15E6, 0x162C, 0x1672, 0x16B9, 0x1700, //
+  0x1747, 0x1790, 0x17D8, 0x1821, 0x186B, 0x18B5, 0x1900, 0x194B, //
+  0x1996, 0x19E2, 0x1A2E, 0x1A7B, 0x1AC8, 0x1B16, 0x1B64, 0x1BB3, //
+  0x1C02, 0x1C51, 0x1CA1, 0x1CF1, 0x1D42, 0x1D93, 0x1DE5, 0x1E37, //
+  0x1E89, 0x1EDC, 0x1F2F, 0x1F82, 0x1FD6, 0x202A, 0x207F, 0x20D4, //
+  0x2129, 0x217F, 0x21D5, 0x222C, 0x2282, 0x22DA, 0x2331, 0x2389, // entry
+  0x23E1, 0x2439, 0x2492, 0x24EB, 0x2545, 0x259E, 0x25F8, 0x2653, // 100..17F
+  0x26AD, 0x2708, 0x2763, 0x27BE, 0x281A, 0x2876, 0x28D2, 0x292E, //
+  0x298B, 0x29E7, 0x2A44, 0x2AA1, 0x2AFF, 0x2B5C, 0x2BBA, 0x2C18, //
+  0x2C76, 0x2CD4, 0x2D33, 0x2D91, 0x2DF0, 0x2E4F, 0x2EAE, 0x2F0D, //
+  0x2F6C, 0x2FCC, 0x302B, 0x308B, 0x30EA, 0x314A, 0x31AA, 0x3209, //
+  0x3269, 0x32C9, 0x3329, 0x3389, 0x33E9, 0x3449, 0x34A9, 0x3509, //
+  0x3569, 0x35C9, 0x3629, 0x3689, 0x36E8, 0x3748, 0x37A8, 0x3807, //
+  0x3867, 0x38C6, 0x3926, 0x3985, 0x39E4, 0x3A43, 0x3AA2, 0x3B00, //
+  0x3B5F, 0x3BBD, 0x3C1B, 0x3C79, 0x3CD7, 0x3D35, 0x3D92, 0x3DEF, //
+  0x3E4C, 0x3EA9, 0x3F05, 0x3F62, 0x3FBD, 0x4019, 0x4074, 0x40D0, //
+  0x412A, 0x4185, 0x41DF, 0x4239, 0x4292, 0x42EB, 0x4344, 0x439C, //
+  0x43F4, 0x444C, 0x44A3, 0x44FA, 0x4550, 0x45A6, 0x45FC, 0x4651, //
+  0x46A6, 0x46FA, 0x474E, 0x47A1, 0x47F4, 0x4846, 0x4898, 0x48E9, //
+  0x493A, 0x498A, 0x49D9, 0x4A29, 0x4A77, 0x4AC5, 0x4B13, 0x4B5F, //
+  0x4BAC, 0x4BF7, 0x4C42, 0x4C8D, 0x4CD7, 0x4D20, 0x4D68, 0x4DB0, //
+  0x4DF7, 0x4E3E, 0x4E84, 0x4EC9, 0x4F0E, 0x4F52, 0x4F95, 0x4FD7, // entry
+  0x5019, 0x505A, 0x509A, 0x50DA, 0x5118, 0x5156, 0x5194, 0x51D0, // 180..1FF
+  0x520C, 0x5247, 0x5281, 0x52BA, 0x52F3, 0x532A, 0x5361, 0x5397, //
+  0x53CC, 0x5401, 0x5434, 0x5467, 0x5499, 0x54CA, 0x54FA, 0x5529, //
+  0x5558, 0x5585, 0x55B2, 0x55DE, 0x5609, 0x5632, 0x565B, 0x5684, //
+  0x56AB, 0x56D1, 0x56F6, 0x571B, 0x573E, 0x5761, 0x5782, 0x57A3, //
+  0x57C3, 0x57E2, 0x57FF, 0x581C, 0x5838, 0x5853, 0x586D, 0x5886, //
+  0x589E, 0x58B5, 0x58CB, 0x58E0, 0x58F4, 0x5907, 0x5919, 0x592A, //
+  0x593A, 0x5949, 0x5958, 0x5965, 0x5971, 0x597C, 0x5986, 0x598F, //
+  0x5997, 0x599E, 0x59A4, 0x59A9, 0x59AD, 0x59B0, 0x59B2, 0x59B3  //
+}};
+
+/// Inputs for the four-tap Gaussian interpolation of every voice, stored tap-major so voices map to vector lanes.
+struct InterpolationInputs
+{
+  alignas(16) std::array<std::array<s16, NUM_VOICES>, 4> samples;
+  alignas(16) std::array<std::array<s16, NUM_VOICES>, 4> weights;
+
+  /// Sets up a voice, samples points to the newest of the four samples, i.e. the current sample position.
+  ALWAYS_INLINE void SetVoice(u32 voice, const s16* samples_ptr, u8 interpolation_index)
+  {
+    samples[0][voice] = samples_ptr[-3];
+    samples[1][voice] = samples_ptr[-2];
+    samples[2][voice] = samples_ptr[-1];
+    samples[3][voice] = samples_ptr[0];
+    weights[0][voice] = g_gauss_table[0x0FF - interpolation_index];
+    weights[1][voice] = g_gauss_table[0x1FF - interpolation_index];
+    weights[2][voice] = g_gauss_table[0x100 + interpolation_index];
+    weights[3][voice] = g_gauss_table[0x000 + interpolation_index];
+  }
+
+  /// Zeroes a voice's inputs, so it interpolates to silence.
+  ALWAYS_INLINE void ClearVoice(u32 voice)
+  {
+    for (u32 tap = 0; tap < 4; tap++)
+    {
+      samples[tap][voice] = 0;
+      weights[tap][voice] = 0;
+    }
+  }
+};
+
+ALWAYS_INLINE_RELEASE static void InterpolateVoicesScalar(const InterpolationInputs& in, s32* out)
+{
+  for (u32 voice = 0; voice < NUM_VOICES; voice++)
+  {
+    s32 sum = s32(in.weights[0][voice]) * s32(in.samples[0][voice]);
+    sum += s32(in.weights[1][voice]) * s32(in.samples[1][voice]);
+    sum += s32(in.weights[2][voice]) * s32(in.samples[2][voice]);
+    sum += s32(in.weights[3][voice]) * s32(in.samples[3][voice]);
+    out[voice] = sum >> 15;
+  }
+}
+
+/// Expands the 28 4-bit samples of an ADPCM block to 16 bits and applies the shift, but not the filter.
+/// block points to the whole 16-byte block including the header, out must have room for NUM_EXPANDED_ADPCM_SAMPLES.
+ALWAYS_INLINE_RELEASE static void ExpandADPCMNibblesScalar(const u8* block, u8 shift, s16* out)
+{
+  const u8* data = block + 2;
+  for (u32 i = 0; i < NUM_SAMPLES_PER_ADPCM_BLOCK; i++)
+  {
+    const u8 nibble = (data[i / 2] >> ((i % 2) * 4)) & 0x0F;
+    out[i] = static_cast<s16>(static_cast<s16>(static_cast<u16>(nibble) << 12) >> shift);
+  }
+  for (u32 i = NUM_SAMPLES_PER_ADPCM_BLOCK; i < NUM_EXPANDED_ADPCM_SAMPLES; i++)
+    out[i] = 0;
+}
+
+#ifdef SPU_VOICE_KERNELS_VECTOR
+
+ALWAYS_INLINE_RELEASE static void InterpolateVoices(const InterpolationInputs& in, s32* out)
+{
+  // Sums are exact in 32 bits: the weights never exceed 0x59B3, so no pair of products can overflow.
+  for (u32 voice = 0; voice < NUM_VOICES; voice += 8)
+  {
+#if defined(CPU_ARCH_SSE)
+    const __m128i s0 = _mm_load_si128(reinterpret_cast<const __m128i*>(&in.samples[0][voice]));
+    const __m128i s1 = _mm_load_si128(reinterpret_cast<const __m128i*>(&in.samples[1][voice]));
+    const __m128i s2 = _mm_load_si128(reinterpret_cast<const __m128i*>(&in.samples[2][voice]));
+    const __m128i s3 = _mm_load_si128(reinterpret_cast<const __m128i*>(&in.samples[3][voice]));
+    const __m128i w0 = _mm_load_si128(reinterpret_cast<const __m128i*>(&in.weights[0][voice]));
+    const __m128i w1 = _mm_load_si128(reinterpret_cast<const __m128i*>(&in.weights[1][voice]));
+    const __m128i w2 = _mm_load_si128(reinterpret_cast<const __m128i*>(&in.weights[2][voice]));
+    const __m128i w3 = _mm_load_si128(reinterpret_cast<const __m128i*>(&in.weights[3][voice]));
+
+    // pmaddwd sums adjacent lanes, so interleave taps 0/1 and 2/3.
+    const __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(s0, s1), _mm_unpacklo_epi16(w0, w1)),
+                                     _mm_madd_epi16(_mm_unpacklo_epi16(s2, s3), _mm_unpacklo_epi16(w2, w3)));
+    const __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(s0, s1), _mm_unpackhi_epi16(w0, w1)),
+                                     _mm_madd_epi16(_mm_unpackhi_epi16(s2, s3), _mm_unpackhi_epi16(w2, w3)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[voice]), _mm_srai_epi32(lo, 15));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[voice + 4]), _mm_srai_epi32(hi, 15));
+#elif defined(CPU_ARCH_NEON)
+    const int16x8_t s0 = vld1q_s16(&in.samples[0][voice]);
+    const int16x8_t s1 = vld1q_s16(&in.samples[1][voice]);
+    const int16x8_t s2 = vld1q_s16(&in.samples[2][voice]);
+    const int16x8_t s3 = vld1q_s16(&in.samples[3][voice]);
+    const int16x8_t w0 = vld1q_s16(&in.weights[0][voice]);
+    const int16x8_t w1 = vld1q_s16(&in.weights[1][voice]);
+    const int16x8_t w2 = vld1q_s16(&in.weights[2][voice]);
+    const int16x8_t w3 = vld1q_s16(&in.weights[3][voice]);
+
+    int32x4_t lo = vmull_s16(vget_low_s16(s0), vget_low_s16(w0));
+    lo = vmlal_s16(lo, vget_low_s16(s1), vget_low_s16(w1));
+    lo = vmlal_s16(lo, vget_low_s16(s2), vget_low_s16(w2));
+    lo = vmlal_s16(lo, vget_low_s16(s3), vget_low_s16(w3));
+    int32x4_t hi = vmull_high_s16(s0, w0);
+    hi = vmlal_high_s16(hi, s1, w1);
+    hi = vmlal_high_s16(hi, s2, w2);
+    hi = vmlal_high_s16(hi, s3, w3);
+    vst1q_s32(&out[voice], vshrq_n_s32(lo, 15));
+    vst1q_s32(&out[voice + 4], vshrq_n_s32(hi, 15));
+#endif
+  }
+}
+
+ALWAYS_INLINE_RELEASE static void ExpandADPCMNibbles(const u8* block, u8 shift, s16* out)
+{
+#if defined(CPU_ARCH_SSE)
+  // Drop the header, leaving the 14 data bytes followed by two zero bytes.
+  const __m128i data = _mm_srli_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block)), 2);
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i high_mask = _mm_set1_epi16(0xF0);
+  const __m128i shift_count = _mm_cvtsi32_si128(shift);
+  for (u32 half = 0; half < 2; half++)
+  {
+    const __m128i bytes = (half == 0) ? _mm_unpacklo_epi8(data, zero) : _mm_unpackhi_epi8(data, zero);
+
+    // Low nibble is the first sample of each byte.
+    const __m128i first = _mm_slli_epi16(bytes, 12);
+    const __m128i second = _mm_slli_epi16(_mm_and_si128(bytes, high_mask), 8);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[half * 16]),
+                     _mm_sra_epi16(_mm_unpacklo_epi16(first, second), shift_count));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[half * 16 + 8]),
+                     _mm_sra_epi16(_mm_unpackhi_epi16(first, second), shift_count));
+  }
+#elif defined(CPU_ARCH_NEON)
+  const uint8x16_t data = vextq_u8(vld1q_u8(block), vdupq_n_u8(0), 2);
+  const uint16x8_t high_mask = vdupq_n_u16(0xF0);
+  const int16x8_t shift_count = vdupq_n_s16(-static_cast<s16>(shift));
+  for (u32 half = 0; half < 2; half++)
+  {
+    const uint16x8_t bytes = (half == 0) ? vmovl_u8(vget_low_u8(data)) : vmovl_high_u8(data);
+    const uint16x8_t first = vshlq_n_u16(bytes, 12);
+    const uint16x8_t second = vshlq_n_u16(vandq_u16(bytes, high_mask), 8);
+    vst1q_s16(&out[half * 16], vshlq_s16(vreinterpretq_s16_u16(vzip1q_u16(first, second)), shift_count));
+    vst1q_s16(&out[half * 16 + 8], vshlq_s16(vreinterpretq_s16_u16(vzip2q_u16(first, second)), shift_count));
+  }
+#endif
+}
+
+#else
+
+ALWAYS_INLINE_RELEASE static void InterpolateVoices(const InterpolationInputs& in, s32* out)
+{
+  InterpolateVoicesScalar(in, out);
+}
+
+ALWAYS_INLINE_RELEASE static void ExpandADPCMNibbles(const u8* block, u8 shift, s16* out)
+{
+  ExpandADPCMNibblesScalar(block, shift, out);
+}
+
+#endif
+
+} // namespace SPU_VoiceKernels
@@ -48,6 +48,7 @@
 #include "common/error.h"
 #include "common/file_system.h"
 #include "common/log.h"
+#include "common/memmap.h"
 #include "common/path.h"
 #include "common/string_util.h"
 #include "common/threading.h"
@@ -56,14 +57,18 @@
 #include "fmt/format.h"
 #include "imgui.h"
 #include "xxhash.h"
+#include "zstd.h"
+#include "zstd_errors.h"
 
 #include <cctype>
 #include <cinttypes>
 #include <cmath>
+#include <condition_variable>
 #include <cstdio>
 #include <deque>
 #include <fstream>
 #include <limits>
+#include <mutex>
 #include <thread>
 
 Log_SetChannel(System);
@@ -92,6 +97,28 @@ SystemBootParameters::SystemBootParameters(std::string filename_) : filename(std
 SystemBootParameters::~SystemBootParameters() = default;
 
 namespace System {
+namespace {
+struct SaveStateBuffer
+{
+  std::string title;
+  std::string serial;
+  std::string media_path;
+  u32 media_subimage_index = 0;
+  u32 screenshot_width = 0;
+  u32 screenshot_height = 0;
+  std::vector<u32> screenshot_data;
+  std::unique_ptr<GrowableMemoryByteStream> state_stream;
+};
+
+struct SaveStateWriteRequest
+{
+  std::string path;
+  bool backup_existing_save;
+  u32 compression_method;
+  SaveStateBuffer buffer;
+};
+} // namespace
+
 static std::optional<ExtendedSaveStateInfo> InternalGetExtendedSaveStateInfo(ByteStream* stream);
 
 static bool LoadEXE(const char* filename);
@@ -99,6 +126,7 @@ static bool LoadEXE(const char* filename);
 static std::string GetExecutableNameForImage(ISOReader& iso, bool strip_subdirectories);
 static bool ReadExecutableFromImage(ISOReader& iso, std::string* out_executable_name,
                                     std::vector<u8>* out_executable_data);
+static bool GetGameDetailsFromGameList(const char* path, CDImage* image, std::string* out_id, GameHash* out_hash);
 
 static bool LoadBIOS(const std::string& override_bios_path);
 static void InternalReset();
@@ -108,6 +136,12 @@ static std::string GetMediaPathFromSaveState(const char* path);
 static bool DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_display, bool is_memory_state);
 static bool CreateGPU(GPURenderer renderer, bool is_switching);
 static bool SaveUndoLoadState();
+static bool SaveStateToBuffer(SaveStateBuffer* buffer, u32 screenshot_size, bool ignore_media);
+static bool SaveStateBufferToStream(ByteStream* state, const SaveStateBuffer& buffer, u32 compression_method);
+static void QueueSaveStateWrite(std::string path, bool backup_existing_save, SaveStateBuffer buffer);
+static void StopSaveStateWriterThread();
+static void SaveStateWriterThreadEntryPoint();
+static void WriteSaveStateFile(const SaveStateWriteRequest& req);
 
 /// Throttles the system, i.e. sleeps until it's time to execute the next frame.
 static void Throttle();
@@ -115,6 +149,12 @@ static void Throttle();
 static void SetRewinding(bool enabled);
 static bool SaveRewindState();
 static void DoRewind();
+static bool PopRewindState();
+static void StartRewindEncodeThread();
+static void StopRewindEncodeThread();
+static void WaitForRewindEncode();
+static void RewindEncodeThreadEntryPoint();
+static void XorMemoryStates(u8* dst, const u8* src, u32 size);
 
 static void SaveRunaheadState();
 static bool DoRunahead();
@@ -124,6 +164,7 @@ static bool FastForwardToFirstFrame();
 
 static bool UpdateGameSettingsLayer();
 static void UpdateRunningGame(const char* path, CDImage* image, bool booting);
+static void UpdatePersistentCodeCache();
 static bool CheckForSBIFile(CDImage* image);
 static std::unique_ptr<MemoryCard> GetMemoryCardForSlot(u32 slot, MemoryCardType type);
 
@@ -213,9 +254,54 @@ static std::unique_ptr<CheatList> s_cheat_list;
 // temporary save state, created when loading, used to undo load state
 static std::unique_ptr<ByteStream> m_undo_load_state;
 
+// Save states are compressed and written to disk on a worker thread, the CPU thread only takes the snapshot.
+static Threading::Thread s_save_state_writer_thread;
+static std::mutex s_save_state_writer_mutex;
+static std::condition_variable s_save_state_writer_cv;
+static std::condition_variable s_save_state_writer_done_cv;
+static std::deque<System::SaveStateWriteRequest> s_save_state_write_queue;
+static std::unique_ptr<GrowableMemoryByteStream> s_save_state_spare_stream;
+static bool s_save_state_write_active = false;
+static bool s_save_state_writer_shutdown = false;
+
 static bool s_memory_saves_enabled = false;
 
-static std::deque<System::MemorySaveState> s_rewind_states;
+// Rewind states are kept as a chain of reverse deltas. Only the newest state is stored in full, every older state is
+// stored as the zstd-compressed XOR of itself against the state which followed it. Since neighbouring states differ
+// in very few bytes, this is a fraction of the size of a full copy, and stepping backwards only needs a single delta.
+namespace {
+struct RewindDelta
+{
+  std::unique_ptr<GPUTexture> vram_texture;
+  std::vector<u8> data;
+  u32 size;
+};
+} // namespace
+
+static constexpr int REWIND_COMPRESSION_LEVEL = 1;
+
+// Used for the memory estimate until we've compressed some deltas for the running game.
+static constexpr u32 REWIND_ESTIMATED_DELTA_SIZE = 256 * 1024;
+
+static System::MemorySaveState s_rewind_head;
+static std::deque<RewindDelta> s_rewind_states;
+static std::unique_ptr<GrowableMemoryByteStream> s_rewind_spare_stream;
+
+// Deltas are compressed on a worker thread, so saving a rewind state only costs the state copy on the CPU thread.
+static Threading::Thread s_rewind_encode_thread;
+static std::mutex s_rewind_encode_mutex;
+static std::condition_variable s_rewind_encode_cv;
+static std::condition_variable s_rewind_encode_done_cv;
+static std::unique_ptr<GrowableMemoryByteStream> s_rewind_encode_stream;
+static const GrowableMemoryByteStream* s_rewind_encode_next_stream = nullptr;
+static RewindDelta* s_rewind_encode_delta = nullptr;
+static bool s_rewind_encode_pending = false;
+static bool s_rewind_encode_shutdown = false;
+
+// Running total of compressed delta sizes, read by the UI thread for the memory estimate.
+static std::atomic<u64> s_rewind_delta_total_size{0};
+static std::atomic<u64> s_rewind_delta_count{0};
+
 static s32 s_rewind_load_frequency = -1;
 static s32 s_rewind_load_counter = -1;
 static s32 s_rewind_save_frequency = -1;
@@ -241,6 +327,9 @@ static TinyString GetTimestampStringForFileName()
 
 void System::Internal::ProcessStartup()
 {
+  // Has to come before fastmem hooks SIGBUS, otherwise shutting down a VM would remove it.
+  MappedFile::InstallFaultHandler();
+
   if (!Bus::AllocateMemory())
     Panic("Failed to allocate memory for emulated bus.");
 
@@ -257,6 +346,8 @@ void System::Internal::ProcessStartup()
 
 void System::Internal::ProcessShutdown()
 {
+  StopSaveStateWriterThread();
+
 #ifdef ENABLE_DISCORD_PRESENCE
   ShutdownDiscordPresence();
 #endif
@@ -1128,6 +1219,9 @@ bool System::LoadState(const char* filename)
 
   Common::Timer load_timer;
 
+  // make sure any pending save to this file has hit the disk
+  FlushSaveStateWrites();
+
   std::unique_ptr<ByteStream> stream = ByteStream::OpenFile(filename, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
   if (!stream)
     return false;
@@ -1163,44 +1257,30 @@ bool System::LoadState(const char* filename)
 
 bool System::SaveState(const char* filename, bool backup_existing_save)
 {
-  if (backup_existing_save && FileSystem::FileExists(filename))
-  {
-    const std::string backup_filename(Path::ReplaceExtension(filename, "bak"));
-    if (!FileSystem::RenamePath(filename, backup_filename.c_str()))
-      Log_ErrorPrintf("Failed to rename save state backup '%s'", backup_filename.c_str());
-  }
-
   Common::Timer save_timer;
 
-  std::unique_ptr<ByteStream> stream =
-    ByteStream::OpenFile(filename, BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_TRUNCATE |
-                                     BYTESTREAM_OPEN_ATOMIC_UPDATE | BYTESTREAM_OPEN_STREAMED);
-  if (!stream)
-    return false;
-
   Log_InfoPrintf("Saving state to '%s'...", filename);
 
+  // reuse the last buffer which was written, if there is one
+  SaveStateBuffer buffer;
+  {
+    std::unique_lock lock(s_save_state_writer_mutex);
+    buffer.state_stream = std::move(s_save_state_spare_stream);
+  }
+
   const u32 screenshot_size = 256;
-  const bool result = SaveStateToStream(stream.get(), screenshot_size,
-                                        g_settings.compress_save_states ? SAVE_STATE_HEADER::COMPRESSION_TYPE_ZSTD :
-                                                                          SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE);
-  if (!result)
+  if (!SaveStateToBuffer(&buffer, screenshot_size, false))
   {
     Host::ReportFormattedErrorAsync(TRANSLATE("OSDMessage", "Save State"),
                                     TRANSLATE("OSDMessage", "Saving state to '%s' failed."), filename);
-    stream->Discard();
-  }
-  else
-  {
-    const std::string display_name(FileSystem::GetDisplayNameFromPath(filename));
-    Host::AddIconOSDMessage(
-      "save_state", ICON_FA_SAVE,
-      fmt::format(TRANSLATE_FS("OSDMessage", "State saved to '{}'."), Path::GetFileName(display_name)), 5.0f);
-    stream->Commit();
+    return false;
   }
 
+  // compression and writing to disk happens on the writer thread
+  QueueSaveStateWrite(filename, backup_existing_save, std::move(buffer));
+
   Log_VerbosePrintf("Saving state took %.2f msec", save_timer.GetTimeMilliseconds());
-  return result;
+  return true;
 }
 
 bool System::SaveResumeState()
@@ -1217,6 +1297,7 @@ bool System::BootSystem(SystemBootParameters parameters)
   if (!parameters.save_state.empty())
   {
     // loading a state, so pull the media path from the save state to avoid a double change
+    FlushSaveStateWrites();
     std::string state_media(GetMediaPathFromSaveState(parameters.save_state.c_str()));
     if (FileSystem::FileExists(state_media.c_str()))
       parameters.filename = std::move(state_media);
@@ -1538,6 +1619,7 @@ bool System::Initialize(bool force_software_renderer)
 
   // CPU code cache must happen after GPU, because it might steal our address space.
   CPU::CodeCache::Initialize();
+  UpdatePersistentCodeCache();
 
   DMA::Initialize();
   InterruptController::Initialize();
@@ -1613,6 +1695,8 @@ void System::DestroySystem()
   s_cpu_thread_usage = {};
 
   ClearMemorySaveStates();
+  StopRewindEncodeThread();
+  FlushSaveStateWrites();
 
   g_texture_replacements.Shutdown();
 
@@ -2359,30 +2443,24 @@ bool System::LoadStateFromStream(ByteStream* state, bool update_display, bool ig
 bool System::SaveStateToStream(ByteStream* state, u32 screenshot_size /* = 256 */,
                                u32 compression_method /* = SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE*/,
                                bool ignore_media /* = false*/)
+{
+  SaveStateBuffer buffer;
+  return SaveStateToBuffer(&buffer, screenshot_size, ignore_media) &&
+         SaveStateBufferToStream(state, buffer, compression_method);
+}
+
+bool System::SaveStateToBuffer(SaveStateBuffer* buffer, u32 screenshot_size, bool ignore_media)
 {
   if (IsShutdown())
     return false;
 
-  SAVE_STATE_HEADER header = {};
-
-  const u64 header_position = state->GetPosition();
-  if (!state->Write2(&header, sizeof(header)))
-    return false;
-
-  // fill in header
-  header.magic = SAVE_STATE_MAGIC;
-  header.version = SAVE_STATE_VERSION;
-  StringUtil::Strlcpy(header.title, s_running_game_title.c_str(), sizeof(header.title));
-  StringUtil::Strlcpy(header.serial, s_running_game_serial.c_str(), sizeof(header.serial));
+  buffer->title = s_running_game_title;
+  buffer->serial = s_running_game_serial;
 
   if (CDROM::HasMedia() && !ignore_media)
   {
-    const std::string& media_filename = CDROM::GetMediaFileName();
-    header.offset_to_media_filename = static_cast<u32>(state->GetPosition());
-    header.media_filename_length = static_cast<u32>(media_filename.length());
-    header.media_subimage_index = CDROM::GetMedia()->HasSubImages() ? CDROM::GetMedia()->GetCurrentSubImage() : 0;
-    if (!media_filename.empty() && !state->Write2(media_filename.data(), header.media_filename_length))
-      return false;
+    buffer->media_path = CDROM::GetMediaFileName();
+    buffer->media_subimage_index = CDROM::GetMedia()->HasSubImages() ? CDROM::GetMedia()->GetCurrentSubImage() : 0;
   }
 
   // save screenshot
@@ -2417,12 +2495,9 @@ bool System::SaveStateToStream(ByteStream* state, u32 screenshot_size /* = 256 *
           GPUTexture::FlipTextureDataRGBA8(screenshot_width, screenshot_height, screenshot_buffer, screenshot_stride);
         }
 
-        header.offset_to_screenshot = static_cast<u32>(state->GetPosition());
-        header.screenshot_width = screenshot_width;
-        header.screenshot_height = screenshot_height;
-        header.screenshot_size = static_cast<u32>(screenshot_buffer.size() * sizeof(u32));
-        if (!state->Write2(screenshot_buffer.data(), header.screenshot_size))
-          return false;
+        buffer->screenshot_width = screenshot_width;
+        buffer->screenshot_height = screenshot_height;
+        buffer->screenshot_data = std::move(screenshot_buffer);
       }
     }
     else
@@ -2432,27 +2507,75 @@ bool System::SaveStateToStream(ByteStream* state, u32 screenshot_size /* = 256 *
     }
   }
 
-  // write data
+  // write data, uncompressed, since we only want to spend time copying on this thread
   {
-    header.offset_to_data = static_cast<u32>(state->GetPosition());
+    if (!buffer->state_stream)
+      buffer->state_stream = std::make_unique<GrowableMemoryByteStream>(nullptr, MAX_SAVE_STATE_SIZE);
+    buffer->state_stream->Resize(0);
+    buffer->state_stream->SeekAbsolute(0);
 
     g_gpu->RestoreDeviceContext();
 
+    StateWrapper sw(buffer->state_stream.get(), StateWrapper::Mode::Write, SAVE_STATE_VERSION);
+    if (!DoState(sw, nullptr, false, false))
+      return false;
+  }
+
+  return true;
+}
+
+bool System::SaveStateBufferToStream(ByteStream* state, const SaveStateBuffer& buffer, u32 compression_method)
+{
+  SAVE_STATE_HEADER header = {};
+
+  const u64 header_position = state->GetPosition();
+  if (!state->Write2(&header, sizeof(header)))
+    return false;
+
+  // fill in header
+  header.magic = SAVE_STATE_MAGIC;
+  header.version = SAVE_STATE_VERSION;
+  StringUtil::Strlcpy(header.title, buffer.title.c_str(), sizeof(header.title));
+  StringUtil::Strlcpy(header.serial, buffer.serial.c_str(), sizeof(header.serial));
+
+  if (!buffer.media_path.empty())
+  {
+    header.offset_to_media_filename = static_cast<u32>(state->GetPosition());
+    header.media_filename_length = static_cast<u32>(buffer.media_path.length());
+    header.media_subimage_index = buffer.media_subimage_index;
+    if (!state->Write2(buffer.media_path.data(), header.media_filename_length))
+      return false;
+  }
+
+  if (!buffer.screenshot_data.empty())
+  {
+    header.offset_to_screenshot = static_cast<u32>(state->GetPosition());
+    header.screenshot_width = buffer.screenshot_width;
+    header.screenshot_height = buffer.screenshot_height;
+    header.screenshot_size = static_cast<u32>(buffer.screenshot_data.size() * sizeof(u32));
+    if (!state->Write2(buffer.screenshot_data.data(), header.screenshot_size))
+      return false;
+  }
+
+  // write data
+  {
+    header.offset_to_data = static_cast<u32>(state->GetPosition());
     header.data_compression_type = compression_method;
 
+    const u8* data = buffer.state_stream->GetMemoryPointer();
+    const u32 data_size = static_cast<u32>(buffer.state_stream->GetSize());
+
     bool result = false;
     if (compression_method == SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE)
     {
-      StateWrapper sw(state, StateWrapper::Mode::Write, SAVE_STATE_VERSION);
-      result = DoState(sw, nullptr, false, false);
-      header.data_uncompressed_size = static_cast<u32>(state->GetPosition() - header.offset_to_data);
+      result = state->Write2(data, data_size);
+      header.data_uncompressed_size = data_size;
     }
     else if (compression_method == SAVE_STATE_HEADER::COMPRESSION_TYPE_ZSTD)
     {
       std::unique_ptr<ByteStream> cstream(ByteStream::CreateZstdCompressStream(state, 0));
-      StateWrapper sw(cstream.get(), StateWrapper::Mode::Write, SAVE_STATE_VERSION);
-      result = DoState(sw, nullptr, false, false) && cstream->Commit();
-      header.data_uncompressed_size = static_cast<u32>(cstream->GetPosition());
+      result = cstream->Write2(data, data_size) && cstream->Commit();
+      header.data_uncompressed_size = data_size;
       header.data_compressed_size = static_cast<u32>(state->GetPosition() - header.offset_to_data);
     }
 
@@ -2471,6 +2594,108 @@ bool System::SaveStateToStream(ByteStream* state, u32 screenshot_size /* = 256 *
   return true;
 }
 
+void System::QueueSaveStateWrite(std::string path, bool backup_existing_save, SaveStateBuffer buffer)
+{
+  std::unique_lock lock(s_save_state_writer_mutex);
+  if (!s_save_state_writer_thread.Joinable())
+  {
+    s_save_state_writer_shutdown = false;
+    s_save_state_writer_thread.Start(&SaveStateWriterThreadEntryPoint);
+  }
+
+  SaveStateWriteRequest& req = s_save_state_write_queue.emplace_back();
+  req.path = std::move(path);
+  req.backup_existing_save = backup_existing_save;
+  req.compression_method = g_settings.compress_save_states ? SAVE_STATE_HEADER::COMPRESSION_TYPE_ZSTD :
+                                                             SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE;
+  req.buffer = std::move(buffer);
+  s_save_state_writer_cv.notify_one();
+}
+
+void System::FlushSaveStateWrites()
+{
+  std::unique_lock lock(s_save_state_writer_mutex);
+  s_save_state_writer_done_cv.wait(lock,
+                                   []() { return (s_save_state_write_queue.empty() && !s_save_state_write_active); });
+}
+
+void System::StopSaveStateWriterThread()
+{
+  if (!s_save_state_writer_thread.Joinable())
+    return;
+
+  {
+    std::unique_lock lock(s_save_state_writer_mutex);
+    s_save_state_writer_shutdown = true;
+    s_save_state_writer_cv.notify_one();
+  }
+
+  s_save_state_writer_thread.Join();
+  s_save_state_spare_stream.reset();
+}
+
+void System::SaveStateWriterThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("Save State Writer");
+
+  std::unique_lock lock(s_save_state_writer_mutex);
+  for (;;)
+  {
+    s_save_state_writer_cv.wait(lock,
+                                []() { return (!s_save_state_write_queue.empty() || s_save_state_writer_shutdown); });
+
+    // finish off anything which is still queued before shutting down, so we don't lose saves
+    if (s_save_state_write_queue.empty())
+      break;
+
+    SaveStateWriteRequest req = std::move(s_save_state_write_queue.front());
+    s_save_state_write_queue.pop_front();
+    s_save_state_write_active = true;
+    lock.unlock();
+
+    WriteSaveStateFile(req);
+
+    lock.lock();
+    s_save_state_write_active = false;
+    s_save_state_spare_stream = std::move(req.buffer.state_stream);
+    s_save_state_writer_done_cv.notify_all();
+  }
+}
+
+void System::WriteSaveStateFile(const SaveStateWriteRequest& req)
+{
+  Common::Timer write_timer;
+
+  const char* filename = req.path.c_str();
+  if (req.backup_existing_save && FileSystem::FileExists(filename))
+  {
+    const std::string backup_filename(Path::ReplaceExtension(req.path, "bak"));
+    if (!FileSystem::RenamePath(filename, backup_filename.c_str()))
+      Log_ErrorPrintf("Failed to rename save state backup '%s'", backup_filename.c_str());
+  }
+
+  std::unique_ptr<ByteStream> stream =
+    ByteStream::OpenFile(filename, BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_TRUNCATE |
+                                     BYTESTREAM_OPEN_ATOMIC_UPDATE | BYTESTREAM_OPEN_STREAMED);
+  if (!stream || !SaveStateBufferToStream(stream.get(), req.buffer, req.compression_method))
+  {
+    Host::ReportFormattedErrorAsync(TRANSLATE("OSDMessage", "Save State"),
+                                    TRANSLATE("OSDMessage", "Saving state to '%s' failed."), filename);
+    if (stream)
+      stream->Discard();
+  }
+  else
+  {
+    const std::string display_name(FileSystem::GetDisplayNameFromPath(filename));
+    Host::AddIconOSDMessage(
+      "save_state", ICON_FA_SAVE,
+      fmt::format(TRANSLATE_FS("OSDMessage", "State saved to '{}'."), Path::GetFileName(display_name)), 5.0f);
+    stream->Commit();
+  }
+
+  Log_VerbosePrintf("Writing state took %.2f msec", write_timer.GetTimeMilliseconds());
+}
+
 float System::GetTargetSpeed()
 {
   return s_target_speed;
@@ -3249,6 +3474,31 @@ void System::RemoveMedia()
   ClearMemorySaveStates();
 }
 
+bool System::GetGameDetailsFromGameList(const char* path, CDImage* image, std::string* out_id, GameHash* out_hash)
+{
+  // Reading the executable can mean seeking all over the disc, which is slow for compressed images, and the game list
+  // has already done it. Only trust the entry if the file hasn't changed since it was scanned. The game list scans
+  // images without PPF patches, which can change the executable, so it can't be used when they're loaded.
+  if (image->HasSubImages() || g_settings.cdrom_load_image_patches)
+    return false;
+
+  FILESYSTEM_STAT_DATA sd;
+  if (!FileSystem::StatFile(path, &sd))
+    return false;
+
+  auto lock = GameList::GetLock();
+  const GameList::Entry* entry = GameList::GetEntryForPath(path);
+  if (!entry || !entry->IsDisc() || entry->hash == 0 || entry->last_modified_time != sd.ModificationTime ||
+      entry->total_size != static_cast<u64>(CDImage::RAW_SECTOR_SIZE) * static_cast<u64>(image->GetLBACount()))
+  {
+    return false;
+  }
+
+  *out_id = entry->serial;
+  *out_hash = entry->hash;
+  return true;
+}
+
 void System::UpdateRunningGame(const char* path, CDImage* image, bool booting)
 {
   if (!booting && s_running_game_path == path)
@@ -3274,7 +3524,8 @@ void System::UpdateRunningGame(const char* path, CDImage* image, bool booting)
     else if (image)
     {
       std::string id;
-      GetGameDetailsFromImage(image, &id, &s_running_game_hash);
+      if (!GetGameDetailsFromGameList(path, image, &id, &s_running_game_hash))
+        GetGameDetailsFromImage(image, &id, &s_running_game_hash);
 
       s_running_game_entry = GameDatabase::GetEntryForId(id);
       if (s_running_game_entry)
@@ -3312,8 +3563,14 @@ void System::UpdateRunningGame(const char* path, CDImage* image, bool booting)
     LoadCheatListFromGameTitle();
 
   if (s_running_game_serial != prev_serial)
+  {
     UpdateSessionTime(prev_serial);
 
+    // Code cache isn't initialized yet when booting.
+    if (!booting)
+      UpdatePersistentCodeCache();
+  }
+
   SaveStateSelectorUI::RefreshList();
 
 #ifdef ENABLE_DISCORD_PRESENCE
@@ -3323,6 +3580,19 @@ void System::UpdateRunningGame(const char* path, CDImage* image, bool booting)
   Host::OnGameChanged(s_running_game_path, s_running_game_serial, s_running_game_title);
 }
 
+void System::UpdatePersistentCodeCache()
+{
+  if (!g_settings.cpu_recompiler_block_cache || !g_settings.IsUsingCodeCache() || s_running_game_serial.empty())
+  {
+    CPU::CodeCache::ClosePersistentCache();
+    return;
+  }
+
+  CPU::CodeCache::OpenPersistentCache(
+    Path::Combine(EmuFolders::Cache, fmt::format("blocks" FS_OSPATH_SEPARATOR_STR "{}.bin",
+                                                 Path::SanitizeFileName(s_running_game_serial))));
+}
+
 bool System::CheckForSBIFile(CDImage* image)
 {
   if (!s_running_game_entry || !s_running_game_entry->HasTrait(GameDatabase::Trait::IsLibCryptProtected) || !image ||
@@ -3520,6 +3790,7 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
         (g_settings.cpu_recompiler_memory_exceptions != old_settings.cpu_recompiler_memory_exceptions ||
          g_settings.cpu_recompiler_block_linking != old_settings.cpu_recompiler_block_linking ||
          g_settings.cpu_recompiler_icache != old_settings.cpu_recompiler_icache ||
+         g_settings.cpu_recompiler_superblocks != old_settings.cpu_recompiler_superblocks ||
          g_settings.bios_tty_logging != old_settings.bios_tty_logging))
     {
       Host::AddOSDMessage(TRANSLATE_STR("OSDMessage", "Recompiler options changed, flushing all blocks."), 5.0f);
@@ -3535,6 +3806,12 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
         CPU::ClearICache();
     }
 
+    if (g_settings.cpu_execution_mode != old_settings.cpu_execution_mode ||
+        g_settings.cpu_recompiler_block_cache != old_settings.cpu_recompiler_block_cache)
+    {
+      UpdatePersistentCodeCache();
+    }
+
     SPU::GetOutputStream()->SetOutputVolume(GetAudioOutputVolume());
 
     if (g_settings.gpu_resolution_scale != old_settings.gpu_resolution_scale ||
@@ -3542,6 +3819,7 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
         g_settings.gpu_per_sample_shading != old_settings.gpu_per_sample_shading ||
         g_settings.gpu_use_thread != old_settings.gpu_use_thread ||
         g_settings.gpu_use_software_renderer_for_readbacks != old_settings.gpu_use_software_renderer_for_readbacks ||
+        g_settings.gpu_sw_render_threads != old_settings.gpu_sw_render_threads ||
         g_settings.gpu_fifo_size != old_settings.gpu_fifo_size ||
         g_settings.gpu_max_run_ahead != old_settings.gpu_max_run_ahead ||
         g_settings.gpu_true_color != old_settings.gpu_true_color ||
@@ -3706,14 +3984,25 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
 
 void System::CalculateRewindMemoryUsage(u32 num_saves, u64* ram_usage, u64* vram_usage)
 {
-  *ram_usage = MAX_SAVE_STATE_SIZE * static_cast<u64>(num_saves);
-  *vram_usage = (VRAM_WIDTH * VRAM_HEIGHT * 4) * static_cast<u64>(std::max(g_settings.gpu_resolution_scale, 1u)) *
-                static_cast<u64>(g_settings.gpu_multisamples) * static_cast<u64>(num_saves);
+  // The newest state and the spare stream are full copies, every other slot is a compressed delta.
+  const u64 delta_count = s_rewind_delta_count.load(std::memory_order_relaxed);
+  const u64 delta_size =
+    (delta_count > 0) ? (s_rewind_delta_total_size.load(std::memory_order_relaxed) / delta_count) :
+                        REWIND_ESTIMATED_DELTA_SIZE;
+  *ram_usage = MAX_SAVE_STATE_SIZE * 2 + delta_size * static_cast<u64>(std::max(num_saves, 1u) - 1);
+
+  // VRAM lives in a host texture per slot, which isn't delta encoded.
+  const u64 scale = std::max(g_settings.gpu_resolution_scale, 1u);
+  *vram_usage = (VRAM_WIDTH * VRAM_HEIGHT * 4) * scale * scale * static_cast<u64>(g_settings.gpu_multisamples) *
+                static_cast<u64>(num_saves);
 }
 
 void System::ClearMemorySaveStates()
 {
+  WaitForRewindEncode();
   s_rewind_states.clear();
+  s_rewind_head = {};
+  s_rewind_spare_stream.reset();
   s_runahead_states.clear();
 }
 
@@ -3738,6 +4027,7 @@ void System::UpdateMemorySaveStateSettings()
   {
     s_rewind_save_frequency = -1;
     s_rewind_save_counter = -1;
+    StopRewindEncodeThread();
   }
 
   s_rewind_load_frequency = -1;
@@ -3785,54 +4075,144 @@ bool System::SaveMemoryState(MemorySaveState* mss)
   return true;
 }
 
+void System::XorMemoryStates(u8* dst, const u8* src, u32 size)
+{
+  u32 pos = 0;
+  for (; (pos + sizeof(u64)) <= size; pos += sizeof(u64))
+  {
+    u64 dst_value, src_value;
+    std::memcpy(&dst_value, dst + pos, sizeof(dst_value));
+    std::memcpy(&src_value, src + pos, sizeof(src_value));
+    dst_value ^= src_value;
+    std::memcpy(dst + pos, &dst_value, sizeof(dst_value));
+  }
+  for (; pos < size; pos++)
+    dst[pos] ^= src[pos];
+}
+
 bool System::SaveRewindState()
 {
 #ifdef PROFILE_MEMORY_SAVE_STATES
   Common::Timer save_timer;
 #endif
 
-  // try to reuse the frontmost slot
-  const u32 save_slots = g_settings.rewind_save_slots;
+  // the previous delta has to be finished before we can replace the state it's relative to
+  WaitForRewindEncode();
+
+  // the newest state counts as a slot, and reuse the oldest slot's texture if we're full
+  const u32 save_slots = std::max(g_settings.rewind_save_slots, 1u);
   MemorySaveState mss;
-  while (s_rewind_states.size() >= save_slots)
+  while (!s_rewind_states.empty() && (s_rewind_states.size() + 2) > save_slots)
   {
-    mss = std::move(s_rewind_states.front());
+    mss.vram_texture = std::move(s_rewind_states.front().vram_texture);
     s_rewind_states.pop_front();
   }
+  if (save_slots == 1 && s_rewind_head.state_stream)
+  {
+    mss.vram_texture = std::move(s_rewind_head.vram_texture);
+    s_rewind_spare_stream = std::move(s_rewind_head.state_stream);
+  }
+
+  mss.state_stream = std::move(s_rewind_spare_stream);
+  if (mss.state_stream)
+    mss.state_stream->Resize(0);
 
   if (!SaveMemoryState(&mss))
+  {
+    s_rewind_spare_stream = std::move(mss.state_stream);
     return false;
+  }
+
+  // the previous newest state becomes a delta against the one we just saved
+  std::unique_ptr<GrowableMemoryByteStream> prev_stream = std::move(s_rewind_head.state_stream);
+  std::unique_ptr<GPUTexture> prev_texture = std::move(s_rewind_head.vram_texture);
+  s_rewind_head = std::move(mss);
+  if (prev_stream)
+  {
+    RewindDelta& delta = s_rewind_states.emplace_back();
+    delta.vram_texture = std::move(prev_texture);
+    delta.size = static_cast<u32>(prev_stream->GetSize());
+
+    if (!s_rewind_encode_thread.Joinable())
+      StartRewindEncodeThread();
 
-  s_rewind_states.push_back(std::move(mss));
+    std::unique_lock lock(s_rewind_encode_mutex);
+    s_rewind_encode_stream = std::move(prev_stream);
+    s_rewind_encode_next_stream = s_rewind_head.state_stream.get();
+    s_rewind_encode_delta = &delta;
+    s_rewind_encode_pending = true;
+    s_rewind_encode_cv.notify_one();
+  }
 
 #ifdef PROFILE_MEMORY_SAVE_STATES
-  Log_DevPrintf("Saved rewind state (%" PRIu64 " bytes, took %.4f ms)", s_rewind_states.back().state_stream->GetSize(),
+  Log_DevPrintf("Saved rewind state (%" PRIu64 " bytes, took %.4f ms)", s_rewind_head.state_stream->GetSize(),
                 save_timer.GetTimeMilliseconds());
 #endif
 
   return true;
 }
 
+bool System::PopRewindState()
+{
+  if (s_rewind_states.empty())
+  {
+    s_rewind_spare_stream = std::move(s_rewind_head.state_stream);
+    s_rewind_head = {};
+    return true;
+  }
+
+  RewindDelta& delta = s_rewind_states.back();
+  std::unique_ptr<GrowableMemoryByteStream> stream = std::move(s_rewind_spare_stream);
+  if (!stream)
+    stream = std::make_unique<GrowableMemoryByteStream>(nullptr, MAX_SAVE_STATE_SIZE);
+  stream->Resize(delta.size);
+
+  const size_t result =
+    ZSTD_decompress(stream->GetMemoryPointer(), delta.size, delta.data.data(), delta.data.size());
+  if (ZSTD_isError(result) || result != delta.size)
+  {
+    Log_ErrorPrintf("Failed to decompress rewind state: %s",
+                    ZSTD_isError(result) ? ZSTD_getErrorName(result) : "size mismatch");
+    s_rewind_states.clear();
+    s_rewind_head = {};
+    return false;
+  }
+
+  const GrowableMemoryByteStream* next_stream = s_rewind_head.state_stream.get();
+  XorMemoryStates(stream->GetMemoryPointer(), next_stream->GetMemoryPointer(),
+                  std::min(delta.size, static_cast<u32>(next_stream->GetSize())));
+
+  s_rewind_spare_stream = std::move(s_rewind_head.state_stream);
+  s_rewind_head.state_stream = std::move(stream);
+  s_rewind_head.vram_texture = std::move(delta.vram_texture);
+  s_rewind_states.pop_back();
+  return true;
+}
+
 bool System::LoadRewindState(u32 skip_saves /*= 0*/, bool consume_state /*=true */)
 {
-  while (skip_saves > 0 && !s_rewind_states.empty())
+  WaitForRewindEncode();
+
+  while (skip_saves > 0 && s_rewind_head.state_stream)
   {
-    s_rewind_states.pop_back();
+    if (!PopRewindState())
+      return false;
+
     skip_saves--;
   }
 
-  if (s_rewind_states.empty())
+  if (!s_rewind_head.state_stream)
     return false;
 
 #ifdef PROFILE_MEMORY_SAVE_STATES
   Common::Timer load_timer;
 #endif
 
-  if (!LoadMemoryState(s_rewind_states.back()))
+  if (!LoadMemoryState(s_rewind_head))
     return false;
 
   if (consume_state)
-    s_rewind_states.pop_back();
+    PopRewindState();
 
 #ifdef PROFILE_MEMORY_SAVE_STATES
   Log_DevPrintf("Rewind load took %.4f ms", load_timer.GetTimeMilliseconds());
@@ -3841,6 +4221,87 @@ bool System::LoadRewindState(u32 skip_saves /*= 0*/, bool consume_state /*=true
   return true;
 }
 
+void System::StartRewindEncodeThread()
+{
+  s_rewind_encode_shutdown = false;
+  s_rewind_encode_thread.Start(&RewindEncodeThreadEntryPoint);
+}
+
+void System::StopRewindEncodeThread()
+{
+  if (!s_rewind_encode_thread.Joinable())
+    return;
+
+  {
+    std::unique_lock lock(s_rewind_encode_mutex);
+    s_rewind_encode_shutdown = true;
+    s_rewind_encode_cv.notify_one();
+  }
+
+  s_rewind_encode_thread.Join();
+  WaitForRewindEncode();
+}
+
+void System::WaitForRewindEncode()
+{
+  std::unique_lock lock(s_rewind_encode_mutex);
+  s_rewind_encode_done_cv.wait(lock, []() { return !s_rewind_encode_pending; });
+  if (s_rewind_encode_stream)
+    s_rewind_spare_stream = std::move(s_rewind_encode_stream);
+}
+
+void System::RewindEncodeThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("Rewind Encoder");
+
+  ZSTD_CCtx* cctx = ZSTD_createCCtx();
+  std::vector<u8> compress_buffer;
+
+  std::unique_lock lock(s_rewind_encode_mutex);
+  for (;;)
+  {
+    s_rewind_encode_cv.wait(lock, []() { return s_rewind_encode_pending || s_rewind_encode_shutdown; });
+    if (!s_rewind_encode_pending)
+      break;
+
+    // the CPU thread won't touch either state, or the delta, until we clear the pending flag
+    GrowableMemoryByteStream* stream = s_rewind_encode_stream.get();
+    const GrowableMemoryByteStream* next_stream = s_rewind_encode_next_stream;
+    RewindDelta* delta = s_rewind_encode_delta;
+    lock.unlock();
+
+    XorMemoryStates(stream->GetMemoryPointer(), next_stream->GetMemoryPointer(),
+                    std::min(delta->size, static_cast<u32>(next_stream->GetSize())));
+
+    compress_buffer.resize(ZSTD_compressBound(delta->size));
+    const size_t result = ZSTD_compressCCtx(cctx, compress_buffer.data(), compress_buffer.size(),
+                                            stream->GetMemoryPointer(), delta->size, REWIND_COMPRESSION_LEVEL);
+    if (ZSTD_isError(result))
+    {
+      // leave it empty, and the buffer will be dropped when we try to rewind past it
+      Log_ErrorPrintf("Failed to compress rewind state: %s", ZSTD_getErrorName(result));
+      delta->data.clear();
+    }
+    else
+    {
+      delta->data.assign(compress_buffer.begin(), compress_buffer.begin() + result);
+      s_rewind_delta_total_size.fetch_add(result, std::memory_order_relaxed);
+      s_rewind_delta_count.fetch_add(1, std::memory_order_relaxed);
+#ifdef PROFILE_MEMORY_SAVE_STATES
+      Log_DevPrintf("Compressed rewind delta from %u to %zu bytes", delta->size, result);
+#endif
+    }
+
+    lock.lock();
+    s_rewind_encode_next_stream = nullptr;
+    s_rewind_encode_delta = nullptr;
+    s_rewind_encode_pending = false;
+    s_rewind_encode_done_cv.notify_one();
+  }
+
+  ZSTD_freeCCtx(cctx);
+}
+
 bool System::IsRewinding()
 {
   return (s_rewind_load_frequency >= 0);
@@ -4231,6 +4692,8 @@ std::optional<SaveStateInfo> System::GetSaveStateInfo(const char* serial, s32 sl
 
 std::optional<ExtendedSaveStateInfo> System::GetExtendedSaveStateInfo(const char* path)
 {
+  FlushSaveStateWrites();
+
   FILESYSTEM_STAT_DATA sd;
   if (!FileSystem::StatFile(path, &sd))
     return std::nullopt;
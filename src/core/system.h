@@ -246,6 +246,9 @@ bool LoadState(const char* filename);
 bool SaveState(const char* filename, bool backup_existing_save);
 bool SaveResumeState();
 
+/// Blocks until all save states queued by SaveState() have been written to disk.
+void FlushSaveStateWrites();
+
 /// Memory save states - only for internal use.
 struct MemorySaveState
 {
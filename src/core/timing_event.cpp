@@ -8,17 +8,57 @@
 #include "cpu_core_private.h"
 #include "system.h"
 #include "util/state_wrapper.h"
+
+#include <algorithm>
+#include <array>
+
 Log_SetChannel(TimingEvents);
 
 namespace TimingEvents {
 
-static TimingEvent* s_active_events_head;
-static TimingEvent* s_active_events_tail;
+enum : u32
+{
+  MAX_EVENTS = 32
+};
+
+namespace {
+// The key is kept next to the id, so sifting never has to touch the events themselves.
+struct HeapEntry
+{
+  u32 next_run_time;
+  u32 id;
+};
+} // namespace
+
+static void AddActiveEvent(TimingEvent* event);
+static void RemoveActiveEvent(TimingEvent* event);
+static void UpdateActiveEvent(TimingEvent* event);
+static void SiftUp(u32 index);
+static void SiftDown(u32 index);
+static void SortEvents();
+static void ShiftActiveEvents(s32 delta);
+static TimingEvent* FindActiveEvent(const char* name);
+
+static std::array<TimingEvent*, MAX_EVENTS> s_events = {};
+static std::array<HeapEntry, MAX_EVENTS> s_active_heap;
 static TimingEvent* s_current_event = nullptr;
 static u32 s_active_event_count = 0;
 static u32 s_global_tick_counter = 0;
 static bool s_frame_done = false;
 
+// Times are compared relative to each other, so the tick counter can wrap. Events due at the same time run in id
+// order, so the order doesn't depend on how the heap got into its current shape (e.g. after loading a state).
+ALWAYS_INLINE static bool IsEarlier(const HeapEntry& lhs, const HeapEntry& rhs)
+{
+  const s32 diff = static_cast<s32>(lhs.next_run_time - rhs.next_run_time);
+  return (diff < 0 || (diff == 0 && lhs.id < rhs.id));
+}
+
+ALWAYS_INLINE static TickCount GetHeadDowncount()
+{
+  return static_cast<TickCount>(s_active_heap[0].next_run_time - s_global_tick_counter);
+}
+
 u32 GetGlobalTickCounter()
 {
   return s_global_tick_counter;
@@ -31,6 +71,8 @@ void Initialize()
 
 void Reset()
 {
+  // active events keep their relative times
+  ShiftActiveEvents(-static_cast<s32>(s_global_tick_counter));
   s_global_tick_counter = 0;
 }
 
@@ -52,205 +94,123 @@ std::unique_ptr<TimingEvent> CreateTimingEvent(std::string name, TickCount perio
 
 void UpdateCPUDowncount()
 {
-  CPU::g_state.downcount = CPU::HasPendingInterrupt() ? 0 : s_active_events_head->GetDowncount();
+  CPU::g_state.downcount = CPU::HasPendingInterrupt() ? 0 : GetHeadDowncount();
 }
 
-TimingEvent** GetHeadEventPtr()
+static void SiftUp(u32 index)
 {
-  return &s_active_events_head;
-}
-
-static void SortEvent(TimingEvent* event)
-{
-  const TickCount event_downcount = event->m_downcount;
-
-  if (event->prev && event->prev->m_downcount > event_downcount)
+  const HeapEntry entry = s_active_heap[index];
+  while (index > 0)
   {
-    // move backwards
-    TimingEvent* current = event->prev;
-    while (current && current->m_downcount > event_downcount)
-      current = current->prev;
-
-    // unlink
-    if (event->prev)
-      event->prev->next = event->next;
-    else
-      s_active_events_head = event->next;
-    if (event->next)
-      event->next->prev = event->prev;
-    else
-      s_active_events_tail = event->prev;
+    const u32 parent = (index - 1) / 2;
+    if (!IsEarlier(entry, s_active_heap[parent]))
+      break;
 
-    // insert after current
-    if (current)
-    {
-      event->next = current->next;
-      if (current->next)
-        current->next->prev = event;
-      else
-        s_active_events_tail = event;
-
-      event->prev = current;
-      current->next = event;
-    }
-    else
-    {
-      // insert at front
-      DebugAssert(s_active_events_head);
-      s_active_events_head->prev = event;
-      event->prev = nullptr;
-      event->next = s_active_events_head;
-      s_active_events_head = event;
-      UpdateCPUDowncount();
-    }
+    s_active_heap[index] = s_active_heap[parent];
+    s_events[s_active_heap[index].id]->m_heap_index = index;
+    index = parent;
   }
-  else if (event->next && event_downcount > event->next->m_downcount)
-  {
-    // move forwards
-    TimingEvent* current = event->next;
-    while (current && event_downcount > current->m_downcount)
-      current = current->next;
-
-    // unlink
-    if (event->prev)
-      event->prev->next = event->next;
-    else
-      s_active_events_head = event->next;
-    if (event->next)
-      event->next->prev = event->prev;
-    else
-      s_active_events_tail = event->prev;
-
-    // insert before current
-    if (current)
-    {
-      event->next = current;
-      event->prev = current->prev;
 
-      if (current->prev)
-        current->prev->next = event;
-      else
-        s_active_events_head = event;
+  s_active_heap[index] = entry;
+  s_events[entry.id]->m_heap_index = index;
+}
 
-      current->prev = event;
-    }
-    else
-    {
-      // insert at back
-      DebugAssert(s_active_events_tail);
-      s_active_events_tail->next = event;
-      event->next = nullptr;
-      event->prev = s_active_events_tail;
-      s_active_events_tail = event;
-    }
+static void SiftDown(u32 index)
+{
+  const HeapEntry entry = s_active_heap[index];
+  for (;;)
+  {
+    u32 child = index * 2 + 1;
+    if (child >= s_active_event_count)
+      break;
+    if ((child + 1) < s_active_event_count && IsEarlier(s_active_heap[child + 1], s_active_heap[child]))
+      child++;
+    if (!IsEarlier(s_active_heap[child], entry))
+      break;
+
+    s_active_heap[index] = s_active_heap[child];
+    s_events[s_active_heap[index].id]->m_heap_index = index;
+    index = child;
   }
+
+  s_active_heap[index] = entry;
+  s_events[entry.id]->m_heap_index = index;
 }
 
 static void AddActiveEvent(TimingEvent* event)
 {
-  DebugAssert(!event->prev && !event->next);
-  s_active_event_count++;
+  DebugAssert(s_active_event_count < MAX_EVENTS);
 
-  TimingEvent* current = nullptr;
-  TimingEvent* next = s_active_events_head;
-  while (next && event->m_downcount > next->m_downcount)
-  {
-    current = next;
-    next = next->next;
-  }
+  const u32 index = s_active_event_count++;
+  s_active_heap[index] = HeapEntry{event->m_next_run_time, event->m_id};
+  SiftUp(index);
 
-  if (!next)
-  {
-    // new tail
-    event->prev = s_active_events_tail;
-    if (s_active_events_tail)
-    {
-      s_active_events_tail->next = event;
-      s_active_events_tail = event;
-    }
-    else
-    {
-      // first event
-      s_active_events_tail = event;
-      s_active_events_head = event;
-      UpdateCPUDowncount();
-    }
-  }
-  else if (!current)
-  {
-    // new head
-    event->next = s_active_events_head;
-    s_active_events_head->prev = event;
-    s_active_events_head = event;
+  if (event->m_heap_index == 0)
     UpdateCPUDowncount();
-  }
-  else
-  {
-    // inbetween current < event > next
-    event->prev = current;
-    event->next = next;
-    current->next = event;
-    next->prev = event;
-  }
 }
 
 static void RemoveActiveEvent(TimingEvent* event)
 {
   DebugAssert(s_active_event_count > 0);
 
-  if (event->next)
-  {
-    event->next->prev = event->prev;
-  }
-  else
+  const u32 index = event->m_heap_index;
+  const u32 last = --s_active_event_count;
+  if (index != last)
   {
-    s_active_events_tail = event->prev;
+    s_active_heap[index] = s_active_heap[last];
+    s_events[s_active_heap[index].id]->m_heap_index = index;
+    if (index > 0 && IsEarlier(s_active_heap[index], s_active_heap[(index - 1) / 2]))
+      SiftUp(index);
+    else
+      SiftDown(index);
   }
 
-  if (event->prev)
-  {
-    event->prev->next = event->next;
-  }
-  else
-  {
-    s_active_events_head = event->next;
-    if (s_active_events_head)
-      UpdateCPUDowncount();
-  }
+  event->m_heap_index = 0;
+  if (index == 0 && s_active_event_count > 0)
+    UpdateCPUDowncount();
+}
 
-  event->prev = nullptr;
-  event->next = nullptr;
+static void UpdateActiveEvent(TimingEvent* event)
+{
+  const u32 index = event->m_heap_index;
+  const HeapEntry old_entry = s_active_heap[index];
+  s_active_heap[index].next_run_time = event->m_next_run_time;
+  if (IsEarlier(s_active_heap[index], old_entry))
+    SiftUp(index);
+  else
+    SiftDown(index);
 
-  s_active_event_count--;
+  if (index == 0 || event->m_heap_index == 0)
+    UpdateCPUDowncount();
 }
 
 static void SortEvents()
 {
-  std::vector<TimingEvent*> events;
-  events.reserve(s_active_event_count);
+  // A sorted array is a valid heap, and gives the same layout no matter what order the events were in before.
+  for (u32 i = 0; i < s_active_event_count; i++)
+    s_active_heap[i].next_run_time = s_events[s_active_heap[i].id]->m_next_run_time;
+  std::sort(s_active_heap.begin(), s_active_heap.begin() + s_active_event_count,
+            [](const HeapEntry& lhs, const HeapEntry& rhs) { return IsEarlier(lhs, rhs); });
+  for (u32 i = 0; i < s_active_event_count; i++)
+    s_events[s_active_heap[i].id]->m_heap_index = i;
+}
 
-  TimingEvent* next = s_active_events_head;
-  while (next)
+static void ShiftActiveEvents(s32 delta)
+{
+  for (u32 i = 0; i < s_active_event_count; i++)
   {
-    TimingEvent* current = next;
-    events.push_back(current);
-    next = current->next;
-    current->prev = nullptr;
-    current->next = nullptr;
+    TimingEvent* event = s_events[s_active_heap[i].id];
+    event->m_next_run_time += static_cast<u32>(delta);
+    event->m_last_run_time += static_cast<u32>(delta);
+    s_active_heap[i].next_run_time = event->m_next_run_time;
   }
-
-  s_active_events_head = nullptr;
-  s_active_events_tail = nullptr;
-  s_active_event_count = 0;
-
-  for (TimingEvent* event : events)
-    AddActiveEvent(event);
 }
 
 static TimingEvent* FindActiveEvent(const char* name)
 {
-  for (TimingEvent* event = s_active_events_head; event; event = event->next)
+  for (u32 i = 0; i < s_active_event_count; i++)
   {
+    TimingEvent* event = s_events[s_active_heap[i].id];
     if (event->GetName().compare(name) == 0)
       return event;
   }
@@ -279,41 +239,32 @@ void RunEvents()
       CPU::DispatchInterrupt();
 
     TickCount pending_ticks = CPU::GetPendingTicks();
-    if (pending_ticks >= s_active_events_head->GetDowncount())
+    if (pending_ticks >= GetHeadDowncount())
     {
       CPU::ResetPendingTicks();
 
       do
       {
-        const TickCount time = std::min(pending_ticks, s_active_events_head->GetDowncount());
+        // Advancing the clock makes any events which are late have a negative downcount.
+        const TickCount time = std::min(pending_ticks, GetHeadDowncount());
         s_global_tick_counter += static_cast<u32>(time);
         pending_ticks -= time;
 
-        // Apply downcount to all events.
-        // This will result in a negative downcount for those events which are late.
-        for (TimingEvent* event = s_active_events_head; event; event = event->next)
-        {
-          event->m_downcount -= time;
-          event->m_time_since_last_run += time;
-        }
-
         // Now we can actually run the callbacks.
-        while (s_active_events_head->m_downcount <= 0)
+        while (GetHeadDowncount() <= 0)
         {
-          // move it to the end, since that'll likely be its new position
-          TimingEvent* event = s_active_events_head;
+          TimingEvent* event = s_events[s_active_heap[0].id];
           s_current_event = event;
 
           // Factor late time into the time for the next invocation.
-          const TickCount ticks_late = -event->m_downcount;
-          const TickCount ticks_to_execute = event->m_time_since_last_run;
-          event->m_downcount += event->m_interval;
-          event->m_time_since_last_run = 0;
+          const TickCount ticks_late = static_cast<TickCount>(s_global_tick_counter - event->m_next_run_time);
+          const TickCount ticks_to_execute = static_cast<TickCount>(s_global_tick_counter - event->m_last_run_time);
+          event->m_next_run_time += static_cast<u32>(event->m_interval);
+          event->m_last_run_time = s_global_tick_counter;
+          UpdateActiveEvent(event);
 
           // The cycles_late is only an indicator, it doesn't modify the cycles to execute.
           event->m_callback(event->m_callback_param, ticks_to_execute, ticks_late);
-          if (event->m_active)
-            SortEvent(event);
         }
       } while (pending_ticks > 0);
 
@@ -332,10 +283,14 @@ void RunEvents()
 
 bool DoState(StateWrapper& sw)
 {
+  const u32 old_global_tick_counter = s_global_tick_counter;
   sw.Do(&s_global_tick_counter);
 
   if (sw.IsReading())
   {
+    // Events which aren't in the state keep their relative times.
+    ShiftActiveEvents(static_cast<s32>(s_global_tick_counter - old_global_tick_counter));
+
     // Load timestamps for the clock events.
     // Any oneshot events should be recreated by the load state method, so we can fix up their times here.
     u32 event_count = 0;
@@ -360,9 +315,9 @@ bool DoState(StateWrapper& sw)
         continue;
       }
 
-      // Using reschedule is safe here since we call sort afterwards.
-      event->m_downcount = downcount;
-      event->m_time_since_last_run = time_since_last_run;
+      // Changing the times directly is safe here since we rebuild the heap afterwards.
+      event->m_next_run_time = s_global_tick_counter + static_cast<u32>(downcount);
+      event->m_last_run_time = s_global_tick_counter - static_cast<u32>(time_since_last_run);
       event->m_period = period;
       event->m_interval = interval;
     }
@@ -378,14 +333,17 @@ bool DoState(StateWrapper& sw)
   }
   else
   {
-
     sw.Do(&s_active_event_count);
 
-    for (TimingEvent* event = s_active_events_head; event; event = event->next)
+    // Stored relative to the tick counter, so the format doesn't depend on how the events are tracked.
+    for (u32 i = 0; i < s_active_event_count; i++)
     {
+      TimingEvent* event = s_events[s_active_heap[i].id];
+      TickCount downcount = event->GetDowncount();
+      TickCount time_since_last_run = static_cast<TickCount>(s_global_tick_counter - event->m_last_run_time);
       sw.Do(&event->m_name);
-      sw.Do(&event->m_downcount);
-      sw.Do(&event->m_time_since_last_run);
+      sw.Do(&downcount);
+      sw.Do(&time_since_last_run);
       sw.Do(&event->m_period);
       sw.Do(&event->m_interval);
     }
@@ -403,22 +361,39 @@ TimingEvent::TimingEvent(std::string name, TickCount period, TickCount interval,
   : m_callback(callback), m_callback_param(callback_param), m_downcount(interval), m_time_since_last_run(0),
     m_period(period), m_interval(interval), m_name(std::move(name))
 {
+  const auto it = std::find(TimingEvents::s_events.begin(), TimingEvents::s_events.end(), nullptr);
+  if (it == TimingEvents::s_events.end())
+    Panic("Too many timing events");
+
+  *it = this;
+  m_id = static_cast<u32>(it - TimingEvents::s_events.begin());
 }
 
 TimingEvent::~TimingEvent()
 {
   if (m_active)
     TimingEvents::RemoveActiveEvent(this);
+
+  TimingEvents::s_events[m_id] = nullptr;
+}
+
+TickCount TimingEvent::GetDowncount() const
+{
+  return m_active ? static_cast<TickCount>(m_next_run_time - TimingEvents::s_global_tick_counter) : m_downcount;
 }
 
 TickCount TimingEvent::GetTicksSinceLastExecution() const
 {
-  return CPU::GetPendingTicks() + m_time_since_last_run;
+  const TickCount pending_ticks = CPU::GetPendingTicks();
+  return m_active ?
+           static_cast<TickCount>(TimingEvents::s_global_tick_counter + static_cast<u32>(pending_ticks) -
+                                  m_last_run_time) :
+           (pending_ticks + m_time_since_last_run);
 }
 
 TickCount TimingEvent::GetTicksUntilNextExecution() const
 {
-  return std::max(m_downcount - CPU::GetPendingTicks(), static_cast<TickCount>(0));
+  return std::max(GetDowncount() - CPU::GetPendingTicks(), static_cast<TickCount>(0));
 }
 
 void TimingEvent::Delay(TickCount ticks)
@@ -429,23 +404,21 @@ void TimingEvent::Delay(TickCount ticks)
     return;
   }
 
-  m_downcount += ticks;
+  m_next_run_time += static_cast<u32>(ticks);
 
   DebugAssert(TimingEvents::s_current_event != this);
-  TimingEvents::SortEvent(this);
-  if (TimingEvents::s_active_events_head == this)
-    TimingEvents::UpdateCPUDowncount();
+  TimingEvents::UpdateActiveEvent(this);
 }
 
 void TimingEvent::Schedule(TickCount ticks)
 {
-  const TickCount pending_ticks = CPU::GetPendingTicks();
-  m_downcount = pending_ticks + ticks;
+  const u32 current_time = TimingEvents::s_global_tick_counter + static_cast<u32>(CPU::GetPendingTicks());
+  m_next_run_time = current_time + static_cast<u32>(ticks);
 
   if (!m_active)
   {
     // Event is going active, so we want it to only execute ticks from the current timestamp.
-    m_time_since_last_run = -pending_ticks;
+    m_last_run_time = current_time;
     m_active = true;
     TimingEvents::AddActiveEvent(this);
   }
@@ -453,12 +426,7 @@ void TimingEvent::Schedule(TickCount ticks)
   {
     // Event is already active, so we leave the time since last run alone, and just modify the downcount.
     // If this is a call from an IO handler for example, re-sort the event queue.
-    if (TimingEvents::s_current_event != this)
-    {
-      TimingEvents::SortEvent(this);
-      if (TimingEvents::s_active_events_head == this)
-        TimingEvents::UpdateCPUDowncount();
-    }
+    TimingEvents::UpdateActiveEvent(this);
   }
 }
 
@@ -480,14 +448,9 @@ void TimingEvent::Reset()
   if (!m_active)
     return;
 
-  m_downcount = m_interval;
-  m_time_since_last_run = 0;
-  if (TimingEvents::s_current_event != this)
-  {
-    TimingEvents::SortEvent(this);
-    if (TimingEvents::s_active_events_head == this)
-      TimingEvents::UpdateCPUDowncount();
-  }
+  m_next_run_time = TimingEvents::s_global_tick_counter + static_cast<u32>(m_interval);
+  m_last_run_time = TimingEvents::s_global_tick_counter;
+  TimingEvents::UpdateActiveEvent(this);
 }
 
 void TimingEvent::InvokeEarly(bool force /* = false */)
@@ -495,20 +458,18 @@ void TimingEvent::InvokeEarly(bool force /* = false */)
   if (!m_active)
     return;
 
-  const TickCount pending_ticks = CPU::GetPendingTicks();
-  const TickCount ticks_to_execute = m_time_since_last_run + pending_ticks;
+  const u32 current_time = TimingEvents::s_global_tick_counter + static_cast<u32>(CPU::GetPendingTicks());
+  const TickCount ticks_to_execute = static_cast<TickCount>(current_time - m_last_run_time);
   if ((!force && ticks_to_execute < m_period) || ticks_to_execute <= 0)
     return;
 
-  m_downcount = pending_ticks + m_interval;
-  m_time_since_last_run -= ticks_to_execute;
-  m_callback(m_callback_param, ticks_to_execute, 0);
-
   // Since we've changed the downcount, we need to re-sort the events.
   DebugAssert(TimingEvents::s_current_event != this);
-  TimingEvents::SortEvent(this);
-  if (TimingEvents::s_active_events_head == this)
-    TimingEvents::UpdateCPUDowncount();
+  m_next_run_time = current_time + static_cast<u32>(m_interval);
+  m_last_run_time = current_time;
+  TimingEvents::UpdateActiveEvent(this);
+
+  m_callback(m_callback_param, ticks_to_execute, 0);
 }
 
 void TimingEvent::Activate()
@@ -517,9 +478,9 @@ void TimingEvent::Activate()
     return;
 
   // leave the downcount intact
-  const TickCount pending_ticks = CPU::GetPendingTicks();
-  m_downcount += pending_ticks;
-  m_time_since_last_run -= pending_ticks;
+  const u32 current_time = TimingEvents::s_global_tick_counter + static_cast<u32>(CPU::GetPendingTicks());
+  m_next_run_time = current_time + static_cast<u32>(m_downcount);
+  m_last_run_time = current_time - static_cast<u32>(m_time_since_last_run);
 
   m_active = true;
   TimingEvents::AddActiveEvent(this);
@@ -530,9 +491,9 @@ void TimingEvent::Deactivate()
   if (!m_active)
     return;
 
-  const TickCount pending_ticks = CPU::GetPendingTicks();
-  m_downcount -= pending_ticks;
-  m_time_since_last_run += pending_ticks;
+  const u32 current_time = TimingEvents::s_global_tick_counter + static_cast<u32>(CPU::GetPendingTicks());
+  m_downcount = static_cast<TickCount>(m_next_run_time - current_time);
+  m_time_since_last_run = static_cast<TickCount>(current_time - m_last_run_time);
 
   m_active = false;
   TimingEvents::RemoveActiveEvent(this);
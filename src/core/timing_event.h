@@ -27,7 +27,9 @@ public:
   // Returns the number of ticks between each event.
   ALWAYS_INLINE TickCount GetPeriod() const { return m_period; }
   ALWAYS_INLINE TickCount GetInterval() const { return m_interval; }
-  ALWAYS_INLINE TickCount GetDowncount() const { return m_downcount; }
+
+  // Relative to the global tick counter, i.e. excludes pending time.
+  TickCount GetDowncount() const;
 
   // Includes pending time.
   TickCount GetTicksSinceLastExecution() const;
@@ -63,16 +65,22 @@ public:
   void SetInterval(TickCount interval) { m_interval = interval; }
   void SetPeriod(TickCount period) { m_period = period; }
 
-  TimingEvent* prev = nullptr;
-  TimingEvent* next = nullptr;
-
   TimingEventCallback m_callback;
   void* m_callback_param;
 
+  // While active, the event is tracked by absolute global tick counter values, so advancing time doesn't have to
+  // touch every event. While inactive, the downcount and time since last run are held relative instead.
+  u32 m_next_run_time = 0;
+  u32 m_last_run_time = 0;
   TickCount m_downcount;
   TickCount m_time_since_last_run;
+
   TickCount m_period;
   TickCount m_interval;
+
+  // Slot in the event table, and position in the active heap.
+  u32 m_id;
+  u32 m_heap_index = 0;
   bool m_active = false;
 
   std::string m_name;
@@ -99,6 +107,4 @@ void RunEvents();
 
 void UpdateCPUDowncount();
 
-TimingEvent** GetHeadEventPtr();
-
 } // namespace TimingEvents
\ No newline at end of file
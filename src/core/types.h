@@ -45,6 +45,7 @@ enum class CPUExecutionMode : u8
 {
   Interpreter,
   CachedInterpreter,
+  ThreadedInterpreter,
   Recompiler,
   Count
 };
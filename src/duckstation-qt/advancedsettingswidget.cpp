@@ -306,6 +306,10 @@ void AdvancedSettingsWidget::addTweakOptions()
                         "RecompilerMemoryExceptions", false);
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Recompiler Block Linking"), "CPU",
                         "RecompilerBlockLinking", true);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Persistent Recompiler Block Cache"), "CPU",
+                        "RecompilerBlockCache", false);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Recompiler Superblocks"), "CPU",
+                        "RecompilerSuperblocks", false);
   addChoiceTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Recompiler Fast Memory Access"), "CPU",
                        "FastmemMode", Settings::ParseCPUFastmemMode, Settings::GetCPUFastmemModeName,
                        Settings::GetCPUFastmemModeDisplayName, static_cast<u32>(CPUFastmemMode::Count),
@@ -336,6 +340,8 @@ void AdvancedSettingsWidget::addTweakOptions()
                          Settings::DEFAULT_GPU_FIFO_SIZE);
   addIntRangeTweakOption(m_dialog, m_ui.tweakOptionTable, tr("GPU Max Run-Ahead"), "Hacks", "GPUMaxRunAhead", 0, 1000,
                          Settings::DEFAULT_GPU_MAX_RUN_AHEAD);
+  addIntRangeTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Software Renderer Worker Threads"), "GPU",
+                         "SoftwareRendererThreads", 0, 15, 0);
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Use Debug Host GPU Device"), "GPU", "UseDebugDevice",
                         false);
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Disable Shader Cache"), "GPU", "DisableShaderCache",
@@ -349,6 +355,12 @@ void AdvancedSettingsWidget::addTweakOptions()
 
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Allow Booting Without SBI File"), "CDROM",
                         "AllowBootingWithoutSBIFile", false);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Preload Images by Mapping Files"), "CDROM",
+                        "PreloadMappedFiles", false);
+  addIntRangeTweakOption(m_dialog, m_ui.tweakOptionTable, tr("CHD Hunk Cache Size"), "CDROM", "CHDCacheHunks", 1, 256,
+                         Settings::DEFAULT_CDROM_CHD_CACHE_HUNKS);
+  addIntRangeTweakOption(m_dialog, m_ui.tweakOptionTable, tr("CHD Read-Ahead Hunks"), "CDROM", "CHDReadaheadHunks", 0,
+                         32, Settings::DEFAULT_CDROM_CHD_READAHEAD_HUNKS);
 
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Create Save State Backups"), "General",
                         "CreateSaveStateBackups", false);
@@ -377,6 +389,8 @@ void AdvancedSettingsWidget::onResetToDefaultClicked()
                              Settings::DEFAULT_GPU_PGXP_DEPTH_THRESHOLD); // PGXP depth clear threshold
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);             // Recompiler memory exceptions
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, true);              // Recompiler block linking
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);             // Recompiler block cache
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);             // Recompiler superblocks
     setChoiceTweakOption(m_ui.tweakOptionTable, i++, Settings::DEFAULT_CPU_FASTMEM_MODE); // Recompiler fastmem mode
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                             // Use Old MDEC Routines
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false); // VRAM write texture replacement
@@ -395,11 +409,17 @@ void AdvancedSettingsWidget::onResetToDefaultClicked()
                            static_cast<int>(Settings::DEFAULT_GPU_FIFO_SIZE)); // GPU FIFO size
     setIntRangeTweakOption(m_ui.tweakOptionTable, i++,
                            static_cast<int>(Settings::DEFAULT_GPU_MAX_RUN_AHEAD)); // GPU max run-ahead
+    setIntRangeTweakOption(m_ui.tweakOptionTable, i++, 0);                         // Software renderer threads
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Use debug host GPU device
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Disable Shader Cache
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Stretch Display Vertically
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, true);                       // Increase Timer Resolution
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Allow booting without SBI file
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Preload mapped files
+    setIntRangeTweakOption(m_ui.tweakOptionTable, i++,
+                           static_cast<int>(Settings::DEFAULT_CDROM_CHD_CACHE_HUNKS)); // CHD hunk cache size
+    setIntRangeTweakOption(m_ui.tweakOptionTable, i++,
+                           static_cast<int>(Settings::DEFAULT_CDROM_CHD_READAHEAD_HUNKS)); // CHD read-ahead hunks
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Create save state backups
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Enable PCDRV
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Enable PCDRV Writes
@@ -428,6 +448,8 @@ void AdvancedSettingsWidget::onResetToDefaultClicked()
   sif->DeleteValue("GPU", "PGXPDepthClearThreshold");
   sif->DeleteValue("CPU", "RecompilerMemoryExceptions");
   sif->DeleteValue("CPU", "RecompilerBlockLinking");
+  sif->DeleteValue("CPU", "RecompilerBlockCache");
+  sif->DeleteValue("CPU", "RecompilerSuperblocks");
   sif->DeleteValue("CPU", "FastmemMode");
   sif->DeleteValue("TextureReplacements", "EnableVRAMWriteReplacements");
   sif->DeleteValue("TextureReplacements", "PreloadTextures");
@@ -440,10 +462,14 @@ void AdvancedSettingsWidget::onResetToDefaultClicked()
   sif->DeleteValue("Hacks", "DMAHaltTicks");
   sif->DeleteValue("Hacks", "GPUFIFOSize");
   sif->DeleteValue("Hacks", "GPUMaxRunAhead");
+  sif->DeleteValue("GPU", "SoftwareRendererThreads");
   sif->DeleteValue("GPU", "UseDebugDevice");
   sif->DeleteValue("Display", "StretchVertically");
   sif->DeleteValue("Main", "IncreaseTimerResolution");
   sif->DeleteValue("CDROM", "AllowBootingWithoutSBIFile");
+  sif->DeleteValue("CDROM", "PreloadMappedFiles");
+  sif->DeleteValue("CDROM", "CHDCacheHunks");
+  sif->DeleteValue("CDROM", "CHDReadaheadHunks");
   sif->DeleteValue("General", "CreateSaveStateBackups");
   sif->DeleteValue("PCDrv", "Enabled");
   sif->DeleteValue("PCDrv", "EnableWrites");
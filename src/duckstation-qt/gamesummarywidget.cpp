@@ -8,7 +8,9 @@
 
 #include "core/game_database.h"
 #include "core/game_list.h"
+#include "core/settings.h"
 
+#include "common/path.h"
 #include "common/string_util.h"
 
 #include "fmt/format.h"
@@ -227,31 +229,25 @@ void GameSummaryWidget::onComputeHashClicked()
 #endif
 
   QtModalProgressCallback progress_callback(this);
-  progress_callback.SetProgressRange(image->GetTrackCount());
 
+  // Calculate hashes, unless the image hasn't changed since they were last calculated.
+  const std::string cache_filename = Path::Combine(EmuFolders::Cache, "trackhashes.cache");
   std::vector<CDImageHasher::Hash> track_hashes;
-  track_hashes.reserve(image->GetTrackCount());
-
-  // Calculate hashes
-  bool calculate_hash_success = true;
-  for (u8 track = 1; track <= image->GetTrackCount(); track++)
+  bool calculate_hash_success = CDImageHasher::GetCachedTrackHashes(cache_filename, image.get(), &track_hashes);
+  if (!calculate_hash_success)
   {
-    progress_callback.SetProgressValue(track - 1);
-    progress_callback.PushState();
+    calculate_hash_success = CDImageHasher::GetTrackHashes(image.get(), &track_hashes, &progress_callback);
+    if (calculate_hash_success)
+      CDImageHasher::AddCachedTrackHashes(cache_filename, image.get(), track_hashes);
+  }
 
-    CDImageHasher::Hash hash;
-    if (!CDImageHasher::GetTrackHash(image.get(), track, &hash, &progress_callback))
+  if (calculate_hash_success)
+  {
+    for (u32 i = 0; i < static_cast<u32>(track_hashes.size()); i++)
     {
-      progress_callback.PopState();
-      calculate_hash_success = false;
-      break;
+      QTableWidgetItem* item = m_ui.tracks->item(i, 4);
+      item->setText(QString::fromStdString(CDImageHasher::HashToString(track_hashes[i])));
     }
-    track_hashes.emplace_back(hash);
-
-    QTableWidgetItem* item = m_ui.tracks->item(track - 1, 4);
-    item->setText(QString::fromStdString(CDImageHasher::HashToString(hash)));
-
-    progress_callback.PopState();
   }
 
   // Verify hashes against gamedb
@@ -262,7 +258,8 @@ void GameSummaryWidget::onComputeHashClicked()
     m_redump_search_keyword = CDImageHasher::HashToString(track_hashes.front());
 
     progress_callback.SetStatusText("Verifying hashes...");
-    progress_callback.SetProgressValue(image->GetTrackCount());
+    progress_callback.SetProgressRange(1);
+    progress_callback.SetProgressValue(1);
 
     // Verification strategy used:
     // 1. First, find all matches for the data track
@@ -2,10 +2,18 @@
 // SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
 
 #include "core/achievements.h"
+#include "core/bus.h"
+#include "core/cpu_code_cache.h"
+#include "core/cpu_core.h"
 #include "core/game_list.h"
 #include "core/gpu.h"
+#include "core/gte_kernels.h"
 #include "core/host.h"
+#include "core/mdec_kernels.h"
+#include "core/spu.h"
+#include "core/spu_reverb.h"
 #include "core/system.h"
+#include "core/timing_event.h"
 
 #include "scmversion/scmversion.h"
 
@@ -21,9 +29,30 @@
 #include "common/memory_settings_interface.h"
 #include "common/path.h"
 #include "common/string_util.h"
+#include "common/timer.h"
 
+#include "rapidjson/document.h"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+
+#include <array>
+#include <atomic>
 #include <csignal>
 #include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include "common/windows_headers.h"
+#else
+#include <csignal>
+#include <spawn.h>
+#include <sys/wait.h>
+extern char** environ;
+#endif
 
 Log_SetChannel(RegTestHost);
 
@@ -36,6 +65,38 @@ static void InitializeEarlyConsole();
 static void HookSignals();
 static bool SetFolders();
 static std::string GetFrameDumpFilename(u32 frame);
+static void RecordFrameHash();
+static bool WriteReport(const std::string& path, const std::string& boot_path, bool booted, double boot_time_ms,
+                        double run_time_ms);
+
+namespace {
+struct BatchJob
+{
+  std::string path;
+  u32 frames;
+  s32 exit_code;
+  bool crashed;
+  bool timed_out;
+  double elapsed_ms;
+  std::string report;
+};
+} // namespace
+
+static bool LoadBatchManifest(const char* path, std::vector<BatchJob>* jobs);
+static int RunWorkerProcess(const std::vector<std::string>& args, u32 timeout_seconds, bool* crashed,
+                            bool* timed_out);
+static void RunBatchJob(BatchJob* job, u32 index);
+static int RunBatch();
+template<typename Function>
+static double RunForBenchmarkTime(const Function& function);
+template<typename Output, typename RunPass>
+static int CompareKernels(const char* name, const char* unit, u32 num_units, u32 num_passes, bool has_vector,
+                          const RunPass& run_pass);
+static int RunEventBenchmark();
+static int RunReverbBenchmark();
+static int RunMDECBenchmark();
+static int RunGTEBenchmark();
+static int RunCodeCacheBenchmark();
 } // namespace RegTestHost
 
 static std::unique_ptr<MemorySettingsInterface> s_base_settings_interface;
@@ -44,6 +105,24 @@ static u32 s_frames_to_run = 60 * 60;
 static u32 s_frame_dump_interval = 0;
 static std::string s_dump_base_directory;
 static std::string s_dump_game_directory;
+static std::string s_audio_dump_path;
+
+static u32 s_frame_hash_interval = 0;
+static std::vector<std::pair<u32, u64>> s_frame_hashes;
+static u32 s_frames_executed = 0;
+static std::string s_report_path;
+static std::string s_game_serial;
+static std::string s_game_title;
+
+static std::string s_batch_manifest_path;
+static u32 s_batch_num_workers = 0;
+static u32 s_batch_timeout_seconds = 10 * 60;
+static std::string s_batch_log_level;
+static std::string s_batch_renderer;
+
+static int (*s_benchmark)() = nullptr;
+static std::string s_reverb_capture_path;
+static std::string s_reverb_benchmark_path;
 
 bool RegTestHost::SetFolders()
 {
@@ -235,6 +314,8 @@ void Host::OnGameChanged(const std::string& disc_path, const std::string& game_s
   Log_InfoPrintf("Disc Path: %s", disc_path.c_str());
   Log_InfoPrintf("Game Serial: %s", game_serial.c_str());
   Log_InfoPrintf("Game Name: %s", game_name.c_str());
+  s_game_serial = game_serial;
+  s_game_title = game_name;
 
   if (!s_dump_base_directory.empty())
   {
@@ -252,9 +333,16 @@ void Host::OnGameChanged(const std::string& disc_path, const std::string& game_s
 
 void Host::PumpMessagesOnCPUThread()
 {
+  s_frames_executed++;
   s_frames_to_run--;
   if (s_frames_to_run == 0)
+  {
+    // always hash the last frame, so there's something to compare
+    if (!s_report_path.empty() && (s_frame_hashes.empty() || s_frame_hashes.back().first != System::GetFrameNumber()))
+      RegTestHost::RecordFrameHash();
+
     System::ShutdownSystem(false);
+  }
 }
 
 void Host::RunOnCPUThread(std::function<void()> function, bool block /* = false */)
@@ -308,6 +396,9 @@ void Host::BeginPresentFrame()
     std::string dump_filename(RegTestHost::GetFrameDumpFilename(frame));
     g_gpu->WriteDisplayTextureToFile(std::move(dump_filename));
   }
+
+  if (s_frame_hash_interval > 0 && (frame % s_frame_hash_interval) == 0)
+    RegTestHost::RecordFrameHash();
 }
 
 void Host::OpenURL(const std::string_view& url)
@@ -426,9 +517,25 @@ void RegTestHost::PrintCommandLineHelp(const char* progname)
   std::fprintf(stderr, "  -version: Displays version information and exits.\n");
   std::fprintf(stderr, "  -dumpdir: Set frame dump base directory (will be dumped to basedir/gametitle).\n");
   std::fprintf(stderr, "  -dumpinterval: Dumps every N frames.\n");
+  std::fprintf(stderr, "  -dumpaudio <file>: Writes the SPU output to a WAV file, for comparing between builds.\n");
   std::fprintf(stderr, "  -frames: Sets the number of frames to execute.\n");
   std::fprintf(stderr, "  -log <level>: Sets the log level. Defaults to verbose.\n");
   std::fprintf(stderr, "  -renderer <renderer>: Sets the graphics renderer. Default to software.\n");
+  std::fprintf(stderr, "  -report <file>: Writes a JSON report of the run(s) to the specified file.\n");
+  std::fprintf(stderr, "  -hashinterval <n>: Records a VRAM hash in the report every N frames.\n");
+  std::fprintf(stderr, "  -batch <manifest>: Runs every image in the manifest in separate worker processes.\n"
+                       "    Each line is a path, optionally followed by a tab and a frame count.\n");
+  std::fprintf(stderr, "  -jobs <n>: Number of worker processes in batch mode. Defaults to the CPU count.\n");
+  std::fprintf(stderr, "  -timeout <seconds>: Kills batch mode workers which run for longer than this. Defaults to\n"
+                       "    600 seconds, 0 waits forever.\n");
+  std::fprintf(stderr, "  -eventbench: Measures timing event scheduler throughput and exits.\n");
+  std::fprintf(stderr, "  -scalarreverb: Uses the scalar reference reverb implementation.\n");
+  std::fprintf(stderr, "  -reverbcapture <file>: Records the reverb input and register writes of the run.\n");
+  std::fprintf(stderr, "  -reverbbench <file>: Replays a reverb capture through each implementation and exits.\n");
+  std::fprintf(stderr, "  -mdecbench: Measures MDEC macroblock reconstruction throughput and exits.\n");
+  std::fprintf(stderr, "  -gtebench: Measures GTE matrix/vector product throughput and exits.\n");
+  std::fprintf(stderr, "  -codecachebench: Measures how fast the CPU code cache compiles and invalidates blocks,\n"
+                       "    and exits.\n");
   std::fprintf(stderr, "  --: Signals that no more arguments will follow and the remaining\n"
                        "    parameters make up the filename. Use when the filename contains\n"
                        "    spaces or starts with a dash.\n");
@@ -485,6 +592,11 @@ bool RegTestHost::ParseCommandLineParameters(int argc, char* argv[], std::option
 
         continue;
       }
+      else if (CHECK_ARG_PARAM("-dumpaudio"))
+      {
+        s_audio_dump_path = argv[++i];
+        continue;
+      }
       else if (CHECK_ARG_PARAM("-frames"))
       {
         s_frames_to_run = StringUtil::FromChars<u32>(argv[++i]).value_or(0);
@@ -506,6 +618,7 @@ bool RegTestHost::ParseCommandLineParameters(int argc, char* argv[], std::option
         }
 
         Log::SetConsoleOutputParams(true, level.value());
+        s_batch_log_level = argv[i];
         s_base_settings_interface->SetStringValue("Logging", "LogLevel", Settings::GetLogLevelName(level.value()));
         continue;
       }
@@ -519,6 +632,87 @@ bool RegTestHost::ParseCommandLineParameters(int argc, char* argv[], std::option
         }
 
         s_base_settings_interface->SetStringValue("GPU", "Renderer", Settings::GetRendererName(renderer.value()));
+        s_batch_renderer = argv[i];
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-report"))
+      {
+        s_report_path = argv[++i];
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-hashinterval"))
+      {
+        s_frame_hash_interval = StringUtil::FromChars<u32>(argv[++i]).value_or(0);
+        if (s_frame_hash_interval == 0)
+        {
+          Log_ErrorPrintf("Invalid hash interval specified: %s", argv[i]);
+          return false;
+        }
+
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-batch"))
+      {
+        s_batch_manifest_path = argv[++i];
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-jobs"))
+      {
+        s_batch_num_workers = StringUtil::FromChars<u32>(argv[++i]).value_or(0);
+        if (s_batch_num_workers == 0)
+        {
+          Log_ErrorPrintf("Invalid job count specified: %s", argv[i]);
+          return false;
+        }
+
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-timeout"))
+      {
+        const std::optional<u32> timeout = StringUtil::FromChars<u32>(argv[++i]);
+        if (!timeout.has_value())
+        {
+          Log_ErrorPrintf("Invalid timeout specified: %s", argv[i]);
+          return false;
+        }
+
+        s_batch_timeout_seconds = timeout.value();
+        continue;
+      }
+      else if (CHECK_ARG("-eventbench"))
+      {
+        s_benchmark = &RegTestHost::RunEventBenchmark;
+        continue;
+      }
+      else if (CHECK_ARG("-scalarreverb"))
+      {
+        SPU::SetReverbVectorized(false);
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-reverbcapture"))
+      {
+        s_reverb_capture_path = argv[++i];
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-reverbbench"))
+      {
+        s_reverb_benchmark_path = argv[++i];
+        s_benchmark = &RegTestHost::RunReverbBenchmark;
+        continue;
+      }
+      else if (CHECK_ARG("-mdecbench"))
+      {
+        s_benchmark = &RegTestHost::RunMDECBenchmark;
+        continue;
+      }
+      else if (CHECK_ARG("-gtebench"))
+      {
+        s_benchmark = &RegTestHost::RunGTEBenchmark;
+        continue;
+      }
+      else if (CHECK_ARG("-codecachebench"))
+      {
+        s_benchmark = &RegTestHost::RunCodeCacheBenchmark;
         continue;
       }
       else if (CHECK_ARG("--"))
@@ -549,6 +743,753 @@ std::string RegTestHost::GetFrameDumpFilename(u32 frame)
   return Path::Combine(s_dump_game_directory, fmt::format("frame_{:05d}.png", frame));
 }
 
+void RegTestHost::RecordFrameHash()
+{
+  s_frame_hashes.emplace_back(System::GetFrameNumber(), g_gpu->GetVRAMHash());
+}
+
+bool RegTestHost::WriteReport(const std::string& path, const std::string& boot_path, bool booted, double boot_time_ms,
+                              double run_time_ms)
+{
+  rapidjson::StringBuffer buffer;
+  rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+  writer.StartObject();
+  writer.Key("path");
+  writer.String(boot_path.c_str(), static_cast<rapidjson::SizeType>(boot_path.length()));
+  writer.Key("serial");
+  writer.String(s_game_serial.c_str(), static_cast<rapidjson::SizeType>(s_game_serial.length()));
+  writer.Key("title");
+  writer.String(s_game_title.c_str(), static_cast<rapidjson::SizeType>(s_game_title.length()));
+  writer.Key("booted");
+  writer.Bool(booted);
+  writer.Key("frames");
+  writer.Uint(s_frames_executed);
+  writer.Key("boot_time_ms");
+  writer.Double(boot_time_ms);
+  writer.Key("run_time_ms");
+  writer.Double(run_time_ms);
+  writer.Key("fps");
+  writer.Double((run_time_ms > 0.0) ? (static_cast<double>(s_frames_executed) / (run_time_ms / 1000.0)) : 0.0);
+  writer.Key("frame_hashes");
+  writer.StartArray();
+  for (const auto& [frame, hash] : s_frame_hashes)
+  {
+    const std::string hash_str(fmt::format("{:016x}", hash));
+    writer.StartObject();
+    writer.Key("frame");
+    writer.Uint(frame);
+    writer.Key("hash");
+    writer.String(hash_str.c_str(), static_cast<rapidjson::SizeType>(hash_str.length()));
+    writer.EndObject();
+  }
+  writer.EndArray();
+  writer.EndObject();
+
+  if (!FileSystem::WriteStringToFile(path.c_str(), std::string_view(buffer.GetString(), buffer.GetSize())))
+  {
+    Log_ErrorPrintf("Failed to write report to '%s'", path.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+bool RegTestHost::LoadBatchManifest(const char* path, std::vector<BatchJob>* jobs)
+{
+  std::optional<std::string> manifest(FileSystem::ReadFileToString(path));
+  if (!manifest.has_value())
+  {
+    Log_ErrorPrintf("Failed to read batch manifest '%s'", path);
+    return false;
+  }
+
+  for (const std::string_view& line : StringUtil::SplitString(manifest.value(), '\n'))
+  {
+    const std::string_view stripped(StringUtil::StripWhitespace(line));
+    if (stripped.empty() || stripped[0] == '#')
+      continue;
+
+    BatchJob& job = jobs->emplace_back();
+    job.frames = s_frames_to_run;
+    job.exit_code = 0;
+    job.crashed = false;
+    job.timed_out = false;
+    job.elapsed_ms = 0.0;
+
+    const std::string_view::size_type tab_pos = stripped.rfind('\t');
+    if (tab_pos != std::string_view::npos)
+    {
+      job.frames = StringUtil::FromChars<u32>(StringUtil::StripWhitespace(stripped.substr(tab_pos + 1))).value_or(0);
+      if (job.frames == 0)
+      {
+        Log_ErrorPrintf("Invalid frame count in manifest line: %.*s", static_cast<int>(stripped.length()),
+                        stripped.data());
+        return false;
+      }
+
+      job.path = StringUtil::StripWhitespace(stripped.substr(0, tab_pos));
+    }
+    else
+    {
+      job.path = stripped;
+    }
+  }
+
+  return true;
+}
+
+int RegTestHost::RunWorkerProcess(const std::vector<std::string>& args, u32 timeout_seconds, bool* crashed,
+                                  bool* timed_out)
+{
+  *crashed = false;
+  *timed_out = false;
+
+#ifdef _WIN32
+  std::wstring command_line;
+  for (const std::string& arg : args)
+  {
+    // CommandLineToArgvW() rules: backslashes are only special before a quote.
+    if (!command_line.empty())
+      command_line += L' ';
+    command_line += L'"';
+    const std::wstring warg(StringUtil::UTF8StringToWideString(arg));
+    u32 num_backslashes = 0;
+    for (const wchar_t ch : warg)
+    {
+      if (ch == L'\\')
+      {
+        num_backslashes++;
+        continue;
+      }
+
+      command_line.append((ch == L'"') ? (num_backslashes * 2 + 1) : num_backslashes, L'\\');
+      command_line += ch;
+      num_backslashes = 0;
+    }
+    command_line.append(num_backslashes * 2, L'\\');
+    command_line += L'"';
+  }
+
+  STARTUPINFOW si = {};
+  si.cb = sizeof(si);
+  PROCESS_INFORMATION pi = {};
+  if (!CreateProcessW(nullptr, command_line.data(), nullptr, nullptr, FALSE, 0, nullptr, nullptr, &si, &pi))
+  {
+    Log_ErrorPrintf("CreateProcessW() failed: %u", GetLastError());
+    return -1;
+  }
+
+  if (WaitForSingleObject(pi.hProcess, (timeout_seconds > 0) ? (timeout_seconds * 1000u) : INFINITE) == WAIT_TIMEOUT)
+  {
+    TerminateProcess(pi.hProcess, static_cast<UINT>(-1));
+    WaitForSingleObject(pi.hProcess, INFINITE);
+    CloseHandle(pi.hThread);
+    CloseHandle(pi.hProcess);
+    *timed_out = true;
+    return -1;
+  }
+
+  DWORD exit_code = static_cast<DWORD>(-1);
+  GetExitCodeProcess(pi.hProcess, &exit_code);
+  CloseHandle(pi.hThread);
+  CloseHandle(pi.hProcess);
+
+  // unhandled exceptions terminate the process with the NTSTATUS error code
+  *crashed = ((exit_code & 0xC0000000u) == 0xC0000000u);
+  return static_cast<int>(exit_code);
+#else
+  std::vector<char*> argv;
+  argv.reserve(args.size() + 1);
+  for (const std::string& arg : args)
+    argv.push_back(const_cast<char*>(arg.c_str()));
+  argv.push_back(nullptr);
+
+  pid_t pid;
+  const int res = posix_spawn(&pid, argv[0], nullptr, nullptr, argv.data(), environ);
+  if (res != 0)
+  {
+    Log_ErrorPrintf("posix_spawn() failed: %d", res);
+    return -1;
+  }
+
+  // waitpid() can't time out, so poll until the deadline, then kill the worker.
+  static constexpr u64 POLL_INTERVAL_NS = 50000000;
+  const Common::Timer::Value deadline =
+    Common::Timer::GetCurrentValue() + Common::Timer::ConvertSecondsToValue(static_cast<double>(timeout_seconds));
+  int status;
+  for (;;)
+  {
+    const pid_t wait_res = waitpid(pid, &status, (timeout_seconds > 0) ? WNOHANG : 0);
+    if (wait_res == pid)
+      break;
+
+    if (wait_res < 0)
+    {
+      if (errno == EINTR)
+        continue;
+
+      return -1;
+    }
+
+    if (Common::Timer::GetCurrentValue() >= deadline)
+    {
+      kill(pid, SIGKILL);
+      while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+        ;
+
+      *timed_out = true;
+      return -1;
+    }
+
+    Common::Timer::NanoSleep(POLL_INTERVAL_NS);
+  }
+
+  if (WIFSIGNALED(status))
+  {
+    *crashed = true;
+    return -WTERMSIG(status);
+  }
+
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#endif
+}
+
+void RegTestHost::RunBatchJob(BatchJob* job, u32 index)
+{
+  const std::string& report_base = s_report_path.empty() ? s_batch_manifest_path : s_report_path;
+  const std::string job_report_path(fmt::format("{}.job{}.tmp", report_base, index));
+
+  std::vector<std::string> args;
+  args.push_back(FileSystem::GetProgramPath());
+  args.push_back("-log");
+  args.push_back(s_batch_log_level.empty() ? std::string("error") : s_batch_log_level);
+  args.push_back("-frames");
+  args.push_back(std::to_string(job->frames));
+  if (!s_batch_renderer.empty())
+  {
+    args.push_back("-renderer");
+    args.push_back(s_batch_renderer);
+  }
+  if (!s_dump_base_directory.empty())
+  {
+    args.push_back("-dumpdir");
+    args.push_back(s_dump_base_directory);
+  }
+  if (s_frame_dump_interval > 0)
+  {
+    args.push_back("-dumpinterval");
+    args.push_back(std::to_string(s_frame_dump_interval));
+  }
+  if (s_frame_hash_interval > 0)
+  {
+    args.push_back("-hashinterval");
+    args.push_back(std::to_string(s_frame_hash_interval));
+  }
+  args.push_back("-report");
+  args.push_back(job_report_path);
+  args.push_back("--");
+  args.push_back(job->path);
+
+  Log_InfoPrintf("Starting '%s' for %u frames...", job->path.c_str(), job->frames);
+
+  FileSystem::DeleteFile(job_report_path.c_str());
+
+  Common::Timer timer;
+  job->exit_code = RunWorkerProcess(args, s_batch_timeout_seconds, &job->crashed, &job->timed_out);
+  job->elapsed_ms = timer.GetTimeMilliseconds();
+
+  std::optional<std::string> report(FileSystem::ReadFileToString(job_report_path.c_str()));
+  if (report.has_value())
+  {
+    job->report = std::move(report.value());
+    FileSystem::DeleteFile(job_report_path.c_str());
+  }
+
+  if (job->timed_out)
+    Log_ErrorPrintf("'%s' timed out after %.2f ms", job->path.c_str(), job->elapsed_ms);
+  else if (job->crashed)
+    Log_ErrorPrintf("'%s' crashed with code %d after %.2f ms", job->path.c_str(), job->exit_code, job->elapsed_ms);
+  else if (job->exit_code != 0)
+    Log_ErrorPrintf("'%s' failed with code %d after %.2f ms", job->path.c_str(), job->exit_code, job->elapsed_ms);
+  else
+    Log_InfoPrintf("'%s' completed in %.2f ms", job->path.c_str(), job->elapsed_ms);
+}
+
+int RegTestHost::RunBatch()
+{
+  std::vector<BatchJob> jobs;
+  if (!LoadBatchManifest(s_batch_manifest_path.c_str(), &jobs))
+    return EXIT_FAILURE;
+
+  const u32 num_workers = std::min<u32>(
+    static_cast<u32>(jobs.size()),
+    (s_batch_num_workers > 0) ? s_batch_num_workers : std::max(std::thread::hardware_concurrency(), 1u));
+  Log_InfoPrintf("Running %zu images with %u workers...", jobs.size(), num_workers);
+
+  // each worker thread babysits one emulator process at a time
+  Common::Timer timer;
+  std::atomic<u32> next_job{0};
+  std::vector<std::thread> workers;
+  workers.reserve(num_workers);
+  for (u32 i = 0; i < num_workers; i++)
+  {
+    workers.emplace_back([&jobs, &next_job]() {
+      u32 index;
+      while ((index = next_job.fetch_add(1, std::memory_order_relaxed)) < static_cast<u32>(jobs.size()))
+        RunBatchJob(&jobs[index], index);
+    });
+  }
+  for (std::thread& worker : workers)
+    worker.join();
+
+  const double elapsed_ms = timer.GetTimeMilliseconds();
+
+  rapidjson::Document report;
+  report.SetObject();
+  rapidjson::Document::AllocatorType& allocator = report.GetAllocator();
+  report.AddMember("version", rapidjson::StringRef(g_scm_tag_str), allocator);
+  report.AddMember("jobs", num_workers, allocator);
+  report.AddMember("elapsed_ms", elapsed_ms, allocator);
+
+  u32 num_failed = 0;
+  u32 num_crashed = 0;
+  u32 num_timed_out = 0;
+  u64 total_frames = 0;
+  rapidjson::Value games(rapidjson::kArrayType);
+  for (const BatchJob& job : jobs)
+  {
+    rapidjson::Value game(rapidjson::kObjectType);
+    rapidjson::Document job_report;
+    if (!job.report.empty() && !job_report.Parse(job.report.c_str(), job.report.length()).HasParseError() &&
+        job_report.IsObject())
+    {
+      game.CopyFrom(job_report, allocator);
+    }
+    else
+    {
+      // worker died before it could write a report
+      game.AddMember("path", rapidjson::Value(job.path.c_str(), allocator), allocator);
+      game.AddMember("booted", false, allocator);
+    }
+
+    if (game.HasMember("frames") && game["frames"].IsUint())
+      total_frames += game["frames"].GetUint();
+
+    game.AddMember("requested_frames", job.frames, allocator);
+    game.AddMember("exit_code", job.exit_code, allocator);
+    game.AddMember("crashed", job.crashed, allocator);
+    game.AddMember("timed_out", job.timed_out, allocator);
+    game.AddMember("wall_time_ms", job.elapsed_ms, allocator);
+    games.PushBack(game, allocator);
+
+    num_failed += BoolToUInt32(job.exit_code != 0);
+    num_crashed += BoolToUInt32(job.crashed);
+    num_timed_out += BoolToUInt32(job.timed_out);
+  }
+
+  report.AddMember("total_frames", total_frames, allocator);
+  report.AddMember("games", games, allocator);
+
+  rapidjson::StringBuffer buffer;
+  rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+  report.Accept(writer);
+  if (s_report_path.empty())
+  {
+    std::fwrite(buffer.GetString(), buffer.GetSize(), 1, stdout);
+    std::fputc('\n', stdout);
+  }
+  else if (!FileSystem::WriteStringToFile(s_report_path.c_str(),
+                                          std::string_view(buffer.GetString(), buffer.GetSize())))
+  {
+    Log_ErrorPrintf("Failed to write report to '%s'", s_report_path.c_str());
+    return EXIT_FAILURE;
+  }
+
+  Log_InfoPrintf("%zu images, %u failed, %u crashed, %u timed out, %.2f seconds, %.2f frames/sec overall",
+                 jobs.size(), num_failed, num_crashed, num_timed_out, elapsed_ms / 1000.0,
+                 static_cast<double>(total_frames) / (elapsed_ms / 1000.0));
+  return (num_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+template<typename Function>
+double RegTestHost::RunForBenchmarkTime(const Function& function)
+{
+  static constexpr double BENCHMARK_TIME_MS = 2000.0;
+
+  Common::Timer timer;
+  double elapsed_ms;
+  do
+  {
+    function();
+    elapsed_ms = timer.GetTimeMilliseconds();
+  } while (elapsed_ms < BENCHMARK_TIME_MS);
+
+  return elapsed_ms;
+}
+
+template<typename Output, typename RunPass>
+int RegTestHost::CompareKernels(const char* name, const char* unit, u32 num_units, u32 num_passes, bool has_vector,
+                                const RunPass& run_pass)
+{
+  const auto run = [&run_pass, num_passes](bool vectorized, Output* output) {
+    double best_ms = std::numeric_limits<double>::max();
+    for (u32 pass = 0; pass < num_passes; pass++)
+    {
+      Common::Timer timer;
+      run_pass(vectorized, output);
+      best_ms = std::min(best_ms, timer.GetTimeMilliseconds());
+    }
+    return best_ms;
+  };
+
+  Output scalar;
+  const double scalar_ms = run(false, &scalar);
+  Log_InfoPrintf("Scalar: %.2f ms, %.2f ns/%s", scalar_ms, (scalar_ms * 1000000.0) / std::max<u32>(num_units, 1),
+                 unit);
+
+  if (!has_vector)
+  {
+    Log_WarningPrintf("No vector %s implementation on this architecture.", name);
+    return EXIT_SUCCESS;
+  }
+
+  Output vector;
+  const double vector_ms = run(true, &vector);
+  Log_InfoPrintf("Vector: %.2f ms, %.2f ns/%s, %.2fx", vector_ms, (vector_ms * 1000000.0) / std::max<u32>(num_units, 1),
+                 unit, scalar_ms / vector_ms);
+
+  if (!(vector == scalar))
+  {
+    Log_ErrorPrintf("Vector %s output does not match the scalar implementation.", name);
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int RegTestHost::RunEventBenchmark()
+{
+  // A mix of intervals resembling a running system, from per-sample SPU events to per-frame events.
+  static constexpr std::array<TickCount, 16> intervals = {
+    {3, 5, 7, 11, 17, 33, 64, 100, 128, 768, 999, 2048, 3413, 4000, 12345, 564480}};
+  static constexpr u32 ITERATIONS_PER_CHECK = 100000;
+
+  TimingEvents::Initialize();
+
+  u64 events_serviced = 0;
+  std::vector<std::unique_ptr<TimingEvent>> events;
+  for (u32 i = 0; i < static_cast<u32>(intervals.size()); i++)
+  {
+    events.push_back(TimingEvents::CreateTimingEvent(
+      fmt::format("Benchmark Event {}", i), intervals[i], intervals[i],
+      [](void* param, TickCount ticks, TickCount ticks_late) { (*static_cast<u64*>(param))++; }, &events_serviced,
+      true));
+  }
+
+  // Pretend the CPU always runs exactly up to the next event.
+  u64 run_count = 0;
+  const double elapsed_ms = RunForBenchmarkTime([&run_count]() {
+    for (u32 i = 0; i < ITERATIONS_PER_CHECK; i++)
+    {
+      CPU::AddPendingTicks(CPU::g_state.downcount - CPU::GetPendingTicks());
+      TimingEvents::RunEvents();
+    }
+
+    run_count += ITERATIONS_PER_CHECK;
+  });
+
+  for (std::unique_ptr<TimingEvent>& event : events)
+    event->Deactivate();
+  events.clear();
+  TimingEvents::Shutdown();
+
+  Log_InfoPrintf("%zu events, %" PRIu64 " RunEvents() calls, %" PRIu64 " events serviced in %.2f ms", intervals.size(),
+                 run_count, events_serviced, elapsed_ms);
+  Log_InfoPrintf("%.2f million events/sec, %.2f ns/event", static_cast<double>(events_serviced) / elapsed_ms / 1000.0,
+                 (elapsed_ms * 1000000.0) / static_cast<double>(events_serviced));
+  return EXIT_SUCCESS;
+}
+
+int RegTestHost::RunReverbBenchmark()
+{
+  static constexpr u32 NUM_PASSES = 5;
+
+  std::optional<std::vector<u8>> data = FileSystem::ReadBinaryFile(s_reverb_benchmark_path.c_str());
+  SPU_Reverb::CaptureHeader header;
+  if (!data.has_value() || data->size() < sizeof(header))
+  {
+    Log_ErrorPrintf("Failed to read reverb capture '%s'", s_reverb_benchmark_path.c_str());
+    return EXIT_FAILURE;
+  }
+
+  std::memcpy(&header, data->data(), sizeof(header));
+  const size_t expected_size = sizeof(header) + sizeof(SPU_Reverb::State) + SPU_Reverb::RAM_SIZE +
+                               (sizeof(SPU_Reverb::CaptureFrame) * header.num_frames) +
+                               (sizeof(SPU_Reverb::CaptureWrite) * header.num_writes);
+  if (header.magic != SPU_Reverb::CAPTURE_MAGIC || header.version != SPU_Reverb::CAPTURE_VERSION ||
+      data->size() != expected_size)
+  {
+    Log_ErrorPrintf("Reverb capture '%s' is invalid or from a different version", s_reverb_benchmark_path.c_str());
+    return EXIT_FAILURE;
+  }
+
+  const u8* ptr = data->data() + sizeof(header);
+  SPU_Reverb::State initial_state;
+  std::memcpy(&initial_state, ptr, sizeof(initial_state));
+  ptr += sizeof(initial_state);
+  const u8* initial_ram = ptr;
+  ptr += SPU_Reverb::RAM_SIZE;
+  std::vector<SPU_Reverb::CaptureFrame> frames(header.num_frames);
+  std::memcpy(frames.data(), ptr, sizeof(SPU_Reverb::CaptureFrame) * header.num_frames);
+  ptr += sizeof(SPU_Reverb::CaptureFrame) * header.num_frames;
+  std::vector<SPU_Reverb::CaptureWrite> writes(header.num_writes);
+  std::memcpy(writes.data(), ptr, sizeof(SPU_Reverb::CaptureWrite) * header.num_writes);
+
+  Log_InfoPrintf("Replaying %u frames and %u register writes of reverb, best of %u passes", header.num_frames,
+                 header.num_writes, NUM_PASSES);
+
+  // The work area in SPU RAM has to match too, not just the output samples.
+  struct Output
+  {
+    std::vector<s32> samples;
+    std::vector<u8> ram;
+
+    bool operator==(const Output& rhs) const = default;
+  };
+
+  const auto replay = [&](bool vectorized, Output* output) {
+    SPU_Reverb::State state = initial_state;
+    bool master_enable = (header.master_enable != 0);
+    output->samples.resize(header.num_frames * 2);
+    output->ram.assign(initial_ram, initial_ram + SPU_Reverb::RAM_SIZE);
+
+    u32 next_write = 0;
+    for (u32 frame = 0; frame < header.num_frames; frame++)
+    {
+      for (; next_write < header.num_writes && writes[next_write].frame == frame; next_write++)
+        SPU_Reverb::ApplyCaptureWrite(state, &master_enable, writes[next_write]);
+
+      s32* out = &output->samples[frame * 2];
+      if (vectorized)
+        SPU_Reverb::Process<true>(state, output->ram.data(), master_enable, frames[frame].left_in,
+                                  frames[frame].right_in, out);
+      else
+        SPU_Reverb::Process<false>(state, output->ram.data(), master_enable, frames[frame].left_in,
+                                   frames[frame].right_in, out);
+    }
+  };
+
+#ifdef SPU_REVERB_VECTOR
+  static constexpr bool has_vector = true;
+#else
+  static constexpr bool has_vector = false;
+#endif
+
+  return CompareKernels<Output>("reverb", "frame", header.num_frames, NUM_PASSES, has_vector, replay);
+}
+
+int RegTestHost::RunMDECBenchmark()
+{
+  static constexpr u32 NUM_MACROBLOCKS = 4096;
+  static constexpr u32 NUM_PASSES = 20;
+
+  // Sparse coefficient blocks like a real stream, with the standard scale table from the BIOS/libpress.
+  static constexpr std::array<s16, 64> scale_table = {{
+    23170, 23170, 23170, 23170, 23170, 23170, 23170, 23170, //
+    32138, 27245, 18204, 6392, -6393, -18205, -27246, -32139, //
+    30273, 12539, -12540, -30274, -30274, -12540, 12539, 30273, //
+    27245, -6393, -32139, -18205, 18204, 32138, 6392, -27246, //
+    23170, -23171, -23171, 23170, 23170, -23171, -23171, 23170, //
+    18204, -32139, 6392, 27245, -27246, -6393, 32138, -18205, //
+    12539, -30274, 30273, -12540, -12540, 30273, -30274, 12539, //
+    6392, -18205, 27245, -32139, 32138, -27246, 18204, -6393, //
+  }};
+
+  std::mt19937 rng(0x1234567u);
+  std::vector<MDEC_Kernels::Macroblock> input(NUM_MACROBLOCKS);
+  for (MDEC_Kernels::Macroblock& macroblock : input)
+  {
+    for (MDEC_Kernels::Block& block : macroblock)
+    {
+      block.fill(0);
+      const u32 num_coefficients = 1 + (rng() % 16);
+      for (u32 i = 0; i < num_coefficients; i++)
+        block[rng() % 64] = static_cast<s16>(static_cast<s32>(rng() % 2048) - 1024);
+    }
+  }
+
+  const auto run = [&input](bool vectorized, std::vector<u32>* output) {
+    output->resize(NUM_MACROBLOCKS * MDEC_Kernels::MACROBLOCK_PIXELS);
+    for (u32 i = 0; i < NUM_MACROBLOCKS; i++)
+    {
+      MDEC_Kernels::Macroblock blocks = input[i];
+      u32* out = &(*output)[i * MDEC_Kernels::MACROBLOCK_PIXELS];
+      if (vectorized)
+      {
+        for (MDEC_Kernels::Block& block : blocks)
+          MDEC_Kernels::IDCT(block.data(), scale_table.data());
+        MDEC_Kernels::YUVToRGB(out, blocks, false);
+      }
+      else
+      {
+        for (MDEC_Kernels::Block& block : blocks)
+          MDEC_Kernels::IDCTScalar(block.data(), scale_table.data());
+        MDEC_Kernels::YUVToRGBScalar(out, blocks, false);
+      }
+    }
+  };
+
+  Log_InfoPrintf("Reconstructing %u colour macroblocks, best of %u passes", NUM_MACROBLOCKS, NUM_PASSES);
+
+#ifdef MDEC_KERNELS_VECTOR
+  static constexpr bool has_vector = true;
+#else
+  static constexpr bool has_vector = false;
+#endif
+
+  return CompareKernels<std::vector<u32>>("MDEC", "macroblock", NUM_MACROBLOCKS, NUM_PASSES, has_vector, run);
+}
+
+int RegTestHost::RunGTEBenchmark()
+{
+  static constexpr u32 NUM_TRIANGLES = 65536;
+  static constexpr u32 NUM_PASSES = 20;
+
+  // A rotation about Y, and a model in front of the camera, like a RTPT-heavy scene.
+  static constexpr s16 M[9] = {3547, 0, 2048, 0, 4096, 0, -2048, 0, 3547};
+  static constexpr s32 T[3] = {-64, 32, 2400};
+
+  std::mt19937 rng(0x7654321u);
+  std::vector<std::array<s16, 9>> input(NUM_TRIANGLES);
+  for (std::array<s16, 9>& triangle : input)
+  {
+    for (s16& value : triangle)
+      value = static_cast<s16>(static_cast<s32>(rng() % 2048) - 1024);
+  }
+
+  const auto run = [&input](bool vectorized, std::vector<GTE_Kernels::MatVecResult>* output) {
+    output->resize(NUM_TRIANGLES * 3);
+    for (u32 i = 0; i < NUM_TRIANGLES; i++)
+    {
+      const s16* const V[3] = {&input[i][0], &input[i][3], &input[i][6]};
+      GTE_Kernels::MatVecResult* out = &(*output)[i * 3];
+      if (vectorized)
+      {
+        GTE_Kernels::MulMatVec<3>(out, M, T, V, 12, false);
+      }
+      else
+      {
+        for (u32 j = 0; j < 3; j++)
+          GTE_Kernels::MulMatVecScalar(&out[j], M, T, V[j], 12, false);
+      }
+    }
+  };
+
+  Log_InfoPrintf("Transforming %u triangles, best of %u passes", NUM_TRIANGLES, NUM_PASSES);
+
+#ifdef GTE_KERNELS_VECTOR
+  static constexpr bool has_vector = true;
+#else
+  static constexpr bool has_vector = false;
+#endif
+
+  return CompareKernels<std::vector<GTE_Kernels::MatVecResult>>("GTE", "triangle", NUM_TRIANGLES, NUM_PASSES,
+                                                                has_vector, run);
+}
+
+int RegTestHost::RunCodeCacheBenchmark()
+{
+  static constexpr u32 NUM_BLOCKS = 4096;
+  static constexpr u32 BLOCK_SPACING = 64;
+  static constexpr VirtualMemoryAddress CODE_BASE = 0x80010000;
+
+  // Flush before blocks get recompiled often enough to fall back to the interpreter.
+  static constexpr u32 ROUNDS_PER_FLUSH = 16;
+
+  System::Internal::ProcessStartup();
+  CPU::Initialize();
+  Bus::Initialize();
+  CPU::CodeCache::Initialize();
+
+  // Small leaf functions with a load and store, like a game's, and data between them. The first instruction changes
+  // each round, so every block has to be recompiled.
+  const auto write_block = [](u32 index, u32 round) {
+    const u32 offset = (index % 64) * sizeof(u32);
+    const std::array<u32, 6> code = {{
+      0x24020000u | (round & 0xFFFFu), // addiu v0, zero, round
+      0x8C830000u | offset,            // lw v1, offset(a0)
+      0x00431021u,                     // addu v0, v0, v1
+      0xAC820000u | offset,            // sw v0, offset(a0)
+      0x03E00008u,                     // jr ra
+      0x00000000u,                     // nop
+    }};
+    const PhysicalMemoryAddress address = (CODE_BASE + index * BLOCK_SPACING) & Bus::g_ram_mask;
+    std::memcpy(&Bus::g_ram[address], code.data(), sizeof(code));
+    return std::make_pair(address, static_cast<u32>(sizeof(code)));
+  };
+
+  for (u32 i = 0; i < NUM_BLOCKS; i++)
+    write_block(i, 0);
+
+  u64 blocks_compiled = 0;
+  u64 blocks_invalidated = 0;
+  u32 num_flushes = 0;
+  double compile_time_ms = 0.0;
+  double invalidate_time_ms = 0.0;
+  double flush_time_ms = 0.0;
+  bool blocks_valid = false;
+  u32 round = 0;
+
+  RunForBenchmarkTime([&]() {
+    round++;
+    if ((round % ROUNDS_PER_FLUSH) == 0)
+    {
+      Common::Timer flush_timer;
+      CPU::CodeCache::Flush();
+      flush_time_ms += flush_timer.GetTimeMilliseconds();
+      num_flushes++;
+      blocks_valid = false;
+    }
+
+    if (blocks_valid)
+    {
+      Common::Timer invalidate_timer;
+      for (u32 i = 0; i < NUM_BLOCKS; i++)
+      {
+        const auto [address, size] = write_block(i, round);
+        CPU::CodeCache::InvalidateBlocksInRange(address, size);
+      }
+      invalidate_time_ms += invalidate_timer.GetTimeMilliseconds();
+      blocks_invalidated += NUM_BLOCKS;
+    }
+
+    Common::Timer compile_timer;
+    for (u32 i = 0; i < NUM_BLOCKS; i++)
+    {
+      if (CPU::CodeCache::PrecompileBlock(CODE_BASE + i * BLOCK_SPACING))
+        blocks_compiled++;
+    }
+    compile_time_ms += compile_timer.GetTimeMilliseconds();
+    blocks_valid = true;
+  });
+
+  CPU::CodeCache::Shutdown();
+  Bus::Shutdown();
+  CPU::Shutdown();
+  System::Internal::ProcessShutdown();
+
+  Log_InfoPrintf("%u blocks, %s mode, %u flushes", NUM_BLOCKS,
+                 Settings::GetCPUExecutionModeName(g_settings.cpu_execution_mode), num_flushes);
+  Log_InfoPrintf("Compiled %" PRIu64 " blocks in %.2f ms, %.2f thousand blocks/sec", blocks_compiled, compile_time_ms,
+                 static_cast<double>(blocks_compiled) / compile_time_ms);
+  Log_InfoPrintf("Invalidated %" PRIu64 " blocks in %.2f ms, %.2f thousand blocks/sec", blocks_invalidated,
+                 invalidate_time_ms, static_cast<double>(blocks_invalidated) / invalidate_time_ms);
+  if (num_flushes > 0)
+    Log_InfoPrintf("Flush: %.3f ms", flush_time_ms / static_cast<double>(num_flushes));
+
+  return EXIT_SUCCESS;
+}
+
 int main(int argc, char* argv[])
 {
   RegTestHost::InitializeEarlyConsole();
@@ -560,6 +1501,12 @@ int main(int argc, char* argv[])
   if (!RegTestHost::ParseCommandLineParameters(argc, argv, autoboot))
     return EXIT_FAILURE;
 
+  if (s_benchmark)
+    return s_benchmark();
+
+  if (!s_batch_manifest_path.empty())
+    return RegTestHost::RunBatch();
+
   if (!autoboot || autoboot->filename.empty())
   {
     Log_ErrorPrintf("No boot path specified.");
@@ -570,10 +1517,14 @@ int main(int argc, char* argv[])
   RegTestHost::HookSignals();
 
   int result = -1;
+  const std::string boot_path(autoboot->filename);
+  Common::Timer boot_timer;
   Log_InfoPrintf("Trying to boot '%s'...", autoboot->filename.c_str());
   if (!System::BootSystem(std::move(autoboot.value())))
   {
     Log_ErrorPrintf("Failed to boot system.");
+    if (!s_report_path.empty())
+      RegTestHost::WriteReport(s_report_path, boot_path, false, boot_timer.GetTimeMilliseconds(), 0.0);
     goto cleanup;
   }
 
@@ -588,8 +1539,36 @@ int main(int argc, char* argv[])
     Log_InfoPrintf("Dumping every %dth frame to '%s'.", s_frame_dump_interval, s_dump_base_directory.c_str());
   }
 
-  Log_InfoPrintf("Running for %d frames...", s_frames_to_run);
-  System::Execute();
+  if (!s_audio_dump_path.empty())
+  {
+    if (!SPU::StartDumpingAudio(s_audio_dump_path.c_str()))
+      goto cleanup;
+
+    Log_InfoPrintf("Dumping audio to '%s'.", s_audio_dump_path.c_str());
+  }
+
+  if (!s_reverb_capture_path.empty())
+  {
+    SPU::StartReverbCapture(s_reverb_capture_path.c_str());
+    Log_InfoPrintf("Capturing reverb to '%s'.", s_reverb_capture_path.c_str());
+  }
+
+  {
+    const double boot_time_ms = boot_timer.GetTimeMilliseconds();
+    Common::Timer run_timer;
+    Log_InfoPrintf("Running for %d frames...", s_frames_to_run);
+    System::Execute();
+    if (!s_audio_dump_path.empty())
+      SPU::StopDumpingAudio();
+    if (!s_reverb_capture_path.empty() && !SPU::StopReverbCapture())
+      goto cleanup;
+
+    if (!s_report_path.empty() &&
+        !RegTestHost::WriteReport(s_report_path, boot_path, true, boot_time_ms, run_timer.GetTimeMilliseconds()))
+    {
+      goto cleanup;
+    }
+  }
 
   Log_InfoPrintf("Exiting with success.");
   result = 0;
@@ -6,6 +6,7 @@
 #include "common/error.h"
 #include "common/file_system.h"
 #include "common/log.h"
+#include "common/memmap.h"
 #include "common/path.h"
 #include "common/string_util.h"
 #include <array>
@@ -302,6 +303,26 @@ bool CDImage::ReadRawSector(void* buffer, SubChannelQ* subq)
   return true;
 }
 
+const u8* CDImage::GetRawSectorPointer()
+{
+  if (m_position_in_index == m_current_index->length)
+  {
+    if (!Seek(m_position_on_disc))
+      return nullptr;
+  }
+
+  // pregap and lead-out sectors aren't backed by the image
+  if (m_current_index->file_sector_size == 0)
+    return nullptr;
+
+  return GetSectorPointerFromIndex(*m_current_index, m_position_in_index);
+}
+
+const u8* CDImage::GetSectorPointerFromIndex(const Index& index, LBA lba_in_index)
+{
+  return nullptr;
+}
+
 bool CDImage::ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index)
 {
   GenerateSubChannelQ(subq, index, lba_in_index);
@@ -355,11 +376,21 @@ CDImage::PrecacheResult CDImage::Precache(ProgressCallback* progress /*= Progres
   return PrecacheResult::Unsupported;
 }
 
+CDImage::PrecacheResult
+CDImage::PreloadMappedFiles(ProgressCallback* progress /*= ProgressCallback::NullProgressCallback*/)
+{
+  return PrecacheResult::Unsupported;
+}
+
 bool CDImage::IsPrecached() const
 {
   return false;
 }
 
+void CDImage::SetReadCache(u32 cache_blocks, u32 readahead_blocks)
+{
+}
+
 void CDImage::ClearTOC()
 {
   m_lba_count = 0;
@@ -480,6 +511,45 @@ void CDImage::AddLeadOutIndex()
   m_indices.push_back(index);
 }
 
+CDImage::PrecacheResult CDImage::MapAndPreloadFile(MappedFile* file, const char* path, ProgressCallback* progress)
+{
+  Error error;
+  if (!file->Open(path, &error))
+  {
+    Log_ErrorFmt("Failed to map '{}': {}", path, error.GetDescription());
+    return PrecacheResult::Unsupported;
+  }
+
+  // Page everything in up front, so it's likely to still be resident when it's read. The data lives in the page
+  // cache rather than in a copy of the image, so it can be evicted again under memory pressure.
+  static constexpr size_t CHUNK_SIZE = 1024 * 1024;
+  const size_t size = file->GetSize();
+  progress->SetStatusText("Preloading CD image to RAM...");
+  progress->SetProgressRange(static_cast<u32>((size + CHUNK_SIZE - 1) / CHUNK_SIZE));
+  progress->SetProgressValue(0);
+
+  for (size_t chunk_offset = 0; chunk_offset < size; chunk_offset += CHUNK_SIZE)
+  {
+    const size_t chunk_end = std::min(chunk_offset + CHUNK_SIZE, size);
+    if (!file->Prefault(chunk_offset, chunk_end - chunk_offset, &error))
+    {
+      Log_ErrorFmt("Failed to preload '{}': {}", path, error.GetDescription());
+      file->Close();
+      return PrecacheResult::ReadError;
+    }
+
+    progress->SetProgressValue(static_cast<u32>(chunk_end / CHUNK_SIZE));
+    if (progress->IsCancelled())
+    {
+      file->Close();
+      return PrecacheResult::ReadError;
+    }
+  }
+
+  Log_DevFmt("Preloaded {} bytes of '{}'", size, Path::GetFileName(path));
+  return PrecacheResult::Success;
+}
+
 u16 CDImage::SubChannelQ::ComputeCRC(const Data& data)
 {
   static constexpr std::array<u16, 256> crc16_table = {
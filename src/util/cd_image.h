@@ -13,6 +13,7 @@
 #include <vector>
 
 class Error;
+class MappedFile;
 
 class CDImage
 {
@@ -286,6 +287,11 @@ public:
   // Read a single raw sector, and subchannel from the current LBA.
   bool ReadRawSector(void* buffer, SubChannelQ* subq);
 
+  // Returns a pointer to the raw sector at the current LBA without advancing, if the image holds it in memory.
+  // Callers can then pass a null buffer to ReadRawSector() to skip the copy. Valid until the image is closed.
+  // File mappings never hand out pointers, since touching an evicted page can fault on an I/O error.
+  const u8* GetRawSectorPointer();
+
   // Reads sub-channel Q for the specified index+LBA.
   virtual bool ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index);
 
@@ -295,6 +301,9 @@ public:
   // Reads a single sector from an index.
   virtual bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) = 0;
 
+  // Returns a pointer to a sector from an index, or nullptr if it has to be read with ReadSectorFromIndex().
+  virtual const u8* GetSectorPointerFromIndex(const Index& index, LBA lba_in_index);
+
   // Retrieve image metadata.
   virtual std::string GetMetadata(const std::string_view& type) const;
 
@@ -317,6 +326,15 @@ public:
   virtual PrecacheResult Precache(ProgressCallback* progress = ProgressCallback::NullProgressCallback);
   virtual bool IsPrecached() const;
 
+  // Maps uncompressed image files and reads them into the page cache, as a lighter alternative to precaching. The
+  // kernel can still evict the pages, so sectors are copied out of the mapping by whoever reads them.
+  virtual PrecacheResult PreloadMappedFiles(ProgressCallback* progress = ProgressCallback::NullProgressCallback);
+
+  // Sets the number of decompressed blocks to keep in memory, and how many blocks past the last read should be
+  // decompressed in the background, for compressed formats. Raw images on Linux use it to size the io_uring reader's
+  // cache and read-ahead instead. Only worth enabling for the image which is being played.
+  virtual void SetReadCache(u32 cache_blocks, u32 readahead_blocks);
+
 protected:
   void ClearTOC();
   void CopyTOC(const CDImage* image);
@@ -333,6 +351,9 @@ protected:
   /// Synthesis of lead-out data.
   void AddLeadOutIndex();
 
+  /// Maps a track file and faults it into the page cache, for PreloadMappedFiles().
+  static PrecacheResult MapAndPreloadFile(MappedFile* file, const char* path, ProgressCallback* progress);
+
   std::string m_filename;
   u32 m_lba_count = 0;
 
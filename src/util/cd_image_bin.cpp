@@ -6,7 +6,13 @@
 #include "common/error.h"
 #include "common/file_system.h"
 #include "common/log.h"
+#include "common/memmap.h"
 #include <cerrno>
+
+#ifdef ENABLE_IO_URING
+#include "uring_file_reader.h"
+#endif
+
 Log_SetChannel(CDImageBin);
 
 class CDImageBin : public CDImage
@@ -19,6 +25,8 @@ public:
 
   bool ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index) override;
   bool HasNonStandardSubchannel() const override;
+  PrecacheResult PreloadMappedFiles(ProgressCallback* progress) override;
+  void SetReadCache(u32 cache_blocks, u32 readahead_blocks) override;
 
 protected:
   bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override;
@@ -27,6 +35,13 @@ private:
   std::FILE* m_fp = nullptr;
   u64 m_file_position = 0;
 
+  // Only mapped once preloaded, sectors are then copied out of it.
+  MappedFile m_mapped_file;
+
+#ifdef ENABLE_IO_URING
+  std::unique_ptr<URingFileReader> m_uring_reader;
+#endif
+
   CDSubChannelReplacement m_sbi;
 };
 
@@ -34,6 +49,11 @@ CDImageBin::CDImageBin() = default;
 
 CDImageBin::~CDImageBin()
 {
+#ifdef ENABLE_IO_URING
+  // reads may still be in flight
+  m_uring_reader.reset();
+#endif
+
   if (m_fp)
     std::fclose(m_fp);
 }
@@ -115,9 +135,62 @@ bool CDImageBin::HasNonStandardSubchannel() const
   return (m_sbi.GetReplacementSectorCount() > 0);
 }
 
+CDImage::PrecacheResult CDImageBin::PreloadMappedFiles(ProgressCallback* progress)
+{
+  if (m_mapped_file.IsOpen())
+    return PrecacheResult::Success;
+
+  const PrecacheResult result = MapAndPreloadFile(&m_mapped_file, m_filename.c_str(), progress);
+  if (result != PrecacheResult::Success)
+    return result;
+
+#ifdef ENABLE_IO_URING
+  m_uring_reader.reset();
+#endif
+
+  return PrecacheResult::Success;
+}
+
+void CDImageBin::SetReadCache(u32 cache_blocks, u32 readahead_blocks)
+{
+#ifdef ENABLE_IO_URING
+  m_uring_reader.reset();
+  if (readahead_blocks == 0 || m_mapped_file.IsOpen())
+    return;
+
+  Error error;
+  m_uring_reader = URingFileReader::Create(cache_blocks, readahead_blocks, &error);
+  if (!m_uring_reader)
+  {
+    Log_WarningFmt("io_uring is unavailable, reading '{}' synchronously: {}", m_filename, error.GetDescription());
+    return;
+  }
+
+  m_uring_reader->AddFile(m_fp);
+#endif
+}
+
 bool CDImageBin::ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index)
 {
   const u64 file_position = index.file_offset + (static_cast<u64>(lba_in_index) * index.file_sector_size);
+  if (m_mapped_file.IsOpen())
+  {
+    Error error;
+    if (!m_mapped_file.Read(buffer, static_cast<size_t>(file_position), index.file_sector_size, &error))
+    {
+      Log_ErrorFmt("Failed to read sector at offset {} of '{}': {}", file_position, m_filename,
+                   error.GetDescription());
+      return false;
+    }
+
+    return true;
+  }
+
+#ifdef ENABLE_IO_URING
+  if (m_uring_reader)
+    return m_uring_reader->Read(0, file_position, buffer, index.file_sector_size);
+#endif
+
   if (m_file_position != file_position)
   {
     if (std::fseek(m_fp, static_cast<long>(file_position), SEEK_SET) != 0)
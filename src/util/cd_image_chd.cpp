@@ -18,13 +18,17 @@
 #include "fmt/format.h"
 #include "libchdr/chd.h"
 
+#include "common/threading.h"
+
 #include <algorithm>
 #include <cerrno>
+#include <condition_variable>
 #include <cstdio>
 #include <cstring>
 #include <limits>
 #include <mutex>
 #include <optional>
+#include <thread>
 
 Log_SetChannel(CDImageCHD);
 
@@ -66,6 +70,7 @@ public:
   bool HasNonStandardSubchannel() const override;
   PrecacheResult Precache(ProgressCallback* progress) override;
   bool IsPrecached() const override;
+  void SetReadCache(u32 cache_blocks, u32 readahead_blocks) override;
 
 protected:
   bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override;
@@ -74,20 +79,53 @@ private:
   static constexpr u32 CHD_CD_SECTOR_DATA_SIZE = 2352 + 96;
   static constexpr u32 CHD_CD_TRACK_ALIGNMENT = 4;
   static constexpr u32 MAX_PARENTS = 32; // Surely someone wouldn't be insane enough to go beyond this...
+  static constexpr u32 INVALID_HUNK_INDEX = static_cast<u32>(-1);
+
+  struct CachedHunk
+  {
+    DynamicHeapArray<u8, 16> data;
+    u32 hunk_index = INVALID_HUNK_INDEX;
+    u32 last_used = 0;
+    bool loading = false;
+  };
 
   chd_file* OpenCHD(std::string_view filename, FileSystem::ManagedCFilePtr fp, Error* error, u32 recursion_level);
-  bool ReadHunk(u32 hunk_index);
+  bool ReadHunk(u32 hunk_index, u8* buffer);
+
+  CachedHunk* LookupHunk(u32 hunk_index);
+  CachedHunk* AllocateHunk(u32 hunk_index);
+  CachedHunk* GetHunk(u32 hunk_index, std::unique_lock<std::mutex>& lock);
+  void QueueReadahead(u32 hunk_index);
+
+  void StartReadaheadThread();
+  void StopReadaheadThread();
+  void ReadaheadThreadEntryPoint();
 
   static void CopyAndSwap(void* dst_ptr, const u8* src_ptr);
 
   chd_file* m_chd = nullptr;
   u32 m_hunk_size = 0;
+  u32 m_hunk_count = 0;
   u32 m_sectors_per_hunk = 0;
-
-  DynamicHeapArray<u8, 16> m_hunk_buffer;
-  u32 m_current_hunk_index = static_cast<u32>(-1);
   bool m_precached = false;
 
+  // Decompressed hunks, least recently used is replaced first. Metadata is protected by m_hunk_cache_mutex, and the
+  // data of a hunk which is loading belongs to whoever is decompressing it. libchdr isn't thread safe, so all reads
+  // from the file go through m_chd_mutex.
+  std::vector<CachedHunk> m_hunk_cache;
+  u32 m_hunk_cache_counter = 0;
+  std::mutex m_hunk_cache_mutex;
+  std::mutex m_chd_mutex;
+  std::condition_variable m_hunk_loaded_cv;
+
+  // Hunks following the last read are decompressed on a worker thread, so streaming doesn't stall the reader.
+  std::thread m_readahead_thread;
+  std::condition_variable m_readahead_cv;
+  u32 m_readahead_hunks = 0;
+  u32 m_readahead_start = 0;
+  u32 m_readahead_end = 0;
+  bool m_readahead_shutdown = false;
+
   CDSubChannelReplacement m_sbi;
 };
 } // namespace
@@ -96,6 +134,8 @@ CDImageCHD::CDImageCHD() = default;
 
 CDImageCHD::~CDImageCHD()
 {
+  StopReadaheadThread();
+
   if (m_chd)
     chd_close(m_chd);
 }
@@ -257,8 +297,9 @@ bool CDImageCHD::Open(const char* filename, Error* error)
     return false;
   }
 
+  m_hunk_count = header->totalhunks;
   m_sectors_per_hunk = m_hunk_size / CHD_CD_SECTOR_DATA_SIZE;
-  m_hunk_buffer.resize(m_hunk_size);
+  SetReadCache(1, 0);
   m_filename = filename;
 
   u32 disc_lba = 0;
@@ -435,6 +476,7 @@ CDImage::PrecacheResult CDImageCHD::Precache(ProgressCallback* progress)
     static_cast<ProgressCallback*>(param)->SetProgressValue(std::min<u32>(percent, 100));
   };
 
+  std::unique_lock lock(m_chd_mutex);
   if (chd_precache_progress(m_chd, callback, progress) != CHDERR_NONE)
     return CDImage::PrecacheResult::ReadError;
 
@@ -447,6 +489,30 @@ bool CDImageCHD::IsPrecached() const
   return m_precached;
 }
 
+void CDImageCHD::SetReadCache(u32 cache_blocks, u32 readahead_blocks)
+{
+  StopReadaheadThread();
+
+  // we need at least one hunk to read into while the read-ahead thread is busy with another
+  const u32 cache_size = std::max(cache_blocks, readahead_blocks + 1);
+  if (m_hunk_cache.size() != cache_size)
+  {
+    m_hunk_cache.clear();
+    m_hunk_cache.resize(cache_size);
+    for (CachedHunk& hunk : m_hunk_cache)
+      hunk.data.resize(m_hunk_size);
+
+    m_hunk_cache_counter = 0;
+  }
+
+  m_readahead_hunks = readahead_blocks;
+  if (m_readahead_hunks > 0)
+  {
+    Log_DevFmt("Caching {} hunks, with {} hunks of read-ahead", cache_size, m_readahead_hunks);
+    StartReadaheadThread();
+  }
+}
+
 ALWAYS_INLINE_RELEASE void CDImageCHD::CopyAndSwap(void* dst_ptr, const u8* src_ptr)
 {
   constexpr u32 data_size = RAW_SECTOR_SIZE;
@@ -510,34 +576,180 @@ bool CDImageCHD::ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_i
   const u32 hunk_offset = static_cast<u32>((disc_frame % m_sectors_per_hunk) * CHD_CD_SECTOR_DATA_SIZE);
   DebugAssert((m_hunk_size - hunk_offset) >= CHD_CD_SECTOR_DATA_SIZE);
 
-  if (m_current_hunk_index != hunk_index && !ReadHunk(hunk_index))
+  // copy while holding the lock, so the read-ahead thread can't replace the hunk underneath us
+  std::unique_lock lock(m_hunk_cache_mutex);
+  const CachedHunk* hunk = GetHunk(hunk_index, lock);
+  if (!hunk)
     return false;
 
   // Audio data is in big-endian, so we have to swap it for little endian hosts...
   if (index.mode == TrackMode::Audio)
-    CopyAndSwap(buffer, &m_hunk_buffer[hunk_offset]);
+    CopyAndSwap(buffer, &hunk->data[hunk_offset]);
   else
-    std::memcpy(buffer, &m_hunk_buffer[hunk_offset], RAW_SECTOR_SIZE);
+    std::memcpy(buffer, &hunk->data[hunk_offset], RAW_SECTOR_SIZE);
 
   return true;
 }
 
-bool CDImageCHD::ReadHunk(u32 hunk_index)
+bool CDImageCHD::ReadHunk(u32 hunk_index, u8* buffer)
 {
-  const chd_error err = chd_read(m_chd, hunk_index, m_hunk_buffer.data());
+  std::unique_lock lock(m_chd_mutex);
+  const chd_error err = chd_read(m_chd, hunk_index, buffer);
   if (err != CHDERR_NONE)
   {
-    Log_ErrorFmt("chd_read({}) failed: %s", hunk_index, chd_error_string(err));
-
-    // data might have been partially written
-    m_current_hunk_index = static_cast<u32>(-1);
+    Log_ErrorFmt("chd_read({}) failed: {}", hunk_index, chd_error_string(err));
     return false;
   }
 
-  m_current_hunk_index = hunk_index;
   return true;
 }
 
+CDImageCHD::CachedHunk* CDImageCHD::LookupHunk(u32 hunk_index)
+{
+  for (CachedHunk& hunk : m_hunk_cache)
+  {
+    if (hunk.hunk_index == hunk_index)
+      return &hunk;
+  }
+
+  return nullptr;
+}
+
+CDImageCHD::CachedHunk* CDImageCHD::AllocateHunk(u32 hunk_index)
+{
+  // replace the least recently used hunk which isn't in the middle of being loaded
+  CachedHunk* victim = nullptr;
+  for (CachedHunk& hunk : m_hunk_cache)
+  {
+    if (!hunk.loading && (!victim || hunk.last_used < victim->last_used))
+      victim = &hunk;
+  }
+
+  if (victim)
+  {
+    victim->hunk_index = hunk_index;
+    victim->last_used = ++m_hunk_cache_counter;
+    victim->loading = true;
+  }
+
+  return victim;
+}
+
+CDImageCHD::CachedHunk* CDImageCHD::GetHunk(u32 hunk_index, std::unique_lock<std::mutex>& lock)
+{
+  CachedHunk* hunk;
+  for (;;)
+  {
+    hunk = LookupHunk(hunk_index);
+    if (!hunk)
+    {
+      // not cached, nor being read ahead, so decompress it ourselves
+      hunk = AllocateHunk(hunk_index);
+      if (!hunk)
+      {
+        m_hunk_loaded_cv.wait(lock);
+        continue;
+      }
+
+      lock.unlock();
+      const bool result = ReadHunk(hunk_index, hunk->data.data());
+      lock.lock();
+
+      hunk->loading = false;
+      if (!result)
+        hunk->hunk_index = INVALID_HUNK_INDEX;
+      m_hunk_loaded_cv.notify_all();
+      if (!result)
+        return nullptr;
+
+      break;
+    }
+    else if (hunk->loading)
+    {
+      // the read-ahead thread got here first
+      m_hunk_loaded_cv.wait(lock);
+      continue;
+    }
+
+    hunk->last_used = ++m_hunk_cache_counter;
+    break;
+  }
+
+  QueueReadahead(hunk_index + 1);
+  return hunk;
+}
+
+void CDImageCHD::QueueReadahead(u32 hunk_index)
+{
+  if (m_readahead_hunks == 0)
+    return;
+
+  const u32 end = std::min(hunk_index + m_readahead_hunks, m_hunk_count);
+  if (m_readahead_start == hunk_index && m_readahead_end == end)
+    return;
+
+  m_readahead_start = hunk_index;
+  m_readahead_end = end;
+  m_readahead_cv.notify_one();
+}
+
+void CDImageCHD::StartReadaheadThread()
+{
+  m_readahead_start = 0;
+  m_readahead_end = 0;
+  m_readahead_shutdown = false;
+  m_readahead_thread = std::thread(&CDImageCHD::ReadaheadThreadEntryPoint, this);
+}
+
+void CDImageCHD::StopReadaheadThread()
+{
+  if (!m_readahead_thread.joinable())
+    return;
+
+  {
+    std::unique_lock lock(m_hunk_cache_mutex);
+    m_readahead_shutdown = true;
+    m_readahead_cv.notify_one();
+  }
+
+  m_readahead_thread.join();
+}
+
+void CDImageCHD::ReadaheadThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("CHD Read-Ahead");
+
+  std::unique_lock lock(m_hunk_cache_mutex);
+  for (;;)
+  {
+    m_readahead_cv.wait(lock, [this]() { return (m_readahead_start < m_readahead_end || m_readahead_shutdown); });
+    if (m_readahead_shutdown)
+      break;
+
+    const u32 hunk_index = m_readahead_start++;
+    if (LookupHunk(hunk_index))
+      continue;
+
+    CachedHunk* hunk = AllocateHunk(hunk_index);
+    if (!hunk)
+      continue;
+
+    lock.unlock();
+    const bool result = ReadHunk(hunk_index, hunk->data.data());
+    lock.lock();
+
+    hunk->loading = false;
+    if (!result)
+    {
+      // don't keep trying to read past a bad hunk
+      hunk->hunk_index = INVALID_HUNK_INDEX;
+      m_readahead_start = m_readahead_end;
+    }
+
+    m_hunk_loaded_cv.notify_all();
+  }
+}
+
 std::unique_ptr<CDImage> CDImage::OpenCHDImage(const char* filename, Error* error)
 {
   std::unique_ptr<CDImageCHD> image = std::make_unique<CDImageCHD>();
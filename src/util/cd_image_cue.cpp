@@ -9,6 +9,7 @@
 #include "common/error.h"
 #include "common/file_system.h"
 #include "common/log.h"
+#include "common/memmap.h"
 #include "common/path.h"
 
 #include "fmt/format.h"
@@ -18,6 +19,10 @@
 #include <cinttypes>
 #include <map>
 
+#ifdef ENABLE_IO_URING
+#include "uring_file_reader.h"
+#endif
+
 Log_SetChannel(CDImageCueSheet);
 
 class CDImageCueSheet : public CDImage
@@ -30,6 +35,8 @@ public:
 
   bool ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index) override;
   bool HasNonStandardSubchannel() const override;
+  PrecacheResult PreloadMappedFiles(ProgressCallback* progress) override;
+  void SetReadCache(u32 cache_blocks, u32 readahead_blocks) override;
 
 protected:
   bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override;
@@ -38,18 +45,32 @@ private:
   struct TrackFile
   {
     std::string filename;
+    std::string path;
     std::FILE* file;
     u64 file_position;
   };
 
   std::vector<TrackFile> m_files;
   CDSubChannelReplacement m_sbi;
+
+  // One per track file, only mapped once preloaded. Sectors are then copied out of them.
+  std::unique_ptr<MappedFile[]> m_mapped_files;
+
+#ifdef ENABLE_IO_URING
+  // Files are added in the same order as m_files.
+  std::unique_ptr<URingFileReader> m_uring_reader;
+#endif
 };
 
 CDImageCueSheet::CDImageCueSheet() = default;
 
 CDImageCueSheet::~CDImageCueSheet()
 {
+#ifdef ENABLE_IO_URING
+  // reads may still be in flight
+  m_uring_reader.reset();
+#endif
+
   std::for_each(m_files.begin(), m_files.end(), [](TrackFile& t) { std::fclose(t.file); });
 }
 
@@ -100,7 +121,8 @@ bool CDImageCueSheet::OpenAndParse(const char* filename, Error* error)
       const std::string track_full_filename(
         !Path::IsAbsolute(track_filename) ? Path::BuildRelativePath(m_filename, track_filename) : track_filename);
       Error track_error;
-      std::FILE* track_fp = FileSystem::OpenCFile(track_full_filename.c_str(), "rb", &track_error);
+      std::string track_path = track_full_filename;
+      std::FILE* track_fp = FileSystem::OpenCFile(track_path.c_str(), "rb", &track_error);
       if (!track_fp && track_file_index == 0)
       {
         // many users have bad cuesheets, or they're renamed the files without updating the cuesheet.
@@ -111,6 +133,7 @@ bool CDImageCueSheet::OpenAndParse(const char* filename, Error* error)
         {
           Log_WarningPrintf("Your cue sheet references an invalid file '%s', but this was found at '%s' instead.",
                             track_filename.c_str(), alternative_filename.c_str());
+          track_path = alternative_filename;
         }
       }
 
@@ -124,7 +147,7 @@ bool CDImageCueSheet::OpenAndParse(const char* filename, Error* error)
         return false;
       }
 
-      m_files.push_back(TrackFile{std::move(track_filename), track_fp, 0});
+      m_files.push_back(TrackFile{std::move(track_filename), std::move(track_path), track_fp, 0});
     }
 
     // data type determines the sector size
@@ -308,12 +331,73 @@ bool CDImageCueSheet::HasNonStandardSubchannel() const
   return (m_sbi.GetReplacementSectorCount() > 0);
 }
 
+CDImage::PrecacheResult CDImageCueSheet::PreloadMappedFiles(ProgressCallback* progress)
+{
+  if (m_mapped_files)
+    return PrecacheResult::Success;
+
+  std::unique_ptr<MappedFile[]> mapped_files = std::make_unique<MappedFile[]>(m_files.size());
+  for (size_t i = 0; i < m_files.size(); i++)
+  {
+    const PrecacheResult result = MapAndPreloadFile(&mapped_files[i], m_files[i].path.c_str(), progress);
+    if (result != PrecacheResult::Success)
+      return result;
+  }
+
+  m_mapped_files = std::move(mapped_files);
+
+#ifdef ENABLE_IO_URING
+  m_uring_reader.reset();
+#endif
+
+  return PrecacheResult::Success;
+}
+
+void CDImageCueSheet::SetReadCache(u32 cache_blocks, u32 readahead_blocks)
+{
+#ifdef ENABLE_IO_URING
+  m_uring_reader.reset();
+  if (readahead_blocks == 0 || m_mapped_files)
+    return;
+
+  Error error;
+  m_uring_reader = URingFileReader::Create(cache_blocks, readahead_blocks, &error);
+  if (!m_uring_reader)
+  {
+    Log_WarningFmt("io_uring is unavailable, reading '{}' synchronously: {}", m_filename, error.GetDescription());
+    return;
+  }
+
+  for (const TrackFile& tf : m_files)
+    m_uring_reader->AddFile(tf.file);
+#endif
+}
+
 bool CDImageCueSheet::ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index)
 {
   DebugAssert(index.file_index < m_files.size());
 
   TrackFile& tf = m_files[index.file_index];
   const u64 file_position = index.file_offset + (static_cast<u64>(lba_in_index) * index.file_sector_size);
+  if (m_mapped_files)
+  {
+    Error error;
+    if (!m_mapped_files[index.file_index].Read(buffer, static_cast<size_t>(file_position), index.file_sector_size,
+                                               &error))
+    {
+      Log_ErrorFmt("Failed to read sector at offset {} of '{}': {}", file_position, tf.filename,
+                   error.GetDescription());
+      return false;
+    }
+
+    return true;
+  }
+
+#ifdef ENABLE_IO_URING
+  if (m_uring_reader)
+    return m_uring_reader->Read(index.file_index, file_position, buffer, index.file_sector_size);
+#endif
+
   if (tf.file_position != file_position)
   {
     if (std::fseek(tf.file, static_cast<long>(file_position), SEEK_SET) != 0)
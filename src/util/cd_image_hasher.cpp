@@ -3,79 +3,224 @@
 
 #include "cd_image_hasher.h"
 #include "cd_image.h"
+#include "common/byte_stream.h"
+#include "common/file_system.h"
+#include "common/log.h"
 #include "common/md5_digest.h"
+#include "common/path.h"
 #include "common/string_util.h"
+#include "common/threading.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+Log_SetChannel(CDImageHasher);
 
 namespace CDImageHasher {
 
-static bool ReadIndex(CDImage* image, u8 track, u8 index, MD5Digest* digest, ProgressCallback* progress_callback)
+namespace {
+struct SectorRange
+{
+  CDImage::LBA start;
+  u32 length;
+};
+
+// Sectors which go into a single digest. Only one worker hashes a stream at a time, so its chunks stay in order.
+struct HashStream
+{
+  std::vector<SectorRange> ranges;
+  MD5Digest digest;
+  std::deque<u32> pending_chunks;
+  bool busy = false;
+};
+
+struct HashChunk
 {
-  const CDImage::LBA index_start = image->GetTrackIndexPosition(track, index);
-  const u32 index_length = image->GetTrackIndexLength(track, index);
-  const u32 update_interval = std::max<u32>(index_length / 100u, 1u);
+  std::array<u8, CDImage::RAW_SECTOR_SIZE * 64> data;
+  u32 size;
+};
+} // namespace
 
-  progress_callback->SetFormattedStatusText("Computing hash for track %u/index %u...", track, index);
-  progress_callback->SetProgressRange(index_length);
+static constexpr u32 CHUNK_SECTORS = sizeof(HashChunk::data) / CDImage::RAW_SECTOR_SIZE;
+static constexpr u32 CHUNKS_PER_WORKER = 4;
 
-  if (!image->Seek(index_start))
+static constexpr u32 CACHE_SIGNATURE = 0x48545344; // DSTH
+static constexpr u32 CACHE_VERSION = 1;
+
+static void AddTrackRanges(CDImage* image, u8 track, std::vector<SectorRange>* ranges)
+{
+  static constexpr u8 INDICES_TO_READ = 2;
+
+  for (u8 index = 0; index < INDICES_TO_READ; index++)
   {
-    progress_callback->DisplayFormattedModalError("Failed to seek to sector %u for track %u index %u", index_start,
-                                                  track, index);
-    return false;
+    // skip index 0 if data track
+    if (track == 1 && index == 0)
+      continue;
+
+    ranges->push_back(
+      SectorRange{image->GetTrackIndexPosition(track, index), image->GetTrackIndexLength(track, index)});
   }
+}
 
-  std::array<u8, CDImage::RAW_SECTOR_SIZE> sector;
-  for (u32 lba = 0; lba < index_length; lba++)
+static bool HashStreams(CDImage* image, std::vector<HashStream>& streams, ProgressCallback* progress_callback)
+{
+  u32 total_sectors = 0;
+  for (const HashStream& stream : streams)
   {
-    if ((lba % update_interval) == 0)
-      progress_callback->SetProgressValue(lba);
+    for (const SectorRange& range : stream.ranges)
+      total_sectors += range.length;
+  }
+
+  // Sectors are read on this thread, since the image can only be read from one place at a time, and reading from
+  // disk in order is fastest anyway. The workers hash them as they arrive, with different tracks in parallel.
+  const u32 num_workers =
+    std::clamp(std::thread::hardware_concurrency(), 1u, std::max(static_cast<u32>(streams.size()), 1u));
+  const u32 num_chunks = (num_workers + 1) * CHUNKS_PER_WORKER;
+  std::unique_ptr<HashChunk[]> chunks = std::make_unique<HashChunk[]>(num_chunks);
+  std::vector<u32> free_chunks;
+  free_chunks.reserve(num_chunks);
+  for (u32 i = 0; i < num_chunks; i++)
+    free_chunks.push_back(i);
+
+  std::mutex mutex;
+  std::condition_variable work_cv;
+  std::condition_variable free_cv;
+  bool reading_done = false;
+  bool aborted = false;
 
-    if (!image->ReadRawSector(sector.data(), nullptr))
+  auto worker = [&]() {
+    Threading::SetNameOfCurrentThread("CD Image Hasher");
+
+    std::unique_lock lock(mutex);
+    for (;;)
     {
-      progress_callback->DisplayFormattedModalError("Failed to read sector %u from image", image->GetPositionOnDisc());
-      return false;
-    }
+      HashStream* stream = nullptr;
+      work_cv.wait(lock, [&]() {
+        if (aborted)
+          return true;
 
-    digest->Update(sector.data(), static_cast<u32>(sector.size()));
-  }
+        auto it = std::find_if(streams.begin(), streams.end(),
+                               [](const HashStream& s) { return (!s.busy && !s.pending_chunks.empty()); });
+        stream = (it != streams.end()) ? &(*it) : nullptr;
+        return (stream || reading_done);
+      });
+      if (aborted || !stream)
+        break;
 
-  progress_callback->SetProgressValue(index_length);
-  return true;
-}
+      const u32 chunk_index = stream->pending_chunks.front();
+      stream->pending_chunks.pop_front();
+      stream->busy = true;
+      lock.unlock();
 
-static bool ReadTrack(CDImage* image, u8 track, MD5Digest* digest, ProgressCallback* progress_callback)
-{
-  static constexpr u8 INDICES_TO_READ = 2;
+      stream->digest.Update(chunks[chunk_index].data.data(), chunks[chunk_index].size);
 
-  progress_callback->PushState();
+      lock.lock();
+      stream->busy = false;
+      free_chunks.push_back(chunk_index);
+      free_cv.notify_one();
 
-  const bool dataTrack = track == 1;
-  progress_callback->SetProgressRange(dataTrack ? 1 : 2);
+      // another worker may have been waiting for the next chunk of this stream
+      work_cv.notify_one();
+    }
+  };
 
-  u8 progress = 0;
-  for (u8 index = 0; index < INDICES_TO_READ; index++)
-  {
-    progress_callback->SetProgressValue(progress);
+  std::vector<std::thread> workers;
+  workers.reserve(num_workers);
+  for (u32 i = 0; i < num_workers; i++)
+    workers.emplace_back(worker);
 
-    // skip index 0 if data track
-    if (dataTrack && index == 0)
-      continue;
+  progress_callback->SetProgressRange(total_sectors);
+  progress_callback->SetProgressValue(0);
 
-    progress++;
-    progress_callback->PushState();
-    if (!ReadIndex(image, track, index, digest, progress_callback))
+  bool result = true;
+  u32 sectors_read = 0;
+  for (u32 stream_index = 0; stream_index < static_cast<u32>(streams.size()) && result; stream_index++)
+  {
+    for (const SectorRange& range : streams[stream_index].ranges)
     {
-      progress_callback->PopState();
-      progress_callback->PopState();
-      return false;
+      if (!image->Seek(range.start))
+      {
+        progress_callback->DisplayFormattedModalError("Failed to seek to sector %u", range.start);
+        result = false;
+        break;
+      }
+
+      for (u32 offset = 0; offset < range.length && result;)
+      {
+        u32 chunk_index;
+        {
+          std::unique_lock lock(mutex);
+          free_cv.wait(lock, [&free_chunks]() { return !free_chunks.empty(); });
+          chunk_index = free_chunks.back();
+          free_chunks.pop_back();
+        }
+
+        HashChunk& chunk = chunks[chunk_index];
+        const u32 count = std::min(range.length - offset, CHUNK_SECTORS);
+        for (u32 i = 0; i < count; i++)
+        {
+          if (!image->ReadRawSector(&chunk.data[i * CDImage::RAW_SECTOR_SIZE], nullptr))
+          {
+            progress_callback->DisplayFormattedModalError("Failed to read sector %u from image",
+                                                          image->GetPositionOnDisc());
+            result = false;
+            break;
+          }
+        }
+        if (!result)
+          break;
+
+        chunk.size = count * CDImage::RAW_SECTOR_SIZE;
+        {
+          std::unique_lock lock(mutex);
+          streams[stream_index].pending_chunks.push_back(chunk_index);
+          work_cv.notify_one();
+        }
+
+        offset += count;
+        sectors_read += count;
+        progress_callback->SetProgressValue(sectors_read);
+        if (progress_callback->IsCancelled())
+          result = false;
+      }
+
+      if (!result)
+        break;
     }
+  }
 
-    progress_callback->PopState();
+  {
+    std::unique_lock lock(mutex);
+    reading_done = true;
+    aborted = !result;
+    work_cv.notify_all();
   }
 
-  progress_callback->SetProgressValue(progress);
-  progress_callback->PopState();
-  return true;
+  for (std::thread& thread : workers)
+    thread.join();
+
+  return result;
+}
+
+// Only the image's own file is checked for changes, so formats which keep their data in other files (cue sheets,
+// mds/mdf, m3u playlists) are never cached. CHD parents are matched by their SHA-1, so they can't change underneath.
+static bool CanCacheImage(const CDImage* image)
+{
+  static constexpr std::array<std::string_view, 6> single_file_extensions = {
+    {"bin", "img", "iso", "chd", "ecm", "pbp"}};
+
+  const std::string_view extension = Path::GetExtension(image->GetFileName());
+  return std::any_of(single_file_extensions.begin(), single_file_extensions.end(),
+                     [extension](const std::string_view& ext) { return StringUtil::EqualNoCase(extension, ext); });
+}
+
+static bool MatchesCachedImage(const FILESYSTEM_STAT_DATA& sd, u64 size, u64 modified_time)
+{
+  return (static_cast<u64>(sd.Size) == size && static_cast<u64>(sd.ModificationTime) == modified_time);
 }
 
 std::string HashToString(const Hash& hash)
@@ -100,36 +245,132 @@ std::optional<Hash> HashFromString(const std::string_view& str)
 bool GetImageHash(CDImage* image, Hash* out_hash,
                   ProgressCallback* progress_callback /*= ProgressCallback::NullProgressCallback*/)
 {
-  MD5Digest digest;
+  std::vector<HashStream> streams(1);
+  for (u32 i = 1; i <= image->GetTrackCount(); i++)
+    AddTrackRanges(image, static_cast<u8>(i), &streams[0].ranges);
 
-  progress_callback->SetProgressRange(image->GetTrackCount());
-  progress_callback->SetProgressValue(0);
-  progress_callback->PushState();
+  progress_callback->SetStatusText("Computing image hash...");
+  if (!HashStreams(image, streams, progress_callback))
+    return false;
 
-  for (u32 i = 1; i <= image->GetTrackCount(); i++)
+  streams[0].digest.Final(out_hash->data());
+  return true;
+}
+
+bool GetTrackHash(CDImage* image, u8 track, Hash* out_hash,
+                  ProgressCallback* progress_callback /*= ProgressCallback::NullProgressCallback*/)
+{
+  std::vector<HashStream> streams(1);
+  AddTrackRanges(image, track, &streams[0].ranges);
+
+  progress_callback->SetFormattedStatusText("Computing hash for track %u...", track);
+  if (!HashStreams(image, streams, progress_callback))
+    return false;
+
+  streams[0].digest.Final(out_hash->data());
+  return true;
+}
+
+bool GetTrackHashes(CDImage* image, std::vector<Hash>* out_hashes,
+                    ProgressCallback* progress_callback /*= ProgressCallback::NullProgressCallback*/)
+{
+  std::vector<HashStream> streams(image->GetTrackCount());
+  for (u32 i = 0; i < image->GetTrackCount(); i++)
+    AddTrackRanges(image, static_cast<u8>(i + 1), &streams[i].ranges);
+
+  progress_callback->SetFormattedStatusText("Computing hashes for %u tracks...", image->GetTrackCount());
+  if (!HashStreams(image, streams, progress_callback))
+    return false;
+
+  out_hashes->resize(streams.size());
+  for (size_t i = 0; i < streams.size(); i++)
+    streams[i].digest.Final((*out_hashes)[i].data());
+
+  return true;
+}
+
+bool GetCachedTrackHashes(const std::string& cache_filename, CDImage* image, std::vector<Hash>* out_hashes)
+{
+  FILESYSTEM_STAT_DATA sd;
+  if (!CanCacheImage(image) || !FileSystem::StatFile(image->GetFileName().c_str(), &sd))
+    return false;
+
+  std::unique_ptr<ByteStream> stream =
+    ByteStream::OpenFile(cache_filename.c_str(), BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
+  if (!stream)
+    return false;
+
+  u32 signature, version;
+  if (!stream->ReadU32(&signature) || !stream->ReadU32(&version) || signature != CACHE_SIGNATURE ||
+      version != CACHE_VERSION)
   {
-    progress_callback->SetProgressValue(i - 1);
-    if (!ReadTrack(image, static_cast<u8>(i), &digest, progress_callback))
+    Log_WarningPrintf("Track hash cache is corrupted");
+    return false;
+  }
+
+  // records are only ever appended, so the last one for a path is the most recent
+  bool found = false;
+  std::string path;
+  std::vector<Hash> hashes;
+  while (stream->GetPosition() != stream->GetSize())
+  {
+    u64 size, modified_time;
+    u32 track_count;
+    if (!stream->ReadSizePrefixedString(&path) || !stream->ReadU64(&size) || !stream->ReadU64(&modified_time) ||
+        !stream->ReadU32(&track_count) || track_count > 99)
     {
-      progress_callback->PopState();
+      Log_WarningPrintf("Track hash cache entry is corrupted");
       return false;
     }
+
+    hashes.resize(track_count);
+    for (Hash& hash : hashes)
+    {
+      if (!stream->Read2(hash.data(), static_cast<u32>(hash.size())))
+        return false;
+    }
+
+    if (path == image->GetFileName())
+    {
+      found = (MatchesCachedImage(sd, size, modified_time) && track_count == image->GetTrackCount());
+      if (found)
+        *out_hashes = hashes;
+    }
   }
 
-  progress_callback->SetProgressValue(image->GetTrackCount());
-  digest.Final(out_hash->data());
-  return true;
+  return found;
 }
 
-bool GetTrackHash(CDImage* image, u8 track, Hash* out_hash,
-                  ProgressCallback* progress_callback /*= ProgressCallback::NullProgressCallback*/)
+bool AddCachedTrackHashes(const std::string& cache_filename, CDImage* image, const std::vector<Hash>& hashes)
 {
-  MD5Digest digest;
-  if (!ReadTrack(image, track, &digest, progress_callback))
+  FILESYSTEM_STAT_DATA sd;
+  if (!CanCacheImage(image) || !FileSystem::StatFile(image->GetFileName().c_str(), &sd))
     return false;
 
-  digest.Final(out_hash->data());
-  return true;
+  std::unique_ptr<ByteStream> stream = ByteStream::OpenFile(
+    cache_filename.c_str(), BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_SEEKABLE);
+  u32 signature, version;
+  if (!stream || !stream->ReadU32(&signature) || signature != CACHE_SIGNATURE || !stream->ReadU32(&version) ||
+      version != CACHE_VERSION || !stream->SeekToEnd())
+  {
+    Log_InfoPrintf("Creating new track hash cache file: '%s'", cache_filename.c_str());
+    stream = ByteStream::OpenFile(cache_filename.c_str(),
+                                  BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_TRUNCATE | BYTESTREAM_OPEN_WRITE);
+    if (!stream || !stream->WriteU32(CACHE_SIGNATURE) || !stream->WriteU32(CACHE_VERSION))
+    {
+      Log_ErrorPrintf("Failed to write track hash cache header");
+      return false;
+    }
+  }
+
+  bool result = stream->WriteSizePrefixedString(image->GetFileName());
+  result &= stream->WriteU64(static_cast<u64>(sd.Size));
+  result &= stream->WriteU64(static_cast<u64>(sd.ModificationTime));
+  result &= stream->WriteU32(static_cast<u32>(hashes.size()));
+  for (const Hash& hash : hashes)
+    result &= stream->Write2(hash.data(), static_cast<u32>(hash.size()));
+
+  return (result && stream->Commit());
 }
 
 } // namespace CDImageHasher
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include <array>
 #include <optional>
 #include <string>
+#include <vector>
 
 class CDImage;
 
@@ -21,4 +22,13 @@ bool GetImageHash(CDImage* image, Hash* out_hash,
 bool GetTrackHash(CDImage* image, u8 track, Hash* out_hash,
                   ProgressCallback* progress_callback = ProgressCallback::NullProgressCallback);
 
+/// Hashes every track. Sectors are read on the calling thread while worker threads hash them, several tracks at once.
+bool GetTrackHashes(CDImage* image, std::vector<Hash>* out_hashes,
+                    ProgressCallback* progress_callback = ProgressCallback::NullProgressCallback);
+
+/// Track hashes from a previous run, keyed by the image's path, size and modification time. Fails if the image has
+/// changed since they were added, or if it's a format which spreads its data over several files.
+bool GetCachedTrackHashes(const std::string& cache_filename, CDImage* image, std::vector<Hash>* out_hashes);
+bool AddCachedTrackHashes(const std::string& cache_filename, CDImage* image, const std::vector<Hash>& hashes);
+
 } // namespace CDImageHasher
\ No newline at end of file
@@ -30,9 +30,11 @@ public:
   u32 GetCurrentSubImage() const override;
   std::string GetSubImageMetadata(u32 index, const std::string_view& type) const override;
   bool SwitchSubImage(u32 index, Error* error) override;
+  void SetReadCache(u32 cache_blocks, u32 readahead_blocks) override;
 
 protected:
   bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override;
+  const u8* GetSectorPointerFromIndex(const Index& index, LBA lba_in_index) override;
 
 private:
   struct Entry
@@ -45,6 +47,8 @@ private:
   std::vector<Entry> m_entries;
   std::unique_ptr<CDImage> m_current_image;
   u32 m_current_image_index = UINT32_C(0xFFFFFFFF);
+  u32 m_cache_blocks = 0;
+  u32 m_readahead_blocks = 0;
   bool m_apply_patches = false;
 };
 
@@ -142,6 +146,9 @@ bool CDImageM3u::SwitchSubImage(u32 index, Error* error)
     return false;
   }
 
+  if (m_cache_blocks > 0)
+    new_image->SetReadCache(m_cache_blocks, m_readahead_blocks);
+
   CopyTOC(new_image.get());
   m_current_image = std::move(new_image);
   m_current_image_index = index;
@@ -151,6 +158,13 @@ bool CDImageM3u::SwitchSubImage(u32 index, Error* error)
   return true;
 }
 
+void CDImageM3u::SetReadCache(u32 cache_blocks, u32 readahead_blocks)
+{
+  m_cache_blocks = cache_blocks;
+  m_readahead_blocks = readahead_blocks;
+  m_current_image->SetReadCache(cache_blocks, readahead_blocks);
+}
+
 std::string CDImageM3u::GetSubImageMetadata(u32 index, const std::string_view& type) const
 {
   if (index > m_entries.size())
@@ -169,6 +183,11 @@ bool CDImageM3u::ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_i
   return m_current_image->ReadSectorFromIndex(buffer, index, lba_in_index);
 }
 
+const u8* CDImageM3u::GetSectorPointerFromIndex(const Index& index, LBA lba_in_index)
+{
+  return m_current_image->GetSectorPointerFromIndex(index, lba_in_index);
+}
+
 bool CDImageM3u::ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index)
 {
   return m_current_image->ReadSubChannelQ(subq, index, lba_in_index);
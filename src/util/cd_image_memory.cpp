@@ -26,6 +26,7 @@ public:
 
 protected:
   bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override;
+  const u8* GetSectorPointerFromIndex(const Index& index, LBA lba_in_index) override;
 
 private:
   u8* m_memory = nullptr;
@@ -151,6 +152,17 @@ bool CDImageMemory::ReadSectorFromIndex(void* buffer, const Index& index, LBA lb
   return true;
 }
 
+const u8* CDImageMemory::GetSectorPointerFromIndex(const Index& index, LBA lba_in_index)
+{
+  DebugAssert(index.file_index == 0);
+
+  const u64 sector_number = index.file_offset + lba_in_index;
+  if (sector_number >= m_memory_sectors)
+    return nullptr;
+
+  return &m_memory[static_cast<size_t>(sector_number) * static_cast<size_t>(RAW_SECTOR_SIZE)];
+}
+
 std::unique_ptr<CDImage>
 CDImage::CreateMemoryImage(CDImage* image, ProgressCallback* progress /* = ProgressCallback::NullProgressCallback */)
 {
@@ -33,9 +33,12 @@ public:
   std::string GetSubImageMetadata(u32 index, const std::string_view& type) const override;
 
   PrecacheResult Precache(ProgressCallback* progress = ProgressCallback::NullProgressCallback) override;
+  PrecacheResult PreloadMappedFiles(ProgressCallback* progress = ProgressCallback::NullProgressCallback) override;
+  void SetReadCache(u32 cache_blocks, u32 readahead_blocks) override;
 
 protected:
   bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override;
+  const u8* GetSectorPointerFromIndex(const Index& index, LBA lba_in_index) override;
 
 private:
   bool ReadV1Patch(std::FILE* fp);
@@ -425,6 +428,17 @@ CDImage::PrecacheResult CDImagePPF::Precache(ProgressCallback* progress /*= Prog
   return m_parent_image->Precache(progress);
 }
 
+CDImage::PrecacheResult
+CDImagePPF::PreloadMappedFiles(ProgressCallback* progress /*= ProgressCallback::NullProgressCallback*/)
+{
+  return m_parent_image->PreloadMappedFiles(progress);
+}
+
+void CDImagePPF::SetReadCache(u32 cache_blocks, u32 readahead_blocks)
+{
+  m_parent_image->SetReadCache(cache_blocks, readahead_blocks);
+}
+
 bool CDImagePPF::ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index)
 {
   DebugAssert(index.file_index == 0);
@@ -438,6 +452,18 @@ bool CDImagePPF::ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_i
   return true;
 }
 
+const u8* CDImagePPF::GetSectorPointerFromIndex(const Index& index, LBA lba_in_index)
+{
+  DebugAssert(index.file_index == 0);
+
+  const u32 sector_number = index.start_lba_on_disc + lba_in_index;
+  const auto it = m_replacement_map.find(sector_number);
+  if (it == m_replacement_map.end())
+    return m_parent_image->GetSectorPointerFromIndex(index, lba_in_index);
+
+  return &m_replacement_data[it->second];
+}
+
 std::unique_ptr<CDImage>
 CDImage::OverlayPPFPatch(const char* filename, std::unique_ptr<CDImage> parent_image,
                          ProgressCallback* progress /* = ProgressCallback::NullProgressCallback */)
@@ -193,17 +193,19 @@ static void SIGSEGVHandler(int sig, siginfo_t* info, void* ctx)
 
 #endif
 
-  std::lock_guard<std::mutex> guard(m_handler_lock);
-  for (const RegisteredHandler& rh : m_handlers)
   {
-    if (rh.callback(exception_pc, exception_address, is_write) == HandlerResult::ContinueExecution)
+    std::lock_guard<std::mutex> guard(m_handler_lock);
+    for (const RegisteredHandler& rh : m_handlers)
     {
-      s_in_handler = false;
-      return;
+      if (rh.callback(exception_pc, exception_address, is_write) == HandlerResult::ContinueExecution)
+      {
+        s_in_handler = false;
+        return;
+      }
     }
   }
 
-  // call old signal handler
+  // call old signal handler, without the lock held, since it may not return (e.g. mapped file reads jump out)
 #if !defined(__APPLE__) && !defined(__aarch64__)
   const struct sigaction& sa = s_old_sigsegv_action;
 #else
@@ -0,0 +1,388 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "uring_file_reader.h"
+
+#include "common/assert.h"
+#include "common/error.h"
+#include "common/file_system.h"
+#include "common/log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+Log_SetChannel(URingFileReader);
+
+URingFileReader::URingFileReader() = default;
+
+URingFileReader::~URingFileReader()
+{
+  // the kernel is still writing to the buffers of any reads in flight
+  while (m_in_flight > 0)
+  {
+    if (!Submit(1))
+      break;
+
+    ReapCompletions();
+  }
+
+  DestroyRing();
+}
+
+std::unique_ptr<URingFileReader> URingFileReader::Create(u32 cache_blocks, u32 readahead_blocks, Error* error)
+{
+  // one block for each end of a read which straddles blocks, plus one which isn't being read into
+  const u32 num_blocks = std::max(cache_blocks, readahead_blocks + 3);
+
+  std::unique_ptr<URingFileReader> reader(new URingFileReader());
+  if (!reader->CreateRing(num_blocks, error))
+    return {};
+
+  reader->m_blocks.resize(num_blocks);
+  for (Block& block : reader->m_blocks)
+    block.data.resize(CACHE_BLOCK_SIZE);
+  reader->m_readahead_blocks = readahead_blocks;
+  return reader;
+}
+
+bool URingFileReader::CreateRing(u32 entries, Error* error)
+{
+  io_uring_params params = {};
+  m_ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+  if (m_ring_fd < 0)
+  {
+    Error::SetErrno(error, errno);
+    return false;
+  }
+
+  m_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(u32);
+  m_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+
+  const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap)
+    m_sq_ring_size = m_cq_ring_size = std::max(m_sq_ring_size, m_cq_ring_size);
+
+  void* sq_ring = mmap(nullptr, m_sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd,
+                       IORING_OFF_SQ_RING);
+  if (sq_ring == MAP_FAILED)
+  {
+    Error::SetErrno(error, errno);
+    return false;
+  }
+  m_sq_ring = sq_ring;
+
+  if (single_mmap)
+  {
+    m_cq_ring = m_sq_ring;
+  }
+  else
+  {
+    void* cq_ring = mmap(nullptr, m_cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd,
+                         IORING_OFF_CQ_RING);
+    if (cq_ring == MAP_FAILED)
+    {
+      Error::SetErrno(error, errno);
+      return false;
+    }
+    m_cq_ring = cq_ring;
+  }
+
+  void* sqes =
+    mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED)
+  {
+    Error::SetErrno(error, errno);
+    return false;
+  }
+  m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+  u8* sq_ptr = static_cast<u8*>(m_sq_ring);
+  m_sq_head = reinterpret_cast<u32*>(sq_ptr + params.sq_off.head);
+  m_sq_tail = reinterpret_cast<u32*>(sq_ptr + params.sq_off.tail);
+  m_sq_array = reinterpret_cast<u32*>(sq_ptr + params.sq_off.array);
+  m_sq_mask = *reinterpret_cast<const u32*>(sq_ptr + params.sq_off.ring_mask);
+  m_sq_entries = params.sq_entries;
+
+  u8* cq_ptr = static_cast<u8*>(m_cq_ring);
+  m_cq_head = reinterpret_cast<u32*>(cq_ptr + params.cq_off.head);
+  m_cq_tail = reinterpret_cast<u32*>(cq_ptr + params.cq_off.tail);
+  m_cqes = reinterpret_cast<io_uring_cqe*>(cq_ptr + params.cq_off.cqes);
+  m_cq_mask = *reinterpret_cast<const u32*>(cq_ptr + params.cq_off.ring_mask);
+  return true;
+}
+
+void URingFileReader::DestroyRing()
+{
+  if (m_sqes)
+    munmap(m_sqes, m_sqes_size);
+  if (m_cq_ring && m_cq_ring != m_sq_ring)
+    munmap(m_cq_ring, m_cq_ring_size);
+  if (m_sq_ring)
+    munmap(m_sq_ring, m_sq_ring_size);
+  if (m_ring_fd >= 0)
+    close(m_ring_fd);
+
+  m_sqes = nullptr;
+  m_cq_ring = nullptr;
+  m_sq_ring = nullptr;
+  m_ring_fd = -1;
+}
+
+u32 URingFileReader::AddFile(std::FILE* fp)
+{
+  const s64 size = FileSystem::FSize64(fp);
+  m_files.push_back(File{fileno(fp), static_cast<u64>(std::max<s64>(size, 0))});
+  return static_cast<u32>(m_files.size() - 1);
+}
+
+bool URingFileReader::Read(u32 file_index, u64 offset, void* buffer, u32 size)
+{
+  DebugAssert(file_index < m_files.size());
+  const File& file = m_files[file_index];
+  if (size == 0 || offset >= file.size || (file.size - offset) < size)
+    return false;
+
+  const u64 first_block = offset / CACHE_BLOCK_SIZE;
+  const u64 last_block = (offset + size - 1) / CACHE_BLOCK_SIZE;
+
+  // queue any blocks we don't have along with the read-ahead, so it all goes in a single submission
+  for (u64 block_index = first_block; block_index <= last_block; block_index++)
+  {
+    Block* block = LookupBlock(file_index, block_index);
+    if (!block)
+    {
+      if (!(block = AllocateBlock(file_index, block_index, true)))
+        return false;
+
+      QueueRead(block);
+    }
+
+    block->last_used = ++m_block_counter;
+  }
+
+  QueueReadahead(file_index, last_block);
+  if (m_queued > 0 && !Submit(0))
+    return false;
+
+  u8* dst = static_cast<u8*>(buffer);
+  u32 block_offset = static_cast<u32>(offset % CACHE_BLOCK_SIZE);
+  u32 remaining = size;
+  for (u64 block_index = first_block; block_index <= last_block; block_index++)
+  {
+    // read-ahead replaces the least recently used blocks first, so this only misses with a tiny cache
+    Block* block = LookupBlock(file_index, block_index);
+    if (!block)
+    {
+      if (!(block = AllocateBlock(file_index, block_index, true)))
+        return false;
+
+      QueueRead(block);
+    }
+
+    if (!WaitForBlock(block))
+      return false;
+
+    const u32 copy_size = std::min(CACHE_BLOCK_SIZE - block_offset, remaining);
+    if ((block_offset + copy_size) > block->size)
+      return false;
+
+    std::memcpy(dst, &block->data[block_offset], copy_size);
+    dst += copy_size;
+    remaining -= copy_size;
+    block_offset = 0;
+  }
+
+  return true;
+}
+
+URingFileReader::Block* URingFileReader::LookupBlock(u32 file_index, u64 block_index)
+{
+  for (Block& block : m_blocks)
+  {
+    if (block.state != BlockState::Empty && block.file_index == file_index && block.block_index == block_index)
+      return &block;
+  }
+
+  return nullptr;
+}
+
+URingFileReader::Block* URingFileReader::AllocateBlock(u32 file_index, u64 block_index, bool wait)
+{
+  for (;;)
+  {
+    Block* best = nullptr;
+    for (Block& block : m_blocks)
+    {
+      if (block.state == BlockState::Loading)
+        continue;
+
+      if (block.state == BlockState::Empty)
+      {
+        best = &block;
+        break;
+      }
+
+      if (!best || block.last_used < best->last_used)
+        best = &block;
+    }
+
+    if (best)
+    {
+      best->file_index = file_index;
+      best->block_index = block_index;
+      best->size = 0;
+      best->last_used = ++m_block_counter;
+      best->state = BlockState::Empty;
+      return best;
+    }
+
+    // every block is being read into, so wait for one of them to finish
+    if (!wait || !Submit(1))
+      return nullptr;
+
+    ReapCompletions();
+  }
+}
+
+void URingFileReader::QueueRead(Block* block)
+{
+  DebugAssert(block->state == BlockState::Empty && m_queued < m_sq_entries);
+  const File& file = m_files[block->file_index];
+  const u64 offset = block->block_index * CACHE_BLOCK_SIZE;
+  block->iov.iov_base = block->data.data();
+  block->iov.iov_len = static_cast<size_t>(std::min<u64>(CACHE_BLOCK_SIZE, file.size - offset));
+  block->state = BlockState::Loading;
+  block->error = false;
+
+  // we're the only producer, so the tail doesn't need to be loaded atomically
+  const u32 tail = *m_sq_tail;
+  const u32 sqe_index = tail & m_sq_mask;
+  io_uring_sqe* sqe = &m_sqes[sqe_index];
+  std::memset(sqe, 0, sizeof(io_uring_sqe));
+  sqe->opcode = IORING_OP_READV;
+  sqe->fd = file.fd;
+  sqe->off = offset;
+  sqe->addr = reinterpret_cast<u64>(&block->iov);
+  sqe->len = 1;
+  sqe->user_data = static_cast<u64>(block - m_blocks.data());
+  m_sq_array[sqe_index] = sqe_index;
+  std::atomic_ref<u32>(*m_sq_tail).store(tail + 1, std::memory_order_release);
+
+  m_queued++;
+  m_in_flight++;
+}
+
+void URingFileReader::QueueReadahead(u32 file_index, u64 block_index)
+{
+  const File& file = m_files[file_index];
+  for (u32 i = 1; i <= m_readahead_blocks; i++)
+  {
+    const u64 readahead_block_index = block_index + i;
+    if ((readahead_block_index * CACHE_BLOCK_SIZE) >= file.size)
+      break;
+
+    if (LookupBlock(file_index, readahead_block_index))
+      continue;
+
+    // don't stall the read we're servicing if everything is busy
+    Block* block = AllocateBlock(file_index, readahead_block_index, false);
+    if (!block)
+      break;
+
+    QueueRead(block);
+  }
+}
+
+bool URingFileReader::WaitForBlock(Block* block)
+{
+  for (;;)
+  {
+    ReapCompletions();
+    if (block->state != BlockState::Loading)
+      break;
+
+    if (!Submit(1))
+      return false;
+  }
+
+  if (block->error)
+  {
+    // try again next time
+    block->state = BlockState::Empty;
+    block->error = false;
+    return false;
+  }
+
+  return true;
+}
+
+bool URingFileReader::Submit(u32 min_complete)
+{
+  const u32 flags = (min_complete > 0) ? IORING_ENTER_GETEVENTS : 0;
+  int ret;
+  do
+  {
+    ret = static_cast<int>(syscall(__NR_io_uring_enter, m_ring_fd, m_queued, min_complete, flags, nullptr, 0));
+  } while (ret < 0 && errno == EINTR);
+
+  if (ret < 0)
+  {
+    Log_ErrorFmt("io_uring_enter() failed: {}", errno);
+    return false;
+  }
+
+  m_queued -= std::min(static_cast<u32>(ret), m_queued);
+  return true;
+}
+
+void URingFileReader::ReapCompletions()
+{
+  u32 head = *m_cq_head;
+  const u32 tail = std::atomic_ref<u32>(*m_cq_tail).load(std::memory_order_acquire);
+  for (; head != tail; head++)
+  {
+    const io_uring_cqe& cqe = m_cqes[head & m_cq_mask];
+    DebugAssert(cqe.user_data < m_blocks.size());
+    CompleteRead(&m_blocks[static_cast<size_t>(cqe.user_data)], cqe.res);
+  }
+
+  std::atomic_ref<u32>(*m_cq_head).store(head, std::memory_order_release);
+}
+
+void URingFileReader::CompleteRead(Block* block, s32 result)
+{
+  DebugAssert(block->state == BlockState::Loading && m_in_flight > 0);
+  m_in_flight--;
+  block->state = BlockState::Loaded;
+  if (result < 0)
+  {
+    Log_ErrorFmt("Read of block {} in file {} failed: {}", block->block_index, block->file_index, -result);
+    block->error = true;
+    return;
+  }
+
+  // short reads can happen on network filesystems, pick up the rest synchronously
+  const File& file = m_files[block->file_index];
+  const u32 expected_size = static_cast<u32>(block->iov.iov_len);
+  u32 size = static_cast<u32>(result);
+  while (size < expected_size)
+  {
+    const ssize_t ret = pread(file.fd, &block->data[size], expected_size - size,
+                              static_cast<off_t>(block->block_index * CACHE_BLOCK_SIZE + size));
+    if (ret < 0 && errno == EINTR)
+      continue;
+    else if (ret <= 0)
+      break;
+
+    size += static_cast<u32>(ret);
+  }
+
+  block->size = size;
+}
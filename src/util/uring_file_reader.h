@@ -0,0 +1,103 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+
+#include "common/heap_array.h"
+#include "common/types.h"
+
+#include <cstdio>
+#include <memory>
+#include <sys/uio.h>
+#include <vector>
+
+class Error;
+
+struct io_uring_cqe;
+struct io_uring_sqe;
+
+/// Reads ranges of one or more files through an io_uring, keeping a small cache of fixed-size blocks. The blocks
+/// following each read are queued in the same submission as the read itself, so a sequential reader usually finds
+/// its data already in memory, and no thread has to block on each request. Not thread safe.
+class URingFileReader
+{
+public:
+  static constexpr u32 CACHE_BLOCK_SIZE = 64 * 1024;
+
+  ~URingFileReader();
+
+  /// Returns nullptr if the kernel doesn't support io_uring, or it has been blocked (e.g. by seccomp).
+  static std::unique_ptr<URingFileReader> Create(u32 cache_blocks, u32 readahead_blocks, Error* error);
+
+  /// Registers a file for reading, returning its index. The file must stay open for the lifetime of the reader.
+  u32 AddFile(std::FILE* fp);
+
+  /// Reads size bytes from offset in the file. Fails if any of the range is past the end of the file.
+  bool Read(u32 file_index, u64 offset, void* buffer, u32 size);
+
+private:
+  enum class BlockState : u8
+  {
+    Empty,
+    Loading,
+    Loaded,
+  };
+
+  struct Block
+  {
+    DynamicHeapArray<u8, 16> data;
+    iovec iov = {}; // READV is available on older kernels than READ
+    u64 block_index = 0;
+    u32 file_index = 0;
+    u32 size = 0;
+    u32 last_used = 0;
+    BlockState state = BlockState::Empty;
+    bool error = false;
+  };
+
+  struct File
+  {
+    int fd;
+    u64 size;
+  };
+
+  URingFileReader();
+
+  bool CreateRing(u32 entries, Error* error);
+  void DestroyRing();
+
+  Block* LookupBlock(u32 file_index, u64 block_index);
+  Block* AllocateBlock(u32 file_index, u64 block_index, bool wait);
+  void QueueRead(Block* block);
+  void QueueReadahead(u32 file_index, u64 block_index);
+  bool WaitForBlock(Block* block);
+
+  bool Submit(u32 min_complete);
+  void ReapCompletions();
+  void CompleteRead(Block* block, s32 result);
+
+  std::vector<File> m_files;
+  std::vector<Block> m_blocks;
+  u32 m_block_counter = 0;
+  u32 m_readahead_blocks = 0;
+  u32 m_in_flight = 0;
+  u32 m_queued = 0;
+
+  int m_ring_fd = -1;
+  void* m_sq_ring = nullptr;
+  void* m_cq_ring = nullptr;
+  io_uring_sqe* m_sqes = nullptr;
+  size_t m_sq_ring_size = 0;
+  size_t m_cq_ring_size = 0;
+  size_t m_sqes_size = 0;
+
+  u32* m_sq_head = nullptr;
+  u32* m_sq_tail = nullptr;
+  u32* m_sq_array = nullptr;
+  u32 m_sq_mask = 0;
+  u32 m_sq_entries = 0;
+  u32* m_cq_head = nullptr;
+  u32* m_cq_tail = nullptr;
+  io_uring_cqe* m_cqes = nullptr;
+  u32 m_cq_mask = 0;
+};